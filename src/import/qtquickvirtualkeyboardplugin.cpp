@@ -39,6 +39,10 @@
 #include <QtVirtualKeyboard/private/enterkeyactionattachedtype_p.h>
 #include <QtVirtualKeyboard/qvirtualkeyboardtrace.h>
 #include <QtVirtualKeyboard/private/shadowinputcontext_p.h>
+#include <QtVirtualKeyboard/private/keyboardlayoutpool_p.h>
+#include <QtVirtualKeyboard/private/keyhitindex_p.h>
+#include <QtVirtualKeyboard/private/latencytracer_p.h>
+#include <QtVirtualKeyboard/private/layoutregistry_p.h>
 #include <QtVirtualKeyboard/private/qvirtualkeyboard_staticplugin_p.h>
 
 QT_BEGIN_NAMESPACE
@@ -58,7 +62,6 @@ void QtQuickVirtualKeyboardPlugin::registerTypes(const char *uri)
     Q_VKB_IMPORT_PLUGIN(QtQuick2Plugin)
     Q_VKB_IMPORT_PLUGIN(QtQuick2WindowPlugin)
     Q_VKB_IMPORT_PLUGIN(QtQuickLayoutsPlugin)
-    Q_VKB_IMPORT_PLUGIN(QmlFolderListModelPlugin)
     Q_VKB_IMPORT_PLUGIN(QtQuickVirtualKeyboardSettingsPlugin)
     Q_VKB_IMPORT_PLUGIN(QtQuickVirtualKeyboardStylesPlugin)
 #endif
@@ -85,6 +88,11 @@ void QtQuickVirtualKeyboardPlugin::registerTypes(const char *uri)
     qmlRegisterType<QVirtualKeyboardTrace>(uri, 2, 4, "Trace");
     qRegisterMetaType<ShadowInputContext *>("ShadowInputContext*");
     qmlRegisterUncreatableType<ShadowInputContext>(uri, 2, 2, "ShadowInputContext", QLatin1String("Cannot create shadow input context"));
+    qRegisterMetaType<LatencyTracer *>("LatencyTracer*");
+    qmlRegisterUncreatableType<LatencyTracer>(uri, 2, 15, "LatencyTracer", QLatin1String("Cannot create latency tracer"));
+    qmlRegisterType<KeyHitIndex>(uri, 2, 15, "KeyHitIndex");
+    qmlRegisterType<KeyboardLayoutPool>(uri, 2, 15, "KeyboardLayoutPool");
+    qmlRegisterType<LayoutRegistry>(uri, 2, 15, "LayoutRegistry");
 
     const QString path(QStringLiteral("qrc:///QtQuick/VirtualKeyboard/content/"));
     qmlRegisterType(QUrl(path + QLatin1String("InputPanel.qml")), uri, 1, 0, "InputPanel");
@@ -36,12 +36,19 @@ namespace QtVirtualKeyboard {
 
 QMutex ExtensionLoader::m_mutex;
 QMultiHash<QString, QJsonObject> ExtensionLoader::m_plugins;
+QHash<QString, QJsonObject> ExtensionLoader::m_latestPlugins;
 bool ExtensionLoader::m_alreadyDiscovered = false;
 
 Q_GLOBAL_STATIC_WITH_ARGS(QFactoryLoader, loader,
         (QVirtualKeyboardExtensionPluginFactoryInterface_iid,
          QLatin1String("/virtualkeyboard")))
 
+static int pluginVersion(const QJsonObject &metaData)
+{
+    const QJsonValue version = metaData.value(QLatin1String("Version"));
+    return version.isDouble() ? int(version.toDouble()) : -1;
+}
+
 QMultiHash<QString, QJsonObject> ExtensionLoader::plugins(bool reload)
 {
     QMutexLocker lock(&m_mutex);
@@ -58,33 +65,13 @@ QMultiHash<QString, QJsonObject> ExtensionLoader::plugins(bool reload)
 
 QJsonObject ExtensionLoader::loadMeta(const QString &extensionName)
 {
-    QJsonObject metaData;
-    metaData = QJsonObject();
-    metaData.insert(QLatin1String("index"), -1);
-
-    QList<QJsonObject> candidates = ExtensionLoader::plugins().values(extensionName);
-
-    int versionFound = -1;
-    int idx = -1;
-
-    // figure out which version of the plugin we want
-    for (int i = 0; i < candidates.size(); ++i) {
-        QJsonObject meta = candidates[i];
-        if (meta.contains(QLatin1String("Version"))
-                && meta.value(QLatin1String("Version")).isDouble()) {
-            int ver = int(meta.value(QLatin1String("Version")).toDouble());
-            if (ver > versionFound) {
-                versionFound = ver;
-                idx = i;
-            }
-        }
-    }
+    QMutexLocker lock(&m_mutex);
 
-    if (idx != -1) {
-        metaData = candidates[idx];
-        return metaData;
+    if (!m_alreadyDiscovered) {
+        loadPluginMetadata();
+        m_alreadyDiscovered = true;
     }
-    return QJsonObject();
+    return m_latestPlugins.value(extensionName);
 }
 
 QVirtualKeyboardExtensionPlugin *ExtensionLoader::loadPlugin(QJsonObject metaData)
@@ -98,6 +85,9 @@ QVirtualKeyboardExtensionPlugin *ExtensionLoader::loadPlugin(QJsonObject metaDat
 
 void ExtensionLoader::loadPluginMetadata()
 {
+    m_plugins.clear();
+    m_latestPlugins.clear();
+
     QFactoryLoader *l = loader();
     QList<QJsonObject> meta = l->metaData();
     for (int i = 0; i < meta.size(); ++i) {
@@ -106,6 +96,11 @@ void ExtensionLoader::loadPluginMetadata()
         if (!name.isEmpty()) {
             obj.insert(QLatin1String("index"), i);
             m_plugins.insert(name, obj);
+
+            // loadMeta() returns the highest version of each extension
+            const int version = pluginVersion(obj);
+            if (version != -1 && version > pluginVersion(m_latestPlugins.value(name)))
+                m_latestPlugins.insert(name, obj);
         }
     }
 }
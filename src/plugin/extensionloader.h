@@ -50,6 +50,7 @@ private:
 private:
     static QMutex m_mutex;
     static QMultiHash<QString, QJsonObject> m_plugins;
+    static QHash<QString, QJsonObject> m_latestPlugins;
     static bool m_alreadyDiscovered;
 };
 
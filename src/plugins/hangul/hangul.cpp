@@ -32,333 +32,199 @@
 QT_BEGIN_NAMESPACE
 namespace QtVirtualKeyboard {
 
-const QList<ushort> Hangul::initials = QList<ushort>()
-    << 0x3131 << 0x3132 << 0x3134 << 0x3137 << 0x3138 << 0x3139 << 0x3141
-    << 0x3142 << 0x3143 << 0x3145 << 0x3146 << 0x3147 << 0x3148 << 0x3149
-    << 0x314A << 0x314B << 0x314C << 0x314D << 0x314E;
-const QList<ushort> Hangul::finals = QList<ushort>()
-    << 0x0000 << 0x3131 << 0x3132 << 0x3133 << 0x3134 << 0x3135 << 0x3136
-    << 0x3137 << 0x3139 << 0x313A << 0x313B << 0x313C << 0x313D << 0x313E
-    << 0x313F << 0x3140 << 0x3141 << 0x3142 << 0x3144 << 0x3145 << 0x3146
-    << 0x3147 << 0x3148 << 0x314A << 0x314B << 0x314C << 0x314D << 0x314E;
-const QMap<ushort, Hangul::HangulMedialIndex> Hangul::doubleMedialMap =
-    Hangul::initDoubleMedialMap();
-const QMap<ushort, Hangul::HangulFinalIndex> Hangul::doubleFinalMap =
-    Hangul::initDoubleFinalMap();
-const int Hangul::SBase = 0xAC00;
-const int Hangul::LBase = 0x1100;
-const int Hangul::VBase = 0x314F;
-const int Hangul::TBase = 0x11A7;
-const int Hangul::LCount = 19;
-const int Hangul::VCount = 21;
-const int Hangul::TCount = 28;
-const int Hangul::NCount = Hangul::VCount * Hangul::TCount; // 588
-const int Hangul::SCount = Hangul::LCount * Hangul::NCount; // 11172
+namespace {
 
-/*!
-    \class QtVirtualKeyboard::Hangul
-    \internal
-*/
+constexpr ushort initials[] = {
+    0x3131, 0x3132, 0x3134, 0x3137, 0x3138, 0x3139, 0x3141,
+    0x3142, 0x3143, 0x3145, 0x3146, 0x3147, 0x3148, 0x3149,
+    0x314A, 0x314B, 0x314C, 0x314D, 0x314E
+};
 
-QString Hangul::decompose(const QString &source)
-{
-    QString result;
-    const int len = source.length();
-    for (int i = 0; i < len; i++) {
-        QChar ch = source.at(i);
-        int SIndex = (int)ch.unicode() - SBase;
-        if (SIndex >= 0 && SIndex < SCount) {
+constexpr ushort finals[] = {
+    0x0000, 0x3131, 0x3132, 0x3133, 0x3134, 0x3135, 0x3136,
+    0x3137, 0x3139, 0x313A, 0x313B, 0x313C, 0x313D, 0x313E,
+    0x313F, 0x3140, 0x3141, 0x3142, 0x3144, 0x3145, 0x3146,
+    0x3147, 0x3148, 0x314A, 0x314B, 0x314C, 0x314D, 0x314E
+};
 
-            // Decompose initial consonant
-            result.append(QChar((int)initials[SIndex / NCount]));
+} // namespace
 
-            // Decompose medial vowel and check if it consists of double Jamo
-            int VIndex = (SIndex % NCount) / TCount;
-            ushort key = findDoubleMedial((HangulMedialIndex)VIndex);
-            if (key) {
-                HangulMedialIndex VIndexA, VIndexB;
-                unpackDoubleMedial(key, VIndexA, VIndexB);
-                result.append(QChar(VBase + (int)VIndexA));
-                result.append(QChar(VBase + (int)VIndexB));
-            } else {
-                result.append(QChar(VBase + VIndex));
-            }
-
-            // Decompose final consonant and check if it consists of double Jamo
-            int TIndex = SIndex % TCount;
-            if (TIndex != 0) {
-                key = findDoubleFinal((HangulFinalIndex)TIndex);
-                if (key) {
-                    HangulFinalIndex TIndexA, TIndexB;
-                    unpackDoubleFinal(key, TIndexA, TIndexB);
-                    result.append(QChar(finals[(int)TIndexA]));
-                    result.append(QChar(finals[(int)TIndexB]));
-                } else {
-                    result.append(QChar(finals[TIndex]));
-                }
-            }
-        } else {
-            result.append(ch);
-        }
-    }
-    return result;
-}
-
-QString Hangul::compose(const QString &source)
+// Transition tables of the composition automaton, built at compile time.
+struct Hangul::Tables
 {
-    const int len = source.length();
-    if (len == 0)
-        return QString();
-
-    // Always add the initial character into buffer.
-    // The last character will serve as the current
-    // Hangul Syllable.
-    QChar last = source.at(0);
-    QString result = QString(last);
-
-    // Go through the input buffer starting at next character
-    for (int i = 1; i < len; i++) {
-        const QChar ch = source.at(i);
-
-        // Check to see if the character is Hangul Compatibility Jamo
-        const ushort unicode = ch.unicode();
-        if (isJamo(unicode)) {
-
-            // Check to see if the character is syllable
-            const ushort lastUnicode = last.unicode();
-            int SIndex = (int)lastUnicode - SBase;
-            if (SIndex >= 0 && SIndex < SCount) {
-
-                // Check to see if the syllable type is LV or LV+T
-                int TIndex = SIndex % TCount;
-                if (TIndex == 0) {
-
-                    // If the current character is final consonant, then
-                    // make syllable of form LV+T
-                    TIndex = finals.indexOf(unicode);
-                    if (TIndex != -1) {
-                        last = QChar((int)lastUnicode + TIndex);
-                        result.replace(result.length() - 1, 1, last);
-                        continue;
-                    }
-
-                    // Check to see if the current character is vowel
-                    HangulMedialIndex VIndexB = (HangulMedialIndex)((int)unicode - VBase);
-                    if (isMedial(VIndexB)) {
-
-                        // Some medial Jamos do not exist in the keyboard layout as is.
-                        // Such Jamos can only be formed by combining the two specific Jamos,
-                        // aka the double Jamos.
-
-                        HangulMedialIndex VIndexA = (HangulMedialIndex)((SIndex % NCount) / TCount);
-                        if (isMedial(VIndexA)) {
-
-                            // Search the double medial map if such a combination exists
-                            ushort key = packDoubleMedial(VIndexA, VIndexB);
-                            const auto it = doubleMedialMap.constFind(key);
-                            if (it != doubleMedialMap.cend()) {
-
-                                // Update syllable by adding the difference between
-                                // the vowels indices
-                                HangulMedialIndex VIndexD = it.value();
-                                int VDiff = (int)VIndexD - (int)VIndexA;
-                                last = QChar((int)lastUnicode + VDiff * TCount);
-                                result.replace(result.length() - 1, 1, last);
-                                continue;
-                            }
-                        }
-                    }
+    qint8 initialOf[JamoCount];         // Jamo -> LIndex, or -1
+    qint8 finalOf[JamoCount];           // Jamo -> TIndex, or 0
+    qint8 doubleMedial[VCount][VCount]; // VIndex x VIndex -> VIndex, or -1
+    qint8 doubleFinal[TCount][TCount];  // TIndex x TIndex -> TIndex, or 0
+    qint8 splitFinal[TCount][2];        // TIndex -> remaining TIndex, moved LIndex
+};
+
+constexpr Hangul::Tables Hangul::makeTables()
+{
+    Tables t = {};
 
-                } else {
+    for (int i = 0; i < JamoCount; ++i) {
+        t.initialOf[i] = -1;
+        t.finalOf[i] = HANGUL_FINAL_NONE;
+    }
+    for (int l = 0; l < LCount; ++l)
+        t.initialOf[initials[l] - JamoBase] = qint8(l);
+    // Only the consonants which can also start a syllable are accepted as
+    // final consonants, the double finals are composed from two keys
+    for (int f = HANGUL_FINAL_KIYEOK; f < TCount; ++f) {
+        if (t.initialOf[finals[f] - JamoBase] != -1)
+            t.finalOf[finals[f] - JamoBase] = qint8(f);
+    }
 
-                    // Check to see if current jamo is vowel
-                    int VIndex = (int)unicode - VBase;
-                    if (VIndex >= 0 && VIndex < VCount) {
+    for (int a = 0; a < VCount; ++a) {
+        for (int b = 0; b < VCount; ++b)
+            t.doubleMedial[a][b] = -1;
+    }
+    t.doubleMedial[HANGUL_MEDIAL_O][HANGUL_MEDIAL_A] = HANGUL_MEDIAL_WA;
+    t.doubleMedial[HANGUL_MEDIAL_O][HANGUL_MEDIAL_AE] = HANGUL_MEDIAL_WAE;
+    t.doubleMedial[HANGUL_MEDIAL_O][HANGUL_MEDIAL_I] = HANGUL_MEDIAL_OE;
+    t.doubleMedial[HANGUL_MEDIAL_U][HANGUL_MEDIAL_EO] = HANGUL_MEDIAL_WEO;
+    t.doubleMedial[HANGUL_MEDIAL_U][HANGUL_MEDIAL_E] = HANGUL_MEDIAL_WE;
+    t.doubleMedial[HANGUL_MEDIAL_U][HANGUL_MEDIAL_I] = HANGUL_MEDIAL_WI;
+    t.doubleMedial[HANGUL_MEDIAL_EU][HANGUL_MEDIAL_I] = HANGUL_MEDIAL_YI;
+
+    // A single final consonant moves as a whole to the next syllable
+    for (int f = 0; f < TCount; ++f) {
+        t.splitFinal[f][0] = HANGUL_FINAL_NONE;
+        t.splitFinal[f][1] = f != HANGUL_FINAL_NONE ? t.initialOf[finals[f] - JamoBase] : qint8(-1);
+    }
 
-                        // Since some initial and final consonants use the same
-                        // Unicode values, we need to check whether the previous final
-                        // Jamo is actually an initial Jamo of the next syllable.
-                        //
-                        // Consider the following scenario:
-                        //      LVT+V == not possible
-                        //      LV, L+V == possible
-                        int LIndex = initials.indexOf(finals[TIndex]);
-                        if (LIndex >= 0 && LIndex < LCount) {
+    // A double final consonant is split, and the second part moves
+    const qint8 doubleFinals[][3] = {
+        { HANGUL_FINAL_KIYEOK, HANGUL_FINAL_SIOS, HANGUL_FINAL_KIYEOK_SIOS },
+        { HANGUL_FINAL_NIEUN, HANGUL_FINAL_CIEUC, HANGUL_FINAL_NIEUN_CIEUC },
+        { HANGUL_FINAL_NIEUN, HANGUL_FINAL_HIEUH, HANGUL_FINAL_NIEUN_HIEUH },
+        { HANGUL_FINAL_RIEUL, HANGUL_FINAL_KIYEOK, HANGUL_FINAL_RIEUL_KIYEOK },
+        { HANGUL_FINAL_RIEUL, HANGUL_FINAL_MIEUM, HANGUL_FINAL_RIEUL_MIEUM },
+        { HANGUL_FINAL_RIEUL, HANGUL_FINAL_PIEUP, HANGUL_FINAL_RIEUL_PIEUP },
+        { HANGUL_FINAL_RIEUL, HANGUL_FINAL_SIOS, HANGUL_FINAL_RIEUL_SIOS },
+        { HANGUL_FINAL_RIEUL, HANGUL_FINAL_THIEUTH, HANGUL_FINAL_RIEUL_THIEUTH },
+        { HANGUL_FINAL_RIEUL, HANGUL_FINAL_PHIEUPH, HANGUL_FINAL_RIEUL_PHIEUPH },
+        { HANGUL_FINAL_RIEUL, HANGUL_FINAL_HIEUH, HANGUL_FINAL_RIEUL_HIEUH },
+        { HANGUL_FINAL_PIEUP, HANGUL_FINAL_SIOS, HANGUL_FINAL_PIEUP_SIOS },
+        { HANGUL_FINAL_SIOS, HANGUL_FINAL_SIOS, HANGUL_FINAL_SSANGSIOS }
+    };
+    for (const auto &d : doubleFinals) {
+        t.doubleFinal[d[0]][d[1]] = d[2];
+        t.splitFinal[d[2]][0] = d[0];
+        t.splitFinal[d[2]][1] = t.initialOf[finals[d[1]] - JamoBase];
+    }
 
-                            // Remove the previous final jamo from the syllable,
-                            // making the current syllable of form LV
-                            last = QChar((int)lastUnicode - TIndex);
-                            result.replace(result.length() - 1, 1, last);
+    return t;
+}
 
-                            // Make new syllable of form LV
-                            last = QChar(SBase + (LIndex * VCount + VIndex) * TCount);
-                            result.append(last);
-                            continue;
-                        }
+constexpr Hangul::Tables Hangul::tables = Hangul::makeTables();
 
-                        // Check to see if the current final Jamo is double consonant.
-                        // In this scenario, the double consonant is split into parts
-                        // and the second part is removed from the current syllable.
-                        // Then the second part is joined with the current vowel making
-                        // the new syllable of form LV.
-                        ushort key = findDoubleFinal((HangulFinalIndex)TIndex);
-                        if (key) {
+/*!
+    \class QtVirtualKeyboard::Hangul
+    \internal
 
-                            // Split the consonant into two jamos and remove the
-                            // second jamo B from the current syllable
-                            HangulFinalIndex TIndexA, TIndexB;
-                            unpackDoubleFinal(key, TIndexA, TIndexB);
-                            last = QChar((int)lastUnicode - TIndex + (int)TIndexA);
-                            result.replace(result.length() - 1, 1, last);
+    Composes Hangul syllables from Hangul Compatibility Jamo with a table
+    driven automaton. Each Jamo is one transition of the State.
+*/
 
-                            // Add new syllable by combining the initial jamo
-                            // and the current vowel
-                            LIndex = initials.indexOf(finals[TIndexB]);
-                            last = QChar(SBase + (LIndex * VCount + VIndex) * TCount);
-                            result.append(last);
-                            continue;
-                        }
-                    }
+bool Hangul::isJamo(ushort unicode)
+{
+    return unicode >= 0x3131 && unicode <= 0x3163;
+}
 
-                    // Check whether the current consonant can connect to current
-                    // consonant forming a double final consonant
-                    HangulFinalIndex TIndexA = (HangulFinalIndex)TIndex;
-                    if (isFinal(TIndexA)) {
+/*!
+    Feeds \a jamo to the syllable \a state, which must be a Hangul
+    Compatibility Jamo. Returns the completed syllable if the Jamo does not
+    fit into the current syllable, or a null character otherwise. In both
+    cases, \a state holds the syllable under composition afterwards.
+*/
+QChar Hangul::next(State &state, ushort jamo)
+{
+    Q_ASSERT(isJamo(jamo));
 
-                        HangulFinalIndex TIndexB = (HangulFinalIndex)finals.indexOf(unicode);
-                        if (isFinal(TIndexB)) {
+    if (state.isEmpty()) {
+        state = start(jamo);
+        return QChar();
+    }
 
-                            // Search the double final map if such a combination exists
-                            ushort key = packDoubleFinal(TIndexA, TIndexB);
-                            const auto it = doubleFinalMap.constFind(key);
-                            if (it != doubleFinalMap.cend()) {
+    const int index = jamo - JamoBase;
+    const int VIndex = jamo >= VBase ? jamo - VBase : -1;
 
-                                // Update syllable by adding the difference between
-                                // the consonant indices
-                                HangulFinalIndex TIndexD = it.value();
-                                int TDiff = (int)TIndexD - (int)TIndexA;
-                                last = QChar((int)lastUnicode + TDiff);
-                                result.replace(result.length() - 1, 1, last);
-                                continue;
-                            }
-                        }
-                    }
+    if (state.jamo == 0) {
+        if (!state.hasMedial()) {
+            // L + V
+            if (VIndex != -1) {
+                state.medial = qint8(VIndex);
+                return QChar();
+            }
+        } else if (state.final == HANGUL_FINAL_NONE) {
+            // LV + T
+            const qint8 TIndex = tables.finalOf[index];
+            if (TIndex != HANGUL_FINAL_NONE) {
+                state.final = TIndex;
+                return QChar();
+            }
+            // LV + V, if the vowels form a double medial
+            if (VIndex != -1) {
+                const qint8 VIndexD = tables.doubleMedial[state.medial][VIndex];
+                if (VIndexD != -1) {
+                    state.medial = VIndexD;
+                    return QChar();
                 }
-
-            } else {
-
-                // The last character is not syllable.
-                // Check to see if the last character is an initial consonant
-                int LIndex = initials.indexOf(lastUnicode);
-                if (LIndex != -1) {
-
-                    // If the current character is medial vowel,
-                    // make syllable of form LV
-                    int VIndex = (int)unicode - VBase;
-                    if (VIndex >= 0 && VIndex < VCount) {
-                        last = QChar(SBase + (LIndex * VCount + VIndex) * TCount);
-                        result.replace(result.length() - 1, 1, last);
-                        continue;
-                    }
+            }
+        } else {
+            // LVT + V: the final consonant, or the second part of a double
+            // final consonant, becomes the initial of the next syllable
+            if (VIndex != -1) {
+                const qint8 TIndex = state.final;
+                State completed = state;
+                completed.final = tables.splitFinal[TIndex][0];
+                state = State();
+                state.initial = tables.splitFinal[TIndex][1];
+                state.medial = qint8(VIndex);
+                return toChar(completed);
+            }
+            // LVT + T, if the consonants form a double final
+            const qint8 TIndex = tables.finalOf[index];
+            if (TIndex != HANGUL_FINAL_NONE) {
+                const qint8 TIndexD = tables.doubleFinal[state.final][TIndex];
+                if (TIndexD != HANGUL_FINAL_NONE) {
+                    state.final = TIndexD;
+                    return QChar();
                 }
-
             }
         }
-
-        // Otherwise, add the character into buffer
-        last = ch;
-        result = result.append(ch);
     }
-    return result;
-}
-
-bool Hangul::isJamo(const ushort &unicode)
-{
-    return unicode >= 0x3131 && unicode <= 0x3163;
-}
 
-bool Hangul::isMedial(HangulMedialIndex vowel)
-{
-    return vowel >= HANGUL_MEDIAL_A && vowel <= HANGUL_MEDIAL_I;
-}
-
-bool Hangul::isFinal(HangulFinalIndex consonant)
-{
-    return consonant >= HANGUL_FINAL_KIYEOK && consonant <= HANGUL_FINAL_HIEUH;
+    const QChar completed = toChar(state);
+    state = start(jamo);
+    return completed;
 }
 
-ushort Hangul::findDoubleMedial(HangulMedialIndex vowel)
-{
-    return doubleMedialMap.key(vowel, 0);
-}
-
-ushort Hangul::findDoubleFinal(HangulFinalIndex consonant)
-{
-    return doubleFinalMap.key(consonant, 0);
-}
-
-// Packs two Hangul Jamo indices into 16-bit integer.
-// The result can be used as a key to the double jamos lookup table.
-// Note: The returned value is not a Unicode character!
-ushort Hangul::packDoubleMedial(HangulMedialIndex a, HangulMedialIndex b)
-{
-    Q_ASSERT(isMedial(a));
-    Q_ASSERT(isMedial(b));
-    return (ushort)a | ((ushort)b << 8);
-}
-
-ushort Hangul::packDoubleFinal(HangulFinalIndex a, HangulFinalIndex b)
-{
-    Q_ASSERT(isFinal(a));
-    Q_ASSERT(isFinal(b));
-    return (ushort)a | ((ushort)b << 8);
-}
-
-void Hangul::unpackDoubleMedial(ushort key, HangulMedialIndex &a, HangulMedialIndex &b)
-{
-    a = (HangulMedialIndex)(key & 0xFF);
-    b = (HangulMedialIndex)(key >> 8);
-    Q_ASSERT(isMedial(a));
-    Q_ASSERT(isMedial(b));
-}
-
-void Hangul::unpackDoubleFinal(ushort key, HangulFinalIndex &a, HangulFinalIndex &b)
-{
-    a = (HangulFinalIndex)(key & 0xFF);
-    b = (HangulFinalIndex)(key >> 8);
-    Q_ASSERT(isFinal(a));
-    Q_ASSERT(isFinal(b));
-}
-
-QMap<ushort, Hangul::HangulMedialIndex> Hangul::initDoubleMedialMap()
+/*!
+    Returns the syllable, or the single Jamo, of \a state.
+*/
+QChar Hangul::toChar(const State &state)
 {
-    QMap<ushort, HangulMedialIndex> map;
-    map.insert(packDoubleMedial(HANGUL_MEDIAL_O, HANGUL_MEDIAL_A), HANGUL_MEDIAL_WA);
-    map.insert(packDoubleMedial(HANGUL_MEDIAL_O, HANGUL_MEDIAL_AE), HANGUL_MEDIAL_WAE);
-    map.insert(packDoubleMedial(HANGUL_MEDIAL_O, HANGUL_MEDIAL_I), HANGUL_MEDIAL_OE);
-    map.insert(packDoubleMedial(HANGUL_MEDIAL_U, HANGUL_MEDIAL_EO), HANGUL_MEDIAL_WEO);
-    map.insert(packDoubleMedial(HANGUL_MEDIAL_U, HANGUL_MEDIAL_E), HANGUL_MEDIAL_WE);
-    map.insert(packDoubleMedial(HANGUL_MEDIAL_U, HANGUL_MEDIAL_I), HANGUL_MEDIAL_WI);
-    map.insert(packDoubleMedial(HANGUL_MEDIAL_EU, HANGUL_MEDIAL_I), HANGUL_MEDIAL_YI);
-    return map;
+    if (state.jamo != 0)
+        return QChar(state.jamo);
+    if (state.initial == -1)
+        return QChar();
+    if (state.medial == -1)
+        return QChar(initials[state.initial]);
+    return QChar(SBase + (state.initial * VCount + state.medial) * TCount + state.final);
 }
 
-QMap<ushort, Hangul::HangulFinalIndex> Hangul::initDoubleFinalMap()
+Hangul::State Hangul::start(ushort jamo)
 {
-    QMap<ushort, HangulFinalIndex> map;
-    map.insert(packDoubleFinal(HANGUL_FINAL_KIYEOK, HANGUL_FINAL_SIOS), HANGUL_FINAL_KIYEOK_SIOS);
-    map.insert(packDoubleFinal(HANGUL_FINAL_NIEUN, HANGUL_FINAL_CIEUC), HANGUL_FINAL_NIEUN_CIEUC);
-    map.insert(packDoubleFinal(HANGUL_FINAL_NIEUN, HANGUL_FINAL_HIEUH), HANGUL_FINAL_NIEUN_HIEUH);
-    map.insert(packDoubleFinal(HANGUL_FINAL_RIEUL, HANGUL_FINAL_KIYEOK), HANGUL_FINAL_RIEUL_KIYEOK);
-    map.insert(packDoubleFinal(HANGUL_FINAL_RIEUL, HANGUL_FINAL_MIEUM), HANGUL_FINAL_RIEUL_MIEUM);
-    map.insert(packDoubleFinal(HANGUL_FINAL_RIEUL, HANGUL_FINAL_PIEUP), HANGUL_FINAL_RIEUL_PIEUP);
-    map.insert(packDoubleFinal(HANGUL_FINAL_RIEUL, HANGUL_FINAL_SIOS), HANGUL_FINAL_RIEUL_SIOS);
-    map.insert(packDoubleFinal(HANGUL_FINAL_RIEUL, HANGUL_FINAL_THIEUTH), HANGUL_FINAL_RIEUL_THIEUTH);
-    map.insert(packDoubleFinal(HANGUL_FINAL_RIEUL, HANGUL_FINAL_PHIEUPH), HANGUL_FINAL_RIEUL_PHIEUPH);
-    map.insert(packDoubleFinal(HANGUL_FINAL_RIEUL, HANGUL_FINAL_HIEUH), HANGUL_FINAL_RIEUL_HIEUH);
-    map.insert(packDoubleFinal(HANGUL_FINAL_PIEUP, HANGUL_FINAL_SIOS), HANGUL_FINAL_PIEUP_SIOS);
-    map.insert(packDoubleFinal(HANGUL_FINAL_SIOS, HANGUL_FINAL_SIOS), HANGUL_FINAL_SSANGSIOS);
-    return map;
+    State state;
+    const qint8 LIndex = tables.initialOf[jamo - JamoBase];
+    if (LIndex != -1)
+        state.initial = LIndex;
+    else
+        state.jamo = jamo;
+    return state;
 }
 
 } // namespace QtVirtualKeyboard
@@ -41,9 +41,7 @@
 // We mean it.
 //
 
-#include <QString>
-#include <QList>
-#include <QMap>
+#include <QChar>
 
 QT_BEGIN_NAMESPACE
 namespace QtVirtualKeyboard {
@@ -112,35 +110,39 @@ class Hangul
     Hangul();
 
 public:
-    static QString decompose(const QString &source);
-    static QString compose(const QString &source);
-    static bool isJamo(const ushort &unicode);
+    // Composition state of a single syllable. A syllable is composed of an
+    // initial consonant (L), a medial vowel (V) and a final consonant (T).
+    // A Jamo which can not start a syllable is held as is.
+    struct State
+    {
+        qint8 initial = -1;
+        qint8 medial = -1;
+        qint8 final = HANGUL_FINAL_NONE;
+        ushort jamo = 0;
+
+        bool isEmpty() const { return initial == -1 && medial == -1 && jamo == 0; }
+        bool hasMedial() const { return medial != -1; }
+    };
+
+    static bool isJamo(ushort unicode);
+    static QChar next(State &state, ushort jamo);
+    static QChar toChar(const State &state);
 
 private:
-    static bool isMedial(HangulMedialIndex vowel);
-    static bool isFinal(HangulFinalIndex consonant);
-    static ushort findDoubleMedial(HangulMedialIndex vowel);
-    static ushort findDoubleFinal(HangulFinalIndex consonant);
-    static ushort packDoubleMedial(HangulMedialIndex a, HangulMedialIndex b);
-    static ushort packDoubleFinal(HangulFinalIndex a, HangulFinalIndex b);
-    static void unpackDoubleMedial(ushort key, HangulMedialIndex &a, HangulMedialIndex &b);
-    static void unpackDoubleFinal(ushort key, HangulFinalIndex &a, HangulFinalIndex &b);
-    static QMap<ushort, HangulMedialIndex> initDoubleMedialMap();
-    static QMap<ushort, HangulFinalIndex> initDoubleFinalMap();
-
-    static const QList<ushort> initials;
-    static const QList<ushort> finals;
-    static const QMap<ushort, HangulMedialIndex> doubleMedialMap;
-    static const QMap<ushort, HangulFinalIndex> doubleFinalMap;
-    static const int SBase;
-    static const int LBase;
-    static const int VBase;
-    static const int TBase;
-    static const int LCount;
-    static const int VCount;
-    static const int TCount;
-    static const int NCount;
-    static const int SCount;
+    struct Tables;
+
+    static State start(ushort jamo);
+    static constexpr Tables makeTables();
+
+    static constexpr int SBase = 0xAC00;
+    static constexpr int VBase = 0x314F;
+    static constexpr int JamoBase = 0x3131;
+    static constexpr int JamoCount = 0x3163 - 0x3131 + 1;
+    static constexpr int LCount = 19;
+    static constexpr int VCount = 21;
+    static constexpr int TCount = 28;
+
+    static const Tables tables;
 };
 
 } // namespace QtVirtualKeyboard
@@ -30,17 +30,118 @@
 #include "hangulinputmethod_p.h"
 #include "hangul_p.h"
 #include <QtVirtualKeyboard/qvirtualkeyboardinputcontext.h>
+#include <QList>
+#include <QVarLengthArray>
 
 QT_BEGIN_NAMESPACE
 namespace QtVirtualKeyboard {
 
+class HangulInputMethodPrivate
+{
+    Q_DECLARE_PUBLIC(HangulInputMethod)
+public:
+    typedef QVarLengthArray<ushort, 8> JamoList;
+
+    HangulInputMethodPrivate(HangulInputMethod *q_ptr) :
+        q_ptr(q_ptr)
+    {}
+
+    static Hangul::State compose(const JamoList &jamos, bool *single = nullptr)
+    {
+        Hangul::State state;
+        bool completed = false;
+        for (ushort jamo : jamos)
+            completed |= !Hangul::next(state, jamo).isNull();
+        if (single)
+            *single = !completed;
+        return state;
+    }
+
+    void addJamo(ushort jamo)
+    {
+        Q_Q(HangulInputMethod);
+        const QChar completed = Hangul::next(state, jamo);
+        if (completed.isNull()) {
+            jamos.append(jamo);
+        } else {
+            // When the final consonant moved to the new syllable, it is the
+            // last Jamo of the completed one
+            JamoList committedJamos(jamos);
+            jamos.clear();
+            if (state.hasMedial() && state.initial != -1) {
+                jamos.append(committedJamos.last());
+                committedJamos.removeLast();
+            }
+            committedSyllables.append(committedJamos);
+            jamos.append(jamo);
+            q->inputContext()->commit(QString(completed));
+        }
+        updatePreedit();
+    }
+
+    bool removeJamo()
+    {
+        Q_Q(HangulInputMethod);
+        if (jamos.isEmpty()) {
+            if (committedSyllables.isEmpty())
+                return false;
+            // Reopen the syllable composed before
+            q->inputContext()->commit(QString(), -1, 1);
+            jamos = committedSyllables.takeLast();
+        }
+
+        jamos.removeLast();
+        state = compose(jamos);
+
+        // A lone consonant left behind rejoins the previous syllable, if the
+        // syllable was composed here and they compose a single syllable
+        if (!committedSyllables.isEmpty() && !jamos.isEmpty() && !state.hasMedial()) {
+            JamoList merged(committedSyllables.last());
+            merged.append(jamos.constData(), jamos.size());
+            bool single;
+            const Hangul::State mergedState = compose(merged, &single);
+            if (single) {
+                q->inputContext()->commit(QString(), -1, 1);
+                jamos = merged;
+                state = mergedState;
+                committedSyllables.removeLast();
+            }
+        }
+
+        updatePreedit();
+        return true;
+    }
+
+    void updatePreedit()
+    {
+        Q_Q(HangulInputMethod);
+        const QChar syllable = Hangul::toChar(state);
+        q->inputContext()->setPreeditText(syllable.isNull() ? QString() : QString(syllable));
+    }
+
+    void clear()
+    {
+        state = Hangul::State();
+        jamos.clear();
+        committedSyllables.clear();
+    }
+
+    HangulInputMethod *q_ptr;
+    Hangul::State state;
+    JamoList jamos;
+    // Jamos of the syllables committed since the last reset, so that
+    // backspace can take them apart again
+    QList<JamoList> committedSyllables;
+};
+
 /*!
     \class QtVirtualKeyboard::HangulInputMethod
     \internal
 */
 
 HangulInputMethod::HangulInputMethod(QObject *parent) :
-    QVirtualKeyboardAbstractInputMethod(parent)
+    QVirtualKeyboardAbstractInputMethod(parent),
+    d_ptr(new HangulInputMethodPrivate(this))
 {
 }
 
@@ -70,33 +171,31 @@ bool HangulInputMethod::setTextCase(QVirtualKeyboardInputEngine::TextCase textCa
 bool HangulInputMethod::keyEvent(Qt::Key key, const QString &text, Qt::KeyboardModifiers modifiers)
 {
     Q_UNUSED(modifiers)
-    QVirtualKeyboardInputContext *ic = inputContext();
-    bool accept = false;
-    int cursorPosition = ic->cursorPosition();
-    if (ic->cursorPosition() > 0) {
-        if (key == Qt::Key_Backspace) {
-            int contextLength = cursorPosition > 1 ? 2 : 1;
-            QString hangul = Hangul::decompose(ic->surroundingText().mid(cursorPosition - contextLength, contextLength));
-            int length = hangul.length();
-            if (hangul.length() > 1) {
-                ic->commit(Hangul::compose(hangul.left(length - 1)), -contextLength, contextLength);
-                accept = true;
-            }
-        } else if (!text.isEmpty() && Hangul::isJamo(text.at(0).unicode())) {
-            QString hangul = Hangul::compose(ic->surroundingText().mid(cursorPosition - 1, 1) + text);
-            ic->commit(hangul, -1, 1);
-            accept = true;
-        }
+    Q_D(HangulInputMethod);
+    if (key == Qt::Key_Backspace)
+        return d->removeJamo();
+
+    if (!text.isEmpty() && Hangul::isJamo(text.at(0).unicode())) {
+        d->addJamo(text.at(0).unicode());
+        return true;
     }
-    return accept;
+
+    update();
+    return false;
 }
 
 void HangulInputMethod::reset()
 {
+    Q_D(HangulInputMethod);
+    d->clear();
 }
 
 void HangulInputMethod::update()
 {
+    Q_D(HangulInputMethod);
+    if (!d->jamos.isEmpty())
+        inputContext()->commit();
+    d->clear();
 }
 
 } // namespace QtVirtualKeyboard
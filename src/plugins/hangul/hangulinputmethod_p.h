@@ -64,6 +64,9 @@ public:
 
     void reset() override;
     void update() override;
+
+private:
+    QScopedPointer<HangulInputMethodPrivate> d_ptr;
 };
 
 } // namespace QtVirtualKeyboard
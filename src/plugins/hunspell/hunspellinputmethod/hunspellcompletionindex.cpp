@@ -0,0 +1,379 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Virtual Keyboard module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtHunspellInputMethod/private/hunspellcompletionindex_p.h>
+#include <QFileInfo>
+#include <QDir>
+#include <QSaveFile>
+#include <algorithm>
+#include <numeric>
+
+QT_BEGIN_NAMESPACE
+namespace QtVirtualKeyboard {
+
+namespace {
+
+const char IndexMagic[8] = { 'Q', 'V', 'K', 'C', 'O', 'M', 'P', 'L' };
+const quint32 IndexVersion = 1;
+const quint32 NoWord = 0xffffffff;
+
+} // namespace
+
+/*!
+    \class QtVirtualKeyboard::HunspellCompletionIndex
+    \internal
+
+    Prefix completion index of the words in a Hunspell dictionary.
+
+    The words are sorted case-insensitively, so the completions of a
+    prefix form a contiguous range which is found by binary search.
+    A segment tree over the word frequencies, where each node holds
+    the most frequent word of its range, returns the most frequent
+    completions in O(k log n) time without visiting the whole range.
+
+    The index is a single file which is memory mapped read-only and
+    rejected when the dictionary or the frequency list changes.
+*/
+
+HunspellCompletionIndex::HunspellCompletionIndex() :
+    indexHeader(nullptr),
+    words(nullptr),
+    tree(nullptr),
+    text(nullptr)
+{
+}
+
+bool HunspellCompletionIndex::open(const QString &indexPath, const QByteArray &dictionary, const QByteArray &frequencies)
+{
+    qint64 size = 0;
+    const uchar *data = map(indexPath, header(IndexMagic, IndexVersion, dictionary, frequencies), size);
+    if (!data)
+        return false;
+
+    const IndexHeader *dataHeader = reinterpret_cast<const IndexHeader *>(data);
+    if (size < qint64(sizeof(IndexHeader)) ||
+            dataHeader->treeSize != 2 * qint64(dataHeader->wordCount) ||
+            size != qint64(sizeof(IndexHeader)) +
+                    qint64(dataHeader->wordCount) * qint64(sizeof(WordEntry)) +
+                    qint64(dataHeader->treeSize) * qint64(sizeof(quint32)) +
+                    qint64(dataHeader->textSize) * qint64(sizeof(char16_t))) {
+        HunspellIndexFile::close();
+        return false;
+    }
+
+    const WordEntry *dataWords = reinterpret_cast<const WordEntry *>(data + sizeof(IndexHeader));
+    const quint32 *dataTree = reinterpret_cast<const quint32 *>(dataWords + dataHeader->wordCount);
+    for (quint32 i = 0; i < dataHeader->treeSize; ++i) {
+        if (dataTree[i] >= dataHeader->wordCount) {
+            HunspellIndexFile::close();
+            return false;
+        }
+    }
+
+    indexHeader = dataHeader;
+    words = dataWords;
+    tree = dataTree;
+    text = reinterpret_cast<const char16_t *>(tree + indexHeader->treeSize);
+
+    return true;
+}
+
+void HunspellCompletionIndex::close()
+{
+    bigrams.clear();
+    indexHeader = nullptr;
+    words = nullptr;
+    tree = nullptr;
+    text = nullptr;
+    HunspellIndexFile::close();
+}
+
+/*!
+    Returns at most \a maxCount completions of \a prefix. The words
+    in \a recentWords, e.g. the user dictionary ordered from the least
+    to the most recently used, come first starting from the most recent
+    one, followed by the dictionary words in the order of frequency.
+    The completions follow the capitalization of \a prefix.
+*/
+QStringList HunspellCompletionIndex::complete(const QString &prefix, int maxCount, const QStringList &recentWords) const
+{
+    QStringList result;
+    if (prefix.isEmpty() || maxCount <= 0)
+        return result;
+
+    auto addCompletion = [&](const QString &word) {
+        if (word.size() <= prefix.size())
+            return;
+        for (const QString &completion : qAsConst(result)) {
+            if (!completion.compare(word, Qt::CaseInsensitive))
+                return;
+        }
+        result.append(matchCase(word, prefix));
+    };
+
+    for (int i = recentWords.size() - 1; i >= 0 && result.size() < maxCount; --i) {
+        if (recentWords.at(i).startsWith(prefix, Qt::CaseInsensitive))
+            addCompletion(recentWords.at(i));
+    }
+
+    if (!indexHeader)
+        return result;
+
+    struct Range
+    {
+        quint32 first;
+        quint32 last;
+        quint32 best;
+    };
+    auto lessFrequent = [this](const Range &a, const Range &b) {
+        return bestWord(a.best, b.best) == b.best;
+    };
+    QList<Range> ranges;
+    auto pushRange = [&](quint32 first, quint32 last) {
+        if (first < last) {
+            ranges.append({ first, last, bestWordInRange(first, last) });
+            std::push_heap(ranges.begin(), ranges.end(), lessFrequent);
+        }
+    };
+
+    pushRange(prefixBound(prefix, false), prefixBound(prefix, true));
+    while (!ranges.isEmpty() && result.size() < maxCount) {
+        std::pop_heap(ranges.begin(), ranges.end(), lessFrequent);
+        const Range range = ranges.takeLast();
+        addCompletion(wordAt(range.best).toString());
+        pushRange(range.first, range.best);
+        pushRange(range.best + 1, range.last);
+    }
+
+    return result;
+}
+
+/*!
+    Returns at most \a maxCount characters which most probably follow
+    \a prefix, in lower case, ordered by the frequency of the most
+    frequent word which continues with each of them. When no word starts
+    with \a prefix, e.g. it is misspelled, the characters are chosen by
+    the letter bigrams of the dictionary words instead.
+*/
+QString HunspellCompletionIndex::nextCharacters(const QString &prefix, int maxCount)
+{
+    QString result;
+    if (!indexHeader || prefix.isEmpty() || maxCount <= 0)
+        return result;
+
+    struct Range
+    {
+        quint32 first;
+        quint32 last;
+        quint32 best;
+    };
+    auto lessFrequent = [this](const Range &a, const Range &b) {
+        return bestWord(a.best, b.best) == b.best;
+    };
+    QList<Range> ranges;
+    auto pushRange = [&](quint32 first, quint32 last) {
+        if (first < last) {
+            ranges.append({ first, last, bestWordInRange(first, last) });
+            std::push_heap(ranges.begin(), ranges.end(), lessFrequent);
+        }
+    };
+
+    // Each step takes the most frequent word and skips the range of the
+    // words continuing with the same character
+    pushRange(prefixBound(prefix, false), prefixBound(prefix, true));
+    while (!ranges.isEmpty() && result.size() < maxCount) {
+        std::pop_heap(ranges.begin(), ranges.end(), lessFrequent);
+        const Range range = ranges.takeLast();
+        const QStringView word(wordAt(range.best));
+        if (word.size() <= prefix.size()) {
+            pushRange(range.first, range.best);
+            pushRange(range.best + 1, range.last);
+            continue;
+        }
+        const QChar c(word.at(prefix.size()).toLower());
+        if (!result.contains(c))
+            result.append(c);
+        const QString continuation(word.left(prefix.size() + 1).toString());
+        pushRange(range.first, qMax(range.first, prefixBound(continuation, false)));
+        pushRange(qMin(range.last, prefixBound(continuation, true)), range.last);
+    }
+
+    if (result.isEmpty()) {
+        if (bigrams.isEmpty())
+            buildBigrams();
+        result = bigrams.value(prefix.at(prefix.size() - 1).toLower()).left(maxCount);
+    }
+
+    return result;
+}
+
+/*!
+    Builds the table of the characters most often following each
+    character in the dictionary words, weighted by the word frequency.
+    The table is built on first use, since it is only needed for
+    prefixes which are not found in the dictionary.
+*/
+void HunspellCompletionIndex::buildBigrams()
+{
+    static const int maxFollowers = 8;
+    QHash<QChar, QHash<QChar, quint64> > counts;
+    for (quint32 i = 0; i < indexHeader->wordCount; ++i) {
+        const QStringView word(wordAt(i));
+        const quint64 weight = quint64(words[i].frequency) + 1;
+        for (qsizetype j = 1; j < word.size(); ++j)
+            counts[word.at(j - 1).toLower()][word.at(j).toLower()] += weight;
+    }
+
+    for (auto it = counts.cbegin(); it != counts.cend(); ++it) {
+        QList<QPair<quint64, QChar> > followers;
+        for (auto follower = it.value().cbegin(); follower != it.value().cend(); ++follower)
+            followers.append(qMakePair(follower.value(), follower.key()));
+        std::sort(followers.begin(), followers.end(), [](const QPair<quint64, QChar> &a, const QPair<quint64, QChar> &b) {
+            return a.first > b.first || (a.first == b.first && a.second < b.second);
+        });
+        QString characters;
+        for (int j = 0; j < followers.size() && j < maxFollowers; ++j)
+            characters.append(followers.at(j).second);
+        bigrams.insert(it.key(), characters);
+    }
+}
+
+/*!
+    Builds the index of the Hunspell \a dictionary and the word
+    \a frequencies to \a indexPath. See HunspellIndexFile::collectWords().
+*/
+bool HunspellCompletionIndex::build(const QString &indexPath, const QByteArray &dictionary, const QByteArray &frequencies,
+                                    const char *encoding, Hunhandle *hunspell)
+{
+    QStringList wordList;
+    QList<quint32> frequencyList;
+    collectWords(dictionary, frequencies, encoding, hunspell, wordList, frequencyList);
+    if (wordList.isEmpty())
+        return false;
+
+    QList<int> order(wordList.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&wordList](int a, int b) {
+        const int result = wordList.at(a).compare(wordList.at(b), Qt::CaseInsensitive);
+        return result < 0 || (result == 0 && wordList.at(a) < wordList.at(b));
+    });
+
+    const quint32 wordCount = quint32(order.size());
+    QList<WordEntry> wordEntries;
+    QString wordText;
+    wordEntries.reserve(order.size());
+    for (int index : qAsConst(order)) {
+        const QString &word = wordList.at(index);
+        wordEntries.append({ quint32(wordText.size()), quint32(word.size()), frequencyList.at(index) });
+        wordText.append(word);
+    }
+
+    auto bestOf = [&wordEntries](quint32 a, quint32 b) {
+        const quint32 frequencyA = wordEntries.at(a).frequency;
+        const quint32 frequencyB = wordEntries.at(b).frequency;
+        return frequencyA > frequencyB || (frequencyA == frequencyB && a < b) ? a : b;
+    };
+    QList<quint32> wordTree(2 * wordCount, 0);
+    for (quint32 i = 0; i < wordCount; ++i)
+        wordTree[wordCount + i] = i;
+    for (quint32 i = wordCount - 1; i > 0; --i)
+        wordTree[i] = bestOf(wordTree.at(2 * i), wordTree.at(2 * i + 1));
+
+    const Header fileHeader(header(IndexMagic, IndexVersion, dictionary, frequencies));
+    IndexHeader dataHeader;
+    dataHeader.wordCount = wordCount;
+    dataHeader.treeSize = quint32(wordTree.size());
+    dataHeader.textSize = quint32(wordText.size());
+    dataHeader.reserved = 0;
+
+    QDir().mkpath(QFileInfo(indexPath).absolutePath());
+    QSaveFile indexFile(indexPath);
+    if (!indexFile.open(QIODevice::WriteOnly))
+        return false;
+    indexFile.write(reinterpret_cast<const char *>(&fileHeader), sizeof(Header));
+    indexFile.write(reinterpret_cast<const char *>(&dataHeader), sizeof(IndexHeader));
+    indexFile.write(reinterpret_cast<const char *>(wordEntries.constData()), wordEntries.size() * qint64(sizeof(WordEntry)));
+    indexFile.write(reinterpret_cast<const char *>(wordTree.constData()), wordTree.size() * qint64(sizeof(quint32)));
+    indexFile.write(reinterpret_cast<const char *>(wordText.constData()), wordText.size() * qint64(sizeof(QChar)));
+    return indexFile.commit();
+}
+
+QStringView HunspellCompletionIndex::wordAt(quint32 wordIndex) const
+{
+    const WordEntry &entry = words[wordIndex];
+    if (entry.textOffset > indexHeader->textSize || entry.textLength > indexHeader->textSize - entry.textOffset)
+        return QStringView();
+    return QStringView(reinterpret_cast<const QChar *>(text + entry.textOffset), qsizetype(entry.textLength));
+}
+
+/*!
+    Returns the index of the first word which starts with \a prefix,
+    or if \a upper is \c true, the index following the last such word.
+*/
+quint32 HunspellCompletionIndex::prefixBound(const QString &prefix, bool upper) const
+{
+    quint32 first = 0;
+    quint32 last = indexHeader->wordCount;
+    while (first < last) {
+        const quint32 middle = first + (last - first) / 2;
+        const int result = wordAt(middle).left(prefix.size()).compare(prefix, Qt::CaseInsensitive);
+        if (upper ? result <= 0 : result < 0)
+            first = middle + 1;
+        else
+            last = middle;
+    }
+    return first;
+}
+
+quint32 HunspellCompletionIndex::bestWord(quint32 a, quint32 b) const
+{
+    if (a == NoWord)
+        return b;
+    if (b == NoWord)
+        return a;
+    const quint32 frequencyA = words[a].frequency;
+    const quint32 frequencyB = words[b].frequency;
+    return frequencyA > frequencyB || (frequencyA == frequencyB && a < b) ? a : b;
+}
+
+quint32 HunspellCompletionIndex::bestWordInRange(quint32 first, quint32 last) const
+{
+    const quint32 wordCount = indexHeader->wordCount;
+    quint32 best = NoWord;
+    for (first += wordCount, last += wordCount; first < last; first >>= 1, last >>= 1) {
+        if (first & 1)
+            best = bestWord(best, tree[first++]);
+        if (last & 1)
+            best = bestWord(best, tree[--last]);
+    }
+    return best;
+}
+
+} // namespace QtVirtualKeyboard
+QT_END_NAMESPACE
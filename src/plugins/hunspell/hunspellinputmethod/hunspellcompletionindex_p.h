@@ -0,0 +1,97 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Virtual Keyboard module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef HUNSPELLCOMPLETIONINDEX_P_H
+#define HUNSPELLCOMPLETIONINDEX_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtHunspellInputMethod/private/hunspellindexfile_p.h>
+#include <QStringView>
+#include <QHash>
+
+QT_BEGIN_NAMESPACE
+namespace QtVirtualKeyboard {
+
+class QHUNSPELLINPUTMETHOD_EXPORT HunspellCompletionIndex : public HunspellIndexFile
+{
+public:
+    HunspellCompletionIndex();
+
+    bool open(const QString &indexPath, const QByteArray &dictionary, const QByteArray &frequencies);
+    void close() override;
+
+    QStringList complete(const QString &prefix, int maxCount, const QStringList &recentWords = QStringList()) const;
+    QString nextCharacters(const QString &prefix, int maxCount);
+
+    static bool build(const QString &indexPath, const QByteArray &dictionary, const QByteArray &frequencies,
+                      const char *encoding, Hunhandle *hunspell);
+
+private:
+    struct IndexHeader
+    {
+        quint32 wordCount;
+        quint32 treeSize;
+        quint32 textSize;
+        quint32 reserved;
+    };
+
+    struct WordEntry
+    {
+        quint32 textOffset;
+        quint32 textLength;
+        quint32 frequency;
+    };
+
+    QStringView wordAt(quint32 wordIndex) const;
+    quint32 prefixBound(const QString &prefix, bool upper) const;
+    quint32 bestWord(quint32 a, quint32 b) const;
+    quint32 bestWordInRange(quint32 first, quint32 last) const;
+    void buildBigrams();
+
+    const IndexHeader *indexHeader;
+    const WordEntry *words;
+    const quint32 *tree;
+    const char16_t *text;
+    QHash<QChar, QString> bigrams;
+};
+
+} // namespace QtVirtualKeyboard
+QT_END_NAMESPACE
+
+#endif // HUNSPELLCOMPLETIONINDEX_P_H
@@ -0,0 +1,300 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Virtual Keyboard module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtHunspellInputMethod/private/hunspellcorrectionindex_p.h>
+#include <QFileInfo>
+#include <QDir>
+#include <QSaveFile>
+#include <algorithm>
+#include <limits>
+
+QT_BEGIN_NAMESPACE
+namespace QtVirtualKeyboard {
+
+namespace {
+
+const char IndexMagic[8] = { 'Q', 'V', 'K', 'S', 'Y', 'M', 'I', 'X' };
+const quint32 IndexVersion = 1;
+
+quint32 deleteHash(const QString &word)
+{
+    // FNV-1a, which is stable across Qt versions unlike qHash()
+    quint32 hash = 2166136261u;
+    for (const QChar c : word) {
+        hash = (hash ^ (c.unicode() & 0xff)) * 16777619u;
+        hash = (hash ^ (c.unicode() >> 8)) * 16777619u;
+    }
+    return hash;
+}
+
+void collectDeletes(const QString &word, int distance, QList<quint32> &hashes)
+{
+    hashes.append(deleteHash(word));
+    if (distance == 0 || word.size() <= 1)
+        return;
+
+    for (int i = 0; i < word.size(); ++i) {
+        QString deleted(word);
+        deleted.remove(i, 1);
+        collectDeletes(deleted, distance - 1, hashes);
+    }
+}
+
+} // namespace
+
+/*!
+    \class QtVirtualKeyboard::HunspellCorrectionIndex
+    \internal
+
+    Symmetric delete (SymSpell) index of the words in a Hunspell
+    dictionary. Each word is stored under the hashes of every string
+    which can be formed by deleting up to MaxEditDistance characters
+    from its first PrefixLength characters. A lookup generates the
+    deletes of the input and verifies the matching words with the
+    Damerau-Levenshtein distance, so it never runs the n-gram search
+    of Hunspell_suggest().
+
+    The index is a single file which is memory mapped read-only and
+    rejected when the dictionary or the frequency list changes.
+*/
+
+HunspellCorrectionIndex::HunspellCorrectionIndex() :
+    indexHeader(nullptr),
+    words(nullptr),
+    deletes(nullptr),
+    text(nullptr)
+{
+}
+
+bool HunspellCorrectionIndex::open(const QString &indexPath, const QByteArray &dictionary, const QByteArray &frequencies)
+{
+    qint64 size = 0;
+    const uchar *data = map(indexPath, header(IndexMagic, IndexVersion, dictionary, frequencies), size);
+    if (!data)
+        return false;
+
+    const IndexHeader *dataHeader = reinterpret_cast<const IndexHeader *>(data);
+    if (size < qint64(sizeof(IndexHeader)) ||
+            dataHeader->maxEditDistance != MaxEditDistance ||
+            dataHeader->prefixLength != PrefixLength ||
+            size != qint64(sizeof(IndexHeader)) +
+                    qint64(dataHeader->wordCount) * qint64(sizeof(WordEntry)) +
+                    qint64(dataHeader->deleteCount) * qint64(sizeof(DeleteEntry)) +
+                    qint64(dataHeader->textSize) * qint64(sizeof(char16_t))) {
+        HunspellIndexFile::close();
+        return false;
+    }
+
+    indexHeader = dataHeader;
+    words = reinterpret_cast<const WordEntry *>(data + sizeof(IndexHeader));
+    deletes = reinterpret_cast<const DeleteEntry *>(words + indexHeader->wordCount);
+    text = reinterpret_cast<const char16_t *>(deletes + indexHeader->deleteCount);
+
+    return true;
+}
+
+void HunspellCorrectionIndex::close()
+{
+    indexHeader = nullptr;
+    words = nullptr;
+    deletes = nullptr;
+    text = nullptr;
+    HunspellIndexFile::close();
+}
+
+/*!
+    Returns at most \a maxCount words within MaxEditDistance of \a word,
+    ordered by the edit distance and then by the word frequency. The
+    words in \a extraWords, e.g. the user dictionary, are ranked before
+    dictionary words at the same distance. The word itself is not
+    included and the candidates follow the capitalization of \a word.
+*/
+QStringList HunspellCorrectionIndex::lookup(const QString &word, int maxCount, const QStringList &extraWords) const
+{
+    QStringList result;
+    if (!indexHeader || word.isEmpty())
+        return result;
+
+    const QString input(word.toLower());
+    QList<quint32> hashes;
+    deleteHashes(input, hashes);
+
+    QList<quint32> candidates;
+    const DeleteEntry *deletesEnd = deletes + indexHeader->deleteCount;
+    for (quint32 hash : qAsConst(hashes)) {
+        const DeleteEntry *entry = std::lower_bound(deletes, deletesEnd, hash, [](const DeleteEntry &a, quint32 b) {
+            return a.hash < b;
+        });
+        for (; entry != deletesEnd && entry->hash == hash; ++entry)
+            candidates.append(entry->wordIndex);
+    }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    struct Match
+    {
+        QString word;
+        int distance;
+        quint32 frequency;
+    };
+    QList<Match> matches;
+    auto addMatch = [&](const QString &candidate, quint32 frequency) {
+        if (candidate.isEmpty() || qAbs(candidate.size() - input.size()) > MaxEditDistance)
+            return;
+        const int distance = editDistance(input, candidate.toLower());
+        if (distance == 0 || distance > MaxEditDistance)
+            return;
+        matches.append({ candidate, distance, frequency });
+    };
+    for (quint32 wordIndex : qAsConst(candidates)) {
+        if (wordIndex < indexHeader->wordCount)
+            addMatch(wordAt(wordIndex), words[wordIndex].frequency);
+    }
+    for (const QString &extraWord : extraWords)
+        addMatch(extraWord, std::numeric_limits<quint32>::max());
+
+    std::stable_sort(matches.begin(), matches.end(), [](const Match &a, const Match &b) {
+        if (a.distance != b.distance)
+            return a.distance < b.distance;
+        return a.frequency > b.frequency;
+    });
+
+    for (const Match &match : qAsConst(matches)) {
+        const QString candidate(matchCase(match.word, word));
+        if (result.contains(candidate))
+            continue;
+        result.append(candidate);
+        if (result.size() >= maxCount)
+            break;
+    }
+
+    return result;
+}
+
+/*!
+    Builds the index of the Hunspell \a dictionary and the word
+    \a frequencies to \a indexPath. See HunspellIndexFile::collectWords().
+*/
+bool HunspellCorrectionIndex::build(const QString &indexPath, const QByteArray &dictionary, const QByteArray &frequencies,
+                                    const char *encoding, Hunhandle *hunspell)
+{
+    QStringList wordList;
+    QList<quint32> frequencyList;
+    collectWords(dictionary, frequencies, encoding, hunspell, wordList, frequencyList);
+    if (wordList.isEmpty())
+        return false;
+
+    QList<WordEntry> wordEntries;
+    QList<DeleteEntry> deleteEntries;
+    QString wordText;
+    QList<quint32> hashes;
+    wordEntries.reserve(wordList.size());
+    deleteEntries.reserve(wordList.size() * 16);
+    for (int i = 0; i < wordList.size(); ++i) {
+        const QString &word = wordList.at(i);
+        wordEntries.append({ quint32(wordText.size()), quint32(word.size()), frequencyList.at(i) });
+        wordText.append(word);
+        deleteHashes(word, hashes);
+        for (quint32 hash : qAsConst(hashes))
+            deleteEntries.append({ hash, quint32(i) });
+    }
+    std::sort(deleteEntries.begin(), deleteEntries.end(), [](const DeleteEntry &a, const DeleteEntry &b) {
+        return a.hash < b.hash || (a.hash == b.hash && a.wordIndex < b.wordIndex);
+    });
+
+    const Header fileHeader(header(IndexMagic, IndexVersion, dictionary, frequencies));
+    IndexHeader dataHeader;
+    dataHeader.maxEditDistance = MaxEditDistance;
+    dataHeader.prefixLength = PrefixLength;
+    dataHeader.wordCount = quint32(wordEntries.size());
+    dataHeader.deleteCount = quint32(deleteEntries.size());
+    dataHeader.textSize = quint32(wordText.size());
+    dataHeader.reserved = 0;
+
+    QDir().mkpath(QFileInfo(indexPath).absolutePath());
+    QSaveFile indexFile(indexPath);
+    if (!indexFile.open(QIODevice::WriteOnly))
+        return false;
+    indexFile.write(reinterpret_cast<const char *>(&fileHeader), sizeof(Header));
+    indexFile.write(reinterpret_cast<const char *>(&dataHeader), sizeof(IndexHeader));
+    indexFile.write(reinterpret_cast<const char *>(wordEntries.constData()), wordEntries.size() * qint64(sizeof(WordEntry)));
+    indexFile.write(reinterpret_cast<const char *>(deleteEntries.constData()), deleteEntries.size() * qint64(sizeof(DeleteEntry)));
+    indexFile.write(reinterpret_cast<const char *>(wordText.constData()), wordText.size() * qint64(sizeof(QChar)));
+    return indexFile.commit();
+}
+
+// Optimal string alignment distance, i.e. Levenshtein distance
+// which also counts the transposition of adjacent characters as one edit
+int HunspellCorrectionIndex::editDistance(const QString &s, const QString &t)
+{
+    const int n = s.size();
+    const int m = t.size();
+    if (n == 0)
+        return m;
+    if (m == 0)
+        return n;
+
+    QList<int> previous2(m + 1);
+    QList<int> previous(m + 1);
+    QList<int> current(m + 1);
+    for (int j = 0; j <= m; ++j)
+        previous[j] = j;
+    for (int i = 1; i <= n; ++i) {
+        current[0] = i;
+        for (int j = 1; j <= m; ++j) {
+            const int cost = s.at(i - 1) == t.at(j - 1) ? 0 : 1;
+            int distance = qMin(qMin(previous[j] + 1, current[j - 1] + 1), previous[j - 1] + cost);
+            if (i > 1 && j > 1 && s.at(i - 1) == t.at(j - 2) && s.at(i - 2) == t.at(j - 1))
+                distance = qMin(distance, previous2[j - 2] + 1);
+            current[j] = distance;
+        }
+        std::swap(previous2, previous);
+        std::swap(previous, current);
+    }
+    return previous[m];
+}
+
+void HunspellCorrectionIndex::deleteHashes(const QString &word, QList<quint32> &hashes)
+{
+    hashes.clear();
+    collectDeletes(word.toLower().left(PrefixLength), MaxEditDistance, hashes);
+    std::sort(hashes.begin(), hashes.end());
+    hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+}
+
+QString HunspellCorrectionIndex::wordAt(quint32 wordIndex) const
+{
+    const WordEntry &entry = words[wordIndex];
+    if (entry.textOffset > indexHeader->textSize || entry.textLength > indexHeader->textSize - entry.textOffset)
+        return QString();
+    return QString(reinterpret_cast<const QChar *>(text + entry.textOffset), int(entry.textLength));
+}
+
+} // namespace QtVirtualKeyboard
+QT_END_NAMESPACE
@@ -0,0 +1,104 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Virtual Keyboard module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef HUNSPELLCORRECTIONINDEX_P_H
+#define HUNSPELLCORRECTIONINDEX_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtHunspellInputMethod/private/hunspellindexfile_p.h>
+
+QT_BEGIN_NAMESPACE
+namespace QtVirtualKeyboard {
+
+class QHUNSPELLINPUTMETHOD_EXPORT HunspellCorrectionIndex : public HunspellIndexFile
+{
+public:
+    enum {
+        MaxEditDistance = 2,
+        PrefixLength = 7
+    };
+
+    HunspellCorrectionIndex();
+
+    bool open(const QString &indexPath, const QByteArray &dictionary, const QByteArray &frequencies);
+    void close() override;
+
+    QStringList lookup(const QString &word, int maxCount, const QStringList &extraWords = QStringList()) const;
+
+    static bool build(const QString &indexPath, const QByteArray &dictionary, const QByteArray &frequencies,
+                      const char *encoding, Hunhandle *hunspell);
+    static int editDistance(const QString &s, const QString &t);
+
+private:
+    struct IndexHeader
+    {
+        quint32 maxEditDistance;
+        quint32 prefixLength;
+        quint32 wordCount;
+        quint32 deleteCount;
+        quint32 textSize;
+        quint32 reserved;
+    };
+
+    struct WordEntry
+    {
+        quint32 textOffset;
+        quint32 textLength;
+        quint32 frequency;
+    };
+
+    struct DeleteEntry
+    {
+        quint32 hash;
+        quint32 wordIndex;
+    };
+
+    static void deleteHashes(const QString &word, QList<quint32> &hashes);
+    QString wordAt(quint32 wordIndex) const;
+
+    const IndexHeader *indexHeader;
+    const WordEntry *words;
+    const DeleteEntry *deletes;
+    const char16_t *text;
+};
+
+} // namespace QtVirtualKeyboard
+QT_END_NAMESPACE
+
+#endif // HUNSPELLCORRECTIONINDEX_P_H
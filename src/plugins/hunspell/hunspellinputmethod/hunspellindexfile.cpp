@@ -0,0 +1,208 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Virtual Keyboard module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtHunspellInputMethod/private/hunspellindexfile_p.h>
+#include <QHash>
+#include <QStringDecoder>
+#include <QStringEncoder>
+#include <cstring>
+
+QT_BEGIN_NAMESPACE
+namespace QtVirtualKeyboard {
+
+/*!
+    \class QtVirtualKeyboard::HunspellIndexFile
+    \internal
+
+    Base class for the memory mapped index files built from a Hunspell
+    dictionary. Every index file starts with a header which identifies
+    the format and records the size and checksum of the dictionary and
+    the checksum of the word frequency list it was built from. A file
+    which does not match the current dictionary is not mapped.
+*/
+
+HunspellIndexFile::HunspellIndexFile() :
+    data(nullptr)
+{
+}
+
+HunspellIndexFile::~HunspellIndexFile()
+{
+    if (data)
+        file.unmap(data);
+}
+
+bool HunspellIndexFile::isOpen() const
+{
+    return data != nullptr;
+}
+
+void HunspellIndexFile::close()
+{
+    if (data)
+        file.unmap(data);
+    data = nullptr;
+    file.close();
+}
+
+/*!
+    Collects the words of the Hunspell \a dictionary (the contents of
+    the .dic file in \a encoding) and their frequencies. The optional
+    \a frequencies list is a UTF-8 text with a word and its count on
+    each line. Words of the list which are not in the dictionary, e.g.
+    inflected forms, are added if they pass the spell check of
+    \a hunspell. Words without a frequency get the frequency 1.
+*/
+void HunspellIndexFile::collectWords(const QByteArray &dictionary, const QByteArray &frequencies,
+                                     const char *encoding, Hunhandle *hunspell,
+                                     QStringList &words, QList<quint32> &wordFrequencies)
+{
+    words.clear();
+    wordFrequencies.clear();
+
+    QStringDecoder decoder(encoding, QStringConverter::Flag::Stateless);
+    QStringEncoder encoder(encoding, QStringConverter::Flag::Stateless);
+    if (!decoder.isValid() || !encoder.isValid())
+        return;
+
+    // The first line of the dictionary is the approximate word count
+    QHash<QString, int> wordIndexes;
+    const QList<QByteArray> lines = dictionary.split('\n');
+    words.reserve(lines.size());
+    wordIndexes.reserve(lines.size());
+    for (int i = 1; i < lines.size(); ++i) {
+        QString word = decoder(lines.at(i));
+        int end = 0;
+        for (; end < word.size(); ++end) {
+            const QChar c = word.at(end);
+            if (c == QLatin1Char('\\') && end + 1 < word.size() && word.at(end + 1) == QLatin1Char('/')) {
+                word.remove(end, 1);
+                continue;
+            }
+            if (c == QLatin1Char('/') || c == QLatin1Char('\t') || c == QLatin1Char(' ') || c == QLatin1Char('\r'))
+                break;
+        }
+        word.truncate(end);
+        if (word.isEmpty() || wordIndexes.contains(word))
+            continue;
+        wordIndexes.insert(word, words.size());
+        words.append(word);
+    }
+    wordFrequencies.fill(1, words.size());
+
+    for (const QByteArray &line : frequencies.split('\n')) {
+        const QList<QByteArray> fields = line.simplified().split(' ');
+        if (fields.size() != 2)
+            continue;
+        bool ok;
+        const quint32 frequency = qMax(fields.at(1).toUInt(&ok), 1u);
+        if (!ok)
+            continue;
+        const QString word(QString::fromUtf8(fields.at(0)));
+        const auto wordIndex = wordIndexes.constFind(word);
+        if (wordIndex != wordIndexes.constEnd()) {
+            wordFrequencies[*wordIndex] = frequency;
+        } else if (hunspell && Hunspell_spell(hunspell, QByteArray { encoder(word) }.constData()) != 0) {
+            wordIndexes.insert(word, words.size());
+            words.append(word);
+            wordFrequencies.append(frequency);
+        }
+    }
+}
+
+/*!
+    Maps \a filePath and returns a pointer to the data following the
+    header, or \c nullptr if the file does not exist or its header
+    differs from \a expectedHeader. The size of the data is returned
+    in \a dataSize.
+*/
+const uchar *HunspellIndexFile::map(const QString &filePath, const Header &expectedHeader, qint64 &dataSize)
+{
+    close();
+
+    file.setFileName(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return nullptr;
+
+    const qint64 size = file.size();
+    uchar *mapped = size >= qint64(sizeof(Header)) ? file.map(0, size) : nullptr;
+    if (!mapped || memcmp(mapped, &expectedHeader, sizeof(Header)) != 0) {
+        if (mapped)
+            file.unmap(mapped);
+        file.close();
+        return nullptr;
+    }
+
+    data = mapped;
+    dataSize = size - qint64(sizeof(Header));
+    return data + sizeof(Header);
+}
+
+HunspellIndexFile::Header HunspellIndexFile::header(const char *magic, quint32 version,
+                                                    const QByteArray &dictionary, const QByteArray &frequencies)
+{
+    Header result;
+    memset(&result, 0, sizeof(Header));
+    memcpy(result.magic, magic, sizeof(result.magic));
+    result.version = version;
+    result.dictionarySize = dictionary.size();
+    result.dictionaryChecksum = checksum(dictionary.constData(), dictionary.size());
+    result.frequencyChecksum = checksum(frequencies.constData(), frequencies.size());
+    return result;
+}
+
+/*!
+    Returns \a word in upper case if \a pattern is in upper case, or
+    with an initial capital if \a pattern starts with a capital.
+*/
+QString HunspellIndexFile::matchCase(const QString &word, const QString &pattern)
+{
+    if (word.isEmpty() || pattern.isEmpty())
+        return word;
+    if (pattern.size() > 1 && pattern == pattern.toUpper() && pattern != pattern.toLower())
+        return word.toUpper();
+    if (pattern.at(0).isUpper() && !word.at(0).isUpper()) {
+        QString result(word);
+        result[0] = result.at(0).toUpper();
+        return result;
+    }
+    return word;
+}
+
+quint32 HunspellIndexFile::checksum(const char *data, qint64 size)
+{
+    // FNV-1a, which is stable across Qt versions unlike qHash()
+    quint32 hash = 2166136261u;
+    for (qint64 i = 0; i < size; ++i)
+        hash = (hash ^ quint8(data[i])) * 16777619u;
+    return hash;
+}
+
+} // namespace QtVirtualKeyboard
+QT_END_NAMESPACE
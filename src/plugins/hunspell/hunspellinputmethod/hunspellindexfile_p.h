@@ -0,0 +1,92 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Virtual Keyboard module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef HUNSPELLINDEXFILE_P_H
+#define HUNSPELLINDEXFILE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QFile>
+#include <QList>
+#include <QStringList>
+#include <hunspell/hunspell.h>
+#include <QtHunspellInputMethod/qhunspellinputmethod_global.h>
+
+QT_BEGIN_NAMESPACE
+namespace QtVirtualKeyboard {
+
+class QHUNSPELLINPUTMETHOD_EXPORT HunspellIndexFile
+{
+    Q_DISABLE_COPY(HunspellIndexFile)
+public:
+    HunspellIndexFile();
+    virtual ~HunspellIndexFile();
+
+    bool isOpen() const;
+    virtual void close();
+
+    static void collectWords(const QByteArray &dictionary, const QByteArray &frequencies,
+                             const char *encoding, Hunhandle *hunspell,
+                             QStringList &words, QList<quint32> &wordFrequencies);
+
+protected:
+    struct Header
+    {
+        char magic[8];
+        quint32 version;
+        quint32 reserved;
+        qint64 dictionarySize;
+        quint32 dictionaryChecksum;
+        quint32 frequencyChecksum;
+    };
+
+    const uchar *map(const QString &filePath, const Header &expectedHeader, qint64 &dataSize);
+    static Header header(const char *magic, quint32 version,
+                         const QByteArray &dictionary, const QByteArray &frequencies);
+    static quint32 checksum(const char *data, qint64 size);
+    static QString matchCase(const QString &word, const QString &pattern);
+
+private:
+    QFile file;
+    uchar *data;
+};
+
+} // namespace QtVirtualKeyboard
+QT_END_NAMESPACE
+
+#endif // HUNSPELLINDEXFILE_P_H
@@ -30,6 +30,7 @@
 #include <QtHunspellInputMethod/private/hunspellinputmethod_p_p.h>
 #include <QtVirtualKeyboard/qvirtualkeyboardinputcontext.h>
 #include <QLoggingCategory>
+#include <QTimerEvent>
 
 QT_BEGIN_NAMESPACE
 namespace QtVirtualKeyboard {
@@ -373,20 +374,33 @@ void HunspellInputMethod::update()
     d->autoSpaceAllowed = false;
 }
 
-void HunspellInputMethod::updateSuggestions(const QSharedPointer<HunspellWordList> &wordList, int tag)
+void HunspellInputMethod::timerEvent(QTimerEvent *timerEvent)
 {
     Q_D(HunspellInputMethod);
+    if (timerEvent->timerId() == d->customDictionaryFlushTimer) {
+        killTimer(d->customDictionaryFlushTimer);
+        d->customDictionaryFlushTimer = 0;
+        d->flushCustomDictionaries();
+    }
+}
+
+void HunspellInputMethod::updateSuggestions()
+{
+    Q_D(HunspellInputMethod);
+    QScopedPointer<HunspellSuggestions> suggestions(d->suggestionsTask->takeSuggestions());
+    if (!suggestions)
+        return;
     if (d->dictionaryState == HunspellInputMethodPrivate::DictionaryNotLoaded) {
         qCDebug(lcHunspell) << "updateSuggestions: skip (dictionary not loaded)";
         update();
         return;
     }
-    if (d->wordCandidatesUpdateTag != tag) {
-        qCDebug(lcHunspell) << "updateSuggestions: skip tag" << tag << "current" << d->wordCandidatesUpdateTag;
+    if (d->wordCandidatesUpdateTag != suggestions->tag) {
+        qCDebug(lcHunspell) << "updateSuggestions: skip tag" << suggestions->tag << "current" << d->wordCandidatesUpdateTag;
         return;
     }
     QString word(d->wordCandidates.wordAt(0));
-    d->wordCandidates = *wordList;
+    d->wordCandidates.assign(*suggestions);
     if (d->wordCandidates.wordAt(0).compare(word) != 0)
         d->wordCandidates.updateWord(0, word);
     emit selectionListChanged(QVirtualKeyboardSelectionListModel::Type::WordCandidateList);
@@ -408,5 +422,13 @@ void HunspellInputMethod::dictionaryLoadCompleted(bool success)
         emit selectionListsChanged();
 }
 
+void HunspellInputMethod::dictionaryIndexesLoaded(bool completionIndexOpen)
+{
+    Q_D(HunspellInputMethod);
+    // Without the completion index, completions come from the suggestion
+    // engine, which needs at least two characters to be useful
+    d->wordCompletionPoint = completionIndexOpen ? 1 : 2;
+}
+
 } // namespace QtVirtualKeyboard
 QT_END_NAMESPACE
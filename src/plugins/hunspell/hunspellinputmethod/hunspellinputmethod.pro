@@ -7,10 +7,16 @@ QT += virtualkeyboard-private
 DEFINES += QHUNSPELLINPUTMETHOD_LIBRARY
 
 SOURCES += \
+    hunspellcompletionindex.cpp \
+    hunspellcorrectionindex.cpp \
+    hunspellindexfile.cpp \
     hunspellinputmethod.cpp \
     hunspellinputmethod_p.cpp \
     hunspellworker.cpp
 HEADERS += \
+    hunspellcompletionindex_p.h \
+    hunspellcorrectionindex_p.h \
+    hunspellindexfile_p.h \
     hunspellinputmethod_p.h \
     hunspellinputmethod_p_p.h \
     hunspellworker_p.h \
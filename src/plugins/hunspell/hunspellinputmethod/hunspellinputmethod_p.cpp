@@ -39,6 +39,8 @@ QT_BEGIN_NAMESPACE
 namespace QtVirtualKeyboard {
 
 const int HunspellInputMethodPrivate::userDictionaryMaxSize = 100;
+const int HunspellInputMethodPrivate::customDictionaryFlushDelay = 5000;
+const qint64 HunspellInputMethodPrivate::customDictionaryMaxLogSize = 4096;
 
 /*!
     \class QtVirtualKeyboard::HunspellInputMethodPrivate
@@ -55,14 +57,21 @@ HunspellInputMethodPrivate::HunspellInputMethodPrivate(HunspellInputMethod *q_pt
     dictionaryState(DictionaryNotLoaded),
     userDictionaryWords(new HunspellWordList(userDictionaryMaxSize)),
     blacklistedWords(new HunspellWordList(userDictionaryMaxSize)),
-    wordCandidatesUpdateTag(0)
+    suggestionsTask(new HunspellSuggestionsTask(blacklistedWords, userDictionaryWords)),
+    wordCandidatesUpdateTag(0),
+    customDictionaryFlushTimer(0)
 {
+    QObject::connect(suggestionsTask.data(), &HunspellSuggestionsTask::suggestionsAvailable, q_ptr, &HunspellInputMethod::updateSuggestions);
     if (hunspellWorker)
         hunspellWorker->start();
 }
 
 HunspellInputMethodPrivate::~HunspellInputMethodPrivate()
 {
+    if (hunspellWorker && !customDictionaryChanges.isEmpty()) {
+        flushCustomDictionaries();
+        hunspellWorker->waitForAllTasks();
+    }
 }
 
 bool HunspellInputMethodPrivate::createHunspell(const QString &locale)
@@ -71,8 +80,10 @@ bool HunspellInputMethodPrivate::createHunspell(const QString &locale)
     if (!hunspellWorker)
         return false;
     if (this->locale != locale) {
+        flushCustomDictionaries();
         clearSuggestionsRelatedTasks();
         hunspellWorker->waitForAllTasks();
+        suggestionsTask->clearCache();
         QString hunspellDataPath(qEnvironmentVariable("QT_VIRTUALKEYBOARD_HUNSPELL_DATA_PATH"));
         const QString pathListSep(
 #if defined(Q_OS_WIN32)
@@ -95,6 +106,8 @@ bool HunspellInputMethodPrivate::createHunspell(const QString &locale)
         }
         QSharedPointer<HunspellLoadDictionaryTask> loadDictionaryTask(new HunspellLoadDictionaryTask(locale, searchPaths));
         QObject::connect(loadDictionaryTask.data(), &HunspellLoadDictionaryTask::completed, q, &HunspellInputMethod::dictionaryLoadCompleted);
+        QObject::connect(loadDictionaryTask.data(), &HunspellLoadDictionaryTask::indexesLoaded, q, &HunspellInputMethod::dictionaryIndexesLoaded);
+        wordCompletionPoint = 2;
         dictionaryState = HunspellInputMethodPrivate::DictionaryLoading;
         emit q->selectionListsChanged();
         hunspellWorker->addTask(loadDictionaryTask);
@@ -126,37 +139,27 @@ bool HunspellInputMethodPrivate::updateSuggestions()
         wordCandidateListChanged = true;
         if (word.length() >= wordCompletionPoint) {
             if (hunspellWorker) {
-                QSharedPointer<HunspellWordList> wordList(new HunspellWordList(wordCandidates));
-
                 // Clear obsolete tasks from the worker queue
                 clearSuggestionsRelatedTasks();
 
-                // Build suggestions
-                QSharedPointer<HunspellBuildSuggestionsTask> buildSuggestionsTask(new HunspellBuildSuggestionsTask());
-                buildSuggestionsTask->wordList = wordList;
-                buildSuggestionsTask->autoCorrect = false;
-                hunspellWorker->addTask(buildSuggestionsTask);
-
-                // Filter out blacklisted word (sometimes Hunspell suggests,
-                // e.g. with different text case)
-                QSharedPointer<HunspellFilterWordTask> filterWordTask(new HunspellFilterWordTask());
-                filterWordTask->wordList = wordList;
-                filterWordTask->filterList = blacklistedWords;
-                hunspellWorker->addTask(filterWordTask);
-
-                // Boost words from user dictionary
-                QSharedPointer<HunspellBoostWordTask> boostWordTask(new HunspellBoostWordTask());
-                boostWordTask->wordList = wordList;
-                boostWordTask->boostList = userDictionaryWords;
-                hunspellWorker->addTask(boostWordTask);
-
-                // Update word candidate list
-                QSharedPointer<HunspellUpdateSuggestionsTask> updateSuggestionsTask(new HunspellUpdateSuggestionsTask());
-                updateSuggestionsTask->wordList = wordList;
-                updateSuggestionsTask->tag = ++wordCandidatesUpdateTag;
-                Q_Q(HunspellInputMethod);
-                QObject::connect(updateSuggestionsTask.data(), &HunspellUpdateSuggestionsTask::updateSuggestions, q, &HunspellInputMethod::updateSuggestions);
-                hunspellWorker->addTask(updateSuggestionsTask);
+                // Build, filter and boost suggestions in one pass
+                HunspellSuggestionRequest *request = new HunspellSuggestionRequest();
+                wordCandidates.wordAt(0, request->word, request->wordFlags);
+                request->tag = ++wordCandidatesUpdateTag;
+                request->autoCorrect = false;
+                request->prefetchOnly = false;
+                request->traceSpan = LatencyTracer::currentSpan();
+
+                // Show prefetched suggestions right away, the worker then
+                // only prefetches the suggestions for the next keystroke
+                QScopedPointer<HunspellSuggestions> suggestions(suggestionsTask->cachedSuggestions(*request));
+                if (suggestions) {
+                    wordCandidates.assign(*suggestions);
+                    request->prefetchOnly = true;
+                }
+
+                suggestionsTask->request(request);
+                hunspellWorker->addTask(suggestionsTask);
             }
         }
     } else {
@@ -174,11 +177,11 @@ bool HunspellInputMethodPrivate::clearSuggestions(bool clearInputWord)
 void HunspellInputMethodPrivate::clearSuggestionsRelatedTasks()
 {
     if (hunspellWorker) {
-        hunspellWorker->removeAllTasksOfType<HunspellBuildSuggestionsTask>();
-        hunspellWorker->removeAllTasksOfType<HunspellFilterWordTask>();
-        hunspellWorker->removeAllTasksOfType<HunspellBoostWordTask>();
-        hunspellWorker->removeAllTasksOfType<HunspellUpdateSuggestionsTask>();
+        hunspellWorker->removeAllTasksOfType<HunspellSuggestionsTask>();
     }
+    // Invalidate the result of a task that may be still running
+    ++wordCandidatesUpdateTag;
+    suggestionsTask->cancel();
 }
 
 bool HunspellInputMethodPrivate::isAutoSpaceAllowed() const
@@ -239,24 +242,62 @@ QString HunspellInputMethodPrivate::customDictionaryLocation(const QString &dict
                     .arg(locale);
 }
 
+QString HunspellInputMethodPrivate::customDictionaryLogLocation(const QString &dictionaryType) const
+{
+    const QString location = customDictionaryLocation(dictionaryType);
+    if (location.isEmpty())
+        return QString();
+
+    return location + QLatin1String(".log");
+}
+
 void HunspellInputMethodPrivate::loadCustomDictionary(const QSharedPointer<HunspellWordList> &wordList,
                                                       const QString &dictionaryType) const
 {
     QSharedPointer<HunspellLoadWordListTask> loadWordsTask(new HunspellLoadWordListTask());
     loadWordsTask->filePath = customDictionaryLocation(dictionaryType);
+    loadWordsTask->logFilePath = customDictionaryLogLocation(dictionaryType);
     loadWordsTask->wordList = wordList;
     hunspellWorker->addTask(loadWordsTask);
 }
 
 void HunspellInputMethodPrivate::saveCustomDictionary(const QSharedPointer<HunspellWordList> &wordList,
-                                                      const QString &dictionaryType) const
+                                                      const QString &dictionaryType)
 {
     QSharedPointer<HunspellSaveWordListTask> saveWordsTask(new HunspellSaveWordListTask());
     saveWordsTask->filePath = customDictionaryLocation(dictionaryType);
+    saveWordsTask->logFilePath = customDictionaryLogLocation(dictionaryType);
+    saveWordsTask->changes = customDictionaryChanges.take(dictionaryType);
+    saveWordsTask->maxLogSize = customDictionaryMaxLogSize;
     saveWordsTask->wordList = wordList;
     hunspellWorker->addTask(saveWordsTask);
 }
 
+/*!
+    Records a change to the custom dictionary. The changes are written
+    to the change log when the user has been idle for
+    customDictionaryFlushDelay milliseconds, when the locale changes,
+    or on shutdown.
+*/
+void HunspellInputMethodPrivate::logCustomDictionaryChange(const QString &dictionaryType,
+                                                           HunspellSaveWordListTask::Change change,
+                                                           const QString &word)
+{
+    Q_Q(HunspellInputMethod);
+    HunspellSaveWordListTask::appendChange(customDictionaryChanges[dictionaryType], change, word);
+    if (customDictionaryFlushTimer)
+        q->killTimer(customDictionaryFlushTimer);
+    customDictionaryFlushTimer = q->startTimer(customDictionaryFlushDelay);
+}
+
+void HunspellInputMethodPrivate::flushCustomDictionaries()
+{
+    if (customDictionaryChanges.contains(QLatin1String("userdictionary")))
+        saveCustomDictionary(userDictionaryWords, QLatin1String("userdictionary"));
+    if (customDictionaryChanges.contains(QLatin1String("blacklist")))
+        saveCustomDictionary(blacklistedWords, QLatin1String("blacklist"));
+}
+
 void HunspellInputMethodPrivate::addToHunspell(const QSharedPointer<HunspellWordList> &wordList) const
 {
     QSharedPointer<HunspellAddWordTask> addWordTask(new HunspellAddWordTask());
@@ -274,10 +315,10 @@ void HunspellInputMethodPrivate::removeFromHunspell(const QSharedPointer<Hunspel
 void HunspellInputMethodPrivate::removeFromDictionary(const QString &word)
 {
     if (userDictionaryWords->removeWord(word) > 0) {
-        saveCustomDictionary(userDictionaryWords, QLatin1String("userdictionary"));
+        logCustomDictionaryChange(QLatin1String("userdictionary"), HunspellSaveWordListTask::RemoveWord, word);
     } else if (!blacklistedWords->contains(word)) {
         blacklistedWords->appendWord(word);
-        saveCustomDictionary(blacklistedWords, QLatin1String("blacklist"));
+        logCustomDictionaryChange(QLatin1String("blacklist"), HunspellSaveWordListTask::AddWord, word);
     }
 
     QSharedPointer<HunspellWordList> wordList(new HunspellWordList());
@@ -307,10 +348,10 @@ void HunspellInputMethodPrivate::addToDictionary()
     wordCandidates.wordAt(activeWordIndex, word, wordFlags);
     if (activeWordIndex == 0) {
         if (blacklistedWords->removeWord(word) > 0) {
-            saveCustomDictionary(blacklistedWords, QLatin1String("blacklist"));
+            logCustomDictionaryChange(QLatin1String("blacklist"), HunspellSaveWordListTask::RemoveWord, word);
         } else if (word.length() > 1 && !wordFlags.testFlag(HunspellWordList::SpellCheckOk) && !userDictionaryWords->contains(word)) {
             userDictionaryWords->appendWord(word);
-            saveCustomDictionary(userDictionaryWords, QLatin1String("userdictionary"));
+            logCustomDictionaryChange(QLatin1String("userdictionary"), HunspellSaveWordListTask::AddWord, word);
         } else {
             // Avoid adding words to Hunspell which are too short or passed spell check
             return;
@@ -328,7 +369,7 @@ void HunspellInputMethodPrivate::addToDictionary()
         int userDictionaryIndex = userDictionaryWords->indexOfWord(word);
         if (userDictionaryIndex != -1) {
             userDictionaryWords->moveWord(userDictionaryIndex, userDictionaryWords->size() - 1);
-            saveCustomDictionary(userDictionaryWords, QLatin1String("userdictionary"));
+            logCustomDictionaryChange(QLatin1String("userdictionary"), HunspellSaveWordListTask::TouchWord, word);
         }
     }
 }
@@ -48,7 +48,6 @@ QT_BEGIN_NAMESPACE
 namespace QtVirtualKeyboard {
 
 class HunspellInputMethodPrivate;
-class HunspellWordList;
 
 class QHUNSPELLINPUTMETHOD_EXPORT HunspellInputMethod : public QVirtualKeyboardAbstractInputMethod
 {
@@ -78,9 +77,13 @@ public:
     void reset() override;
     void update() override;
 
+protected:
+    void timerEvent(QTimerEvent *timerEvent) override;
+
 protected Q_SLOTS:
-    void updateSuggestions(const QSharedPointer<HunspellWordList> &wordList, int tag);
+    void updateSuggestions();
     void dictionaryLoadCompleted(bool success);
+    void dictionaryIndexesLoaded(bool completionIndexOpen);
 
 protected:
     QScopedPointer<HunspellInputMethodPrivate> d_ptr;
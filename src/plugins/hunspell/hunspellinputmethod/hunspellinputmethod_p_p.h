@@ -43,6 +43,7 @@
 
 #include <QtHunspellInputMethod/private/hunspellinputmethod_p.h>
 #include <QtHunspellInputMethod/private/hunspellworker_p.h>
+#include <QHash>
 
 QT_BEGIN_NAMESPACE
 namespace QtVirtualKeyboard {
@@ -70,8 +71,11 @@ public:
     bool isValidInputChar(const QChar &c) const;
     bool isJoiner(const QChar &c) const;
     QString customDictionaryLocation(const QString &dictionaryType) const;
+    QString customDictionaryLogLocation(const QString &dictionaryType) const;
     void loadCustomDictionary(const QSharedPointer<HunspellWordList> &wordList, const QString &dictionaryType) const;
-    void saveCustomDictionary(const QSharedPointer<HunspellWordList> &wordList, const QString &dictionaryType) const;
+    void saveCustomDictionary(const QSharedPointer<HunspellWordList> &wordList, const QString &dictionaryType);
+    void logCustomDictionaryChange(const QString &dictionaryType, HunspellSaveWordListTask::Change change, const QString &word);
+    void flushCustomDictionaries();
     void addToHunspell(const QSharedPointer<HunspellWordList> &wordList) const;
     void removeFromHunspell(const QSharedPointer<HunspellWordList> &wordList) const;
     void removeFromDictionary(const QString &word);
@@ -87,8 +91,13 @@ public:
     DictionaryState dictionaryState;
     QSharedPointer<HunspellWordList> userDictionaryWords;
     QSharedPointer<HunspellWordList> blacklistedWords;
+    QSharedPointer<HunspellSuggestionsTask> suggestionsTask;
     int wordCandidatesUpdateTag;
+    QHash<QString, QByteArray> customDictionaryChanges;
+    int customDictionaryFlushTimer;
     static const int userDictionaryMaxSize;
+    static const int customDictionaryFlushDelay;
+    static const qint64 customDictionaryMaxLogSize;
 };
 
 } // namespace QtVirtualKeyboard
@@ -33,12 +33,102 @@
 #include <QRegularExpression>
 #include <QElapsedTimer>
 #include <QFile>
+#include <QSaveFile>
 #include <QDir>
+#include <QStandardPaths>
 #include <QtAlgorithms>
 
 QT_BEGIN_NAMESPACE
 namespace QtVirtualKeyboard {
 
+namespace {
+
+class SearchContext {
+public:
+    SearchContext(const QString &word,
+                  const QStringList &list) :
+        word(word),
+        list(list)
+    {}
+    const QString &word;
+    const QStringList &list;
+};
+
+QList<int>::const_iterator searchIndexLowerBound(const QStringList &list, const QList<int> &searchIndex, const QString &word)
+{
+    SearchContext searchContext(word, list);
+    return std::lower_bound(searchIndex.cbegin(), searchIndex.cend(), -1, [searchContext](int a, int b) {
+        const QString &wordA = (a == -1) ? searchContext.word : searchContext.list[a];
+        const QString &wordB = (b == -1) ? searchContext.word : searchContext.list[b];
+        return wordA.compare(wordB, Qt::CaseInsensitive) < 0;
+    });
+}
+
+bool searchIndexContains(const QStringList &list, const QList<int> &searchIndex, const QString &word)
+{
+    auto match = searchIndexLowerBound(list, searchIndex, word);
+    return match != searchIndex.cend() && !word.compare(list[*match], Qt::CaseInsensitive);
+}
+
+QString searchIndexFindWordCompletion(const QStringList &list, const QList<int> &searchIndex, const QString &word)
+{
+    auto match = searchIndexLowerBound(list, searchIndex, word);
+    if (match == searchIndex.cend())
+        return QString();
+
+    if (!word.compare(list[*match], Qt::CaseInsensitive)) {
+        match++;
+        if (match == searchIndex.cend())
+            return QString();
+    }
+
+    return list[*match].startsWith(word, Qt::CaseInsensitive) ? list[*match] : QString();
+}
+
+QList<int> buildSearchIndex(const QStringList &list)
+{
+    QList<int> searchIndex(list.size());
+    std::iota(searchIndex.begin(), searchIndex.end(), 0);
+    std::sort(searchIndex.begin(), searchIndex.end(), [&list](int a, int b) { return list[a].compare(list[b], Qt::CaseInsensitive) < 0; });
+    return searchIndex;
+}
+
+} // namespace
+
+/*!
+    \class QtVirtualKeyboard::HunspellWordListSnapshot
+    \internal
+
+    Immutable, indexed copy of a HunspellWordList. The snapshot can be
+    searched from any thread without locking.
+*/
+
+HunspellWordListSnapshot::HunspellWordListSnapshot(const QStringList &list) :
+    _list(list),
+    _searchIndex(buildSearchIndex(list))
+{
+}
+
+bool HunspellWordListSnapshot::isEmpty() const
+{
+    return _list.isEmpty();
+}
+
+const QStringList &HunspellWordListSnapshot::words() const
+{
+    return _list;
+}
+
+bool HunspellWordListSnapshot::contains(const QString &word) const
+{
+    return searchIndexContains(_list, _searchIndex, word);
+}
+
+QString HunspellWordListSnapshot::findWordCompletion(const QString &word) const
+{
+    return searchIndexFindWordCompletion(_list, _searchIndex, word);
+}
+
 HunspellWordList::HunspellWordList(int limit) :
     _index(0),
     _limit(limit)
@@ -60,6 +150,7 @@ HunspellWordList &HunspellWordList::operator=(HunspellWordList &other)
         _index = other._index;
         _limit = other._limit;
         _searchIndex = other._searchIndex;
+        _snapshot = other._snapshot;
     }
     return *this;
 }
@@ -83,6 +174,7 @@ bool HunspellWordList::clear()
     _flags.clear();
     _index = 0;
     _searchIndex.clear();
+    _snapshot.reset();
     return result;
 }
 
@@ -93,6 +185,7 @@ bool HunspellWordList::clearSuggestions()
         return false;
 
     _searchIndex.clear();
+    _snapshot.reset();
     if (_list.size() > 1) {
         QString word = _list.at(0);
         Flags flags = _flags.at(0);
@@ -139,13 +232,7 @@ bool HunspellWordList::contains(const QString &word)
     // cleared when the word list is modified.
     if (!_searchIndex.isEmpty()) {
         Q_ASSERT(_searchIndex.size() == _list.size());
-
-        SearchContext searchContext(word, _list);
-        return std::binary_search(_searchIndex.begin(), _searchIndex.end(), -1, [searchContext](const int &a, const int &b) {
-            const QString &wordA = (a == -1) ? searchContext.word : searchContext.list[a];
-            const QString &wordB = (b == -1) ? searchContext.word : searchContext.list[b];
-            return wordA.compare(wordB, Qt::CaseInsensitive) < 0;
-        });
+        return searchIndexContains(_list, _searchIndex, word);
     }
 
     return _list.contains(word, Qt::CaseInsensitive);
@@ -157,24 +244,7 @@ QString HunspellWordList::findWordCompletion(const QString &word)
 
     if (!_searchIndex.isEmpty()) {
         Q_ASSERT(_searchIndex.size() == _list.size());
-
-        SearchContext searchContext(word, _list);
-        auto match = std::lower_bound(_searchIndex.begin(), _searchIndex.end(), -1, [searchContext](const int &a, const int &b) {
-            const QString &wordA = (a == -1) ? searchContext.word : searchContext.list[a];
-            const QString &wordB = (b == -1) ? searchContext.word : searchContext.list[b];
-            return wordA.compare(wordB, Qt::CaseInsensitive) < 0;
-        });
-
-        if (match == _searchIndex.end())
-            return QString();
-
-        if (!word.compare(_list[*match], Qt::CaseInsensitive)) {
-            match++;
-            if (match == _searchIndex.end())
-                return QString();
-        }
-
-        return _list[*match].startsWith(word, Qt::CaseInsensitive) ? _list[*match] : QString();
+        return searchIndexFindWordCompletion(_list, _searchIndex, word);
     }
 
     QString bestMatch;
@@ -196,13 +266,8 @@ int HunspellWordList::indexOfWord(const QString &word)
     if (!_searchIndex.isEmpty()) {
         Q_ASSERT(_searchIndex.size() == _list.size());
 
-        SearchContext searchContext(word, _list);
-        auto match = std::lower_bound(_searchIndex.begin(), _searchIndex.end(), -1, [searchContext](int a, int b) {
-            const QString &wordA = (a == -1) ? searchContext.word : searchContext.list[a];
-            const QString &wordB = (b == -1) ? searchContext.word : searchContext.list[b];
-            return wordA.compare(wordB, Qt::CaseInsensitive) < 0;
-        });
-        return (match != _searchIndex.end()) ? *match : -1;
+        auto match = searchIndexLowerBound(_list, _searchIndex, word);
+        return (match != _searchIndex.cend()) ? *match : -1;
     }
 
     return _list.indexOf(word);
@@ -236,6 +301,7 @@ void HunspellWordList::appendWord(const QString &word, const Flags &flags)
     QMutexLocker guard(&_lock);
 
     _searchIndex.clear();
+    _snapshot.reset();
     if (_limit > 0) {
         while (_list.size() >= _limit) {
             _list.removeAt(0);
@@ -252,6 +318,7 @@ void HunspellWordList::insertWord(int index, const QString &word, const Flags &f
     Q_ASSERT(_limit == 0);
 
     _searchIndex.clear();
+    _snapshot.reset();
     _list.insert(index, word);
     _flags.insert(index, flags);
 }
@@ -262,12 +329,15 @@ void HunspellWordList::updateWord(int index, const QString &word, const Flags &f
     QMutexLocker guard(&_lock);
 
     if (index < _list.size()) {
-        if (word != _list[index])
+        if (word != _list[index]) {
             _searchIndex.clear();
+            _snapshot.reset();
+        }
         _list[index] = word;
         _flags[index] = flags;
     } else {
         _searchIndex.clear();
+        _snapshot.reset();
         _list.append(word);
         _flags.append(flags);
     }
@@ -285,6 +355,7 @@ void HunspellWordList::moveWord(int from, int to)
         return;
 
     _searchIndex.clear();
+    _snapshot.reset();
     _list.move(from, to);
     _flags.move(from, to);
 }
@@ -303,8 +374,10 @@ int HunspellWordList::removeWord(const QString &word)
             ++i;
         }
     }
-    if (removeCount > 0)
+    if (removeCount > 0) {
         _searchIndex.clear();
+        _snapshot.reset();
+    }
     return removeCount;
 }
 
@@ -312,7 +385,10 @@ void HunspellWordList::removeWordAt(int index)
 {
     QMutexLocker guard(&_lock);
 
+    _searchIndex.clear();
+    _snapshot.reset();
     _list.removeAt(index);
+    _flags.removeAt(index);
 }
 
 void HunspellWordList::rebuildSearchIndex()
@@ -323,11 +399,104 @@ void HunspellWordList::rebuildSearchIndex()
     if (_list.isEmpty())
         return;
 
-    _searchIndex.resize(_list.size());
-    std::iota(_searchIndex.begin(), _searchIndex.end(), 0);
+    _searchIndex = buildSearchIndex(_list);
+}
+
+void HunspellWordList::assign(const HunspellSuggestions &suggestions)
+{
+    QMutexLocker guard(&_lock);
+    Q_ASSERT(suggestions.words.size() == suggestions.flags.size());
 
-    const QStringList list(_list);
-    std::sort(_searchIndex.begin(), _searchIndex.end(), [list](int a, int b) { return list[a].compare(list[b], Qt::CaseInsensitive) < 0; });
+    _list = suggestions.words;
+    _flags = suggestions.flags;
+    _index = suggestions.index;
+    _searchIndex.clear();
+    _snapshot.reset();
+}
+
+/*!
+    Returns an immutable snapshot of the word list. The snapshot is
+    cached and rebuilt only after the word list has changed.
+*/
+QSharedPointer<const HunspellWordListSnapshot> HunspellWordList::snapshot()
+{
+    QMutexLocker guard(&_lock);
+
+    if (!_snapshot)
+        _snapshot.reset(new HunspellWordListSnapshot(_list));
+
+    return _snapshot;
+}
+
+/*!
+    \class QtVirtualKeyboard::HunspellSuggestionCache
+    \internal
+
+    Small, thread-safe cache of the suggestions computed by the worker
+    thread, ordered from the most to the least recently used. An entry
+    is only valid with the same snapshots of the blacklist and the user
+    dictionary it was computed with, so it becomes stale as soon as
+    either list changes.
+*/
+
+HunspellSuggestionCache::HunspellSuggestionCache(int maxSize) :
+    _maxSize(maxSize)
+{
+}
+
+/*!
+    Returns a copy of the cached suggestions for \a request, or \c nullptr
+    if there are none. The tag of the copy is taken from \a request.
+*/
+HunspellSuggestions *HunspellSuggestionCache::find(const HunspellSuggestionRequest &request,
+                                                   const QSharedPointer<const HunspellWordListSnapshot> &blacklist,
+                                                   const QSharedPointer<const HunspellWordListSnapshot> &userDictionary)
+{
+    QMutexLocker guard(&_lock);
+
+    const int index = indexOf(request, blacklist, userDictionary);
+    if (index == -1)
+        return nullptr;
+
+    _entries.move(index, 0);
+    HunspellSuggestions *suggestions = new HunspellSuggestions(_entries.first().suggestions);
+    suggestions->tag = request.tag;
+    return suggestions;
+}
+
+void HunspellSuggestionCache::insert(const HunspellSuggestionRequest &request, const HunspellSuggestions &suggestions,
+                                     const QSharedPointer<const HunspellWordListSnapshot> &blacklist,
+                                     const QSharedPointer<const HunspellWordListSnapshot> &userDictionary)
+{
+    QMutexLocker guard(&_lock);
+
+    const int index = indexOf(request, blacklist, userDictionary);
+    if (index != -1)
+        _entries.removeAt(index);
+    _entries.prepend({ request.word, request.wordFlags, request.autoCorrect, blacklist, userDictionary, suggestions });
+    while (_entries.size() > _maxSize)
+        _entries.removeLast();
+}
+
+void HunspellSuggestionCache::clear()
+{
+    QMutexLocker guard(&_lock);
+
+    _entries.clear();
+}
+
+int HunspellSuggestionCache::indexOf(const HunspellSuggestionRequest &request,
+                                     const QSharedPointer<const HunspellWordListSnapshot> &blacklist,
+                                     const QSharedPointer<const HunspellWordListSnapshot> &userDictionary) const
+{
+    for (int i = 0; i < _entries.size(); ++i) {
+        const Entry &entry = _entries.at(i);
+        if (entry.word == request.word && entry.wordFlags == request.wordFlags &&
+                entry.autoCorrect == request.autoCorrect &&
+                entry.blacklist == blacklist && entry.userDictionary == userDictionary)
+            return i;
+    }
+    return -1;
 }
 
 /*!
@@ -363,6 +532,8 @@ void HunspellLoadDictionaryTask::run()
         Hunspell_destroy(*hunspellPtr);
         *hunspellPtr = nullptr;
     }
+    correctionIndex->close();
+    completionIndex->close();
 
     QString affPath;
     QString dicPath;
@@ -394,41 +565,342 @@ void HunspellLoadDictionaryTask::run()
     }
 
     emit completed(*hunspellPtr != nullptr);
+
+    if (*hunspellPtr) {
+        loadIndexes(dicPath);
+        emit indexesLoaded(completionIndex->isOpen());
+    }
 }
 
+namespace {
+
+/*  Opens the index \a indexFileName of the dictionary \a dicInfo.
+    The index is searched next to the dictionary and in the cache
+    location. When neither is up to date, the index is built next to
+    the dictionary, or in the cache location if the dictionary
+    directory is read-only.
+*/
+template <class Index>
+void openIndex(Index &index, const QString &indexFileName, const QFileInfo &dicInfo,
+               const QByteArray &dictionary, const QByteArray &frequencies, Hunhandle *hunspell)
+{
+    const QString indexPath(dicInfo.absoluteDir().filePath(indexFileName));
+    if (index.open(indexPath, dictionary, frequencies))
+        return;
+
+    const QString cacheLocation(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation));
+    const QString cachedIndexPath(cacheLocation.isEmpty() ? QString() :
+            QStringLiteral("%1/qtvirtualkeyboard/hunspell/%2").arg(cacheLocation, indexFileName));
+    if (!cachedIndexPath.isEmpty() && index.open(cachedIndexPath, dictionary, frequencies))
+        return;
+
+    const QString buildPath(QFileInfo(dicInfo.absolutePath()).isWritable() ? indexPath : cachedIndexPath);
+    if (buildPath.isEmpty())
+        return;
+
+    QElapsedTimer perf;
+    perf.start();
+    if (Index::build(buildPath, dictionary, frequencies, Hunspell_get_dic_encoding(hunspell), hunspell)) {
+        qCDebug(lcHunspell) << "Built" << buildPath << "in" << perf.elapsed() << "ms";
+        index.open(buildPath, dictionary, frequencies);
+    } else {
+        qCWarning(lcHunspell) << "Failed to build" << buildPath;
+    }
+}
+
+} // namespace
+
 /*!
-    \class QtVirtualKeyboard::HunspellBuildSuggestionsTask
+    Opens the correction and completion indexes of the dictionary
+    \a dicPath, building them if needed. The optional word frequency
+    list \c {<locale>.freq} next to the dictionary is used for ranking.
+*/
+void HunspellLoadDictionaryTask::loadIndexes(const QString &dicPath)
+{
+    const bool correctionIndexEnabled = !qEnvironmentVariableIsSet("QT_VIRTUALKEYBOARD_HUNSPELL_DISABLE_CORRECTION_INDEX");
+    const bool completionIndexEnabled = !qEnvironmentVariableIsSet("QT_VIRTUALKEYBOARD_HUNSPELL_DISABLE_COMPLETION_INDEX");
+    if (!correctionIndexEnabled && !completionIndexEnabled)
+        return;
+
+    QFile dicFile(dicPath);
+    if (!dicFile.open(QIODevice::ReadOnly))
+        return;
+    const QByteArray dictionary(dicFile.readAll());
+    dicFile.close();
+
+    const QFileInfo dicInfo(dicPath);
+    QByteArray frequencies;
+    QFile frequencyFile(dicInfo.absoluteDir().filePath(dicInfo.completeBaseName() + QLatin1String(".freq")));
+    if (frequencyFile.open(QIODevice::ReadOnly)) {
+        frequencies = frequencyFile.readAll();
+        frequencyFile.close();
+    }
+
+    if (correctionIndexEnabled)
+        openIndex(*correctionIndex, dicInfo.completeBaseName() + QLatin1String(".sym"), dicInfo, dictionary, frequencies, *hunspellPtr);
+    if (completionIndexEnabled)
+        openIndex(*completionIndex, dicInfo.completeBaseName() + QLatin1String(".cpl"), dicInfo, dictionary, frequencies, *hunspellPtr);
+}
+
+/*!
+    \class QtVirtualKeyboard::HunspellSuggestionsTask
     \internal
+
+    Builds the word candidates, filters out blacklisted words and boosts
+    words from the user dictionary in a single pass on the worker thread.
+
+    The task is long-lived and is re-queued for each keystroke. The input
+    is handed over in a HunspellSuggestionRequest, which replaces any
+    request not yet picked up by the worker. The result is built in a
+    private buffer and published as an immutable HunspellSuggestions,
+    which the receiver takes with takeSuggestions() after the
+    suggestionsAvailable() signal.
+
+    When the environment variable QT_VIRTUALKEYBOARD_HUNSPELL_PREFETCH is
+    set, the task uses the idle time after publishing to compute the
+    suggestions for the most probable next characters into a small cache.
+    The receiver checks the cache with cachedSuggestions() before
+    queueing a request, so a hit is shown without waiting for the worker.
+    A new request interrupts the prefetching.
 */
 
-void HunspellBuildSuggestionsTask::run()
+const int HunspellSuggestionsTask::maxCorrections = 10;
+const int HunspellSuggestionsTask::minCorrections = 3;
+const int HunspellSuggestionsTask::maxCompletions = 5;
+const int HunspellSuggestionsTask::minSuggestionLength = 3;
+const int HunspellSuggestionsTask::maxPrefetchCount = 4;
+const int HunspellSuggestionsTask::cacheSize = 16;
+
+HunspellSuggestionsTask::HunspellSuggestionsTask(const QSharedPointer<HunspellWordList> &blacklistedWords,
+                                                 const QSharedPointer<HunspellWordList> &userDictionaryWords) :
+    HunspellTask(),
+    blacklistedWords(blacklistedWords),
+    userDictionaryWords(userDictionaryWords),
+    pendingRequest(nullptr),
+    publishedSuggestions(nullptr),
+    cache(cacheSize),
+    prefetchEnabled(qEnvironmentVariableIsSet("QT_VIRTUALKEYBOARD_HUNSPELL_PREFETCH"))
 {
-    if (wordList->isEmpty())
-        return;
+}
+
+HunspellSuggestionsTask::~HunspellSuggestionsTask()
+{
+    delete pendingRequest.fetchAndStoreOrdered(nullptr);
+    delete publishedSuggestions.fetchAndStoreOrdered(nullptr);
+}
+
+void HunspellSuggestionsTask::request(HunspellSuggestionRequest *request)
+{
+    delete pendingRequest.fetchAndStoreOrdered(request);
+}
+
+void HunspellSuggestionsTask::cancel()
+{
+    delete pendingRequest.fetchAndStoreOrdered(nullptr);
+    delete publishedSuggestions.fetchAndStoreOrdered(nullptr);
+}
+
+HunspellSuggestions *HunspellSuggestionsTask::takeSuggestions()
+{
+    return publishedSuggestions.fetchAndStoreAcquire(nullptr);
+}
+
+/*!
+    Returns the suggestions for \a request from the cache, or \c nullptr
+    if they have not been computed with the current word lists. The cache
+    is used only when prefetching is enabled.
+*/
+HunspellSuggestions *HunspellSuggestionsTask::cachedSuggestions(const HunspellSuggestionRequest &request)
+{
+    if (!prefetchEnabled)
+        return nullptr;
+    return cache.find(request, blacklistedWords->snapshot(), userDictionaryWords->snapshot());
+}
+
+/*!
+    Clears the cached suggestions, e.g. when the dictionary changes.
+*/
+void HunspellSuggestionsTask::clearCache()
+{
+    cache.clear();
+}
+
+bool HunspellSuggestionsTask::prepare()
+{
+    currentRequest.reset(pendingRequest.fetchAndStoreAcquire(nullptr));
+    if (!currentRequest)
+        return false;
+    traceSpan = currentRequest->traceSpan;
+    return true;
+}
 
-    wordList->clearSuggestions();
-    QString word = wordList->wordAt(0);
+void HunspellSuggestionsTask::run()
+{
+    Q_ASSERT(currentRequest);
+
+    QSharedPointer<const HunspellWordListSnapshot> blacklist;
+    QSharedPointer<const HunspellWordListSnapshot> userDictionary;
+    const bool ready = !currentRequest->word.isEmpty() && updateTextCodecs();
+    if (ready) {
+        blacklist = blacklistedWords->snapshot();
+        userDictionary = userDictionaryWords->snapshot();
+    }
 
-    /*  Select text codec based on the dictionary encoding.
-        Hunspell_get_dic_encoding() should always return at least
-        "ISO8859-1", but you can never be too sure.
-     */
-    textDecoder = QStringDecoder(Hunspell_get_dic_encoding(hunspell));
-    textEncoder = QStringEncoder(Hunspell_get_dic_encoding(hunspell));
-    if (!textDecoder.isValid() || !textEncoder.isValid())
+    // The receiver already has the suggestions from the cache
+    if (!currentRequest->prefetchOnly) {
+        HunspellSuggestions *suggestions;
+        if (ready) {
+            suggestions = suggest(*currentRequest, *blacklist, *userDictionary);
+            if (prefetchEnabled)
+                cache.insert(*currentRequest, *suggestions, blacklist, userDictionary);
+        } else {
+            suggestions = new HunspellSuggestions();
+            suggestions->words.append(currentRequest->word);
+            suggestions->flags.append(currentRequest->wordFlags);
+            suggestions->index = 0;
+            suggestions->tag = currentRequest->tag;
+        }
+        delete publishedSuggestions.fetchAndStoreOrdered(suggestions);
+        emit suggestionsAvailable();
+    }
+
+    if (ready && prefetchEnabled)
+        prefetch(blacklist, userDictionary);
+
+    currentRequest.reset();
+}
+
+HunspellSuggestions *HunspellSuggestionsTask::suggest(const HunspellSuggestionRequest &request,
+                                                      const HunspellWordListSnapshot &blacklist,
+                                                      const HunspellWordListSnapshot &userDictionary)
+{
+    HunspellSuggestions *suggestions = new HunspellSuggestions();
+    suggestions->words.append(request.word);
+    suggestions->flags.append(request.wordFlags);
+    suggestions->index = 0;
+    suggestions->tag = request.tag;
+
+    // Short words get only completions, without running the suggestion
+    // engine, as long as the completion index can provide them
+    if (request.word.length() >= minSuggestionLength || !completionIndex || !completionIndex->isOpen())
+        buildSuggestions(*suggestions, request.autoCorrect, userDictionary);
+    insertCompletions(*suggestions, userDictionary);
+    spellCheckWords(*suggestions);
+
+    // Filter out blacklisted word (sometimes Hunspell suggests,
+    // e.g. with different text case)
+    if (!blacklist.isEmpty())
+        filterWords(*suggestions, blacklist);
+
+    // Boost words from user dictionary
+    if (!userDictionary.isEmpty())
+        boostWords(*suggestions, userDictionary);
+
+    return suggestions;
+}
+
+/*!
+    Computes the suggestions for the current word followed by each of
+    its most probable next characters into the cache. The next
+    characters come from the completion index. Stops as soon as a new
+    request arrives, so the latency of a real keystroke grows by one
+    suggestion run at most.
+*/
+void HunspellSuggestionsTask::prefetch(const QSharedPointer<const HunspellWordListSnapshot> &blacklist,
+                                       const QSharedPointer<const HunspellWordListSnapshot> &userDictionary)
+{
+    if (!completionIndex || !completionIndex->isOpen())
         return;
 
-    char **slst = nullptr;
-    int n = Hunspell_suggest(hunspell, &slst, QByteArray { textEncoder(word) }.constData());
+    const QString word(currentRequest->word);
+    const QString nextCharacters(completionIndex->nextCharacters(word, maxPrefetchCount));
+    const bool upperCase = word.size() > 1 && word == word.toUpper() && word != word.toLower();
+
+    // The input word is updated with empty flags on every keystroke
+    HunspellSuggestionRequest request(*currentRequest);
+    request.wordFlags = HunspellWordList::Flags();
+    for (const QChar c : nextCharacters) {
+        if (pendingRequest.loadAcquire())
+            break;
+        request.word = word + (upperCase ? c.toUpper() : c);
+        QScopedPointer<HunspellSuggestions> suggestions(cache.find(request, blacklist, userDictionary));
+        if (suggestions)
+            continue;
+        suggestions.reset(suggest(request, *blacklist, *userDictionary));
+        cache.insert(request, *suggestions, blacklist, userDictionary);
+    }
+}
+
+/*!
+    Returns the corrections of \a word found in the correction index,
+    or an empty list if the index is not available. The index knows
+    nothing about words removed from Hunspell or forbidden by the affix
+    rules, so the corrections are verified with Hunspell_spell().
+*/
+QStringList HunspellSuggestionsTask::lookupCorrections(const QString &word, const HunspellWordListSnapshot &userDictionary)
+{
+    QStringList corrections;
+    if (!correctionIndex || !correctionIndex->isOpen())
+        return corrections;
+
+    corrections = correctionIndex->lookup(word, maxCorrections, userDictionary.words());
+    for (int i = 0; i < corrections.size();) {
+        if (Hunspell_spell(hunspell, QByteArray { textEncoder(corrections.at(i)) }.constData()) == 0)
+            corrections.removeAt(i);
+        else
+            ++i;
+    }
+    return corrections;
+}
+
+/*!
+    Selects the text codecs based on the dictionary encoding.
+    Hunspell_get_dic_encoding() should always return at least
+    "ISO8859-1", but you can never be too sure. The codecs are
+    stateless, so they are kept until the encoding changes.
+*/
+bool HunspellSuggestionsTask::updateTextCodecs()
+{
+    const char *encoding = Hunspell_get_dic_encoding(hunspell);
+    if (dictionaryEncoding != encoding) {
+        dictionaryEncoding = encoding;
+        textDecoder = QStringDecoder(encoding, QStringConverter::Flag::Stateless);
+        textEncoder = QStringEncoder(encoding, QStringConverter::Flag::Stateless);
+    }
+    return textDecoder.isValid() && textEncoder.isValid();
+}
+
+void HunspellSuggestionsTask::buildSuggestions(HunspellSuggestions &suggestions, bool autoCorrect, const HunspellWordListSnapshot &userDictionary)
+{
+    QStringList &words = suggestions.words;
+    QList<HunspellWordList::Flags> &flags = suggestions.flags;
+    QString word = words.at(0);
+
+    /*  Use the correction index when it finds enough candidates and
+        fall back to the much slower Hunspell_suggest() otherwise.
+    */
+    QStringList wordCandidates(lookupCorrections(word, userDictionary));
+    if (wordCandidates.size() < minCorrections) {
+        wordCandidates.clear();
+        char **slst = nullptr;
+        int n = Hunspell_suggest(hunspell, &slst, QByteArray { textEncoder(word) }.constData());
+        for (int i = 0; i < n; i++)
+            wordCandidates.append(textDecoder(slst[i]));
+        Hunspell_free_list(hunspell, &slst, n);
+    }
+
+    const int n = wordCandidates.size();
     if (n > 0) {
         /*  Collect word candidates from the Hunspell suggestions.
             Insert word completions in the beginning of the list.
         */
-        const int firstWordCompletionIndex = wordList->size();
+        const int firstWordCompletionIndex = words.size();
         int lastWordCompletionIndex = firstWordCompletionIndex;
         bool suggestCapitalization = false;
+        words.reserve(words.size() + n);
+        flags.reserve(flags.size() + n);
         for (int i = 0; i < n; i++) {
-            QString wordCandidate(textDecoder(slst[i]));
+            QString wordCandidate(wordCandidates.at(i));
             wordCandidate.replace(QChar(0x2019), QLatin1Char('\''));
             QString normalizedWordCandidate = removeAccentsAndDiacritics(wordCandidate);
             /*  Prioritize word Capitalization */
@@ -442,7 +914,8 @@ void HunspellBuildSuggestionsTask::run()
                         else
                             wordCandidate[0] = wordCandidate.at(0).toUpper();
                     }
-                    wordList->insertWord(1, wordCandidate);
+                    words.insert(1, wordCandidate);
+                    flags.insert(1, HunspellWordList::Flags());
                     lastWordCompletionIndex++;
                     suggestCapitalization = true;
                 }
@@ -450,19 +923,21 @@ void HunspellBuildSuggestionsTask::run()
             } else if ((normalizedWordCandidate.length() > word.length() &&
                         normalizedWordCandidate.startsWith(word)) ||
                        wordCandidate.contains(QLatin1Char('\''))) {
-                wordList->insertWord(lastWordCompletionIndex++, wordCandidate);
+                words.insert(lastWordCompletionIndex, wordCandidate);
+                flags.insert(lastWordCompletionIndex++, HunspellWordList::Flags());
             } else {
-                wordList->appendWord(wordCandidate);
+                words.append(wordCandidate);
+                flags.append(HunspellWordList::Flags());
             }
         }
         /*  Prioritize words with missing spaces next to word completions.
         */
-        for (int i = lastWordCompletionIndex; i < wordList->size(); i++) {
-            QString wordCandidate(wordList->wordAt(i));
-            if (wordCandidate.contains(QLatin1String(" "))) {
-                wordList->updateWord(i, wordCandidate, wordList->wordFlagsAt(i) | HunspellWordList::CompoundWord);
+        for (int i = lastWordCompletionIndex; i < words.size(); i++) {
+            if (words.at(i).contains(QLatin1String(" "))) {
+                flags[i] |= HunspellWordList::CompoundWord;
                 if (i != lastWordCompletionIndex) {
-                    wordList->moveWord(i, lastWordCompletionIndex);
+                    words.move(i, lastWordCompletionIndex);
+                    flags.move(i, lastWordCompletionIndex);
                 }
                 lastWordCompletionIndex++;
             }
@@ -475,24 +950,95 @@ void HunspellBuildSuggestionsTask::run()
             which may be suboptimal for the purpose, but gives some clue
             how much the suggested word differs from the given word.
         */
-        if (autoCorrect && wordList->size() > 1 && (!spellCheck(word) || suggestCapitalization)) {
-            if (lastWordCompletionIndex > firstWordCompletionIndex || levenshteinDistance(word, wordList->wordAt(firstWordCompletionIndex)) < 3)
-                wordList->setIndex(firstWordCompletionIndex);
+        if (autoCorrect && words.size() > 1 && (!spellCheck(word) || suggestCapitalization)) {
+            if (lastWordCompletionIndex > firstWordCompletionIndex || levenshteinDistance(word, words.at(firstWordCompletionIndex)) < 3)
+                suggestions.index = firstWordCompletionIndex;
         }
     }
-    Hunspell_free_list(hunspell, &slst, n);
+}
 
-    for (int i = 0, count = wordList->size(); i < count; ++i) {
-        HunspellWordList::Flags flags;
-        wordList->wordAt(i, word, flags);
-        if (flags.testFlag(HunspellWordList::CompoundWord))
+/*!
+    Inserts the most frequent completions of the input word from the
+    completion index, preceded by the recently used completions from the
+    user dictionary, to the beginning of the candidates.
+*/
+void HunspellSuggestionsTask::insertCompletions(HunspellSuggestions &suggestions, const HunspellWordListSnapshot &userDictionary)
+{
+    if (!completionIndex || !completionIndex->isOpen())
+        return;
+
+    QStringList &words = suggestions.words;
+    QList<HunspellWordList::Flags> &flags = suggestions.flags;
+    const QStringList completions(completionIndex->complete(words.at(0), maxCompletions, userDictionary.words()));
+    int insertIndex = 1;
+    for (const QString &completion : completions) {
+        const int index = words.indexOf(completion, 1);
+        if (index == -1) {
+            words.insert(insertIndex, completion);
+            flags.insert(insertIndex, HunspellWordList::Flags());
+            if (suggestions.index >= insertIndex)
+                ++suggestions.index;
+        } else if (index >= insertIndex) {
+            words.move(index, insertIndex);
+            flags.move(index, insertIndex);
+            if (suggestions.index == index)
+                suggestions.index = insertIndex;
+            else if (suggestions.index >= insertIndex && suggestions.index < index)
+                ++suggestions.index;
+        } else {
             continue;
-        if (Hunspell_spell(hunspell, QByteArray { textEncoder(word) }.constData()) != 0)
-            wordList->updateWord(i, word, wordList->wordFlagsAt(i) | HunspellWordList::SpellCheckOk);
+        }
+        ++insertIndex;
     }
 }
 
-bool HunspellBuildSuggestionsTask::spellCheck(const QString &word)
+void HunspellSuggestionsTask::spellCheckWords(HunspellSuggestions &suggestions)
+{
+    for (int i = 0, count = suggestions.words.size(); i < count; ++i) {
+        if (suggestions.flags.at(i).testFlag(HunspellWordList::CompoundWord))
+            continue;
+        if (Hunspell_spell(hunspell, QByteArray { textEncoder(suggestions.words.at(i)) }.constData()) != 0)
+            suggestions.flags[i] |= HunspellWordList::SpellCheckOk;
+    }
+}
+
+void HunspellSuggestionsTask::filterWords(HunspellSuggestions &suggestions, const HunspellWordListSnapshot &filterList, int startIndex)
+{
+    for (int i = startIndex; i < suggestions.words.size();) {
+        if (filterList.contains(suggestions.words.at(i))) {
+            suggestions.words.removeAt(i);
+            suggestions.flags.removeAt(i);
+        } else {
+            ++i;
+        }
+    }
+}
+
+void HunspellSuggestionsTask::boostWords(HunspellSuggestions &suggestions, const HunspellWordListSnapshot &boostList)
+{
+    QStringList &words = suggestions.words;
+    const QString word(words.at(0));
+    const QString wordCompletion(boostList.findWordCompletion(word));
+    if (!wordCompletion.isEmpty()) {
+        int from = words.indexOf(wordCompletion);
+        if (from != 1) {
+            int to;
+            for (to = 1; to < words.size() && words.at(to).startsWith(word); ++to)
+                ;
+            if (from != -1) {
+                if (to < from) {
+                    words.move(from, to);
+                    suggestions.flags.move(from, to);
+                }
+            } else {
+                words.insert(to, wordCompletion);
+                suggestions.flags.insert(to, HunspellWordList::SpellCheckOk);
+            }
+        }
+    }
+}
+
+bool HunspellSuggestionsTask::spellCheck(const QString &word)
 {
     if (!hunspell)
         return false;
@@ -502,7 +1048,7 @@ bool HunspellBuildSuggestionsTask::spellCheck(const QString &word)
 }
 
 // source: http://en.wikipedia.org/wiki/Levenshtein_distance
-int HunspellBuildSuggestionsTask::levenshteinDistance(const QString &s, const QString &t)
+int HunspellSuggestionsTask::levenshteinDistance(const QString &s, const QString &t)
 {
     if (s == t)
         return 0;
@@ -526,7 +1072,7 @@ int HunspellBuildSuggestionsTask::levenshteinDistance(const QString &s, const QS
     return v1[t.length()];
 }
 
-QString HunspellBuildSuggestionsTask::removeAccentsAndDiacritics(const QString& s)
+QString HunspellSuggestionsTask::removeAccentsAndDiacritics(const QString& s)
 {
     QString normalized = s.normalized(QString::NormalizationForm_D);
     for (int i = 0; i < normalized.length();) {
@@ -540,16 +1086,6 @@ QString HunspellBuildSuggestionsTask::removeAccentsAndDiacritics(const QString&
     return normalized;
 }
 
-/*!
-    \class QtVirtualKeyboard::HunspellUpdateSuggestionsTask
-    \internal
-*/
-
-void HunspellUpdateSuggestionsTask::run()
-{
-    emit updateSuggestions(wordList, tag);
-}
-
 void HunspellAddWordTask::run()
 {
     auto fromUtf16 = QStringEncoder(Hunspell_get_dic_encoding(hunspell));
@@ -605,6 +1141,14 @@ void HunspellRemoveWordTask::run()
     }
 }
 
+/*!
+    \class QtVirtualKeyboard::HunspellLoadWordListTask
+    \internal
+
+    Loads a custom dictionary from the word list file and replays
+    the changes recorded in the change log after the last compaction.
+*/
+
 void HunspellLoadWordListTask::run()
 {
     wordList->clear();
@@ -620,62 +1164,97 @@ void HunspellLoadWordListTask::run()
         }
         inputFile.close();
     }
-}
 
-void HunspellSaveWordListTask::run()
-{
-    QFile outputFile(filePath);
-    if (!QFileInfo::exists(filePath))
-        QDir().mkpath(QFileInfo(filePath).absoluteDir().path());
-    if (outputFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QTextStream outStream(&outputFile);
-        for (int i = 0, count = wordList->size(); i < count; ++i) {
-            const QString word(wordList->wordAt(i));
-            outStream << word.toUtf8() << '\n';
+    if (logFilePath.isEmpty())
+        return;
+
+    /*  Replaying a change is idempotent, so the log may safely contain
+        changes which were already compacted into the word list file.
+    */
+    QFile logFile(logFilePath);
+    if (logFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        while (!logFile.atEnd()) {
+            QByteArray record = logFile.readLine();
+            // Ignore the incomplete record of an interrupted write
+            if (!record.endsWith('\n'))
+                break;
+            record.chop(1);
+            if (record.size() < 2)
+                continue;
+            const QString word(QString::fromUtf8(record.constData() + 1, record.size() - 1));
+            switch (record.at(0)) {
+            case HunspellSaveWordListTask::AddWord:
+                if (!wordList->contains(word))
+                    wordList->appendWord(word);
+                break;
+            case HunspellSaveWordListTask::RemoveWord:
+                wordList->removeWord(word);
+                break;
+            case HunspellSaveWordListTask::TouchWord:
+            {
+                const int index = wordList->indexOfWord(word);
+                if (index != -1)
+                    wordList->moveWord(index, wordList->size() - 1);
+                break;
+            }
+            default:
+                qCWarning(lcHunspell) << "Invalid record in" << logFilePath;
+                break;
+            }
         }
-        outputFile.close();
+        logFile.close();
     }
 }
 
-void HunspellFilterWordTask::run()
+/*!
+    \class QtVirtualKeyboard::HunspellSaveWordListTask
+    \internal
+
+    Appends the pending changes of a custom dictionary to its change log.
+    When the log grows beyond maxLogSize, the word list file is rewritten
+    atomically and the log is removed.
+*/
+
+void HunspellSaveWordListTask::appendChange(QByteArray &changes, Change change, const QString &word)
 {
-    if (filterList->isEmpty())
-        return;
+    changes.append(change);
+    changes.append(word.toUtf8());
+    changes.append('\n');
+}
 
-    filterList->rebuildSearchIndex();
+void HunspellSaveWordListTask::run()
+{
+    if (!QFileInfo::exists(filePath))
+        QDir().mkpath(QFileInfo(filePath).absoluteDir().path());
 
-    for (int i = startIndex, count = wordList->size(); i < count;) {
-        if (filterList->contains(wordList->wordAt(i))) {
-            wordList->removeWordAt(i);
-            --count;
-        } else {
-            ++i;
+    if (!changes.isEmpty()) {
+        QFile logFile(logFilePath);
+        if (logFile.open(QIODevice::WriteOnly | QIODevice::Append)) {
+            const bool success = logFile.write(changes) == changes.size();
+            const qint64 logSize = logFile.size();
+            logFile.close();
+            if (success && logSize <= maxLogSize)
+                return;
         }
     }
+
+    compact();
 }
 
-void HunspellBoostWordTask::run()
+void HunspellSaveWordListTask::compact()
 {
-    if (boostList->isEmpty())
-        return;
-
-    boostList->rebuildSearchIndex();
+    QByteArray data;
+    data.reserve(wordList->size() * 16);
+    for (int i = 0, count = wordList->size(); i < count; ++i) {
+        data.append(wordList->wordAt(i).toUtf8());
+        data.append('\n');
+    }
 
-    const QString word(wordList->wordAt(0));
-    const QString wordCompletion(boostList->findWordCompletion(word));
-    if (!wordCompletion.isEmpty()) {
-        int from = wordList->indexOfWord(wordCompletion);
-        if (from != 1) {
-            int to;
-            for (to = 1; to < wordList->size() && wordList->wordAt(to).startsWith(word); ++to)
-                ;
-            if (from != -1) {
-                if (to < from)
-                    wordList->moveWord(from, to);
-            } else {
-                wordList->insertWord(to, wordCompletion, HunspellWordList::SpellCheckOk);
-            }
-        }
+    QSaveFile outputFile(filePath);
+    if (outputFile.open(QIODevice::WriteOnly)) {
+        outputFile.write(data);
+        if (outputFile.commit())
+            QFile::remove(logFilePath);
     }
 }
 
@@ -692,7 +1271,6 @@ HunspellWorker::HunspellWorker(QObject *parent) :
     hunspell(nullptr)
 {
     abort = false;
-    qRegisterMetaType<QSharedPointer<HunspellWordList>>("QSharedPointer<HunspellWordList>");
 }
 
 HunspellWorker::~HunspellWorker()
@@ -757,8 +1335,14 @@ void HunspellWorker::run()
                 currentTask->hunspell = hunspell;
             else
                 continue;
+            currentTask->correctionIndex = &correctionIndex;
+            currentTask->completionIndex = &completionIndex;
+            if (!currentTask->prepare())
+                continue;
             perf.start();
+            LatencyTracer::mark(LatencyTracer::WorkerTaskStarted, currentTask->traceSpan);
             currentTask->run();
+            LatencyTracer::mark(LatencyTracer::WorkerTaskFinished, currentTask->traceSpan);
             qCDebug(lcHunspell) << QString(QLatin1String(currentTask->metaObject()->className()) + QLatin1String("::run(): time:")).toLatin1().constData() << perf.elapsed() << "ms";
         }
     }
@@ -44,6 +44,8 @@
 #include <QThread>
 #include <QSemaphore>
 #include <QMutex>
+#include <QAtomicPointer>
+#include <QScopedPointer>
 #include <QStringList>
 #include <QSharedPointer>
 #include <QList>
@@ -52,6 +54,9 @@
 #include <QStringEncoder>
 #include <hunspell/hunspell.h>
 #include <QtHunspellInputMethod/qhunspellinputmethod_global.h>
+#include <QtHunspellInputMethod/private/hunspellcorrectionindex_p.h>
+#include <QtHunspellInputMethod/private/hunspellcompletionindex_p.h>
+#include <QtVirtualKeyboard/private/latencytracer_p.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -59,6 +64,23 @@ namespace QtVirtualKeyboard {
 
 Q_DECLARE_LOGGING_CATEGORY(lcHunspell)
 
+class HunspellSuggestions;
+
+class QHUNSPELLINPUTMETHOD_EXPORT HunspellWordListSnapshot
+{
+public:
+    explicit HunspellWordListSnapshot(const QStringList &list);
+
+    bool isEmpty() const;
+    const QStringList &words() const;
+    bool contains(const QString &word) const;
+    QString findWordCompletion(const QString &word) const;
+
+private:
+    const QStringList _list;
+    const QList<int> _searchIndex;
+};
+
 class QHUNSPELLINPUTMETHOD_EXPORT HunspellWordList
 {
 public:
@@ -94,40 +116,91 @@ public:
     int removeWord(const QString &word);
     void removeWordAt(int index);
     void rebuildSearchIndex();
-
-private:
-    class SearchContext {
-    public:
-        SearchContext(const QString &word,
-                      const QStringList &list) :
-            word(word),
-            list(list)
-        {}
-        const QString &word;
-        const QStringList &list;
-    };
+    void assign(const HunspellSuggestions &suggestions);
+    QSharedPointer<const HunspellWordListSnapshot> snapshot();
 
 private:
     QMutex _lock;
     QStringList _list;
     QList<Flags> _flags;
     QList<int> _searchIndex;
+    QSharedPointer<const HunspellWordListSnapshot> _snapshot;
     int _index;
     int _limit;
 };
 
+class HunspellSuggestionRequest
+{
+public:
+    QString word;
+    HunspellWordList::Flags wordFlags;
+    int tag;
+    bool autoCorrect;
+    bool prefetchOnly;
+    quint64 traceSpan;
+};
+
+class HunspellSuggestions
+{
+public:
+    QStringList words;
+    QList<HunspellWordList::Flags> flags;
+    int index;
+    int tag;
+};
+
+class HunspellSuggestionCache
+{
+public:
+    explicit HunspellSuggestionCache(int maxSize);
+
+    HunspellSuggestions *find(const HunspellSuggestionRequest &request,
+                              const QSharedPointer<const HunspellWordListSnapshot> &blacklist,
+                              const QSharedPointer<const HunspellWordListSnapshot> &userDictionary);
+    void insert(const HunspellSuggestionRequest &request, const HunspellSuggestions &suggestions,
+                const QSharedPointer<const HunspellWordListSnapshot> &blacklist,
+                const QSharedPointer<const HunspellWordListSnapshot> &userDictionary);
+    void clear();
+
+private:
+    struct Entry
+    {
+        QString word;
+        HunspellWordList::Flags wordFlags;
+        bool autoCorrect;
+        QSharedPointer<const HunspellWordListSnapshot> blacklist;
+        QSharedPointer<const HunspellWordListSnapshot> userDictionary;
+        HunspellSuggestions suggestions;
+    };
+
+    int indexOf(const HunspellSuggestionRequest &request,
+                const QSharedPointer<const HunspellWordListSnapshot> &blacklist,
+                const QSharedPointer<const HunspellWordListSnapshot> &userDictionary) const;
+
+    QMutex _lock;
+    QList<Entry> _entries;
+    const int _maxSize;
+};
+
 class HunspellTask : public QObject
 {
     Q_OBJECT
 public:
     explicit HunspellTask(QObject *parent = nullptr) :
         QObject(parent),
-        hunspell(nullptr)
+        hunspell(nullptr),
+        correctionIndex(nullptr),
+        completionIndex(nullptr),
+        traceSpan(LatencyTracer::currentSpan())
     {}
 
+    virtual bool prepare() { return true; }
     virtual void run() = 0;
 
     Hunhandle *hunspell;
+    HunspellCorrectionIndex *correctionIndex;
+    HunspellCompletionIndex *completionIndex;
+    quint64 traceSpan;
 };
 
 class HunspellLoadDictionaryTask : public HunspellTask
@@ -140,6 +213,10 @@ public:
 
 signals:
     void completed(bool success);
+    void indexesLoaded(bool completionIndexOpen);
+
+private:
+    void loadIndexes(const QString &dicPath);
 
 public:
     Hunhandle **hunspellPtr;
@@ -147,36 +224,61 @@ public:
     const QStringList searchPaths;
 };
 
-class HunspellBuildSuggestionsTask : public HunspellTask
+class HunspellSuggestionsTask : public HunspellTask
 {
     Q_OBJECT
 public:
-    QSharedPointer<HunspellWordList> wordList;
-    bool autoCorrect;
+    HunspellSuggestionsTask(const QSharedPointer<HunspellWordList> &blacklistedWords,
+                            const QSharedPointer<HunspellWordList> &userDictionaryWords);
+    ~HunspellSuggestionsTask();
 
+    void request(HunspellSuggestionRequest *request);
+    void cancel();
+    HunspellSuggestions *takeSuggestions();
+    HunspellSuggestions *cachedSuggestions(const HunspellSuggestionRequest &request);
+    void clearCache();
+
+    bool prepare() override;
     void run() override;
     bool spellCheck(const QString &word);
     int levenshteinDistance(const QString &s, const QString &t);
     QString removeAccentsAndDiacritics(const QString& s);
 
-private:
-    QStringDecoder textDecoder;
-    QStringEncoder textEncoder;
-};
-
-class HunspellUpdateSuggestionsTask : public HunspellTask
-{
-    Q_OBJECT
-public:
-    QSharedPointer<HunspellWordList> wordList;
-
-    void run() override;
+    static const int maxCorrections;
+    static const int minCorrections;
+    static const int maxCompletions;
+    static const int minSuggestionLength;
+    static const int maxPrefetchCount;
+    static const int cacheSize;
 
 signals:
-    void updateSuggestions(const QSharedPointer<HunspellWordList> &wordList, int tag);
+    void suggestionsAvailable();
 
-public:
-    int tag;
+private:
+    QStringList lookupCorrections(const QString &word, const HunspellWordListSnapshot &userDictionary);
+    bool updateTextCodecs();
+    HunspellSuggestions *suggest(const HunspellSuggestionRequest &request,
+                                 const HunspellWordListSnapshot &blacklist,
+                                 const HunspellWordListSnapshot &userDictionary);
+    void prefetch(const QSharedPointer<const HunspellWordListSnapshot> &blacklist,
+                  const QSharedPointer<const HunspellWordListSnapshot> &userDictionary);
+    void buildSuggestions(HunspellSuggestions &suggestions, bool autoCorrect, const HunspellWordListSnapshot &userDictionary);
+    void insertCompletions(HunspellSuggestions &suggestions, const HunspellWordListSnapshot &userDictionary);
+    void spellCheckWords(HunspellSuggestions &suggestions);
+    void filterWords(HunspellSuggestions &suggestions, const HunspellWordListSnapshot &filterList, int startIndex = 1);
+    void boostWords(HunspellSuggestions &suggestions, const HunspellWordListSnapshot &boostList);
+
+private:
+    const QSharedPointer<HunspellWordList> blacklistedWords;
+    const QSharedPointer<HunspellWordList> userDictionaryWords;
+    QAtomicPointer<HunspellSuggestionRequest> pendingRequest;
+    QAtomicPointer<HunspellSuggestions> publishedSuggestions;
+    QScopedPointer<HunspellSuggestionRequest> currentRequest;
+    HunspellSuggestionCache cache;
+    const bool prefetchEnabled;
+    QByteArray dictionaryEncoding;
+    QStringDecoder textDecoder;
+    QStringEncoder textEncoder;
 };
 
 class HunspellAddWordTask : public HunspellTask
@@ -205,6 +307,7 @@ class HunspellLoadWordListTask : public HunspellTask
 public:
     QSharedPointer<HunspellWordList> wordList;
     QString filePath;
+    QString logFilePath;
 
     void run() override;
 };
@@ -213,40 +316,30 @@ class HunspellSaveWordListTask : public HunspellTask
 {
     Q_OBJECT
 public:
-    QSharedPointer<HunspellWordList> wordList;
-    QString filePath;
-
-    void run() override;
-};
+    enum Change : char
+    {
+        AddWord = '+',
+        RemoveWord = '-',
+        TouchWord = '^'
+    };
 
-class HunspellFilterWordTask : public HunspellTask
-{
-    Q_OBJECT
-public:
-    HunspellFilterWordTask() :
+    HunspellSaveWordListTask() :
         HunspellTask(),
-        startIndex(1)
+        maxLogSize(0)
     {}
 
-    QSharedPointer<HunspellWordList> wordList;
-    QSharedPointer<HunspellWordList> filterList;
-    int startIndex;
-
-    void run() override;
-};
-
-class HunspellBoostWordTask : public HunspellTask
-{
-    Q_OBJECT
-public:
-    HunspellBoostWordTask() :
-        HunspellTask()
-    {}
+    static void appendChange(QByteArray &changes, Change change, const QString &word);
 
     QSharedPointer<HunspellWordList> wordList;
-    QSharedPointer<HunspellWordList> boostList;
+    QString filePath;
+    QString logFilePath;
+    QByteArray changes;
+    qint64 maxLogSize;
 
     void run() override;
+
+private:
+    void compact();
 };
 
 class HunspellWorker : public QThread
@@ -287,12 +380,12 @@ private:
     QSemaphore taskSema;
     QMutex taskLock;
     Hunhandle *hunspell;
+    HunspellCorrectionIndex correctionIndex;
+    HunspellCompletionIndex completionIndex;
     QBasicAtomicInt abort;
 };
 
 } // namespace QtVirtualKeyboard
 QT_END_NAMESPACE
 
-Q_DECLARE_METATYPE(QSharedPointer<QT_PREPEND_NAMESPACE(QtVirtualKeyboard)::HunspellWordList>);
-
 #endif // HUNSPELLWORKER_P_H
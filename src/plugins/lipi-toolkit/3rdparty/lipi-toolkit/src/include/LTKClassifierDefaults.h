@@ -70,4 +70,6 @@
 #define NEURALNET_DEF_HIDDEN_LAYERS_SIZE	1
 #define	NEURALNET_DEF_HIDDEN_LAYERS_UNITS	25
 #define NEURALNET_DEF_MAX_ITR	100
+#define NEURALNET_DEF_FLOAT_INFERENCE	false
+#define NEURALNET_DEF_FLOAT_INFERENCE_TOLERANCE	0.0
 #endif //#ifdef __CLASSIFIERDEFAULTS_H__
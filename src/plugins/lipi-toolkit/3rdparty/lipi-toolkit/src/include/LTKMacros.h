@@ -164,6 +164,8 @@
 #define NEURALNET_WEIGHT_REESTIMATION		"ReestimateNeuralnetConnectionWeights"
 #define	NEURALNET_TRAINING_ITERATION		"NeuralnetTrainingIteration"
 #define	NEURALNET_TRAINING_SEQUENCE		"PrepareTrainingSequence"
+#define NEURALNET_FLOAT_INFERENCE	"NeuralNetFloatInference"
+#define NEURALNET_FLOAT_INFERENCE_TOLERANCE	"NeuralNetFloatInferenceTolerance"
 
 //holistic config values
 #define NUMNNS "numnns"
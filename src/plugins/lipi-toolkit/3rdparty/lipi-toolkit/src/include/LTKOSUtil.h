@@ -103,6 +103,13 @@ public:
     
     virtual string getEnvVariable(const string& envVariableName) =0;
 
+    /** @brief  Returns a string identifying the current state of a file on disk.
+        * The string changes whenever the file is replaced or modified.
+        * @param filePath : path of the file
+        * @param outStr : identity string (device, inode, size and modification time)
+        */
+    virtual int getFileIdentity(const string& filePath, string& outStr)=0;
+
 
 	
 };
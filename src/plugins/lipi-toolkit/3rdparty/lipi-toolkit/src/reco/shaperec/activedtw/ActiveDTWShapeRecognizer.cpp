@@ -1656,7 +1656,11 @@ int ActiveDTWShapeRecognizer::computeDTWDistance(
     const vector<LTKShapeFeaturePtr>& firstFeatureVec = inFirstShapeSampleFeatures.getFeatureVector();
     const vector<LTKShapeFeaturePtr>& secondFeatureVec = inSecondShapeSampleFeatures.getFeatureVector();
 	
-    int errorCode = m_dtwObj.computeDTW(firstFeatureVec, secondFeatureVec, getDistance,outDTWDistance,
+    // The proximity matrix is computed on several threads, each thread
+    // needs its own DTW work matrices
+    static thread_local DynamicTimeWarping<LTKShapeFeaturePtr, float> dtwObj;
+
+    int errorCode = dtwObj.computeDTW(firstFeatureVec, secondFeatureVec, getDistance,outDTWDistance,
 		m_dtwBanding, FLT_MAX, FLT_MAX);
 	
     
@@ -1796,8 +1800,9 @@ int ActiveDTWShapeRecognizer::loadModelData()
 	
     stringStringMap headerSequence;
     LTKCheckSumGenerate cheSumGen;
+    LTKMDTBuffer mdtBuffer;
 	
-    if(errorCode = cheSumGen.readMDTHeader(m_activedtwMDTFilePath,headerSequence))
+    if(errorCode = cheSumGen.readMDTHeader(m_activedtwMDTFilePath,headerSequence,mdtBuffer))
     {
         LOG(LTKLogger::LTK_LOGLEVEL_ERR)<<"Error: "<< errorCode << " " <<
             " ActiveDTWShapeRecognizer::loadModelData()" << endl;
@@ -1874,26 +1879,9 @@ int ActiveDTWShapeRecognizer::loadModelData()
 	
     // Version comparison END
 	
-    //Input Stream for Model Data file
-    ifstream mdtFileHandle;
-	
-    if (m_MDTFileOpenMode == NN_MDT_OPEN_MODE_ASCII )
-    {
-        mdtFileHandle.open(m_activedtwMDTFilePath.c_str(), ios::in);
-    }
-    else
-    {
-        mdtFileHandle.open(m_activedtwMDTFilePath.c_str(), ios::in | ios::binary);
-    }
-	
-    //If error while opening, return an error
-    if(!mdtFileHandle)
-    {
-        LOG(LTKLogger::LTK_LOGLEVEL_ERR)<<"Error: "<< EMODEL_DATA_FILE_OPEN << " " <<
-            " Unable to open model data file : " <<m_activedtwMDTFilePath<<
-            " ActiveDTWShapeRecognizer::loadModelData()" << endl;
-        LTKReturnError(EMODEL_DATA_FILE_OPEN);
-    }
+    //Input Stream for Model Data file, reading the content loaded
+    //by readMDTHeader() instead of opening the file again
+    istream mdtFileHandle(&mdtBuffer);
 	
     mdtFileHandle.seekg(atoi(headerSequence[HEADERLEN].c_str()),ios::beg);
 	
@@ -2311,8 +2299,6 @@ int ActiveDTWShapeRecognizer::loadModelData()
 	
 	
     
-    mdtFileHandle.close();
-	
     LOG(LTKLogger::LTK_LOGLEVEL_DEBUG) << "Exiting " <<
         "ActiveDTWShapeRecognizer::loadModelData()" << endl;
 	
@@ -3611,9 +3597,9 @@ int ActiveDTWShapeRecognizer::performClustering(const vector<LTKShapeSample>& sh
 	
     intVector tempVec;
     
-    float2DVector distanceMatrix;
     int sampleCount=shapeSamplesVec.size();
     int returnStatus = SUCCESS;
+    int progressPercent = -1;
 	
     
 	
@@ -3623,6 +3609,8 @@ int ActiveDTWShapeRecognizer::performClustering(const vector<LTKShapeSample>& sh
         //this is done when either of NumClusters or PrototypeReducrion factor is set
         //to automatic
         LTKHierarchicalClustering<LTKShapeSample,ActiveDTWShapeRecognizer> hc(shapeSamplesVec,AVERAGE_LINKAGE,AVG_SIL);
+        hc.setNumOfThreads(0);
+        hc.setProgressCallback(printProximityProgress, &progressPercent);
         
         returnStatus = hc.cluster(this,&ActiveDTWShapeRecognizer::computeDTWDistance);
         if(returnStatus != SUCCESS)
@@ -3671,6 +3659,8 @@ int ActiveDTWShapeRecognizer::performClustering(const vector<LTKShapeSample>& sh
 			
 			LTKHierarchicalClustering<LTKShapeSample,ActiveDTWShapeRecognizer>
 				hc(shapeSamplesVec,numClusters, AVERAGE_LINKAGE);
+			hc.setNumOfThreads(0);
+			hc.setProgressCallback(printProximityProgress, &progressPercent);
 			
 			if(numClusters == 1)
 			{
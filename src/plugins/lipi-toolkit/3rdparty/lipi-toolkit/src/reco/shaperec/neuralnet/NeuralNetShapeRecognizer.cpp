@@ -69,6 +69,8 @@ void NeuralNetShapeRecognizer::assignDefaultValues()
     m_rejectThreshold=NN_DEF_REJECT_THRESHOLD;
     m_deleteLTKLipiPreProcessor=NULL;
     m_MDTFileOpenMode = NN_MDT_OPEN_MODE_ASCII;
+	m_isFloatInferenceEnabled = NEURALNET_DEF_FLOAT_INFERENCE;
+	m_floatInferenceTolerance = NEURALNET_DEF_FLOAT_INFERENCE_TOLERANCE;
 
     LOG(LTKLogger::LTK_LOGLEVEL_DEBUG) << "Exiting " <<
         "NeuralNetShapeRecognizer::assignDefaultValues()" << endl;
@@ -938,6 +940,72 @@ int NeuralNetShapeRecognizer::readClassifierConfig()
             m_isCreateTrainingSequence << endl;
     }
 
+	//float32 inference
+	tempStringVar = "";
+    shapeRecognizerProperties->getConfigValue(NEURALNET_FLOAT_INFERENCE, tempStringVar);
+
+    if(LTKSTRCMP(tempStringVar.c_str(), "true") ==0)
+    {
+        m_isFloatInferenceEnabled = true;
+
+        LOG(LTKLogger::LTK_LOGLEVEL_DEBUG)
+            <<NEURALNET_FLOAT_INFERENCE << " = " << tempStringVar << endl;
+    }
+    else
+    {
+        LOG(LTKLogger::LTK_LOGLEVEL_DEBUG)<<
+            "Using default value for " << NEURALNET_FLOAT_INFERENCE << " : " <<
+            m_isFloatInferenceEnabled << endl;
+    }
+
+	//float32 inference tolerance
+	tempStringVar = "";
+    errorCode = shapeRecognizerProperties->getConfigValue(NEURALNET_FLOAT_INFERENCE_TOLERANCE,
+                                                          tempStringVar);
+    if(errorCode == SUCCESS)
+    {
+        if ( LTKStringUtil::isFloat(tempStringVar) )
+        {
+            tempFloatVar = LTKStringUtil::convertStringToFloat(tempStringVar);
+
+            if(tempFloatVar >= 0 && tempFloatVar < 1)
+            {
+                m_floatInferenceTolerance = tempFloatVar;
+
+                LOG(LTKLogger::LTK_LOGLEVEL_DEBUG)<<
+                    NEURALNET_FLOAT_INFERENCE_TOLERANCE << " = " <<tempStringVar <<endl;
+            }
+            else
+            {
+                LOG(LTKLogger::LTK_LOGLEVEL_ERR)<<
+                    "Error: " << ECONFIG_FILE_RANGE << NEURALNET_FLOAT_INFERENCE_TOLERANCE <<
+                    " should be in the range [0-1)" <<
+                    " NeuralNetShapeRecognizer::readClassifierConfig()"<<endl;
+
+                delete shapeRecognizerProperties;
+
+                LTKReturnError(ECONFIG_FILE_RANGE);
+            }
+        }
+        else
+        {
+            LOG(LTKLogger::LTK_LOGLEVEL_ERR)<<
+                "Error: " << ECONFIG_FILE_RANGE << NEURALNET_FLOAT_INFERENCE_TOLERANCE <<
+                " should be in the range [0-1)" <<
+                " NeuralNetShapeRecognizer::readClassifierConfig()"<<endl;
+
+            delete shapeRecognizerProperties;
+
+            LTKReturnError(ECONFIG_FILE_RANGE);
+        }
+    }
+    else
+    {
+        LOG(LTKLogger::LTK_LOGLEVEL_DEBUG)<<
+            "Using default value for " << NEURALNET_FLOAT_INFERENCE_TOLERANCE <<
+            " : " << m_floatInferenceTolerance << endl;
+    }
+
 
 	tempStringVar = "";
     errorCode = shapeRecognizerProperties->getConfigValue(SIZETHRESHOLD,
@@ -1655,8 +1723,9 @@ int NeuralNetShapeRecognizer::loadModelData()
     stringStringMap headerSequence;
 
     LTKCheckSumGenerate cheSumGen;
+    LTKMDTBuffer mdtBuffer;
 
-	if(errorCode = cheSumGen.readMDTHeader(m_neuralnetMDTFilePath,headerSequence))
+	if(errorCode = cheSumGen.readMDTHeader(m_neuralnetMDTFilePath,headerSequence,mdtBuffer))
     {
         LOG(LTKLogger::LTK_LOGLEVEL_ERR)<<"Error: "<< errorCode << " " <<
             " NeuralNetShapeRecognizer::loadModelData()" << endl;
@@ -1744,26 +1813,9 @@ int NeuralNetShapeRecognizer::loadModelData()
     }
     // Version comparison END
 
-	//Input Stream for Model Data file
-    ifstream mdtFileHandle;
-
-    if (m_MDTFileOpenMode == NN_MDT_OPEN_MODE_ASCII )
-    {
-        mdtFileHandle.open(m_neuralnetMDTFilePath.c_str(), ios::in);
-    }
-    else
-    {
-        mdtFileHandle.open(m_neuralnetMDTFilePath.c_str(), ios::in | ios::binary);
-    }
-
-    //If error while opening, return an error
-    if(!mdtFileHandle)
-    {
-        LOG(LTKLogger::LTK_LOGLEVEL_ERR)<<"Error: "<< EMODEL_DATA_FILE_OPEN << " " <<
-            " Unable to open model data file : " <<m_neuralnetMDTFilePath<<
-            " NNShapeRecognizer::loadModelData()" << endl;
-        LTKReturnError(EMODEL_DATA_FILE_OPEN);
-    }
+	//Input Stream for Model Data file, reading the content loaded
+	//by readMDTHeader() instead of opening the file again
+    istream mdtFileHandle(&mdtBuffer);
 
     mdtFileHandle.seekg(atoi(headerSequence[HEADERLEN].c_str()),ios::beg);
 
@@ -1828,6 +1880,11 @@ int NeuralNetShapeRecognizer::loadModelData()
 	{
 		while(getline(mdtFileHandle, strValue, NEW_LINE_DELIMITER ))
 		{
+			// The file is read in binary, drop carriage returns of
+			// files written in text mode on Windows
+			if(!strValue.empty() && strValue[strValue.size() - 1] == '\r')
+				strValue.erase(strValue.size() - 1);
+
 			if(LTKSTRCMP(strValue.c_str(),"<Weight>") == 0)
 			{
 				for (layerIndex = 0; layerIndex < m_neuralnetNumHiddenLayers + 1; layerIndex++)
@@ -1975,8 +2032,18 @@ int NeuralNetShapeRecognizer::loadModelData()
 		}
 	}
 
-	mdtFileHandle.close();
+	if(m_isFloatInferenceEnabled)
+	{
+		int errorCode = packConnectionWeights();
 
+		if(errorCode != SUCCESS)
+		{
+			LOG(LTKLogger::LTK_LOGLEVEL_ERR)<<"Error: "<< errorCode << " " <<
+				" NeuralNetShapeRecognizer::loadModelData()" << endl;
+
+			LTKReturnError(errorCode);
+		}
+	}
 
 	LOG(LTKLogger::LTK_LOGLEVEL_DEBUG) << "Exiting " <<
         "NeuralNetShapeRecognizer::loadModelData()" << endl;
@@ -2358,6 +2425,12 @@ int NeuralNetShapeRecognizer::unloadModelData()
 
 	m_previousDelW.clear();
 
+	m_packedWeightVec.clear();
+
+	m_packedLayerOffsetVec.clear();
+
+	m_packedLayerStrideVec.clear();
+
     LOG(LTKLogger::LTK_LOGLEVEL_DEBUG) << "Exiting " <<
         "NeuralNetShapeRecognizer::unloadModelData()" << endl;
 
@@ -3753,15 +3826,97 @@ int NeuralNetShapeRecognizer::recognize(const vector<LTKShapeFeaturePtr>& shapeF
 		outptr[index][m_layerOutputUnitVec[index]] = 1.0;
 	}
 
-	//compute the forward algo for recognition performance
-	int errorCode = feedForward(shapeFeatureVector,outptr,0);
+	int errorCode = SUCCESS;
 
-	if(errorCode != SUCCESS)
+	if(m_isFloatInferenceEnabled)
 	{
-		LOG(LTKLogger::LTK_LOGLEVEL_ERR)<<"Error: "<< errorCode << " " <<
-            " NeuralNetShapeRecognizer::recognize()" << endl;
+		if(m_packedWeightVec.empty())
+		{
+			errorCode = packConnectionWeights();
 
-		LTKReturnError(errorCode);
+			if(errorCode != SUCCESS)
+			{
+				LOG(LTKLogger::LTK_LOGLEVEL_ERR)<<"Error: "<< errorCode << " " <<
+					" NeuralNetShapeRecognizer::recognize()" << endl;
+
+				LTKReturnError(errorCode);
+			}
+		}
+
+		vector< vector<LTKShapeFeaturePtr> > shapeFeatureBatch(1, shapeFeatureVector);
+
+		float2DVector floatOutputLayerVec;
+
+		errorCode = feedForwardFloat(shapeFeatureBatch, floatOutputLayerVec);
+
+		if(errorCode != SUCCESS)
+		{
+			LOG(LTKLogger::LTK_LOGLEVEL_ERR)<<"Error: "<< errorCode << " " <<
+				" NeuralNetShapeRecognizer::recognize()" << endl;
+
+			LTKReturnError(errorCode);
+		}
+
+		bool isFloatOutputValid = true;
+
+		if(m_floatInferenceTolerance > 0.0)
+		{
+			//compute the double path as the reference
+			errorCode = feedForward(shapeFeatureVector,outptr,0);
+
+			if(errorCode != SUCCESS)
+			{
+				LOG(LTKLogger::LTK_LOGLEVEL_ERR)<<"Error: "<< errorCode << " " <<
+					" NeuralNetShapeRecognizer::recognize()" << endl;
+
+				LTKReturnError(errorCode);
+			}
+
+			double maxDifference = 0.0;
+
+			for(index = 0; index < m_numShapes; ++index)
+			{
+				double difference = fabs(m_outputLayerContentVec[0][index] -
+											(double)floatOutputLayerVec[0][index]);
+
+				if(difference > maxDifference)
+				{
+					maxDifference = difference;
+				}
+			}
+
+			if(maxDifference > m_floatInferenceTolerance)
+			{
+				LOG(LTKLogger::LTK_LOGLEVEL_ERR)<<
+					"Float32 output differs from double output by " << maxDifference <<
+					" (" << NEURALNET_FLOAT_INFERENCE_TOLERANCE << " = " <<
+					m_floatInferenceTolerance << "), using double output" <<
+					" NeuralNetShapeRecognizer::recognize()" << endl;
+
+				isFloatOutputValid = false;
+			}
+		}
+
+		if(isFloatOutputValid)
+		{
+			for(index = 0; index < m_numShapes; ++index)
+			{
+				m_outputLayerContentVec[0][index] = floatOutputLayerVec[0][index];
+			}
+		}
+	}
+	else
+	{
+		//compute the forward algo for recognition performance
+		errorCode = feedForward(shapeFeatureVector,outptr,0);
+
+		if(errorCode != SUCCESS)
+		{
+			LOG(LTKLogger::LTK_LOGLEVEL_ERR)<<"Error: "<< errorCode << " " <<
+				" NeuralNetShapeRecognizer::recognize()" << endl;
+
+			LTKReturnError(errorCode);
+		}
 	}
 
 	errorCode = computeConfidence();
@@ -4255,6 +4410,340 @@ int NeuralNetShapeRecognizer::feedForward(const vector<LTKShapeFeaturePtr>& shap
 	return SUCCESS;
 }
 
+/******************************************************************************
+ * AUTHOR		: The Qt Company
+ * DATE			: 19-Oct-2026
+ * NAME			: packConnectionWeights
+ * DESCRIPTION	: Copies m_connectionWeightVec into m_packedWeightVec as float32
+ *				  row-major matrices with rows padded to NEURALNET_FLOAT_BLOCK_SIZE
+ * ARGUMENTS	:
+ * RETURNS		: int:
+ * NOTES		:
+ * CHANGE HISTROY
+ * Author			Date				Description
+ ******************************************************************************/
+int NeuralNetShapeRecognizer::packConnectionWeights()
+{
+	LOG(LTKLogger::LTK_LOGLEVEL_DEBUG) << "Entering " <<
+        "NeuralNetShapeRecognizer::packConnectionWeights()" << endl;
+
+	if(m_connectionWeightVec.size() < (size_t)(m_neuralnetNumHiddenLayers + 1) ||
+		m_layerOutputUnitVec.size() < (size_t)(m_neuralnetNumHiddenLayers + 2))
+	{
+		LOG(LTKLogger::LTK_LOGLEVEL_ERR) << "Error: "<< EEMPTY_VECTOR << "(Empty network weights) " <<
+            getErrorMessage(EEMPTY_VECTOR)<<
+            " NeuralNetShapeRecognizer::packConnectionWeights()" << endl;
+
+        LTKReturnError(EEMPTY_VECTOR);
+	}
+
+	m_packedWeightVec.clear();
+	m_packedLayerOffsetVec.clear();
+	m_packedLayerStrideVec.clear();
+
+	int totalSize = 0;
+
+	int layerIndex;
+
+	for(layerIndex = 0; layerIndex < m_neuralnetNumHiddenLayers + 1; ++layerIndex)
+	{
+		int numInputs = m_layerOutputUnitVec[layerIndex] + 1;
+
+		int stride = ((numInputs + NEURALNET_FLOAT_BLOCK_SIZE - 1) /
+						NEURALNET_FLOAT_BLOCK_SIZE) * NEURALNET_FLOAT_BLOCK_SIZE;
+
+		m_packedLayerOffsetVec.push_back(totalSize);
+		m_packedLayerStrideVec.push_back(stride);
+
+		totalSize += stride * m_layerOutputUnitVec[layerIndex + 1];
+	}
+
+	m_packedWeightVec.assign(totalSize, 0.0f);
+
+	for(layerIndex = 0; layerIndex < m_neuralnetNumHiddenLayers + 1; ++layerIndex)
+	{
+		int numInputs = m_layerOutputUnitVec[layerIndex] + 1;
+
+		int numNodes = m_layerOutputUnitVec[layerIndex + 1];
+
+		const doubleVector& layerWeights = m_connectionWeightVec[layerIndex];
+
+		if(layerWeights.size() < (size_t)(numInputs * numNodes))
+		{
+			LOG(LTKLogger::LTK_LOGLEVEL_ERR) << "Error: "<< EEMPTY_VECTOR << "(Incomplete network weights) " <<
+				getErrorMessage(EEMPTY_VECTOR)<<
+				" NeuralNetShapeRecognizer::packConnectionWeights()" << endl;
+
+			m_packedWeightVec.clear();
+			m_packedLayerOffsetVec.clear();
+			m_packedLayerStrideVec.clear();
+
+			LTKReturnError(EEMPTY_VECTOR);
+		}
+
+		float* packedRow = &m_packedWeightVec[m_packedLayerOffsetVec[layerIndex]];
+
+		for(int nodeIndex = 0; nodeIndex < numNodes; ++nodeIndex)
+		{
+			for(int index = 0; index < numInputs; ++index)
+			{
+				packedRow[index] = (float)layerWeights[numInputs * nodeIndex + index];
+			}
+
+			packedRow += m_packedLayerStrideVec[layerIndex];
+		}
+	}
+
+	LOG(LTKLogger::LTK_LOGLEVEL_DEBUG) << "Exiting " <<
+        "NeuralNetShapeRecognizer::packConnectionWeights()" << endl;
+
+	return SUCCESS;
+}
+
+/******************************************************************************
+ * AUTHOR		: The Qt Company
+ * DATE			: 19-Oct-2026
+ * NAME			: computeSigmoidLayerFloat
+ * DESCRIPTION	: outActivations[b][j] = sigmoid(sum_k weights[j][k] * inActivations[b][k])
+ *				  for numNodes rows j and batchSize samples b
+ * ARGUMENTS	:
+ * RETURNS		:
+ * NOTES		: Four weight rows are evaluated at a time against each sample so
+ *				  that every loaded activation is reused four times. The partial
+ *				  sums are kept in NEURALNET_FLOAT_BLOCK_SIZE independent lanes,
+ *				  which the compiler maps to SIMD registers without requiring
+ *				  floating point reassociation. stride is a multiple of
+ *				  NEURALNET_FLOAT_BLOCK_SIZE and the padding is zero.
+ * CHANGE HISTROY
+ * Author			Date				Description
+ ******************************************************************************/
+static void computeSigmoidLayerFloat(const float* weights, int numNodes, int stride,
+									 const float* inActivations, float* outActivations,
+									 int outStride, int batchSize)
+{
+	const int ROW_BLOCK = 4;
+
+	int nodeIndex = 0;
+
+	for(; nodeIndex + ROW_BLOCK <= numNodes; nodeIndex += ROW_BLOCK)
+	{
+		const float* w0 = weights + (nodeIndex + 0) * stride;
+		const float* w1 = weights + (nodeIndex + 1) * stride;
+		const float* w2 = weights + (nodeIndex + 2) * stride;
+		const float* w3 = weights + (nodeIndex + 3) * stride;
+
+		for(int sampleIndex = 0; sampleIndex < batchSize; ++sampleIndex)
+		{
+			const float* in = inActivations + sampleIndex * stride;
+
+			float acc0[NEURALNET_FLOAT_BLOCK_SIZE] = {0};
+			float acc1[NEURALNET_FLOAT_BLOCK_SIZE] = {0};
+			float acc2[NEURALNET_FLOAT_BLOCK_SIZE] = {0};
+			float acc3[NEURALNET_FLOAT_BLOCK_SIZE] = {0};
+
+			for(int index = 0; index < stride; index += NEURALNET_FLOAT_BLOCK_SIZE)
+			{
+				for(int lane = 0; lane < NEURALNET_FLOAT_BLOCK_SIZE; ++lane)
+				{
+					float x = in[index + lane];
+
+					acc0[lane] += w0[index + lane] * x;
+					acc1[lane] += w1[index + lane] * x;
+					acc2[lane] += w2[index + lane] * x;
+					acc3[lane] += w3[index + lane] * x;
+				}
+			}
+
+			float net0 = 0.0f, net1 = 0.0f, net2 = 0.0f, net3 = 0.0f;
+
+			for(int lane = 0; lane < NEURALNET_FLOAT_BLOCK_SIZE; ++lane)
+			{
+				net0 += acc0[lane];
+				net1 += acc1[lane];
+				net2 += acc2[lane];
+				net3 += acc3[lane];
+			}
+
+			float* out = outActivations + sampleIndex * outStride + nodeIndex;
+
+			out[0] = 1.0f / (1.0f + expf(-net0));
+			out[1] = 1.0f / (1.0f + expf(-net1));
+			out[2] = 1.0f / (1.0f + expf(-net2));
+			out[3] = 1.0f / (1.0f + expf(-net3));
+		}
+	}
+
+	// remaining rows
+	for(; nodeIndex < numNodes; ++nodeIndex)
+	{
+		const float* w = weights + nodeIndex * stride;
+
+		for(int sampleIndex = 0; sampleIndex < batchSize; ++sampleIndex)
+		{
+			const float* in = inActivations + sampleIndex * stride;
+
+			float acc[NEURALNET_FLOAT_BLOCK_SIZE] = {0};
+
+			for(int index = 0; index < stride; index += NEURALNET_FLOAT_BLOCK_SIZE)
+			{
+				for(int lane = 0; lane < NEURALNET_FLOAT_BLOCK_SIZE; ++lane)
+				{
+					acc[lane] += w[index + lane] * in[index + lane];
+				}
+			}
+
+			float net = 0.0f;
+
+			for(int lane = 0; lane < NEURALNET_FLOAT_BLOCK_SIZE; ++lane)
+			{
+				net += acc[lane];
+			}
+
+			outActivations[sampleIndex * outStride + nodeIndex] = 1.0f / (1.0f + expf(-net));
+		}
+	}
+}
+
+/******************************************************************************
+ * AUTHOR		: The Qt Company
+ * DATE			: 19-Oct-2026
+ * NAME			: feedForwardFloat
+ * DESCRIPTION	: float32 counterpart of feedForward() for a batch of samples
+ * ARGUMENTS	:
+ * RETURNS		: int:
+ * NOTES		:
+ * CHANGE HISTROY
+ * Author			Date				Description
+ ******************************************************************************/
+int NeuralNetShapeRecognizer::feedForwardFloat(const vector< vector<LTKShapeFeaturePtr> >& shapeFeatureBatch,
+											   float2DVector& outOutputLayerVec)
+{
+	LOG(LTKLogger::LTK_LOGLEVEL_DEBUG) << "Entering " <<
+        "NeuralNetShapeRecognizer::feedForwardFloat()" << endl;
+
+	if(shapeFeatureBatch.size() == 0)
+	{
+		LOG(LTKLogger::LTK_LOGLEVEL_ERR) << "Error: "<< EEMPTY_VECTOR << "(Empty sample set) " <<
+            getErrorMessage(EEMPTY_VECTOR)<<
+            " NeuralNetShapeRecognizer::feedForwardFloat()" << endl;
+
+        LTKReturnError(EEMPTY_VECTOR);
+	}
+
+	if(m_packedWeightVec.size() == 0 || m_packedLayerStrideVec.size() != (size_t)(m_neuralnetNumHiddenLayers + 1))
+	{
+		LOG(LTKLogger::LTK_LOGLEVEL_ERR) << "Error: "<< EEMPTY_VECTOR << "(Empty packed network weights) " <<
+            getErrorMessage(EEMPTY_VECTOR)<<
+            " NeuralNetShapeRecognizer::feedForwardFloat()" << endl;
+
+        LTKReturnError(EEMPTY_VECTOR);
+	}
+
+	float normalizationFactor = m_neuralnetNormalizationFactor;
+
+	if(normalizationFactor <= 0.0f)
+	{
+		LOG(LTKLogger::LTK_LOGLEVEL_ERR) << "Error: "<< ENON_POSITIVE_NUM <<"(Normalised factor should be posative)" <<
+			getErrorMessage(ENON_POSITIVE_NUM)<<
+			" NeuralNetShapeRecognizer::feedForwardFloat()" << endl;
+
+		LTKReturnError(ENON_POSITIVE_NUM);
+	}
+
+	int batchSize = shapeFeatureBatch.size();
+
+	int numInputNodes = m_layerOutputUnitVec[0];
+
+	int numOutputLayer = m_neuralnetNumHiddenLayers + 1;
+
+	// the activations of one layer for all samples, row-major by sample, padded
+	// to the stride of the weight matrix which consumes them
+	floatVector inActivations(batchSize * m_packedLayerStrideVec[0], 0.0f);
+
+	floatVector outActivations;
+
+	//	assign content to input layer
+	for(int sampleIndex = 0; sampleIndex < batchSize; ++sampleIndex)
+	{
+		float* in = &inActivations[sampleIndex * m_packedLayerStrideVec[0]];
+
+		int nodeIndex = 0;
+
+		vector<LTKShapeFeaturePtr>::const_iterator shapeFeatureIter = shapeFeatureBatch[sampleIndex].begin();
+		vector<LTKShapeFeaturePtr>::const_iterator shapeFeatureIterEnd = shapeFeatureBatch[sampleIndex].end();
+
+		floatVector floatFeatureVector;
+
+		for(; shapeFeatureIter != shapeFeatureIterEnd; ++shapeFeatureIter)
+		{
+			floatFeatureVector.clear();
+
+			(*shapeFeatureIter)->toFloatVector(floatFeatureVector);
+
+			int vectorSize = floatFeatureVector.size();
+
+			if(nodeIndex + vectorSize > numInputNodes)
+			{
+				LOG(LTKLogger::LTK_LOGLEVEL_ERR) << "Error: "<< EINVALID_NUM_OF_INPUT_NODE <<
+					getErrorMessage(EINVALID_NUM_OF_INPUT_NODE)<<
+					" NeuralNetShapeRecognizer::feedForwardFloat()" << endl;
+
+				LTKReturnError(EINVALID_NUM_OF_INPUT_NODE);
+			}
+
+			for (int i = 0; i < vectorSize; i++)
+			{
+				// Normalised the feature, so that the feature value lies between 0 to 1
+				in[nodeIndex++] = floatFeatureVector[i] / normalizationFactor;
+			}
+		}
+
+		// bias
+		in[numInputNodes] = 1.0f;
+	}
+
+	//hidden & output layer output calculation
+	for(int layerIndex = 0; layerIndex < numOutputLayer; ++layerIndex)
+	{
+		int numNodes = m_layerOutputUnitVec[layerIndex + 1];
+
+		// the output layer needs no padding, all other layers feed the next matrix
+		int outStride = (layerIndex + 1 < numOutputLayer) ? m_packedLayerStrideVec[layerIndex + 1] : numNodes;
+
+		outActivations.assign(batchSize * outStride, 0.0f);
+
+		computeSigmoidLayerFloat(&m_packedWeightVec[m_packedLayerOffsetVec[layerIndex]],
+								 numNodes, m_packedLayerStrideVec[layerIndex],
+								 &inActivations[0], &outActivations[0],
+								 outStride, batchSize);
+
+		if(layerIndex + 1 < numOutputLayer)
+		{
+			for(int sampleIndex = 0; sampleIndex < batchSize; ++sampleIndex)
+			{
+				outActivations[sampleIndex * outStride + numNodes] = 1.0f;
+			}
+		}
+
+		inActivations.swap(outActivations);
+	}
+
+	int numOutputNodes = m_layerOutputUnitVec[numOutputLayer];
+
+	outOutputLayerVec.resize(batchSize);
+
+	for(int sampleIndex = 0; sampleIndex < batchSize; ++sampleIndex)
+	{
+		outOutputLayerVec[sampleIndex].assign(inActivations.begin() + sampleIndex * numOutputNodes,
+											  inActivations.begin() + (sampleIndex + 1) * numOutputNodes);
+	}
+
+	LOG(LTKLogger::LTK_LOGLEVEL_DEBUG) << "Exiting " <<
+        "NeuralNetShapeRecognizer::feedForwardFloat()" << endl;
+
+	return SUCCESS;
+}
+
 /******************************************************************************
  * AUTHOR		: Tanmay Mondal
  * SUPERVISOR   : Ujjwal Bhattacharya
@@ -19,6 +19,9 @@ class LTKShapeFeature;
 
 #define SUPPORTED_MIN_VERSION "3.0.0"
 
+// Number of columns processed together by the float32 inference kernel
+#define NEURALNET_FLOAT_BLOCK_SIZE 4
+
 typedef int (*FN_PTR_CREATELTKLIPIPREPROCESSOR)(const LTKControlInfo& , LTKPreprocessorInterface** );
 typedef int (*FN_PTR_DELETELTKLIPIPREPROCESSOR)(LTKPreprocessorInterface* );
 
@@ -334,6 +337,50 @@ class NeuralNetShapeRecognizer: public LTKShapeRecognizer
 		 *
          *			DEFAULT : Ascii
          *     </p>
+         */
+
+		bool m_isFloatInferenceEnabled;
+		/**< @brief If true recognition uses the packed float32 weights
+         *     <p>
+         *			See feedForwardFloat()
+		 *
+         *			DEFAULT : false
+         *     </p>
+         */
+
+		double m_floatInferenceTolerance;
+		/**< @brief Maximum absolute difference allowed between the float32
+		 *		and the double output layer
+         *     <p>
+         *			If positive, every float32 recognition is also evaluated with
+		 *			feedForward() and the double result is used when the outputs
+		 *			differ by more than this value. Zero disables the check.
+		 *
+         *			DEFAULT : 0.0
+         *     </p>
+         */
+
+		floatVector m_packedWeightVec;
+		/**< @brief m_connectionWeightVec packed into one contiguous float32 buffer
+         *     <p>
+         *			Each layer is stored as a row-major matrix with one row per node
+		 *			of the upper layer. Rows are padded with zero weights to a multiple
+		 *			of NEURALNET_FLOAT_BLOCK_SIZE columns.
+         *     </p>
+         */
+
+		intVector m_packedLayerOffsetVec;
+		/**< @brief Offset of each layer matrix in m_packedWeightVec
+         *     <p>
+         *
+         *     </p>
+         */
+
+		intVector m_packedLayerStrideVec;
+		/**< @brief Padded row length (input nodes + bias) of each layer matrix
+         *     <p>
+         *
+         *     </p>
          */
 
         //@}
@@ -1038,6 +1085,45 @@ class NeuralNetShapeRecognizer: public LTKShapeRecognizer
 		*				LTKErrorList::ENON_POSITIVE_NUM	Normalised factor should be positive
 		*/
 		int feedForward(const vector<LTKShapeFeaturePtr>& shapeFeature,double2DVector& outptr,const int& currentIndex);
+
+		/**
+		*  Pack the network connection weights for float32 inference
+		*
+		* Semantics
+		*
+		*		   - Convert m_connectionWeightVec to float32 and copy all layers into
+		*				m_packedWeightVec, padding every row to a multiple of
+		*				NEURALNET_FLOAT_BLOCK_SIZE
+		*
+		* @param none
+		*
+		* @return SUCCESS: successfully complete
+        *         FAILURE: return ErrorCode
+		*
+		* @exception	LTKErrorList::EEMPTY_VECTOR		Network weights are not loaded
+		*/
+		int packConnectionWeights();
+
+		/**
+		*  Feedforward a batch of input samples using the packed float32 weights
+		*
+		* Semantics
+		*
+		*		   - Normalise the feature vectors as feedForward() does
+		*
+        *          - Evaluate every layer as one blocked matrix product of the packed
+		*				layer weights with the activations of all samples in the batch
+		*
+		* @param :	shapeFeatureBatch	: vector< vector<LTKShapeFeaturePtr> > : Feature representation of the input samples
+		*			outOutputLayerVec : float2DVector : Output layer content, one row per sample
+		*
+		* @return SUCCESS: successfully complete
+        *         FAILURE: return ErrorCode
+		*
+		* @exception	LTKErrorList::EEMPTY_VECTOR		Vector which is used in this method is empty
+		*				LTKErrorList::ENON_POSITIVE_NUM	Normalised factor should be positive
+		*/
+		int feedForwardFloat(const vector< vector<LTKShapeFeaturePtr> >& shapeFeatureBatch, float2DVector& outOutputLayerVec);
 		
 		/** This method is used to take dissection for terminating training process if network converge or maximum itaretion reach
          *
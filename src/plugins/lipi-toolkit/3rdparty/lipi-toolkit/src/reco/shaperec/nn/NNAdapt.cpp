@@ -232,6 +232,11 @@ int LTKAdapt::adaptAddLVQ(int shapeId)
 			//Update m_shapeIDNumPrototypesMap
 			m_nnShapeRecognizer->m_shapeIDNumPrototypesMap[shapeId]=
 				m_nnShapeRecognizer->m_shapeIDNumPrototypesMap[shapeId] + 1;
+
+			//Update MDT File
+			errorCode = m_nnShapeRecognizer->appendToAdaptationJournal(
+										NN_JOURNAL_ADD_SAMPLE,
+										m_nnShapeRecognizer->getNumPrototypes() - 1);
 		}
 		else
 		{
@@ -246,7 +251,7 @@ int LTKAdapt::adaptAddLVQ(int shapeId)
 				if(distindexPairObj.classId ==m_nnShapeRecognizer->m_vecRecoResult.at(0).getShapeId())
 				{
 					nearestSampleIndex = distindexPairObj.prototypeSetIndex;
-					recognizedClassNearestSample = m_nnShapeRecognizer->m_prototypeSet.at(nearestSampleIndex);
+					recognizedClassNearestSample = m_nnShapeRecognizer->getPrototype(nearestSampleIndex);
 					break;
 				}
 			}
@@ -261,10 +266,17 @@ int LTKAdapt::adaptAddLVQ(int shapeId)
 
 			//Update PrototypeSet with Morph Vector
 			const vector<LTKShapeFeaturePtr>& tempFeatVec = recognizedClassNearestSample.getFeatureVector();
-			m_nnShapeRecognizer->m_prototypeSet.at(nearestSampleIndex).setFeatureVector(tempFeatVec);
+			m_nnShapeRecognizer->getPrototype(nearestSampleIndex).setFeatureVector(tempFeatVec);
+
+			//Update MDT File
+			errorCode = m_nnShapeRecognizer->appendToAdaptationJournal(
+										NN_JOURNAL_MORPH_SAMPLE,
+										nearestSampleIndex);
+		}
+		if(errorCode != SUCCESS)
+		{
+			LTKReturnError(errorCode);
 		}
-		//Update MDT File
-		m_nnShapeRecognizer->writePrototypeSetToMDTFile();
 
 	}
 	catch(...)
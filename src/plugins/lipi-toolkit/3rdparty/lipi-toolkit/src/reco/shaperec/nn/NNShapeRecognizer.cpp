@@ -71,6 +71,9 @@
 #include "LTKStringUtil.h"
 #include "LTKDynamicTimeWarping.h"
 
+#include <iterator>
+#include <sstream>
+
 /**********************************************************************************
  * AUTHOR		: Saravanan R.
  * DATE			: 23-Jan-2007
@@ -105,6 +108,9 @@ void NNShapeRecognizer::assignDefaultValues()
     m_numClusters=NN_NUM_CLUST_INITIAL; // just to check that this is not what is mentioned by the user
     m_MDTUpdateFreq=NN_DEF_MDT_UPDATE_FREQ;
     m_prototypeSetModifyCount=0;
+    m_journalHeaderValid=false;
+    m_journalNumRecords=0;
+    m_journalCompactionStatus=SUCCESS;
     m_rejectThreshold=NN_DEF_REJECT_THRESHOLD;
     m_adaptivekNN=false;
     m_deleteLTKLipiPreProcessor=NULL;
@@ -1138,19 +1144,13 @@ NNShapeRecognizer::~NNShapeRecognizer()
     deleteAdaptInstance();
 
 	int returnStatus = SUCCESS;
-    //To update MDT File
-    if(m_prototypeSetModifyCount >0)
+    //Modifications not yet in the MDT File are kept in the journal,
+    //only wait for a compaction in progress
+    returnStatus = waitForJournalCompaction();
+    if(returnStatus != SUCCESS)
     {
-        m_prototypeSetModifyCount = m_MDTUpdateFreq-1;
-
-        returnStatus = writePrototypeSetToMDTFile();
-        if(returnStatus != SUCCESS)
-        {
-            LOG(LTKLogger::LTK_LOGLEVEL_ERR) << "Error: " << returnStatus << " " <<
-                " NNShapeRecognizer::~NNShapeRecognizer()" << endl;
-             throw LTKException(returnStatus);
-
-        }
+        LOG(LTKLogger::LTK_LOGLEVEL_ERR) << "Error: " << returnStatus << " " <<
+            " NNShapeRecognizer::~NNShapeRecognizer()" << endl;
     }
 
     m_neighborInfoVec.clear();
@@ -1164,6 +1164,8 @@ NNShapeRecognizer::~NNShapeRecognizer()
     }
 
     m_prototypeSet.clear();
+    m_adaptedPrototypeSet.clear();
+    m_adaptedPrototypeIndexMap.clear();
 
 	m_cachedShapeSampleFeatures.clearShapeSampleFeatures();
     
@@ -1203,8 +1205,14 @@ int NNShapeRecognizer::train(const string& trainingInputFilePath,
     LOG(LTKLogger::LTK_LOGLEVEL_DEBUG) << "Entering " <<
         "NNShapeRecognizer::train()" << endl;
 
-    int returnStatus = SUCCESS;
-
+    //A compaction in progress would write the MDT file and the journal
+    //concurrently with the training
+    int returnStatus = waitForJournalCompaction();
+    if(returnStatus != SUCCESS)
+    {
+        LOG(LTKLogger::LTK_LOGLEVEL_ERR) << "Error: " << returnStatus << " " <<
+            " NNShapeRecognizer::train()" << endl;
+    }
 
     if(comment.empty() != true)
     {
@@ -1241,6 +1249,14 @@ int NNShapeRecognizer::train(const string& trainingInputFilePath,
         }
     }
 
+    //Adaptations recorded for the previous model do not apply to the new one
+    {
+        std::lock_guard<std::mutex> journalLock(m_journalMutex);
+        remove((m_nnMDTFilePath + NN_JOURNAL_FILE_EXT).c_str());
+        m_journalHeaderValid = false;
+        m_journalNumRecords = 0;
+    }
+
     LOG(LTKLogger::LTK_LOGLEVEL_DEBUG) << "Exiting " <<
         "NNShapeRecognizer::train()" << endl;
     return SUCCESS;
@@ -1343,7 +1359,7 @@ int NNShapeRecognizer::trainClustering(const string& trainingInputFilePath,
  * Author			Date				Description
  *************************************************************************************/
 int NNShapeRecognizer::appendPrototypesToMDTFile(const vector<LTKShapeSample>& prototypeVec,
-        ofstream & mdtFileHandle)
+        ostream & mdtFileHandle)
 {
 
     LOG(LTKLogger::LTK_LOGLEVEL_DEBUG) << "Entering " <<
@@ -1353,8 +1369,6 @@ int NNShapeRecognizer::appendPrototypesToMDTFile(const vector<LTKShapeSample>& p
     vector<LTKShapeSample>::const_iterator sampleFeatureIter = prototypeVec.begin();
     vector<LTKShapeSample>::const_iterator sampleFeatureIterEnd = prototypeVec.end();
 
-    string strFeature = "";
-
     if(!mdtFileHandle)
     {
         LOG(LTKLogger::LTK_LOGLEVEL_ERR)<<"Error: "<< EINVALID_FILE_HANDLE << " " <<
@@ -1366,61 +1380,77 @@ int NNShapeRecognizer::appendPrototypesToMDTFile(const vector<LTKShapeSample>& p
 
     for(; sampleFeatureIter != sampleFeatureIterEnd; sampleFeatureIter++)
     {
-        //Write the class Id
-        int classId = (*sampleFeatureIter).getClassID();
+        appendPrototypeToMDTFile(*sampleFeatureIter, mdtFileHandle);
+    }
 
-        if ( m_MDTFileOpenMode == NN_MDT_OPEN_MODE_ASCII )
-        {
-            mdtFileHandle << classId << " ";
-        }
-        else
-        {
-            mdtFileHandle.write((char*) &classId,sizeof(int));
-        }
+    LOG(LTKLogger::LTK_LOGLEVEL_DEBUG) << "Exiting " <<
+        "NNShapeRecognizer::appendPrototypesToMDTFile()" << endl;
 
-        const vector<LTKShapeFeaturePtr>& shapeFeatureVector = (*sampleFeatureIter).getFeatureVector();
+    return SUCCESS;
+}
 
-        if ( m_MDTFileOpenMode == NN_MDT_OPEN_MODE_BINARY )
-        {
-            int numberOfFeatures = shapeFeatureVector.size();
-            int featureDimension = shapeFeatureVector[0]->getFeatureDimension();
+/******************************************************************************
+ * NAME			: appendPrototypeToMDTFile
+ * DESCRIPTION	: Writes the class ID and the features of prototype
+ * ARGUMENTS		:
+ * RETURNS		:
+ * NOTES			: Only reads prototype, it is called on the compaction thread
+ * CHANGE HISTROY
+ * Author			Date				Description
+ ******************************************************************************/
+void NNShapeRecognizer::appendPrototypeToMDTFile(const LTKShapeSample& prototype,
+        ostream & mdtFileHandle)
+{
+    string strFeature = "";
 
-            mdtFileHandle.write((char *)(&numberOfFeatures), sizeof(int));
-            mdtFileHandle.write((char *)(&featureDimension), sizeof(int));
+    //Write the class Id
+    int classId = prototype.getClassID();
 
-            floatVector floatFeatureVector;
-            m_shapeRecUtil.shapeFeatureVectorToFloatVector(shapeFeatureVector,
-                                                           floatFeatureVector);
+    if ( m_MDTFileOpenMode == NN_MDT_OPEN_MODE_ASCII )
+    {
+        mdtFileHandle << classId << " ";
+    }
+    else
+    {
+        mdtFileHandle.write((char*) &classId,sizeof(int));
+    }
 
-            int vectorSize = floatFeatureVector.size();
+    const vector<LTKShapeFeaturePtr>& shapeFeatureVector = prototype.getFeatureVector();
 
-            for (int i=0; i< vectorSize; i++)
-            {
-                float floatValue = floatFeatureVector[i];
-                mdtFileHandle.write((char *)(&floatValue), sizeof(float));
-            }
-        }
-        else
-        {
+    if ( m_MDTFileOpenMode == NN_MDT_OPEN_MODE_BINARY )
+    {
+        int numberOfFeatures = shapeFeatureVector.size();
+        int featureDimension = shapeFeatureVector[0]->getFeatureDimension();
 
-            vector<LTKShapeFeaturePtr>::const_iterator shapeFeatureIter = shapeFeatureVector.begin();
-            vector<LTKShapeFeaturePtr>::const_iterator shapeFeatureIterEnd = shapeFeatureVector.end();
+        mdtFileHandle.write((char *)(&numberOfFeatures), sizeof(int));
+        mdtFileHandle.write((char *)(&featureDimension), sizeof(int));
 
-            for(; shapeFeatureIter != shapeFeatureIterEnd; ++shapeFeatureIter)
-            {
-                (*shapeFeatureIter)->toString(strFeature);
-                mdtFileHandle << strFeature << FEATURE_EXTRACTOR_DELIMITER;
-            }
+        floatVector floatFeatureVector;
+        m_shapeRecUtil.shapeFeatureVectorToFloatVector(shapeFeatureVector,
+                                                       floatFeatureVector);
 
-            mdtFileHandle << "\n";
-        }
+        int vectorSize = floatFeatureVector.size();
 
+        for (int i=0; i< vectorSize; i++)
+        {
+            float floatValue = floatFeatureVector[i];
+            mdtFileHandle.write((char *)(&floatValue), sizeof(float));
+        }
     }
+    else
+    {
 
-    LOG(LTKLogger::LTK_LOGLEVEL_DEBUG) << "Exiting " <<
-        "NNShapeRecognizer::appendPrototypesToMDTFile()" << endl;
+        vector<LTKShapeFeaturePtr>::const_iterator shapeFeatureIter = shapeFeatureVector.begin();
+        vector<LTKShapeFeaturePtr>::const_iterator shapeFeatureIterEnd = shapeFeatureVector.end();
 
-    return SUCCESS;
+        for(; shapeFeatureIter != shapeFeatureIterEnd; ++shapeFeatureIter)
+        {
+            (*shapeFeatureIter)->toString(strFeature);
+            mdtFileHandle << strFeature << FEATURE_EXTRACTOR_DELIMITER;
+        }
+
+        mdtFileHandle << "\n";
+    }
 }
 
 /**********************************************************************************
@@ -1496,7 +1526,7 @@ int NNShapeRecognizer::preprocess (const LTKTraceGroup& inTraceGroup,
  *************************************************************************************/
 
 int NNShapeRecognizer::calculateMedian(const int2DVector& clusteringResult,
-        const float2DVector& distanceMatrix, vector<int>& outMedianIndexVec)
+        const floatVector& distanceMatrix, int numSamples, vector<int>& outMedianIndexVec)
 
 {
     LOG(LTKLogger::LTK_LOGLEVEL_DEBUG) << "Entering " <<
@@ -1522,13 +1552,13 @@ int NNShapeRecognizer::calculateMedian(const int2DVector& clusteringResult,
 					{
 						int tempi = clusteringResult[clusterID][clusMem];
 						int tempj = clusteringResult[clusterID][otherClusMem];
-						dist += distanceMatrix[tempi][tempj-tempi-1];
+						dist += distanceMatrix[getCondensedIndex(numSamples, tempi, tempj)];
 					}
 					else
 					{
 						int tempi = clusteringResult[clusterID][otherClusMem];
 						int tempj = clusteringResult[clusterID][clusMem];
-						dist += distanceMatrix[tempi][tempj-tempi-1];
+						dist += distanceMatrix[getCondensedIndex(numSamples, tempi, tempj)];
 					}
 				}
 			}
@@ -1572,7 +1602,11 @@ int NNShapeRecognizer::computeDTWDistance(
     const vector<LTKShapeFeaturePtr>& firstFeatureVec = inFirstShapeSampleFeatures.getFeatureVector();
     const vector<LTKShapeFeaturePtr>& secondFeatureVec = inSecondShapeSampleFeatures.getFeatureVector();
 
-    int errorCode = m_dtwObj.computeDTW(firstFeatureVec, secondFeatureVec, getDistance,outDTWDistance,
+    // The proximity matrix is computed on several threads, each thread
+    // needs its own DTW work matrices
+    static thread_local DynamicTimeWarping<LTKShapeFeaturePtr, float> dtwObj;
+
+    int errorCode = dtwObj.computeDTW(firstFeatureVec, secondFeatureVec, getDistance,outDTWDistance,
             m_dtwBanding, FLT_MAX, FLT_MAX);
 
     LOG(LTKLogger::LTK_LOGLEVEL_DEBUG) << "DTWDistance: " <<
@@ -1668,8 +1702,9 @@ int NNShapeRecognizer::loadModelData()
 
     stringStringMap headerSequence;
     LTKCheckSumGenerate cheSumGen;
+    LTKMDTBuffer mdtBuffer;
 
-    if(errorCode = cheSumGen.readMDTHeader(m_nnMDTFilePath,headerSequence))
+    if(errorCode = cheSumGen.readMDTHeader(m_nnMDTFilePath,headerSequence,mdtBuffer))
     {
         LOG(LTKLogger::LTK_LOGLEVEL_ERR)<<"Error: "<< errorCode << " " <<
             " NNShapeRecognizer::loadModelData()" << endl;
@@ -1746,26 +1781,9 @@ int NNShapeRecognizer::loadModelData()
     }
     // Version comparison END
 
-    //Input Stream for Model Data file
-    ifstream mdtFileHandle;
-
-    if (m_MDTFileOpenMode == NN_MDT_OPEN_MODE_ASCII )
-    {
-        mdtFileHandle.open(m_nnMDTFilePath.c_str(), ios::in);
-    }
-    else
-    {
-        mdtFileHandle.open(m_nnMDTFilePath.c_str(), ios::in | ios::binary);
-    }
-
-    //If error while opening, return an error
-    if(!mdtFileHandle)
-    {
-        LOG(LTKLogger::LTK_LOGLEVEL_ERR)<<"Error: "<< EMODEL_DATA_FILE_OPEN << " " <<
-            " Unable to open model data file : " <<m_nnMDTFilePath<<
-            " NNShapeRecognizer::loadModelData()" << endl;
-        LTKReturnError(EMODEL_DATA_FILE_OPEN);
-    }
+    //Input Stream for Model Data file, reading the content loaded
+    //by readMDTHeader() instead of opening the file again
+    istream mdtFileHandle(&mdtBuffer);
 
     mdtFileHandle.seekg(atoi(headerSequence[HEADERLEN].c_str()),ios::beg);
 
@@ -1812,6 +1830,11 @@ int NNShapeRecognizer::loadModelData()
 	{
 		while(getline(mdtFileHandle, strFeatureVector, NEW_LINE_DELIMITER ))
 		{
+			// The file is read in binary, drop carriage returns of
+			// files written in text mode on Windows
+			if(!strFeatureVector.empty() && strFeatureVector[strFeatureVector.size() - 1] == '\r')
+				strFeatureVector.erase(strFeatureVector.size() - 1);
+
 			LTKStringUtil::tokenizeString(strFeatureVector,
 					CLASSID_FEATURES_DELIMITER,  classToken);
 
@@ -1943,7 +1966,14 @@ int NNShapeRecognizer::loadModelData()
 		}
 	}
 
-	mdtFileHandle.close();
+    //Apply the adaptations made since the MDT file was written
+    errorCode = readAdaptationJournal(headerSequence[CKS]);
+    if(errorCode != SUCCESS)
+    {
+        LOG(LTKLogger::LTK_LOGLEVEL_ERR)<<"Error: "<< errorCode << " " <<
+            " NNShapeRecognizer::loadModelData()" << endl;
+        LTKReturnError(errorCode);
+    }
 
     LOG(LTKLogger::LTK_LOGLEVEL_DEBUG) << "Exiting " <<
         "NNShapeRecognizer::loadModelData()" << endl;
@@ -2078,7 +2108,7 @@ int NNShapeRecognizer::recognize(const vector<LTKShapeFeaturePtr>& shapeFeatureV
     //Creating a local copy of input inSubSetOfClasses, as it is const, STL's unique function modifies it!!!
     vector<int> subSetOfClasses = inSubSetOfClasses;
 
-	int numPrototypes = m_prototypeSet.size();
+	int numPrototypes = getNumPrototypes();
 
     /*********Validation for m_prototypeSet ***************************/
     if ( numPrototypes == 0 )
@@ -2149,16 +2179,8 @@ int NNShapeRecognizer::recognize(const vector<LTKShapeFeaturePtr>& shapeFeatureV
     //Variable to store the Euclidean distance.
     float euclideanDistance = 0.0f;
 
-
-    // begin and end iterators for m_prototypeSet
-    vector<LTKShapeSample>::iterator prototypeSetIter = m_prototypeSet.begin();
-    vector<LTKShapeSample>::iterator prototypeSetIterEnd = m_prototypeSet.end();
-
-    //iterator for iterating the input shape subset vector
-
-    vector<int>::iterator subSetOfClassesIter;
-
-    int prototypeIndexOffset=0;
+    //Indices of the prototypes to compare with, adapted prototypes included
+    vector<int> prototypeIndices;
 
     int numPrototypesForSubset=0;
 
@@ -2214,86 +2236,54 @@ int NNShapeRecognizer::recognize(const vector<LTKShapeFeaturePtr>& shapeFeatureV
                 dtwEuclideanFilter = EUCLIDEAN_FILTER_OFF;
             }
         }
-
-        subSetOfClassesIter=subSetOfClasses.begin();
     }
-    // If Euclidean filter size >= size of the m_prototypeSet, do not use twEuclideanFilter
-    else if(subSetOfClasses.size()==0 && dtwEuclideanFilter >= m_prototypeSet.size())
+    // If Euclidean filter size >= size of the prototype set, do not use twEuclideanFilter
+    else if(subSetOfClasses.size()==0 && dtwEuclideanFilter >= numPrototypes)
     {
         LOG(LTKLogger::LTK_LOGLEVEL_DEBUG) <<
             "dtwEuclideanFilter >= m_prototypeSet.size(), switching Euclidean filter off" << endl;
         dtwEuclideanFilter = EUCLIDEAN_FILTER_OFF;
     }
 
+    getPrototypeIndices(subSetOfClasses, prototypeIndices);
+
+    int numPrototypeIndices = prototypeIndices.size();
+
     // If the distance metric is Euclidean, compute the distances of test sample to all the samples in the prototype set
     if(LTKSTRCMP(m_prototypeDistance.c_str(), EUCLIDEAN_DISTANCE) == 0)
     {
-        for (int j = 0; prototypeSetIter != prototypeSetIterEnd; )
+        for (int j = 0; j < numPrototypeIndices; ++j)
         {
+            const LTKShapeSample& prototype = getPrototype(prototypeIndices[j]);
 
-            if(subSetOfClasses.size()>0)
-            {
-                if((*prototypeSetIter).getClassID()<(*subSetOfClassesIter))
-                {
-                    j=j + m_shapeIDNumPrototypesMap[(*prototypeSetIter).getClassID()];
-                    prototypeSetIter=prototypeSetIter +
-                        m_shapeIDNumPrototypesMap[(*prototypeSetIter).getClassID()];
-
-                    continue;
-                }
+			euclideanDistance = 0.0f;
+            errorCode = computeEuclideanDistance(prototype,
+                    m_cachedShapeSampleFeatures,
+                    euclideanDistance);
 
+            if(errorCode == SUCCESS && m_cancelRecognition)
+                return SUCCESS;
 
-            }
-            if(subSetOfClasses.size()==0 || (*prototypeSetIter).getClassID()==(*subSetOfClassesIter))
+            if(errorCode != SUCCESS)
             {
-                while(subSetOfClasses.size()==0 || (*prototypeSetIter).getClassID()==(*subSetOfClassesIter))
-                {
-					euclideanDistance = 0.0f;
-                    errorCode = computeEuclideanDistance(*prototypeSetIter,
-                            m_cachedShapeSampleFeatures,
-                            euclideanDistance);
-
-                    if(errorCode == SUCCESS && m_cancelRecognition)
-                        return SUCCESS;
-
-                    if(errorCode != SUCCESS)
-                    {
-                        LOG(LTKLogger::LTK_LOGLEVEL_ERR) << "Error: " << errorCode << " " <<
-                            " NNShapeRecognizer::recognize()" << endl;
-
-                        LTKReturnError(errorCode);
-
-                    }
+                LOG(LTKLogger::LTK_LOGLEVEL_ERR) << "Error: " << errorCode << " " <<
+                    " NNShapeRecognizer::recognize()" << endl;
 
-                    tempPair.distance = euclideanDistance;
-                    tempPair.classId = (*prototypeSetIter).getClassID();
-                    tempPair.prototypeSetIndex = j;
+                LTKReturnError(errorCode);
 
-                    m_neighborInfoVec.push_back(tempPair);
-                    ++prototypeSetIter;
-                    ++j;
+            }
 
-                    if(prototypeSetIter==m_prototypeSet.end())
-                    {
-                        break;
-                    }
-                }
+            tempPair.distance = euclideanDistance;
+            tempPair.classId = prototype.getClassID();
+            tempPair.prototypeSetIndex = prototypeIndices[j];
 
-                if(subSetOfClasses.size()>0)
-                {
-                    ++subSetOfClassesIter;
-                    if(subSetOfClassesIter==subSetOfClasses.end())
-                    {
-                        break;
-                    }
-                }
-            }
+            m_neighborInfoVec.push_back(tempPair);
         }
     }
     // If the distance metric is DTW
     else if(LTKSTRCMP(m_prototypeDistance.c_str(), DTW_DISTANCE) == 0)
     {
-        vector<bool> filterVector(m_prototypeSet.size(), true);
+        vector<bool> filterVector(numPrototypes, true);
 
         // If Euclidean Filter is specified, find Euclidean distance to all the samples in the prototypeset,
         // choose the top dtwEuclideanFilter number of prototypes, to which the DTW distance will be computed.
@@ -2301,68 +2291,34 @@ int NNShapeRecognizer::recognize(const vector<LTKShapeFeaturePtr>& shapeFeatureV
         {
             vector <struct NeighborInfo> eucDistIndexPairVector;
 
-            filterVector.assign(m_prototypeSet.size(), false);
-
+            filterVector.assign(numPrototypes, false);
 
-            for (int j = 0; prototypeSetIter != prototypeSetIterEnd;)
+            for (int j = 0; j < numPrototypeIndices; ++j)
             {
-                if(subSetOfClasses.size()>0)
-                {
-                    if((*prototypeSetIter).getClassID()<(*subSetOfClassesIter))
-                    {
-
-                        j=j + m_shapeIDNumPrototypesMap[(*prototypeSetIter).getClassID()];
-                        prototypeSetIter = prototypeSetIter + m_shapeIDNumPrototypesMap
-                            [(*prototypeSetIter).getClassID()];
-
-                        continue;
-                    }
-                }
-                if(subSetOfClasses.size()==0 || (*prototypeSetIter).getClassID()==(*subSetOfClassesIter))
-                {
-                    while(subSetOfClasses.size()==0 ||
-                            (*prototypeSetIter).getClassID()==(*subSetOfClassesIter))
-                    {
-						euclideanDistance = 0.0f;
-                        errorCode = computeEuclideanDistance(*prototypeSetIter,
-                                m_cachedShapeSampleFeatures,
-                                euclideanDistance);
+                const LTKShapeSample& prototype = getPrototype(prototypeIndices[j]);
 
-                        if(errorCode == SUCCESS && m_cancelRecognition)
-                            return SUCCESS;
-
-                        if(errorCode != SUCCESS)
-                        {
-                            LOG(LTKLogger::LTK_LOGLEVEL_ERR) << "Error: " << errorCode << " " <<
-                                " NNShapeRecognizer::recognize()" << endl;
+				euclideanDistance = 0.0f;
+                errorCode = computeEuclideanDistance(prototype,
+                        m_cachedShapeSampleFeatures,
+                        euclideanDistance);
 
-                            LTKReturnError(errorCode);
-                        }
+                if(errorCode == SUCCESS && m_cancelRecognition)
+                    return SUCCESS;
 
+                if(errorCode != SUCCESS)
+                {
+                    LOG(LTKLogger::LTK_LOGLEVEL_ERR) << "Error: " << errorCode << " " <<
+                        " NNShapeRecognizer::recognize()" << endl;
 
-                        tempPair.distance = euclideanDistance;
-                        tempPair.classId = (*prototypeSetIter).getClassID();
-                        tempPair.prototypeSetIndex = j;
+                    LTKReturnError(errorCode);
+                }
 
-                        eucDistIndexPairVector.push_back(tempPair);
-                        ++prototypeSetIter;
-                        ++j;
 
-                        if(prototypeSetIter==m_prototypeSet.end())
-                        {
-                            break;
-                        }
-                    }
+                tempPair.distance = euclideanDistance;
+                tempPair.classId = prototype.getClassID();
+                tempPair.prototypeSetIndex = prototypeIndices[j];
 
-                    if(subSetOfClasses.size()>0)
-                    {
-                        ++subSetOfClassesIter;
-                        if(subSetOfClassesIter==subSetOfClasses.end())
-                        {
-                            break;
-                        }
-                    }
-                }
+                eucDistIndexPairVector.push_back(tempPair);
             }
 
             //Sort the eucDistIndexPairVector in ascending order of distance, and used only top dtwEuclideanFilter for DTW distance computation
@@ -2378,51 +2334,26 @@ int NNShapeRecognizer::recognize(const vector<LTKShapeFeaturePtr>& shapeFeatureV
         {
             if(subSetOfClasses.size()>0)
             {
-                filterVector.assign(m_prototypeSet.size(), false);
+                filterVector.assign(numPrototypes, false);
 
-                for(map<int,int>::iterator shapeIDNumPrototypesMapIter=m_shapeIDNumPrototypesMap.begin();
-                        shapeIDNumPrototypesMapIter!=m_shapeIDNumPrototypesMap.end();)
+                for (int j = 0; j < numPrototypeIndices; ++j)
                 {
-                    if(shapeIDNumPrototypesMapIter->first<(*subSetOfClassesIter))
-                    {
-
-                        prototypeIndexOffset=prototypeIndexOffset +
-                            shapeIDNumPrototypesMapIter->second;
-
-                        ++shapeIDNumPrototypesMapIter;
-
-                        continue;
-                    }
-                    else if(shapeIDNumPrototypesMapIter->first==(*subSetOfClassesIter))
-                    {
-                        while(m_prototypeSet[prototypeIndexOffset].getClassID()==
-							(*subSetOfClassesIter))
-                        {
-                            filterVector[prototypeIndexOffset]=true;
-                            ++prototypeIndexOffset;
-							if( prototypeIndexOffset == m_prototypeSet.size())								break;                        }
-						 if(subSetOfClassesIter==subSetOfClasses.end())                        {                            break;                        }                        //filterVector.assign(filterVector.begin()+prototypeIndexOffset,filterVector.begin()+prototypeIndexOffset+shapeIDNumPrototypesMapIter->second,true);
-                        ++shapeIDNumPrototypesMapIter;
-                        ++subSetOfClassesIter;
-                        if(subSetOfClassesIter==subSetOfClasses.end())
-                        {
-                            break;
-                        }
-                       
-                    }
+                    filterVector[prototypeIndices[j]] = true;
                 }
             }
         }
 
 
         //Iterate through all the prototypes, and compute DTW distance to the prototypes for which corresponding entry in filterVector is true
-        for (int i = 0 ; i < m_prototypeSet.size(); ++i )
+        for (int i = 0 ; i < numPrototypes; ++i )
         {
 
             if(filterVector[i])
             {
+                const LTKShapeSample& prototype = getPrototype(i);
+
 				dtwDistance = 0.0f;
-                errorCode = computeDTWDistance(m_prototypeSet[i],
+                errorCode = computeDTWDistance(prototype,
                         m_cachedShapeSampleFeatures,
                         dtwDistance);
 
@@ -2438,7 +2369,7 @@ int NNShapeRecognizer::recognize(const vector<LTKShapeFeaturePtr>& shapeFeatureV
                 }
 
                 tempPair.distance = dtwDistance;
-                tempPair.classId = (m_prototypeSet[i]).getClassID();
+                tempPair.classId = prototype.getClassID();
                 tempPair.prototypeSetIndex = i;
                 m_neighborInfoVec.push_back(tempPair);
             }
@@ -2548,23 +2479,24 @@ int NNShapeRecognizer::unloadModelData()
 
     int returnStatus = SUCCESS;
 
-    //Update MDT file with any modification, if available in memory
-    if(m_prototypeSetModifyCount >0)
+    //Modifications not yet in the MDT file are kept in the journal and
+    //replayed by the next loadModelData(), wait for a compaction in progress
+    returnStatus = waitForJournalCompaction();
+    if(returnStatus != SUCCESS)
     {
-        m_prototypeSetModifyCount = m_MDTUpdateFreq-1;
-
-        returnStatus = writePrototypeSetToMDTFile();
-        if(returnStatus != SUCCESS)
-        {
-            LOG(LTKLogger::LTK_LOGLEVEL_ERR) << "Error: " << returnStatus << " " <<
-                " NNShapeRecognizer::unloadModelData()" << endl;
-        }
-        m_prototypeSetModifyCount = 0;
+        LOG(LTKLogger::LTK_LOGLEVEL_ERR) << "Error: " << returnStatus << " " <<
+            " NNShapeRecognizer::unloadModelData()" << endl;
     }
+    m_prototypeSetModifyCount = 0;
+    m_journalHeaderValid = false;
+    m_journalNumRecords = 0;
 
     //Clearing the prototypSet
     m_prototypeSet.clear();
+    m_adaptedPrototypeSet.clear();
+    m_adaptedPrototypeIndexMap.clear();
     m_shapeIDNumPrototypesMap.clear();
+    m_neighborInfoVec.clear();
 
     LOG(LTKLogger::LTK_LOGLEVEL_DEBUG) << "Exiting " <<
         "NNShapeRecognizer::unloadModelData()" << endl;
@@ -2625,9 +2557,10 @@ int NNShapeRecognizer::performClustering(const vector<LTKShapeSample> & shapeSam
 
     intVector tempVec;
     int2DVector outputVector;
-    float2DVector distanceMatrix;
+    floatVector distanceMatrix;
     int sampleCount=shapeSamplesVec.size();
     int returnStatus = SUCCESS;
+    int progressPercent = -1;
 
     if(m_prototypeReductionFactor == -1)
     {
@@ -2635,6 +2568,8 @@ int NNShapeRecognizer::performClustering(const vector<LTKShapeSample> & shapeSam
         //this is done when either of NumClusters or PrototypeReducrion factor is set
         //to automatic
         LTKHierarchicalClustering<LTKShapeSample,NNShapeRecognizer> hc(shapeSamplesVec,AVERAGE_LINKAGE,AVG_SIL);
+        hc.setNumOfThreads(0);
+        hc.setProgressCallback(printProximityProgress, &progressPercent);
         if(LTKSTRCMP(m_prototypeDistance.c_str(), DTW_DISTANCE) == 0)
         {
             returnStatus = hc.cluster(this,&NNShapeRecognizer::computeDTWDistance);
@@ -2687,6 +2622,8 @@ int NNShapeRecognizer::performClustering(const vector<LTKShapeSample> & shapeSam
 	{
         LTKHierarchicalClustering<LTKShapeSample,NNShapeRecognizer>
             hc(shapeSamplesVec,numClusters, AVERAGE_LINKAGE);
+        hc.setNumOfThreads(0);
+        hc.setProgressCallback(printProximityProgress, &progressPercent);
 
 
         if(numClusters == 1)
@@ -2755,7 +2692,7 @@ int NNShapeRecognizer::performClustering(const vector<LTKShapeSample> & shapeSam
 
 	    vector<int> medianIndexVec;
 
-	    errorCode = calculateMedian(outputVector, distanceMatrix, medianIndexVec);
+	    errorCode = calculateMedian(outputVector, distanceMatrix, sampleCount, medianIndexVec);
 
             if(errorCode != SUCCESS)
             {
@@ -3529,7 +3466,7 @@ int NNShapeRecognizer::addClass(const LTKTraceGroup& sampleTraceGroup, int& shap
 
 
     //Update MDT File
-    errorCode = writePrototypeSetToMDTFile();
+    errorCode = appendToAdaptationJournal(NN_JOURNAL_ADD_SAMPLE, getNumPrototypes()-1);
     if(errorCode != SUCCESS)
     {
         LOG(LTKLogger::LTK_LOGLEVEL_ERR) << "Error: "<< errorCode << " " <<
@@ -3600,7 +3537,7 @@ int NNShapeRecognizer::addSample(const LTKTraceGroup& sampleTraceGroup, int shap
 	m_shapeIDNumPrototypesMap[shapeID]= currentNum+1;
 
 	//Update MDT File
-	errorCode = writePrototypeSetToMDTFile();
+	errorCode = appendToAdaptationJournal(NN_JOURNAL_ADD_SAMPLE, getNumPrototypes()-1);
 	if(errorCode != SUCCESS)
 	{
 		LOG(LTKLogger::LTK_LOGLEVEL_ERR) << "Error: "<< errorCode << " " <<
@@ -3653,6 +3590,10 @@ int NNShapeRecognizer::deleteClass(int shapeID)
         LTKReturnError(EINVALID_SHAPEID);
     }
 
+    //Bring the adapted samples into m_prototypeSet
+    mergeAdaptedPrototypes();
+    prototypeSetSize = m_prototypeSet.size();
+
     //Update m_prototypeSet
     int k =0;
     for (int i=0;i<prototypeSetSize;i++)
@@ -3672,7 +3613,7 @@ int NNShapeRecognizer::deleteClass(int shapeID)
     m_shapeIDNumPrototypesMap.erase(shapeID);
 
     //Update MDT File
-    int returnStatus = writePrototypeSetToMDTFile();
+    int returnStatus = writePrototypeSetToMDTFile(true);
 
     if(returnStatus != SUCCESS)
     {
@@ -3692,112 +3633,79 @@ int NNShapeRecognizer::deleteClass(int shapeID)
  * DATE			: 09-06-2007
  * NAME			: writePrototypeSetToMDTFile
  * DESCRIPTION	: Creates a MDTFile with updated m_prototypeSet
- * ARGUMENTS		:
+ * ARGUMENTS		: waitForCompletion : write the MDT file before returning
  * RETURNS		:
- * NOTES			:
+ * NOTES			: Unless waitForCompletion is true, the prototype set is merged,
+ *				  serialized and written on the compaction thread from a snapshot
  * CHANGE HISTROY
  * Author			Date				Description
  ******************************************************************************/
-int NNShapeRecognizer::writePrototypeSetToMDTFile()
+int NNShapeRecognizer::writePrototypeSetToMDTFile(bool waitForCompletion)
 {
 
     LOG(LTKLogger::LTK_LOGLEVEL_DEBUG) << "Entering " <<
         "NNShapeRecognizer::writePrototypeSetToMDTFile()" << endl;
 
-    int returnStatus = SUCCESS;
-
-    //Flush to MDT only after m_MDTUpdateFreq modifications
-    m_prototypeSetModifyCount++;
-    if(m_prototypeSetModifyCount == m_MDTUpdateFreq)
+    //Only one compaction at a time
+    int returnStatus = waitForJournalCompaction();
+    if(returnStatus != SUCCESS)
     {
-        m_prototypeSetModifyCount = 0;
-
-        ofstream mdtFileHandle;
-        vector<LTKShapeSample> vecShapeSampleFeatures;
-        LTKShapeSample shapeSampleFeatures;
-
-        vector<LTKShapeSample>::iterator prototypeSetIter;
-
-        int prototypeSetSize = m_prototypeSet.size();
-
-        //Open the Model data file for writing mode
-        if ( m_MDTFileOpenMode == NN_MDT_OPEN_MODE_ASCII )
-        {
-            mdtFileHandle.open(m_nnMDTFilePath.c_str(), ios::out);
-        }
-        else
-        {
-            mdtFileHandle.open(m_nnMDTFilePath.c_str(),ios::out|ios::binary);
-        }
-
-
-        //Throw an error if unable to open the Model data file
-        if(!mdtFileHandle)
-        {
-            LOG(LTKLogger::LTK_LOGLEVEL_ERR) << "Error: "<< EMODEL_DATA_FILE_OPEN << " " <<
-                getErrorMessage(EMODEL_DATA_FILE_OPEN) <<
-                " NNShapeRecognizer::writePrototypeSetToMDTFile()" << endl;
-
-            LTKReturnError(EMODEL_DATA_FILE_OPEN);
-        }
+        //The records of the failed compaction are still in the journal,
+        //and are written again below
+        LOG(LTKLogger::LTK_LOGLEVEL_ERR)<<"Error: "<< returnStatus << " " <<
+            " NNShapeRecognizer::writePrototypeSetToMDTFile()" << endl;
+    }
 
+    //Updating the Header Information
+    updateHeaderWithAlgoInfo();
 
-        if ( m_MDTFileOpenMode == NN_MDT_OPEN_MODE_ASCII )
-        {
-            //Write the number of Shapes
-            mdtFileHandle << 0 << endl; //Representing Dynamic
-        }
-        else
-        {
-            int numShapes = 0;
-            mdtFileHandle.write((char*) &numShapes, sizeof(unsigned short));
-        }
-        prototypeSetIter = m_prototypeSet.begin();
+    //Records appended from now on are kept in the journal
+    int numJournalRecords;
+    {
+        std::lock_guard<std::mutex> journalLock(m_journalMutex);
+        numJournalRecords = m_journalNumRecords;
+    }
+    m_prototypeSetModifyCount = 0;
 
-        for (int i=0;i<prototypeSetSize;i++)
-        {
-            int classId = (*prototypeSetIter).getClassID();
-            shapeSampleFeatures.setClassID(classId);
-            shapeSampleFeatures.setFeatureVector((*prototypeSetIter).getFeatureVector());
+    if(waitForCompletion)
+    {
+        mergeAdaptedPrototypes();
 
-            vecShapeSampleFeatures.push_back(shapeSampleFeatures);
-            prototypeSetIter++;
-        }
+        ostringstream mdtData;
+        appendPrototypeSetToMDTFile(m_prototypeSet, m_adaptedPrototypeSet,
+                                    m_adaptedPrototypeIndexMap, m_shapeIDNumPrototypesMap,
+                                    mdtData);
 
-        returnStatus = appendPrototypesToMDTFile(vecShapeSampleFeatures,mdtFileHandle);
+        returnStatus = writeCompactedMDTFile(mdtData.str(), m_headerInfo, numJournalRecords);
 
         if(returnStatus != SUCCESS)
         {
-            LOG(LTKLogger::LTK_LOGLEVEL_ERR)<<"Error: "<< returnStatus << " " <<
+            LOG(LTKLogger::LTK_LOGLEVEL_ERR)<<"Error: "<<  returnStatus << " " <<
                 " NNShapeRecognizer::writePrototypeSetToMDTFile()" << endl;
 
             LTKReturnError(returnStatus);
         }
+    }
+    else
+    {
+        //The features are shared with the snapshot, which is released by
+        //waitForJournalCompaction() since their reference count is not atomic
+        m_compactionPrototypeSet = m_prototypeSet;
+        m_compactionAdaptedPrototypeSet = m_adaptedPrototypeSet;
+        m_compactionAdaptedPrototypeIndexMap = m_adaptedPrototypeIndexMap;
+        m_compactionShapeIDNumPrototypesMap = m_shapeIDNumPrototypesMap;
+        stringStringMap headerInfo = m_headerInfo;
 
-        mdtFileHandle.close();
-
-        //Updating the Header Information
-        updateHeaderWithAlgoInfo();
-
-        //Adding header information	and checksum generation
-        string strModelDataHeaderInfoFile = "";
-        LTKCheckSumGenerate cheSumGen;
-
-        returnStatus = cheSumGen.addHeaderInfo(
-                strModelDataHeaderInfoFile,
-                m_nnMDTFilePath,
-                m_headerInfo
-                );
-
-        if(returnStatus != SUCCESS)
+        m_journalCompactionThread = std::thread([this, headerInfo, numJournalRecords]()
         {
-            LOG(LTKLogger::LTK_LOGLEVEL_ERR)<<"Error: "<<  returnStatus << " " <<
-                " NNShapeRecognizer::writePrototypeSetToMDTFile()" << endl;
-
-            LTKReturnError(returnStatus);
-        }
+            ostringstream mdtData;
+            appendPrototypeSetToMDTFile(m_compactionPrototypeSet, m_compactionAdaptedPrototypeSet,
+                                        m_compactionAdaptedPrototypeIndexMap,
+                                        m_compactionShapeIDNumPrototypesMap, mdtData);
 
-        vecShapeSampleFeatures.clear();
+            m_journalCompactionStatus = writeCompactedMDTFile(mdtData.str(), headerInfo,
+                                                              numJournalRecords);
+        });
     }
 
     LOG(LTKLogger::LTK_LOGLEVEL_DEBUG)
@@ -3807,67 +3715,766 @@ int NNShapeRecognizer::writePrototypeSetToMDTFile()
 }
 
 /******************************************************************************
- * AUTHOR		: Tarun Madan
- * DATE			: 09-06-2007
- * NAME			: Add Sample to m_prototypeSet
- * DESCRIPTION	: Add  LTKShapeSample to m_prototypeSet
- *
+ * NAME			: replaceFile
+ * DESCRIPTION	: Renames fromPath to toPath, replacing toPath
  * ARGUMENTS		:
- * RETURNS		:
- * NOTES			:
+ * RETURNS		: SUCCESS or EMODEL_DATA_FILE_OPEN
+ * NOTES			: rename() does not replace an existing file on Windows
  * CHANGE HISTROY
  * Author			Date				Description
  ******************************************************************************/
-int NNShapeRecognizer::insertSampleToPrototypeSet(const LTKShapeSample &shapeSampleFeatures)
+static int replaceFile(const string& fromPath, const string& toPath)
 {
-    //Error??
-
-    LOG(LTKLogger::LTK_LOGLEVEL_DEBUG)<<
-        "Entering NNShapeRecognizer::insertSampleToPrototypeSet"<<endl;
-
-    vector<LTKShapeSample>::iterator prototypeSetIter;
-    int classID = shapeSampleFeatures.getClassID();
-    int maxClassID;
-
-    int prototypeSize = m_prototypeSet.size();
-    if(prototypeSize > 0)
-    {
-        maxClassID = m_prototypeSet.at(prototypeSize-1).getClassID();
-    }
-    else
+    if(rename(fromPath.c_str(), toPath.c_str()) != 0)
     {
-        maxClassID = LTK_START_SHAPEID;
-    }
-
-    prototypeSetIter = m_prototypeSet.begin();
+        remove(toPath.c_str());
 
-    if(classID >= maxClassID)
-    {
-        m_prototypeSet.push_back(shapeSampleFeatures);
-    }
-    else
-    {
-        for(;prototypeSetIter!=m_prototypeSet.end();)
+        if(rename(fromPath.c_str(), toPath.c_str()) != 0)
         {
-            int currentClassId = (*prototypeSetIter).getClassID();
-
-            if(currentClassId >= classID)
-            {
-                m_prototypeSet.insert(prototypeSetIter,shapeSampleFeatures);
-                break;
-            }
-            int count = m_shapeIDNumPrototypesMap[currentClassId];
-            prototypeSetIter = prototypeSetIter + count; //To point to first sample of next classID
+            remove(fromPath.c_str());
+            LTKReturnError(EMODEL_DATA_FILE_OPEN);
         }
     }
-    LOG(LTKLogger::LTK_LOGLEVEL_DEBUG)<<"Exiting NNShapeRecognizer::insertSampleToPrototypeSet"<<endl;
 
     return SUCCESS;
 }
 
 /******************************************************************************
- * AUTHOR                : Vandana Roy
- * DATE                  : 05-07-2007
+ * NAME			: writeCompactedMDTFile
+ * DESCRIPTION	: Replaces the MDT file with mdtData and removes the records
+ *				  it contains from the adaptation journal
+ * ARGUMENTS		: mdtData : prototype set as written after the header
+ *				  headerInfo : header of the MDT file
+ *				  numJournalRecords : journal records contained in mdtData
+ * RETURNS		: SUCCESS or error code
+ * NOTES			: Runs on the compaction thread, it must not touch the
+ *				  prototype set
+ * CHANGE HISTROY
+ * Author			Date				Description
+ ******************************************************************************/
+int NNShapeRecognizer::writeCompactedMDTFile(const string& mdtData,
+        const stringStringMap& headerInfo, int numJournalRecords)
+{
+    LOG(LTKLogger::LTK_LOGLEVEL_DEBUG) << "Entering " <<
+        "NNShapeRecognizer::writeCompactedMDTFile()" << endl;
+
+    string tempMDTFilePath = m_nnMDTFilePath + ".tmp";
+    string journalFilePath = m_nnMDTFilePath + NN_JOURNAL_FILE_EXT;
+    string tempJournalFilePath = journalFilePath + ".tmp";
+
+    //Written in binary mode, so that the checksum of mdtData is the one
+    //addHeaderInfo() computes from the file
+    ofstream mdtFileHandle(tempMDTFilePath.c_str(), ios::out|ios::binary);
+
+    if(!mdtFileHandle)
+    {
+        LOG(LTKLogger::LTK_LOGLEVEL_ERR) << "Error: "<< EMODEL_DATA_FILE_OPEN << " " <<
+            getErrorMessage(EMODEL_DATA_FILE_OPEN) <<
+            " NNShapeRecognizer::writeCompactedMDTFile()" << endl;
+
+        LTKReturnError(EMODEL_DATA_FILE_OPEN);
+    }
+
+    mdtFileHandle.write(mdtData.data(), mdtData.size());
+    mdtFileHandle.close();
+
+    if(mdtFileHandle.fail())
+    {
+        remove(tempMDTFilePath.c_str());
+        LTKReturnError(EMODEL_DATA_FILE_OPEN);
+    }
+
+    //Adding header information	and checksum generation
+    string strModelDataHeaderInfoFile = "";
+    LTKCheckSumGenerate cheSumGen;
+
+    int returnStatus = cheSumGen.addHeaderInfo(
+            strModelDataHeaderInfoFile,
+            tempMDTFilePath,
+            headerInfo
+            );
+
+    if(returnStatus != SUCCESS)
+    {
+        remove(tempMDTFilePath.c_str());
+        LTKReturnError(returnStatus);
+    }
+
+    returnStatus = replaceFile(tempMDTFilePath, m_nnMDTFilePath);
+    if(returnStatus != SUCCESS)
+    {
+        LTKReturnError(returnStatus);
+    }
+
+    char checkSum[CKSUM_HDR_STR_LEN];
+    sprintf(checkSum, "%x", cheSumGen.getCRC(mdtData.c_str(), strlen(mdtData.c_str())));
+
+    //Start the journal over from the new MDT file, keeping the records
+    //appended while it was written
+    std::lock_guard<std::mutex> journalLock(m_journalMutex);
+
+    string remainingRecords;
+    int numRemainingRecords = 0;
+
+    if(m_journalHeaderValid)
+    {
+        ifstream journalFile(journalFilePath.c_str(), ios::in|ios::binary);
+        string journalHeader;
+        JournalRecordHeader recordHeader;
+
+        getline(journalFile, journalHeader);
+
+        for(int i = 0; i < numJournalRecords && journalFile; ++i)
+        {
+            journalFile.read((char*) &recordHeader, sizeof(recordHeader));
+            journalFile.seekg((streamoff) recordHeader.numberOfFeatures *
+                              recordHeader.featureDimension * sizeof(float), ios::cur);
+        }
+
+        if(journalFile)
+        {
+            remainingRecords.assign(istreambuf_iterator<char>(journalFile),
+                                    istreambuf_iterator<char>());
+            numRemainingRecords = m_journalNumRecords - numJournalRecords;
+        }
+    }
+
+    m_journalBaseCheckSum = checkSum;
+    m_journalHeaderValid = false;
+    m_journalNumRecords = 0;
+
+    ofstream journalFile(tempJournalFilePath.c_str(), ios::out|ios::binary);
+    journalFile << NN_JOURNAL_HEADER << " " << m_journalBaseCheckSum << "\n";
+    journalFile.write(remainingRecords.data(), remainingRecords.size());
+    journalFile.close();
+
+    if(journalFile.fail() || replaceFile(tempJournalFilePath, journalFilePath) != SUCCESS)
+    {
+        LOG(LTKLogger::LTK_LOGLEVEL_ERR) << "Error: "<< EMODEL_DATA_FILE_OPEN << " " <<
+            "Unable to write the adaptation journal" <<
+            " NNShapeRecognizer::writeCompactedMDTFile()" << endl;
+
+        LTKReturnError(EMODEL_DATA_FILE_OPEN);
+    }
+
+    m_journalHeaderValid = true;
+    m_journalNumRecords = numRemainingRecords;
+
+    LOG(LTKLogger::LTK_LOGLEVEL_DEBUG)
+        <<"Exiting NNShapeRecognizer::writeCompactedMDTFile"<<endl;
+
+    return SUCCESS;
+}
+
+/******************************************************************************
+ * NAME			: waitForJournalCompaction
+ * DESCRIPTION	: Waits for the compaction thread started by
+ *				  writePrototypeSetToMDTFile()
+ * ARGUMENTS		:
+ * RETURNS		: Status of the compaction
+ * NOTES			:
+ * CHANGE HISTROY
+ * Author			Date				Description
+ ******************************************************************************/
+int NNShapeRecognizer::waitForJournalCompaction()
+{
+    if(m_journalCompactionThread.joinable())
+    {
+        m_journalCompactionThread.join();
+    }
+
+    m_compactionPrototypeSet.clear();
+    m_compactionAdaptedPrototypeSet.clear();
+    m_compactionAdaptedPrototypeIndexMap.clear();
+    m_compactionShapeIDNumPrototypesMap.clear();
+
+    int returnStatus = m_journalCompactionStatus;
+    m_journalCompactionStatus = SUCCESS;
+
+    return returnStatus;
+}
+
+/******************************************************************************
+ * NAME			: appendToAdaptationJournal
+ * DESCRIPTION	: Appends the prototype at prototypeIndex to the journal
+ * ARGUMENTS		: recordType : NN_JOURNAL_ADD_SAMPLE or NN_JOURNAL_MORPH_SAMPLE
+ *				  prototypeIndex : index of the added or morphed prototype
+ * RETURNS		: SUCCESS or error code
+ * NOTES			: The journal is compacted into the MDT file after
+ *				  m_MDTUpdateFreq records
+ * CHANGE HISTROY
+ * Author			Date				Description
+ ******************************************************************************/
+int NNShapeRecognizer::appendToAdaptationJournal(int recordType, int prototypeIndex)
+{
+    LOG(LTKLogger::LTK_LOGLEVEL_DEBUG) << "Entering " <<
+        "NNShapeRecognizer::appendToAdaptationJournal()" << endl;
+
+    const LTKShapeSample& prototype = getPrototype(prototypeIndex);
+    const vector<LTKShapeFeaturePtr>& shapeFeatureVector = prototype.getFeatureVector();
+
+    JournalRecordHeader recordHeader;
+    recordHeader.recordType = recordType;
+    recordHeader.classId = prototype.getClassID();
+    recordHeader.ordinal = getPrototypeOrdinal(prototypeIndex);
+    recordHeader.numberOfFeatures = shapeFeatureVector.size();
+    recordHeader.featureDimension = shapeFeatureVector.empty() ? 0 :
+                                    shapeFeatureVector[0]->getFeatureDimension();
+
+    floatVector floatFeatureVector;
+    m_shapeRecUtil.shapeFeatureVectorToFloatVector(shapeFeatureVector,
+                                                   floatFeatureVector);
+
+    {
+        std::lock_guard<std::mutex> journalLock(m_journalMutex);
+
+        string journalFilePath = m_nnMDTFilePath + NN_JOURNAL_FILE_EXT;
+        ofstream journalFile;
+
+        if(m_journalHeaderValid)
+        {
+            journalFile.open(journalFilePath.c_str(), ios::out|ios::app|ios::binary);
+        }
+        else
+        {
+            //Replace a journal left from another MDT file
+            journalFile.open(journalFilePath.c_str(), ios::out|ios::trunc|ios::binary);
+            journalFile << NN_JOURNAL_HEADER << " " << m_journalBaseCheckSum << "\n";
+            m_journalNumRecords = 0;
+        }
+
+        if(!journalFile)
+        {
+            LOG(LTKLogger::LTK_LOGLEVEL_ERR) << "Error: "<< EMODEL_DATA_FILE_OPEN << " " <<
+                "Unable to open the adaptation journal" <<
+                " NNShapeRecognizer::appendToAdaptationJournal()" << endl;
+
+            LTKReturnError(EMODEL_DATA_FILE_OPEN);
+        }
+
+        m_journalHeaderValid = true;
+
+        journalFile.write((char*) &recordHeader, sizeof(recordHeader));
+        if(!floatFeatureVector.empty())
+        {
+            journalFile.write((char*) &floatFeatureVector.front(),
+                              floatFeatureVector.size() * sizeof(float));
+        }
+        journalFile.close();
+
+        if(journalFile.fail())
+        {
+            LOG(LTKLogger::LTK_LOGLEVEL_ERR) << "Error: "<< EMODEL_DATA_FILE_OPEN << " " <<
+                "Unable to write the adaptation journal" <<
+                " NNShapeRecognizer::appendToAdaptationJournal()" << endl;
+
+            LTKReturnError(EMODEL_DATA_FILE_OPEN);
+        }
+
+        ++m_journalNumRecords;
+    }
+
+    //Compact the journal into the MDT only after m_MDTUpdateFreq modifications
+    m_prototypeSetModifyCount++;
+    if(m_prototypeSetModifyCount >= m_MDTUpdateFreq)
+    {
+        int returnStatus = writePrototypeSetToMDTFile(false);
+        if(returnStatus != SUCCESS)
+        {
+            LOG(LTKLogger::LTK_LOGLEVEL_ERR)<<"Error: "<< returnStatus << " " <<
+                " NNShapeRecognizer::appendToAdaptationJournal()" << endl;
+
+            LTKReturnError(returnStatus);
+        }
+    }
+
+    LOG(LTKLogger::LTK_LOGLEVEL_DEBUG)
+        <<"Exiting NNShapeRecognizer::appendToAdaptationJournal"<<endl;
+
+    return SUCCESS;
+}
+
+/******************************************************************************
+ * NAME			: readAdaptationJournal
+ * DESCRIPTION	: Applies the journal records to the prototype set loaded
+ *				  from the MDT file
+ * ARGUMENTS		: checkSum : checksum of the loaded MDT file
+ * RETURNS		: SUCCESS or error code
+ * NOTES			: A journal written for another MDT file, e.g. before
+ *				  retraining, is ignored and replaced by the next record.
+ *				  Replay stops at an incomplete record left by an interrupted
+ *				  write, which is cut from the file.
+ * CHANGE HISTROY
+ * Author			Date				Description
+ ******************************************************************************/
+int NNShapeRecognizer::readAdaptationJournal(const string& checkSum)
+{
+    LOG(LTKLogger::LTK_LOGLEVEL_DEBUG) << "Entering " <<
+        "NNShapeRecognizer::readAdaptationJournal()" << endl;
+
+    string journalFilePath = m_nnMDTFilePath + NN_JOURNAL_FILE_EXT;
+    string journalHeader;
+    JournalRecordHeader recordHeader;
+    floatVector floatFeatureVector;
+
+    m_journalBaseCheckSum = checkSum;
+    m_journalHeaderValid = false;
+    m_journalNumRecords = 0;
+    m_prototypeSetModifyCount = 0;
+
+    ifstream journalFile(journalFilePath.c_str(), ios::in|ios::binary);
+
+    if(!journalFile)
+    {
+        return SUCCESS;
+    }
+
+    journalFile.seekg(0, ios::end);
+    streamoff journalFileSize = journalFile.tellg();
+    journalFile.seekg(0, ios::beg);
+
+    getline(journalFile, journalHeader);
+
+    if(journalHeader != string(NN_JOURNAL_HEADER) + " " + checkSum)
+    {
+        return SUCCESS;
+    }
+
+    m_journalHeaderValid = true;
+    streamoff validJournalSize = journalFile.tellg();
+
+    while(journalFile.read((char*) &recordHeader, sizeof(recordHeader)))
+    {
+        if(recordHeader.numberOfFeatures < 0 || recordHeader.featureDimension < 0 ||
+           (streamoff) recordHeader.numberOfFeatures * recordHeader.featureDimension * sizeof(float) >
+           journalFileSize - journalFile.tellg())
+        {
+            break;
+        }
+
+        floatFeatureVector.resize(recordHeader.numberOfFeatures * recordHeader.featureDimension);
+        if(!floatFeatureVector.empty() &&
+           !journalFile.read((char*) &floatFeatureVector.front(),
+                             floatFeatureVector.size() * sizeof(float)))
+        {
+            break;
+        }
+
+        vector<LTKShapeFeaturePtr> shapeFeatureVector;
+        LTKShapeFeaturePtr shapeFeature;
+        int featureIndex = 0;
+
+        for(; featureIndex < recordHeader.numberOfFeatures; ++featureIndex)
+        {
+            shapeFeature = m_ptrFeatureExtractor->getShapeFeatureInstance();
+
+            if(shapeFeature->initialize(floatFeatureVector.data() +
+                                        featureIndex * recordHeader.featureDimension,
+                                        recordHeader.featureDimension) != SUCCESS)
+            {
+                break;
+            }
+
+            shapeFeatureVector.push_back(shapeFeature);
+        }
+
+        if(featureIndex != recordHeader.numberOfFeatures)
+        {
+            break;
+        }
+
+        if(recordHeader.recordType == NN_JOURNAL_ADD_SAMPLE)
+        {
+            LTKShapeSample shapeSampleFeatures;
+            shapeSampleFeatures.setFeatureVector(shapeFeatureVector);
+            shapeSampleFeatures.setClassID(recordHeader.classId);
+
+            insertSampleToPrototypeSet(shapeSampleFeatures);
+            ++m_shapeIDNumPrototypesMap[recordHeader.classId];
+        }
+        else if(recordHeader.recordType == NN_JOURNAL_MORPH_SAMPLE)
+        {
+            int prototypeIndex = getPrototypeIndex(recordHeader.classId, recordHeader.ordinal);
+            if(prototypeIndex < 0)
+            {
+                break;
+            }
+
+            getPrototype(prototypeIndex).setFeatureVector(shapeFeatureVector);
+        }
+        else
+        {
+            break;
+        }
+
+        ++m_journalNumRecords;
+        validJournalSize = journalFile.tellg();
+    }
+
+    if(validJournalSize < journalFileSize)
+    {
+        LOG(LTKLogger::LTK_LOGLEVEL_INFO) <<
+            "Ignoring incomplete records at the end of the adaptation journal" << endl;
+
+        string validJournalData(validJournalSize, '\0');
+
+        journalFile.clear();
+        journalFile.seekg(0, ios::beg);
+        journalFile.read(&validJournalData[0], validJournalSize);
+        journalFile.close();
+
+        ofstream truncatedJournalFile(journalFilePath.c_str(), ios::out|ios::trunc|ios::binary);
+        truncatedJournalFile.write(validJournalData.data(), validJournalData.size());
+        truncatedJournalFile.close();
+
+        if(truncatedJournalFile.fail())
+        {
+            LOG(LTKLogger::LTK_LOGLEVEL_ERR) << "Error: "<< EMODEL_DATA_FILE_OPEN << " " <<
+                "Unable to write the adaptation journal" <<
+                " NNShapeRecognizer::readAdaptationJournal()" << endl;
+
+            LTKReturnError(EMODEL_DATA_FILE_OPEN);
+        }
+    }
+
+    m_prototypeSetModifyCount = m_journalNumRecords;
+
+    LOG(LTKLogger::LTK_LOGLEVEL_DEBUG)
+        <<"Exiting NNShapeRecognizer::readAdaptationJournal"<<endl;
+
+    return SUCCESS;
+}
+
+/******************************************************************************
+ * AUTHOR		: Tarun Madan
+ * DATE			: 09-06-2007
+ * NAME			: Add Sample to m_prototypeSet
+ * DESCRIPTION	: Add  LTKShapeSample to m_adaptedPrototypeSet
+ *
+ * ARGUMENTS		:
+ * RETURNS		:
+ * NOTES			: The sample gets index getNumPrototypes() - 1
+ * CHANGE HISTROY
+ * Author			Date				Description
+ ******************************************************************************/
+int NNShapeRecognizer::insertSampleToPrototypeSet(const LTKShapeSample &shapeSampleFeatures)
+{
+    LOG(LTKLogger::LTK_LOGLEVEL_DEBUG)<<
+        "Entering NNShapeRecognizer::insertSampleToPrototypeSet"<<endl;
+
+    int classID = shapeSampleFeatures.getClassID();
+
+    m_adaptedPrototypeIndexMap[classID].push_back(m_adaptedPrototypeSet.size());
+    m_adaptedPrototypeSet.push_back(shapeSampleFeatures);
+
+    LOG(LTKLogger::LTK_LOGLEVEL_DEBUG)<<"Exiting NNShapeRecognizer::insertSampleToPrototypeSet"<<endl;
+
+    return SUCCESS;
+}
+
+/******************************************************************************
+ * NAME			: mergeAdaptedPrototypes
+ * DESCRIPTION	: Moves m_adaptedPrototypeSet into m_prototypeSet, after the
+ *				  samples of the same class
+ * ARGUMENTS		:
+ * RETURNS		:
+ * NOTES			: Prototype indices cached in m_neighborInfoVec for adapt()
+ *				  are renumbered
+ * CHANGE HISTROY
+ * Author			Date				Description
+ ******************************************************************************/
+void NNShapeRecognizer::mergeAdaptedPrototypes()
+{
+    if(m_adaptedPrototypeSet.empty())
+    {
+        return;
+    }
+
+    int prototypeSetSize = m_prototypeSet.size();
+    vector<LTKShapeSample> mergedPrototypeSet;
+    intVector mergedIndices(getNumPrototypes());
+
+    mergedPrototypeSet.reserve(getNumPrototypes());
+
+    int prototypeIndex = 0;
+    intIntMap::const_iterator shapeIDNumPrototypesMapIter = m_shapeIDNumPrototypesMap.begin();
+
+    for(; shapeIDNumPrototypesMapIter != m_shapeIDNumPrototypesMap.end(); ++shapeIDNumPrototypesMapIter)
+    {
+        int classId = shapeIDNumPrototypesMapIter->first;
+
+        for(; prototypeIndex < prototypeSetSize &&
+              m_prototypeSet[prototypeIndex].getClassID() == classId; ++prototypeIndex)
+        {
+            mergedIndices[prototypeIndex] = mergedPrototypeSet.size();
+            mergedPrototypeSet.push_back(m_prototypeSet[prototypeIndex]);
+        }
+
+        map<int, intVector>::const_iterator adaptedIter = m_adaptedPrototypeIndexMap.find(classId);
+        if(adaptedIter == m_adaptedPrototypeIndexMap.end())
+        {
+            continue;
+        }
+
+        const intVector& adaptedIndices = adaptedIter->second;
+        for(int i = 0; i < adaptedIndices.size(); ++i)
+        {
+            mergedIndices[prototypeSetSize + adaptedIndices[i]] = mergedPrototypeSet.size();
+            mergedPrototypeSet.push_back(m_adaptedPrototypeSet[adaptedIndices[i]]);
+        }
+    }
+
+    m_prototypeSet.swap(mergedPrototypeSet);
+    m_adaptedPrototypeSet.clear();
+    m_adaptedPrototypeIndexMap.clear();
+
+    for(int i = 0; i < m_neighborInfoVec.size(); ++i)
+    {
+        m_neighborInfoVec[i].prototypeSetIndex = mergedIndices[m_neighborInfoVec[i].prototypeSetIndex];
+    }
+}
+
+/******************************************************************************
+ * NAME			: appendPrototypeSetToMDTFile
+ * DESCRIPTION	: Writes the MDT file contents following the header, the
+ *				  adapted prototypes after the samples of the same class
+ * ARGUMENTS		: prototypeSet, adaptedPrototypeSet, adaptedPrototypeIndexMap,
+ *				  shapeIDNumPrototypesMap : prototype set as kept by the recognizer
+ *				  mdtFileHandle : output stream
+ * RETURNS		:
+ * NOTES			: Writes the order of mergeAdaptedPrototypes() without copying
+ *				  the samples, it is called on the compaction thread
+ * CHANGE HISTROY
+ * Author			Date				Description
+ ******************************************************************************/
+void NNShapeRecognizer::appendPrototypeSetToMDTFile(const vector<LTKShapeSample>& prototypeSet,
+        const vector<LTKShapeSample>& adaptedPrototypeSet,
+        const map<int, intVector>& adaptedPrototypeIndexMap,
+        const intIntMap& shapeIDNumPrototypesMap, ostream & mdtFileHandle)
+{
+    if ( m_MDTFileOpenMode == NN_MDT_OPEN_MODE_ASCII )
+    {
+        //Write the number of Shapes
+        mdtFileHandle << 0 << endl; //Representing Dynamic
+    }
+    else
+    {
+        int numShapes = 0;
+        mdtFileHandle.write((char*) &numShapes, sizeof(unsigned short));
+    }
+
+    int prototypeSetSize = prototypeSet.size();
+    int prototypeIndex = 0;
+    intIntMap::const_iterator shapeIDNumPrototypesMapIter = shapeIDNumPrototypesMap.begin();
+
+    for(; shapeIDNumPrototypesMapIter != shapeIDNumPrototypesMap.end(); ++shapeIDNumPrototypesMapIter)
+    {
+        int classId = shapeIDNumPrototypesMapIter->first;
+
+        for(; prototypeIndex < prototypeSetSize &&
+              prototypeSet[prototypeIndex].getClassID() == classId; ++prototypeIndex)
+        {
+            appendPrototypeToMDTFile(prototypeSet[prototypeIndex], mdtFileHandle);
+        }
+
+        map<int, intVector>::const_iterator adaptedIter = adaptedPrototypeIndexMap.find(classId);
+        if(adaptedIter == adaptedPrototypeIndexMap.end())
+        {
+            continue;
+        }
+
+        const intVector& adaptedIndices = adaptedIter->second;
+        for(int i = 0; i < adaptedIndices.size(); ++i)
+        {
+            appendPrototypeToMDTFile(adaptedPrototypeSet[adaptedIndices[i]], mdtFileHandle);
+        }
+    }
+}
+
+/******************************************************************************
+ * NAME			: getNumPrototypes
+ * DESCRIPTION	: Number of prototypes, adapted ones included
+ * ARGUMENTS		:
+ * RETURNS		:
+ * NOTES			:
+ * CHANGE HISTROY
+ * Author			Date				Description
+ ******************************************************************************/
+int NNShapeRecognizer::getNumPrototypes() const
+{
+    return m_prototypeSet.size() + m_adaptedPrototypeSet.size();
+}
+
+/******************************************************************************
+ * NAME			: getPrototype
+ * DESCRIPTION	: Prototype at prototypeIndex, indices past the end of
+ *				  m_prototypeSet address m_adaptedPrototypeSet
+ * ARGUMENTS		:
+ * RETURNS		:
+ * NOTES			:
+ * CHANGE HISTROY
+ * Author			Date				Description
+ ******************************************************************************/
+LTKShapeSample& NNShapeRecognizer::getPrototype(int prototypeIndex)
+{
+    int prototypeSetSize = m_prototypeSet.size();
+
+    if(prototypeIndex < prototypeSetSize)
+    {
+        return m_prototypeSet[prototypeIndex];
+    }
+
+    return m_adaptedPrototypeSet[prototypeIndex - prototypeSetSize];
+}
+
+static bool lessSampleClassID(const LTKShapeSample& shapeSample, int classId)
+{
+    return shapeSample.getClassID() < classId;
+}
+
+static bool lessClassIDSample(int classId, const LTKShapeSample& shapeSample)
+{
+    return classId < shapeSample.getClassID();
+}
+
+/******************************************************************************
+ * NAME			: getBasePrototypeRange
+ * DESCRIPTION	: Range of the samples of classId in m_prototypeSet
+ * ARGUMENTS		:
+ * RETURNS		:
+ * NOTES			: m_prototypeSet is sorted by class ID
+ * CHANGE HISTROY
+ * Author			Date				Description
+ ******************************************************************************/
+void NNShapeRecognizer::getBasePrototypeRange(int classId, int& outBegin, int& outEnd)
+{
+    outBegin = lower_bound(m_prototypeSet.begin(), m_prototypeSet.end(),
+                           classId, lessSampleClassID) - m_prototypeSet.begin();
+    outEnd = upper_bound(m_prototypeSet.begin() + outBegin, m_prototypeSet.end(),
+                         classId, lessClassIDSample) - m_prototypeSet.begin();
+}
+
+/******************************************************************************
+ * NAME			: getPrototypeOrdinal
+ * DESCRIPTION	: Position of the prototype at prototypeIndex among the
+ *				  prototypes of its class
+ * ARGUMENTS		:
+ * RETURNS		:
+ * NOTES			: Adapted prototypes follow the ones of m_prototypeSet, the
+ *				  order mergeAdaptedPrototypes() keeps
+ * CHANGE HISTROY
+ * Author			Date				Description
+ ******************************************************************************/
+int NNShapeRecognizer::getPrototypeOrdinal(int prototypeIndex)
+{
+    int prototypeSetSize = m_prototypeSet.size();
+    int classId = getPrototype(prototypeIndex).getClassID();
+    int classBegin, classEnd;
+
+    getBasePrototypeRange(classId, classBegin, classEnd);
+
+    if(prototypeIndex < prototypeSetSize)
+    {
+        return prototypeIndex - classBegin;
+    }
+
+    const intVector& adaptedIndices = m_adaptedPrototypeIndexMap[classId];
+
+    return (classEnd - classBegin) +
+           (find(adaptedIndices.begin(), adaptedIndices.end(),
+                 prototypeIndex - prototypeSetSize) - adaptedIndices.begin());
+}
+
+/******************************************************************************
+ * NAME			: getPrototypeIndex
+ * DESCRIPTION	: Index of the ordinal-th prototype of classId
+ * ARGUMENTS		:
+ * RETURNS		: -1 if classId has no such prototype
+ * NOTES			:
+ * CHANGE HISTROY
+ * Author			Date				Description
+ ******************************************************************************/
+int NNShapeRecognizer::getPrototypeIndex(int classId, int ordinal)
+{
+    int classBegin, classEnd;
+
+    getBasePrototypeRange(classId, classBegin, classEnd);
+
+    if(ordinal < 0)
+    {
+        return -1;
+    }
+
+    if(ordinal < classEnd - classBegin)
+    {
+        return classBegin + ordinal;
+    }
+
+    ordinal -= classEnd - classBegin;
+
+    map<int, intVector>::const_iterator adaptedIter = m_adaptedPrototypeIndexMap.find(classId);
+    if(adaptedIter == m_adaptedPrototypeIndexMap.end() || ordinal >= adaptedIter->second.size())
+    {
+        return -1;
+    }
+
+    return m_prototypeSet.size() + adaptedIter->second[ordinal];
+}
+
+/******************************************************************************
+ * NAME			: getPrototypeIndices
+ * DESCRIPTION	: Indices of the prototypes of the classes in subSetOfClasses,
+ *				  of all prototypes if it is empty
+ * ARGUMENTS		: subSetOfClasses : sorted class IDs
+ * RETURNS		:
+ * NOTES			:
+ * CHANGE HISTROY
+ * Author			Date				Description
+ ******************************************************************************/
+void NNShapeRecognizer::getPrototypeIndices(const vector<int>& subSetOfClasses,
+        vector<int>& outPrototypeIndices)
+{
+    int prototypeSetSize = m_prototypeSet.size();
+
+    outPrototypeIndices.clear();
+
+    if(subSetOfClasses.empty())
+    {
+        outPrototypeIndices.resize(getNumPrototypes());
+        for(int i = 0; i < outPrototypeIndices.size(); ++i)
+        {
+            outPrototypeIndices[i] = i;
+        }
+        return;
+    }
+
+    for(int i = 0; i < subSetOfClasses.size(); ++i)
+    {
+        int classBegin, classEnd;
+
+        getBasePrototypeRange(subSetOfClasses[i], classBegin, classEnd);
+
+        for(int j = classBegin; j < classEnd; ++j)
+        {
+            outPrototypeIndices.push_back(j);
+        }
+
+        map<int, intVector>::const_iterator adaptedIter =
+            m_adaptedPrototypeIndexMap.find(subSetOfClasses[i]);
+
+        if(adaptedIter != m_adaptedPrototypeIndexMap.end())
+        {
+            for(int j = 0; j < adaptedIter->second.size(); ++j)
+            {
+                outPrototypeIndices.push_back(prototypeSetSize + adaptedIter->second[j]);
+            }
+        }
+    }
+}
+
+/******************************************************************************
+ * AUTHOR                : Vandana Roy
+ * DATE                  : 05-07-2007
  * NAME                  : computeConfidence
  * DESCRIPTION   :
  * ARGUMENTS             :
@@ -4158,41 +4765,24 @@ int NNShapeRecognizer::getTraceGroups(int shapeID, int numberOfTraceGroups,
             << numberOfTraceGroups <<endl;
     }
 
-    vector<LTKShapeSample>::iterator prototypeSetIter = m_prototypeSet.begin();
-    int counter =0;
-    for(;prototypeSetIter!=m_prototypeSet.end();)
+    vector<int> prototypeIndices;
+    getPrototypeIndices(vector<int>(1, shapeID), prototypeIndices);
+
+    for(int counter = 0; counter < numberOfTraceGroups; ++counter)
     {
-        int currentShapeId = (*prototypeSetIter).getClassID();
+        LTKTraceGroup traceGroup;
 
-        if(currentShapeId == shapeID)
+        int errorCode = m_ptrFeatureExtractor->convertFeatVecToTraceGroup(
+                getPrototype(prototypeIndices[counter]).getFeatureVector(),
+                traceGroup);
+        if(errorCode != SUCCESS)
         {
-            LTKTraceGroup traceGroup;
-
-            int errorCode = m_ptrFeatureExtractor->convertFeatVecToTraceGroup(
-                    (*prototypeSetIter).getFeatureVector(),
-                    traceGroup);
-            if(errorCode != SUCCESS)
-            {
-                LOG(LTKLogger::LTK_LOGLEVEL_ERR)<<"Error: "<< errorCode << " " <<
-                    " NNShapeRecognizer::getTraceGroups()" << endl;
-
-                LTKReturnError(errorCode);
-            }
-            outTraceGroups.push_back(traceGroup);
-
-            counter++;
-            if(counter==numberOfTraceGroups)
-                break;
+            LOG(LTKLogger::LTK_LOGLEVEL_ERR)<<"Error: "<< errorCode << " " <<
+                " NNShapeRecognizer::getTraceGroups()" << endl;
 
-            prototypeSetIter++;
-        }
-        else
-        {
-            //To point to first sample of next classID
-            int offset = m_shapeIDNumPrototypesMap[currentShapeId];
-            prototypeSetIter = prototypeSetIter + offset;
+            LTKReturnError(errorCode);
         }
-
+        outTraceGroups.push_back(traceGroup);
     }
 
     LOG(LTKLogger::LTK_LOGLEVEL_DEBUG)
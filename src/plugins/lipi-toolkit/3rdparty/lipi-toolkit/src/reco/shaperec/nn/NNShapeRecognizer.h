@@ -51,6 +51,9 @@
 #include "LTKCheckSumGenerate.h"
 #include "LTKDynamicTimeWarping.h"
 
+#include <mutex>
+#include <thread>
+
 /**            Forward declaration of classes          */
 class LTKTraceGroup;
 class LTKPreprocessorInterface;
@@ -61,6 +64,12 @@ class LTKShapeFeature;
 #define SIMILARITY(distance) (1 / (distance + EPS ))
 #define SUPPORTED_MIN_VERSION "3.0.0"
 
+// Adaptation journal, appended next to the MDT file
+#define NN_JOURNAL_FILE_EXT ".journal"
+#define NN_JOURNAL_HEADER "LTKNNJOURNAL"
+#define NN_JOURNAL_ADD_SAMPLE 1
+#define NN_JOURNAL_MORPH_SAMPLE 2
+
 class LTKAdapt;
 
 typedef int (*FN_PTR_LOCAL_DISTANCE)(LTKShapeFeaturePtr, LTKShapeFeaturePtr,float&);
@@ -277,6 +286,23 @@ class NNShapeRecognizer: public LTKShapeRecognizer
          *     </p>
          */
 
+        vector<LTKShapeSample> m_adaptedPrototypeSet;
+        /**< @brief Prototypes added by adapt, addClass and addSample
+         *     <p>
+         *     Appended here instead of being inserted into m_prototypeSet, which
+         *     stays sorted by class ID until the next compaction of the journal.
+         *     A prototype index i >= m_prototypeSet.size() refers to
+         *     m_adaptedPrototypeSet[i - m_prototypeSet.size()]
+         *     </p>
+         */
+
+        map<int, intVector> m_adaptedPrototypeIndexMap;
+        /**< @brief Map of shapeID and indices of its samples in m_adaptedPrototypeSet
+         *     <p>
+         *
+         *     </p>
+         */
+
         LTKCaptureDevice m_captureDevice;
 
         struct NeighborInfo
@@ -286,6 +312,22 @@ class NNShapeRecognizer: public LTKShapeRecognizer
             int prototypeSetIndex;
         };
 
+        struct JournalRecordHeader
+        {
+            int recordType;
+            int classId;
+            int ordinal;
+            int numberOfFeatures;
+            int featureDimension;
+        };
+        /**< @brief Start of a record in the adaptation journal
+         *     <p>
+         *     Followed by numberOfFeatures * featureDimension floats. ordinal is
+         *     the position of the prototype among the prototypes of classId,
+         *     which is kept when the journal is compacted into the MDT file
+         *     </p>
+         */
+
         /*
            struct MapModFunc
            {
@@ -299,7 +341,7 @@ class NNShapeRecognizer: public LTKShapeRecognizer
         intIntMap m_shapeIDNumPrototypesMap;
         /**< @brief Map of shapeID and Number of Samples per shape
          *     <p>
-         *
+         *     Counts both the samples in m_prototypeSet and in m_adaptedPrototypeSet
          *     </p>
          */
 
@@ -307,7 +349,7 @@ class NNShapeRecognizer: public LTKShapeRecognizer
         /**< @brief
          *     <p>
          *     Used to count number of modifications done to m_prototypeSet.
-         *   Write to MDT after m_prototypeModifyCntCFG such modifications or at Exit.
+         *   Compact the journal into the MDT after m_MDTUpdateFreq such modifications.
          *     </p>
          */
 
@@ -319,6 +361,78 @@ class NNShapeRecognizer: public LTKShapeRecognizer
          *     </p>
          */
 
+        string m_journalBaseCheckSum;
+        /**< @brief Checksum of the MDT file the adaptation journal applies to
+         *     <p>
+         *     Written in the journal header, a journal of another MDT file is ignored
+         *     </p>
+         */
+
+        bool m_journalHeaderValid;
+        /**< @brief True if the journal file on disk starts with m_journalBaseCheckSum
+         *     <p>
+         *     If false, the next record truncates the journal and writes a new header
+         *     </p>
+         */
+
+        int m_journalNumRecords;
+        /**< @brief Number of records in the journal file on disk
+         *     <p>
+         *
+         *     </p>
+         */
+
+        int m_journalCompactionStatus;
+        /**< @brief Return status of the last compaction of the journal
+         *     <p>
+         *
+         *     </p>
+         */
+
+        std::thread m_journalCompactionThread;
+        /**< @brief Writes the compacted MDT file in the background
+         *     <p>
+         *
+         *     </p>
+         */
+
+        vector<LTKShapeSample> m_compactionPrototypeSet;
+        /**< @brief Snapshot of m_prototypeSet written by the compaction thread
+         *     <p>
+         *     The snapshot shares the features of the prototype set. It is only
+         *     copied and released on the calling thread, the compaction thread
+         *     reads it
+         *     </p>
+         */
+
+        vector<LTKShapeSample> m_compactionAdaptedPrototypeSet;
+        /**< @brief Snapshot of m_adaptedPrototypeSet written by the compaction thread
+         *     <p>
+         *
+         *     </p>
+         */
+
+        map<int, intVector> m_compactionAdaptedPrototypeIndexMap;
+        /**< @brief Snapshot of m_adaptedPrototypeIndexMap used by the compaction thread
+         *     <p>
+         *
+         *     </p>
+         */
+
+        intIntMap m_compactionShapeIDNumPrototypesMap;
+        /**< @brief Snapshot of m_shapeIDNumPrototypesMap used by the compaction thread
+         *     <p>
+         *
+         *     </p>
+         */
+
+        std::mutex m_journalMutex;
+        /**< @brief Guards the journal file and its state against the compaction thread
+         *     <p>
+         *
+         *     </p>
+         */
+
         //Cache Parameters used by Adapt
         vector<LTKShapeRecoResult> m_vecRecoResult;
         /**< @brief Store Recognize results
@@ -370,8 +484,6 @@ class NNShapeRecognizer: public LTKShapeRecognizer
 
         string m_MDTFileOpenMode;
 
-     DynamicTimeWarping<LTKShapeFeaturePtr, float> m_dtwObj;
-
     public:
 
         /** @name Constructors and Destructor */
@@ -725,7 +837,7 @@ class NNShapeRecognizer: public LTKShapeRecognizer
                                      float& outEuclideanDistance);
 
      int calculateMedian(const int2DVector& clusteringResult,
-          const float2DVector& distanceMatrix, vector<int>& outMedianIndexVec);
+          const floatVector& distanceMatrix, int numSamples, vector<int>& outMedianIndexVec);
 
 
 
@@ -903,14 +1015,26 @@ class NNShapeRecognizer: public LTKShapeRecognizer
          *
          *
          * @param resultVector          : ShapeSampleVector : A vector of ShapeSamples created as a result of training
-         *           mdtFileHandle      : ofstream            : Specifies the outut stream
+         *           mdtFileHandle      : ostream             : Specifies the outut stream
          *
          * @return none
          *
          * @exception none
          */
 
-        int appendPrototypesToMDTFile(const vector<LTKShapeSample>& prototypeVec, ofstream & mdtFileHandle);
+        int appendPrototypesToMDTFile(const vector<LTKShapeSample>& prototypeVec, ostream & mdtFileHandle);
+
+        /**
+         * This method writes the class ID and the features of a prototype to the MDT file
+         *
+         * @param prototype     : LTKShapeSample : Prototype to write
+         *        mdtFileHandle : ostream        : Specifies the output stream
+         *
+         * @return none
+         *
+         * @exception none
+         */
+        void appendPrototypeToMDTFile(const LTKShapeSample& prototype, ostream & mdtFileHandle);
 
         static bool sortDist(const NeighborInfo& x, const NeighborInfo& y);
 
@@ -944,22 +1068,28 @@ class NNShapeRecognizer: public LTKShapeRecognizer
          *
          * Semantics
          *
+         *     - Wait for the previous compaction to finish
+         *     - Merge m_adaptedPrototypeSet into m_prototypeSet
+         *     - Write the MDT file and drop the compacted records from the journal,
+         *       on a background thread unless waitForCompletion is true
          *
-         * @param None
+         * @param waitForCompletion : bool : Write the MDT file before returning
          *
-         * @return None
+         * @return SUCCESS:  if the MDT file was written or the compaction was started
+         *         FAILURE:  return ErrorCode
          *
          * @exception none
          */
-        int writePrototypeSetToMDTFile();
+        int writePrototypeSetToMDTFile(bool waitForCompletion);
 
         /**
          * This method adds Sample To Prototype
          *
          * Semantics
          *
-         *     - Add data in ascending order to ShapeID
-         *     -
+         *     - Append the sample to m_adaptedPrototypeSet, its index is
+         *       getNumPrototypes() - 1
+         *     - Add the index to m_adaptedPrototypeIndexMap
          *
          * @param shapeSampleFeatures   : LTKShapeSample : Holds features of sample to be added to PrototypeSet
          *
@@ -969,6 +1099,121 @@ class NNShapeRecognizer: public LTKShapeRecognizer
          */
         int insertSampleToPrototypeSet(const LTKShapeSample &shapeSampleFeatures);
 
+        /**
+         * This method returns the number of prototypes, adapted ones included
+         */
+        int getNumPrototypes() const;
+
+        /**
+         * This method returns the prototype at prototypeIndex, indices past
+         * the end of m_prototypeSet address m_adaptedPrototypeSet
+         */
+        LTKShapeSample& getPrototype(int prototypeIndex);
+
+        /**
+         * This method returns the range [outBegin, outEnd) of the samples of
+         * classId in m_prototypeSet
+         */
+        void getBasePrototypeRange(int classId, int& outBegin, int& outEnd);
+
+        /**
+         * This method returns the position of the prototype at prototypeIndex
+         * among the prototypes of its class
+         */
+        int getPrototypeOrdinal(int prototypeIndex);
+
+        /**
+         * This method returns the index of the ordinal-th prototype of classId,
+         * or -1 if there is no such prototype
+         */
+        int getPrototypeIndex(int classId, int ordinal);
+
+        /**
+         * This method collects the indices of the prototypes of the given classes
+         *
+         * @param subSetOfClasses      : vector<int> : Sorted class IDs, all classes if empty
+         * @param outPrototypeIndices : vector<int> : Prototype indices of these classes
+         *
+         * @return none
+         * @exception none
+         */
+        void getPrototypeIndices(const vector<int>& subSetOfClasses,
+                vector<int>& outPrototypeIndices);
+
+        /**
+         * This method appends a record for the prototype at prototypeIndex to the
+         * adaptation journal, and compacts the journal every m_MDTUpdateFreq records
+         *
+         * @param recordType     : int : NN_JOURNAL_ADD_SAMPLE or NN_JOURNAL_MORPH_SAMPLE
+         * @param prototypeIndex : int : Index of the added or morphed prototype
+         *
+         * @return SUCCESS:  if the record was written
+         *         FAILURE:  return ErrorCode
+         * @exception none
+         */
+        int appendToAdaptationJournal(int recordType, int prototypeIndex);
+
+        /**
+         * This method replays the adaptation journal on top of the loaded MDT file
+         *
+         * Semantics
+         *
+         *     - Ignore the journal if it was written for another MDT file
+         *     - Apply records up to the first incomplete one, and cut the journal there
+         *
+         * @param checkSum : string : Checksum from the header of the loaded MDT file
+         *
+         * @return SUCCESS:  if the journal was read or there is none
+         *         FAILURE:  return ErrorCode
+         * @exception none
+         */
+        int readAdaptationJournal(const string& checkSum);
+
+        /**
+         * This method moves m_adaptedPrototypeSet into m_prototypeSet, keeping it
+         * sorted by class ID, and renumbers the indices cached in m_neighborInfoVec
+         */
+        void mergeAdaptedPrototypes();
+
+        /**
+         * This method writes the MDT file contents following the header in the
+         * order of mergeAdaptedPrototypes(), without modifying the prototype set
+         *
+         * @param prototypeSet             : vector<LTKShapeSample> : Samples sorted by class ID
+         *        adaptedPrototypeSet      : vector<LTKShapeSample> : Adapted samples
+         *        adaptedPrototypeIndexMap : map<int, intVector>    : Indices of the adapted samples of each class
+         *        shapeIDNumPrototypesMap  : intIntMap              : Number of samples of each class
+         *        mdtFileHandle            : ostream                : Specifies the output stream
+         *
+         * @return none
+         *
+         * @exception none
+         */
+        void appendPrototypeSetToMDTFile(const vector<LTKShapeSample>& prototypeSet,
+                const vector<LTKShapeSample>& adaptedPrototypeSet,
+                const map<int, intVector>& adaptedPrototypeIndexMap,
+                const intIntMap& shapeIDNumPrototypesMap, ostream & mdtFileHandle);
+
+        /**
+         * This method writes the serialized prototype set to the MDT file and
+         * removes the first numJournalRecords records from the journal
+         *
+         * @param mdtData           : string          : Prototype set as written after the header
+         * @param headerInfo        : stringStringMap : Header of the MDT file
+         * @param numJournalRecords : int             : Journal records contained in mdtData
+         *
+         * @return SUCCESS:  if the MDT file and the journal were written
+         *         FAILURE:  return ErrorCode
+         * @exception none
+         */
+        int writeCompactedMDTFile(const string& mdtData, const stringStringMap& headerInfo,
+                int numJournalRecords);
+
+        /**
+         * This method waits for the background compaction and returns its status
+         */
+        int waitForJournalCompaction();
+
         /**
          * This method computes the confidences of test sample belonging to various classes
          *
@@ -107,10 +107,21 @@ void LTKCheckSumGenerate::initCRC32Table()
 	// 256 values representing ASCII character codes.
 	for(int i = 0; i <= 0xFF; i++)
 	{
-		m_CRC32Table[i]=reflect(i, 8) << 24;
+		m_CRC32Table[0][i]=reflect(i, 8) << 24;
 		for (int j = 0; j < 8; j++)
-			m_CRC32Table[i] = (m_CRC32Table[i] << 1) ^ (m_CRC32Table[i] & (1 << 31) ? ulPolynomial : 0);
-		m_CRC32Table[i] = reflect(m_CRC32Table[i], 32);
+			m_CRC32Table[0][i] = (m_CRC32Table[0][i] << 1) ^ (m_CRC32Table[0][i] & (1 << 31) ? ulPolynomial : 0);
+		m_CRC32Table[0][i] = reflect(m_CRC32Table[0][i], 32);
+	}
+
+	// Tables for slicing-by-8: m_CRC32Table[k][i] is the CRC of byte i
+	// followed by k zero bytes.
+	for(int k = 1; k < 8; k++)
+	{
+		for(int i = 0; i <= 0xFF; i++)
+		{
+			unsigned int prev = m_CRC32Table[k - 1][i];
+			m_CRC32Table[k][i] = (prev >> 8) ^ m_CRC32Table[0][prev & 0xFF];
+		}
 	}
 	LOG( LTKLogger::LTK_LOGLEVEL_DEBUG) << 
         " Exiting: LTKCheckSumGenerate::initCRC32Table()" << endl;
@@ -163,39 +174,64 @@ unsigned int LTKCheckSumGenerate::reflect(unsigned int ref, char ch)
 *************************************************************************************/
 int LTKCheckSumGenerate::getCRC(string& text) 
 {
-	  // Pass a text string to this function and it will return the CRC. 
-
-      // Once the lookup table has been filled in by the two functions above, 
-      // this function creates all CRCs using only the lookup table. 
-
-      // Be sure to use unsigned variables, 
-      // because negative values introduce high bits 
-      // where zero bits are required. 
+	return getCRC(text.c_str(), text.size());
+}
 
-      // Start out with all bits set high. 
-  	LOG( LTKLogger::LTK_LOGLEVEL_DEBUG) << 
+/**********************************************************************************
+* NAME			: getCRC
+* DESCRIPTION	: Function to generate the checkSum of a memory block.
+* ARGUMENTS		: data - start of the block
+*				  length - number of bytes in the block
+* RETURNS		: checksum of the block
+* NOTES			: Processes eight bytes per step using the slicing-by-8
+*				  tables. The result is the same as the byte-wise algorithm.
+* CHANGE HISTROY
+* Author			Date				Description
+*************************************************************************************/
+int LTKCheckSumGenerate::getCRC(const char* data, size_t length)
+{
+	LOG( LTKLogger::LTK_LOGLEVEL_DEBUG) << 
 		 " Entering: LTKCheckSumGenerate::getCRC()" << endl;
-      unsigned int  ulCRC(0xffffffff); 
 
-      // Get the length. 
-      int len = text.size(); 
+	// Start out with all bits set high. 
+	unsigned int ulCRC(0xffffffff);
 
-	  // Save the text in the buffer. 
-      unsigned char* buffer = (unsigned char*)text.c_str(); 
+	const unsigned char* buffer = (const unsigned char*)data;
 
-	  // Perform the algorithm on each character 
-      // in the string, using the lookup table values. 
-      while(len--)
-	  { 
-          ulCRC = (ulCRC >> 8) ^ m_CRC32Table[(ulCRC & 0xFF) ^ *buffer++]; 
-      }
+	// The words are assembled byte by byte, so the result does not
+	// depend on the byte order of the host.
+	while(length >= 8)
+	{
+		unsigned int one = ulCRC ^ (buffer[0] | (buffer[1] << 8) |
+		                            (buffer[2] << 16) | ((unsigned int)buffer[3] << 24));
+		unsigned int two = buffer[4] | (buffer[5] << 8) |
+		                   (buffer[6] << 16) | ((unsigned int)buffer[7] << 24);
+
+		ulCRC = m_CRC32Table[7][one & 0xFF] ^
+		        m_CRC32Table[6][(one >> 8) & 0xFF] ^
+		        m_CRC32Table[5][(one >> 16) & 0xFF] ^
+		        m_CRC32Table[4][one >> 24] ^
+		        m_CRC32Table[3][two & 0xFF] ^
+		        m_CRC32Table[2][(two >> 8) & 0xFF] ^
+		        m_CRC32Table[1][(two >> 16) & 0xFF] ^
+		        m_CRC32Table[0][two >> 24];
+
+		buffer += 8;
+		length -= 8;
+	}
+
+	// Remaining bytes.
+	while(length--)
+	{
+		ulCRC = (ulCRC >> 8) ^ m_CRC32Table[0][(ulCRC & 0xFF) ^ *buffer++];
+	}
 
 	LOG( LTKLogger::LTK_LOGLEVEL_DEBUG) << 
 		 " Exiting: LTKCheckSumGenerate::getCRC()" << endl;
 
-	  // Exclusive OR the result with the beginning value. 
-      return ulCRC ^ 0xffffffff; 
-} 
+	// Exclusive OR the result with the beginning value. 
+	return ulCRC ^ 0xffffffff;
+}
 
 /**********************************************************************************
 * AUTHOR		: Srinivasa Vithal
@@ -288,10 +324,8 @@ int LTKCheckSumGenerate::addHeaderInfo(const string& modelDataHeaderInfoFilePath
 
 	readFile.close();
 
-	string szBuf(modelFileData);   
-
 	//Caluculate Checksum for the Modiel File Data.
-	nCRC = getCRC(szBuf);
+	nCRC = getCRC(modelFileData, strlen(modelFileData));
 
 	//Convert the check sum into Hexadecimal Value.
 	sprintf(chSum, "%x", nCRC);
@@ -467,15 +501,37 @@ stringStringMap LTKCheckSumGenerate::updateHeaderWithMandatoryFields(const strin
 *****************************************************************************/
 int LTKCheckSumGenerate::readMDTHeader(const string &mdtFilePath,
                                              stringStringMap &headerSequence)
+{
+	LTKMDTBuffer mdtBuffer;
+
+	return readMDTHeader(mdtFilePath, headerSequence, mdtBuffer);
+}
+
+/****************************************************************************
+* NAME			: readMDTHeader
+* DESCRIPTION	: Reads the whole model data file into mdtBuffer, parses the
+*				  header and checks the file integrity.
+* ARGUMENTS		: mdtFilePath - model data file
+*				  headerSequence - receives the header keys and values
+*				  mdtBuffer - receives the content of the file
+* RETURNS		: SUCCESS on success, otherwise the error code
+* NOTES			: The checksum covers the data following the header up to
+*				  the first null byte, as computed by addHeaderInfo().
+*				  Successful verifications are recorded in a sidecar file
+*				  and not repeated while the file stays the same.
+* CHANGE HISTROY
+* Author			Date				Description
+*****************************************************************************/
+int LTKCheckSumGenerate::readMDTHeader(const string &mdtFilePath,
+                                             stringStringMap &headerSequence,
+                                             LTKMDTBuffer &mdtBuffer)
 {
 	LOG( LTKLogger::LTK_LOGLEVEL_DEBUG) << 
 		 " Entering: LTKCheckSumGenerate::readMDTHeader()" << endl;
 
 	int headerLen, nCRC;
-	
-	long dSize, actDataSize;
-	
-	char chSum[CKSUM_HDR_STR_LEN], *sbuf,*headerData, headerInfo[51];
+
+	char chSum[CKSUM_HDR_STR_LEN];
 
 	stringVector strTokens;
 
@@ -490,11 +546,48 @@ int LTKCheckSumGenerate::readMDTHeader(const string &mdtFilePath,
 		LTKReturnError(EMODEL_DATA_FILE_OPEN);
 	}	
 
+	// Identify the file before reading it, so that a later modification
+	// never matches the recorded verification.
+	string fileIdentity;
+	bool hasFileIdentity = (m_OSUtilPtr->getFileIdentity(mdtFilePath, fileIdentity) == SUCCESS);
+
+	// get the file size in bytes and read the whole file at once
+	mdtFileHandle.seekg(0, ios::end);
+	long dSize = mdtFileHandle.tellg();
+	mdtFileHandle.seekg(0, ios::beg);
+
+	vector<char>& data = mdtBuffer.data();
+	data.resize(dSize > 0 ? dSize : 0);
 
-	mdtFileHandle.read(headerInfo, 50);
+	if(dSize > 0)
+		mdtFileHandle.read(&data[0], dSize);
 
-	char *ptr = strstr(headerInfo, HEADERLEN);
-	if(ptr == NULL)
+	if(!mdtFileHandle)
+	{
+		LOG( LTKLogger::LTK_LOGLEVEL_ERR)  
+			<<"Error : "<< EMODEL_DATA_FILE_OPEN <<":"<< getErrorMessage(EMODEL_DATA_FILE_OPEN)
+            <<"LTKCheckSumGenerate::readMDTHeader()" <<endl;
+
+		LTKReturnError(EMODEL_DATA_FILE_OPEN);
+	}
+
+	mdtFileHandle.close();
+
+	mdtBuffer.reset();
+
+	// The header length is stored within the first 50 bytes.
+	string headerInfo(data.begin(), data.begin() + min(dSize, 50L));
+
+	string::size_type headerLenPos = headerInfo.find(HEADERLEN);
+	string::size_type headerLenEnd = string::npos;
+	if(headerLenPos != string::npos)
+	{
+		headerLenPos = headerInfo.find('=', headerLenPos);
+		if(headerLenPos != string::npos)
+			headerLenEnd = headerInfo.find('>', headerLenPos);
+	}
+
+	if(headerLenEnd == string::npos)
 	{
 		LOG( LTKLogger::LTK_LOGLEVEL_ERR) 
 			<<"Error : "<< EMODEL_DATA_FILE_FORMAT <<":"<< getErrorMessage(EMODEL_DATA_FILE_FORMAT)
@@ -503,11 +596,9 @@ int LTKCheckSumGenerate::readMDTHeader(const string &mdtFilePath,
 		LTKReturnError(EMODEL_DATA_FILE_FORMAT);
 	}
 
-	strtok(ptr, "=");
+	headerLen = atoi(headerInfo.substr(headerLenPos + 1, headerLenEnd - headerLenPos - 1).c_str());
 
-	char *headerLenPtr = strtok( NULL , ">" );
-	
-	if(headerLenPtr == NULL)
+	if(headerLen <= 0 || headerLen > dSize)
 	{
 		LOG( LTKLogger::LTK_LOGLEVEL_ERR)
 			<<"Error : "<< EMODEL_DATA_FILE_FORMAT <<":"<< getErrorMessage(EMODEL_DATA_FILE_FORMAT)
@@ -516,15 +607,7 @@ int LTKCheckSumGenerate::readMDTHeader(const string &mdtFilePath,
 		LTKReturnError(EMODEL_DATA_FILE_FORMAT);
 	}
 
-	headerLen = atoi(headerLenPtr);
-
-	mdtFileHandle.seekg(0, ios::beg);
-
-	headerData = new char [headerLen+1];
-
-	memset(headerData, '\0', headerLen+1);
-
-	mdtFileHandle.read(headerData, headerLen);	
+	string headerData(&data[0], headerLen);
 
 	LTKStringUtil::tokenizeString(headerData,  TOKENIZE_DELIMITER,  strTokens);
 
@@ -535,45 +618,55 @@ int LTKCheckSumGenerate::readMDTHeader(const string &mdtFilePath,
 		headerSequence[strTokens.at(indx)] = strTokens.at(indx+1);	
 	}
 
-	// get the file size in bytes
-	mdtFileHandle.seekg(0,ios::beg);
-	mdtFileHandle.seekg(0, ios::end);
-	dSize = mdtFileHandle.tellg();
-
-	//Size fo the actual data excluding Header size.
-	actDataSize=dSize-headerLen+1;
-
 	string cks = headerSequence[CKS];
 
-	//Allocate memory to read the actual data.
-	sbuf = new char[actDataSize];
-	memset(sbuf, '\0', actDataSize);
-	
-	//Read the file.
-	mdtFileHandle.seekg(headerLen, ios::beg);
-	mdtFileHandle.read(sbuf, actDataSize);
+	// Skip the checksum if this exact file was verified before.
+	string sidecarPath = mdtFilePath + ".cks";
+	string verifiedRecord;
 
-	//Close the file.	
-	mdtFileHandle.close();
+	if(hasFileIdentity)
+	{
+		verifiedRecord = fileIdentity + " " + cks;
+
+		ifstream sidecarHandle(sidecarPath.c_str(), ios::in);
+		string sidecarRecord;
+		if(sidecarHandle && getline(sidecarHandle, sidecarRecord) &&
+		   sidecarRecord == verifiedRecord)
+		{
+			LOG( LTKLogger::LTK_LOGLEVEL_DEBUG) << 
+				 " Exiting: LTKCheckSumGenerate::readMDTHeader() (verified)" << endl;
 
-	string szBuf(sbuf);
+			return SUCCESS;
+		}
+	}
 
 	//Caluculate Checksum for the Model File Data.
-	nCRC = getCRC(szBuf);
-	sprintf(chSum, "%x", nCRC);
+	const char* modelData = &data[0] + headerLen;
+	const void* modelDataEnd = memchr(modelData, '\0', dSize - headerLen);
+	size_t modelDataLen = modelDataEnd ? (const char*)modelDataEnd - modelData
+	                                   : dSize - headerLen;
 
-	delete [] sbuf;
-	delete [] headerData;
+	nCRC = getCRC(modelData, modelDataLen);
+	sprintf(chSum, "%x", nCRC);
 
 	if(strcmp(cks.c_str(), chSum) != 0)
 	{
 		LOG( LTKLogger::LTK_LOGLEVEL_ERR)
 			<<"Error : "<< EINVALID_INPUT_FORMAT <<":"<< getErrorMessage(EINVALID_INPUT_FORMAT)
-			<<"LTKCheckSumGenerate::readMDTHeade()r"<<endl;
+			<<"LTKCheckSumGenerate::readMDTHeader()"<<endl;
 		LTKReturnError(EINVALID_INPUT_FORMAT);
 	}
+
+	// Record the verification, if the location is writable.
+	if(!verifiedRecord.empty())
+	{
+		ofstream sidecarHandle(sidecarPath.c_str(), ios::out | ios::trunc);
+		if(sidecarHandle)
+			sidecarHandle << verifiedRecord << endl;
+	}
+
 	LOG( LTKLogger::LTK_LOGLEVEL_DEBUG) << 
 		 " Exiting: LTKCheckSumGenerate::readMDTHeader()" << endl;
 
 	return SUCCESS;
-}
\ No newline at end of file
+}
@@ -60,11 +60,67 @@ const int BUFSIZE = 256;
 
 class LTKOSUtil;
 
+/**
+ * In-memory copy of a model data file. The whole file is read once by
+ * LTKCheckSumGenerate::readMDTHeader() and can then be parsed through an
+ * istream attached to this buffer, without opening the file again.
+ */
+class LTKMDTBuffer : public streambuf
+{
+private:
+
+	vector<char> m_data;
+
+public:
+
+	LTKMDTBuffer() {}
+
+	/**
+	 * Returns the storage of the buffer, resetting the read position.
+	 */
+	vector<char>& data()
+	{
+		setg(NULL, NULL, NULL);
+		return m_data;
+	}
+
+	/**
+	 * Makes the whole content available for reading.
+	 */
+	void reset()
+	{
+		char* begin = m_data.empty() ? NULL : &m_data[0];
+		setg(begin, begin, begin + m_data.size());
+	}
+
+protected:
+
+	pos_type seekoff(off_type off, ios_base::seekdir dir,
+	                 ios_base::openmode which = ios_base::in)
+	{
+		off_type pos = off;
+		if(dir == ios_base::cur)
+			pos += gptr() - eback();
+		else if(dir == ios_base::end)
+			pos += egptr() - eback();
+		return seekpos(pos_type(pos), which);
+	}
+
+	pos_type seekpos(pos_type pos, ios_base::openmode which = ios_base::in)
+	{
+		off_type off = off_type(pos);
+		if(!(which & ios_base::in) || off < 0 || off > egptr() - eback())
+			return pos_type(off_type(-1));
+		setg(eback(), eback() + off, egptr());
+		return pos;
+	}
+};
+
 class LTKCheckSumGenerate
 {
 private:
 
-	unsigned int m_CRC32Table[256]; // Lookup table array.
+	unsigned int m_CRC32Table[8][256]; // Slicing-by-8 lookup tables.
 
     LTKOSUtil* m_OSUtilPtr;
 
@@ -94,6 +150,16 @@ public:
 	 */
 	int getCRC(string& text);
 
+	/**
+	 * This method generates the checksum of a memory block.
+	 *
+	 * @param data, start of the block.
+	 * @param length, number of bytes in the block.
+	 *
+	 * @return checksum for the block.
+	 */
+	int getCRC(const char* data, size_t length);
+
 	/**
 	 * This method reads the header information from the model data header information file and
 	 * adds it to the data file with additional header information.
@@ -135,6 +201,26 @@ public:
 	int readMDTHeader(const string &mdtFilePath,
 	                        stringStringMap &headerSequence);	
 
+	/**
+	 * This method reads the model data file once, checks its integrity and
+	 * keeps its content in mdtBuffer, so that the caller can parse the model
+	 * data without reading the file again.
+	 *
+	 * The checksum is skipped when a sidecar file (mdtFilePath + ".cks")
+	 * records that this exact file, identified by its device, inode, size
+	 * and modification time, was already verified.
+	 *
+	 * @param mdtFilePath, Model data file Name.
+	 * @param string - string map variable, which holds the header keys and the values respectively.
+	 * @param mdtBuffer, receives the content of the whole file.
+	 *
+	 * @return SUCCESS, 
+	 */
+
+	int readMDTHeader(const string &mdtFilePath,
+	                        stringStringMap &headerSequence,
+	                        LTKMDTBuffer &mdtBuffer);
+
 private:
 
     /**
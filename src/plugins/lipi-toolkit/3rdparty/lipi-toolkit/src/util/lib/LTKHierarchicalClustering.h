@@ -21,13 +21,18 @@
  * FILE DESCR: Definitions of Agglomerative Hierarchical Clustering module
  *
  * CONTENTS:
+ *             getCondensedIndex
+ *             printProximityProgress
  *             cluster
  *             getProximityMatrix
  *             setOutputConfig
  *             setHyperlinkMap
  *             getClusterResult
+ *             setNumOfThreads
+ *             setProgressCallback
  *             computeProximityMatrix
  *             computeDistances
+ *             computeDistancesInTiles
  *             clusterToFindNumClusters
  *             getInterObjectDistance
  *             findGroup
@@ -59,6 +64,10 @@
 #include "LTKException.h"
 #include "LTKErrors.h"
 
+#include <atomic>
+#include <functional>
+#include <thread>
+
 /*Enumerator for stopping criterion to be used*/
 enum ELTKHCStoppingCriterion
 {
@@ -77,6 +86,64 @@ enum ELTKHCStoppingCriterion
 #define OUTPUT_HTML_FILE_NAME "output.html"
 #define MIN_CUTOFF 20
 
+/*Number of data objects per side of a tile of the proximity matrix*/
+#define PROXIMITY_TILE_SIZE 64
+
+/*Function pointer type for reporting the progress of computing the
+  proximity matrix: number of distances computed so far and in total*/
+typedef void (*FN_PTR_PROXIMITY_PROGRESS)(size_t done, size_t total, void* userData);
+
+/**********************************************************************************
+* NAME              : printProximityProgress
+* DESCRIPTION  : Progress function printing the percentage of the proximity matrix
+*                     computed whenever it changes
+* ARGUMENTS         : done - number of distances computed so far
+*                     total - number of distances in the matrix
+*                     userData - pointer to an int holding the last printed percentage
+* RETURNS      :
+* NOTES             :
+* CHANGE HISTROY
+* Author            Date                Description of change
+*************************************************************************************/
+inline void printProximityProgress(size_t done, size_t total, void* userData)
+{
+     int* lastPercent = (int*)userData;
+     int percent = total > 0 ? (int)((double)done * 100 / total) : 100;
+
+     if(lastPercent == NULL || *lastPercent != percent)
+     {
+          cout<<"\r Amount of Proximity Matrix Computed = "<<percent<<" %"<<flush;
+
+          if(percent == 100)
+          {
+               cout<<endl;
+          }
+
+          if(lastPercent != NULL)
+          {
+               *lastPercent = percent;
+          }
+     }
+}
+
+/**********************************************************************************
+* NAME              : getCondensedIndex
+* DESCRIPTION  : Returns the position of the distance between two data objects in
+*                     the condensed proximity matrix, which stores the upper
+*                     triangle of the matrix row by row in one contiguous vector
+* ARGUMENTS         : numObjects - number of data objects
+*                     row - index of the first data object
+*                     col - index of the second data object, greater than row
+* RETURNS      : index in the condensed proximity matrix
+* NOTES             :
+* CHANGE HISTROY
+* Author            Date                Description of change
+*************************************************************************************/
+inline size_t getCondensedIndex(int numObjects, int row, int col)
+{
+     return (size_t)row * (2 * (size_t)numObjects - row - 1) / 2 + (col - row - 1);
+}
+
 /**
  * @class LTKHierarchicalClustering
  * <p> This class does agglomerative hierarchical clustering. The data objects
@@ -96,9 +163,9 @@ class LTKHierarchicalClustering
           //reference to the vector containing the data objects to be clustered
          const vector<ClusterObjType>& m_data;
 
-          //triangular matrix containing the pairwise distances between data
-          //objects
-          float2DVector m_proximityMatrix;
+          //condensed triangular matrix containing the pairwise distances
+          //between data objects (see getCondensedIndex)
+          floatVector m_proximityMatrix;
 
           //data structure that stores current (intermediate) state of the
           //clusters
@@ -157,6 +224,15 @@ class LTKHierarchicalClustering
           //distance function pointer
           FN_PTR_DISTANCE m_distancePtr;
 
+          //number of threads computing the proximity matrix
+          int m_numOfThreads;
+
+          //function reporting the progress of computing the proximity matrix
+          FN_PTR_PROXIMITY_PROGRESS m_progressPtr;
+
+          //user data passed to the progress function
+          void* m_progressUserData;
+
 
      public:
 
@@ -184,7 +260,10 @@ LTKHierarchicalClustering(const vector<ClusterObjType>& clusterObjects,int noOfC
                                 m_data(clusterObjects),m_method(clusteringMethod),
                                 m_numOfClusters(noOfClusters),m_writeHTML(false),
                                 m_showAllLevels(false),
-                                m_determineClusters(false)
+                                m_determineClusters(false),
+                                m_numOfThreads(1),
+                                m_progressPtr(NULL),
+                                m_progressUserData(NULL)
 {
 
      LOG(LTKLogger::LTK_LOGLEVEL_DEBUG)<<"Entering: "
@@ -240,7 +319,10 @@ LTKHierarchicalClustering(const vector<ClusterObjType>& clusterObjects,
                                 m_stoppingCriterion(stoppingCriterion),
                                 m_writeHTML(false),
                                 m_showAllLevels(false),
-                                m_determineClusters(true)
+                                m_determineClusters(true),
+                                m_numOfThreads(1),
+                                m_progressPtr(NULL),
+                                m_progressUserData(NULL)
 {
 
      LOG(LTKLogger::LTK_LOGLEVEL_DEBUG)<<"Entering: "
@@ -383,13 +465,14 @@ int cluster(DistanceClass* distanceClassPtr,FN_PTR_DISTANCE distFuncPtr)
 * NAME              : getProximityMatrix
 * DESCRIPTION  : returns the distance matrix
 * ARGUMENTS         :
-* RETURNS      : proximity matrix (float2DVector)
-* NOTES             :
+* RETURNS      : condensed proximity matrix (floatVector)
+* NOTES             : use getCondensedIndex to locate the distance between
+*                     two data objects
 * CHANGE HISTROY
 * Author            Date                Description of change
 *************************************************************************************/
 
-const float2DVector& getProximityMatrix() const
+const floatVector& getProximityMatrix() const
 {
 
      LOG(LTKLogger::LTK_LOGLEVEL_DEBUG)<<"Entering: "
@@ -548,6 +631,44 @@ void getClusterResult(vector<vector<int> >& outClusterResult) const
           <<"LTKHierarchicalClustering::getClusterResult()"<<endl;
 }
 
+/**********************************************************************************
+* NAME              : setNumOfThreads
+* DESCRIPTION  : Sets the number of threads computing the proximity matrix.
+* ARGUMENTS         : numOfThreads - number of threads, 0 uses one thread
+*                                        per hardware thread
+* RETURNS      :
+* NOTES             : With more than one thread, the distance function is
+*                     called concurrently and must be reentrant.
+* CHANGE HISTROY
+* Author            Date                Description of change
+*************************************************************************************/
+void setNumOfThreads(int numOfThreads)
+{
+     if(numOfThreads <= 0)
+     {
+          numOfThreads = std::thread::hardware_concurrency();
+     }
+
+     m_numOfThreads = numOfThreads > 0 ? numOfThreads : 1;
+}
+
+/**********************************************************************************
+* NAME              : setProgressCallback
+* DESCRIPTION  : Sets the function reporting the progress of computing the
+*                     proximity matrix.
+* ARGUMENTS         : progressPtr - progress function, NULL for none
+*                     userData - passed to the progress function
+* RETURNS      :
+* NOTES             : The progress function is called from the calling thread.
+* CHANGE HISTROY
+* Author            Date                Description of change
+*************************************************************************************/
+void setProgressCallback(FN_PTR_PROXIMITY_PROGRESS progressPtr, void* userData = NULL)
+{
+     m_progressPtr = progressPtr;
+     m_progressUserData = userData;
+}
+
 /**********************************************************************************
 * AUTHOR       : Bharath A
 * DATE              : 22-FEB-2005
@@ -610,34 +731,69 @@ int computeDistances()
      LOG(LTKLogger::LTK_LOGLEVEL_DEBUG)<<"Entering: "
           <<"LTKHierarchicalClustering::computeDistances()"<<endl;
 
-     for(int i=0;i<(m_data.size()-1);++i)
-     {
-          vector<float> eachRow((m_data.size()-i)-1);//added -1 at the end
+     const int numObjects = m_data.size();
+
+     m_proximityMatrix.assign((size_t)numObjects * (numObjects - 1) / 2, 0.0f);
 
-          int c=0;
+     //the upper triangle is split into square tiles, so that each thread
+     //works on a small set of data objects at a time
+     const int numOfBlocks = (numObjects + PROXIMITY_TILE_SIZE - 1) / PROXIMITY_TILE_SIZE;
 
-          for(int j=i+1;j<m_data.size();++j)
+     vector<pair<int,int> > tiles;
+     tiles.reserve((size_t)numOfBlocks * (numOfBlocks + 1) / 2);
+
+     for(int rowBlock = 0; rowBlock < numOfBlocks; ++rowBlock)
+     {
+          for(int colBlock = rowBlock; colBlock < numOfBlocks; ++colBlock)
           {
-               //external distance function called
-               int errorCode = (m_distClassPtr->*m_distancePtr)(m_data[i],m_data[j], eachRow[c]);
+               tiles.push_back(make_pair(rowBlock, colBlock));
+          }
+     }
 
-               if (errorCode != SUCCESS )
-               {
-                    LOG(LTKLogger::LTK_LOGLEVEL_ERR)
-                         <<"Error while calling distance function"<<endl;
+     std::atomic<size_t> nextTile(0);
+     std::atomic<size_t> numOfDistancesDone(0);
+     std::atomic<int> errorCode(SUCCESS);
 
-                    LOG(LTKLogger::LTK_LOGLEVEL_ERR)
-                         <<"Error: LTKHierarchicalClustering::computeDistances()"<<endl;
+     int numOfThreads = m_numOfThreads;
+     if(numOfThreads > (int)tiles.size())
+     {
+          numOfThreads = tiles.size();
+     }
 
-                    LTKReturnError(errorCode);
-               }
+     vector<std::thread> workers;
 
-               ++c;
+     for(int t = 1; t < numOfThreads; ++t)
+     {
+          workers.push_back(std::thread(&LTKHierarchicalClustering::computeDistancesInTiles,
+                                        this, std::cref(tiles), std::ref(nextTile),
+                                        std::ref(numOfDistancesDone), std::ref(errorCode),
+                                        false));
+     }
 
-          }
+     //the calling thread takes part and reports the progress
+     computeDistancesInTiles(tiles, nextTile, numOfDistancesDone, errorCode, true);
 
-          m_proximityMatrix.push_back(eachRow);
+     for(size_t t = 0; t < workers.size(); ++t)
+     {
+          workers[t].join();
+     }
 
+     if (errorCode != SUCCESS )
+     {
+          LOG(LTKLogger::LTK_LOGLEVEL_ERR)
+               <<"Error while calling distance function"<<endl;
+
+          LOG(LTKLogger::LTK_LOGLEVEL_ERR)
+               <<"Error: LTKHierarchicalClustering::computeDistances()"<<endl;
+
+          m_proximityMatrix.clear();
+
+          LTKReturnError(errorCode.load());
+     }
+
+     if(m_progressPtr != NULL)
+     {
+          (*m_progressPtr)(m_proximityMatrix.size(), m_proximityMatrix.size(), m_progressUserData);
      }
 
      LOG(LTKLogger::LTK_LOGLEVEL_DEBUG)<<"Exiting: "
@@ -647,6 +803,73 @@ int computeDistances()
 
 }
 
+/**********************************************************************************
+* NAME              : computeDistancesInTiles
+* DESCRIPTION  : Computes the distances of the tiles of the proximity matrix
+*                     until all tiles are taken or an error occurs
+* ARGUMENTS         : tiles - row and column block of each tile
+*                     nextTile - index of the next tile to compute
+*                     numOfDistancesDone - number of distances computed so far
+*                     errorCode - first error returned by the distance function
+*                     reportProgress - true to call the progress function
+* RETURNS      :
+* NOTES             : Runs concurrently; each distance is written by one thread.
+* CHANGE HISTROY
+* Author            Date                Description of change
+*************************************************************************************/
+void computeDistancesInTiles(const vector<pair<int,int> >& tiles,
+                             std::atomic<size_t>& nextTile,
+                             std::atomic<size_t>& numOfDistancesDone,
+                             std::atomic<int>& errorCode,
+                             bool reportProgress)
+{
+     const int numObjects = m_data.size();
+
+     for(size_t tile = nextTile++; tile < tiles.size() && errorCode == SUCCESS; tile = nextTile++)
+     {
+          const int rowBegin = tiles[tile].first * PROXIMITY_TILE_SIZE;
+          const int rowEnd = min(rowBegin + PROXIMITY_TILE_SIZE, numObjects);
+          const int colBegin = tiles[tile].second * PROXIMITY_TILE_SIZE;
+          const int colEnd = min(colBegin + PROXIMITY_TILE_SIZE, numObjects);
+
+          size_t numOfDistances = 0;
+
+          for(int i = rowBegin; i < rowEnd; ++i)
+          {
+               const int firstCol = max(colBegin, i + 1);
+
+               if(firstCol >= colEnd)
+               {
+                    continue;
+               }
+
+               float* eachRow = &m_proximityMatrix[getCondensedIndex(numObjects, i, firstCol)];
+
+               for(int j = firstCol; j < colEnd; ++j)
+               {
+                    //external distance function called
+                    int status = (m_distClassPtr->*m_distancePtr)(m_data[i], m_data[j], *eachRow++);
+
+                    if (status != SUCCESS )
+                    {
+                         int expected = SUCCESS;
+                         errorCode.compare_exchange_strong(expected, status);
+                         return;
+                    }
+               }
+
+               numOfDistances += colEnd - firstCol;
+          }
+
+          size_t done = (numOfDistancesDone += numOfDistances);
+
+          if(reportProgress && m_progressPtr != NULL)
+          {
+               (*m_progressPtr)(done, m_proximityMatrix.size(), m_progressUserData);
+          }
+     }
+}
+
 
 
 /**********************************************************************************
@@ -895,7 +1118,7 @@ float getInterObjectDistance(int firstObjIndex,int secondObjIndex) const
      LOG(LTKLogger::LTK_LOGLEVEL_DEBUG)<<"Exiting: "
           <<"LTKHierarchicalClustering::getInterObjectDistance()"<<endl;
 
-     return m_proximityMatrix[row][col-row-1];
+     return m_proximityMatrix[getCondensedIndex(m_data.size(), row, col)];
 }
 
 /**********************************************************************************
@@ -41,11 +41,14 @@
 #include "LTKLinuxUtil.h"
 #include "LTKMacros.h"
 #include "LTKLoggerUtil.h"
+#include "LTKErrorsList.h"
 
 
 #include <dlfcn.h>
 #include <stdio.h>
 #include <sys/utsname.h>
+#include <sys/stat.h>
+#include <sstream>
 
 
 /************************************************************************
@@ -248,6 +251,8 @@ int LTKLinuxUtil::getOSInfo(string& outStr)
 	string sysRelease(name.release);
 
     outStr = sysName + " " + sysRelease;
+
+    return SUCCESS;
 }
 
 /**************************************************************************
@@ -376,3 +381,41 @@ string LTKLinuxUtil::getEnvVariable(const string& envVariableName)
 {
 	return getenv(envVariableName.c_str());
 }
+
+/**************************************************************************
+ * NAME			: getFileIdentity
+ * DESCRIPTION	: Returns the device, inode, size and modification time of
+ *				  the file as a single string
+ * ARGUMENTS      : filePath - path of the file
+ *				  outStr - identity string
+ *
+ * RETURNS		: SUCCESS on success, EFILE_OPEN_ERROR if the file cannot
+ *				  be queried
+ * NOTES			: 
+ * CHANGE HISTROY
+ * Author			Date				Description
+ ***************************************************************************/
+
+int LTKLinuxUtil::getFileIdentity(const string& filePath, string& outStr)
+{
+	struct stat fileStat;
+
+	if(stat(filePath.c_str(), &fileStat) != 0)
+	{
+		LTKReturnError(EFILE_OPEN_ERROR);
+	}
+
+	ostringstream identity;
+
+	identity << fileStat.st_dev << ":" << fileStat.st_ino << ":"
+	         << fileStat.st_size << ":" << fileStat.st_mtime;
+#if defined(__linux__)
+	identity << "." << fileStat.st_mtim.tv_nsec;
+#elif defined(__APPLE__)
+	identity << "." << fileStat.st_mtimespec.tv_nsec;
+#endif
+
+	outStr = identity.str();
+
+	return SUCCESS;
+}
@@ -99,6 +99,8 @@ public:
     void* getLibraryHandle(const string& libName);
     
     string getEnvVariable(const string& envVariableName);
+
+    int getFileIdentity(const string& filePath, string& outStr);
 	
 };
 
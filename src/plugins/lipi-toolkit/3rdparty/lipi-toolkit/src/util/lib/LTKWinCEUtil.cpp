@@ -41,6 +41,7 @@
 #include "LTKWinCEUtil.h"
 #include "LTKMacros.h"
 #include "LTKLoggerUtil.h"
+#include "LTKErrorsList.h"
 #include "LTKStringUtil.h"
 
 /************************************************************************
@@ -466,4 +467,18 @@ TCHAR* LTKWinCEUtil::convertCharToTChar(const char* pszData)
 string LTKWinCEUtil::getEnvVariable(const string& envVariableName)
 {
 	return NULL;
-}
\ No newline at end of file
+}
+
+/***************************************************************************
+* NAME			: getFileIdentity
+* DESCRIPTION	: Not supported on Windows CE
+* ARGUMENTS		: 
+* RETURNS		: EFILE_OPEN_ERROR
+* NOTES			:
+* CHANGE HISTROY
+* Author			Date				Description of change
+*******************************************************************************/
+int LTKWinCEUtil::getFileIdentity(const string& filePath, string& outStr)
+{
+	return EFILE_OPEN_ERROR;
+}
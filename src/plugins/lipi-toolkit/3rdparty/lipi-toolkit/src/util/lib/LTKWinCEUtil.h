@@ -106,6 +106,8 @@ public:
     
     string getEnvVariable(const string& envVariableName);
 
+    int getFileIdentity(const string& filePath, string& outStr);
+
 };
 
 
@@ -41,8 +41,10 @@
 #include "LTKWindowsUtil.h"
 #include "LTKMacros.h"
 #include "LTKLoggerUtil.h"
+#include "LTKErrorsList.h"
 
 #include <windows.h>
+#include <sstream>
 
 /************************************************************************
  * AUTHOR		: Nidhi Sharma
@@ -580,3 +582,50 @@ string LTKWindowsUtil::getEnvVariable(const string& envVariableName)
 {
 	return getenv(envVariableName.c_str());
 }
+
+/**************************************************************************
+ * NAME			: getFileIdentity
+ * DESCRIPTION	: Returns the volume serial number, file index, size and
+ *				  last write time of the file as a single string
+ * ARGUMENTS      : filePath - path of the file
+ *				  outStr - identity string
+ *
+ * RETURNS		: SUCCESS on success, EFILE_OPEN_ERROR if the file cannot
+ *				  be queried
+ * NOTES			: 
+ * CHANGE HISTROY
+ * Author			Date				Description
+ ***************************************************************************/
+
+int LTKWindowsUtil::getFileIdentity(const string& filePath, string& outStr)
+{
+	HANDLE fileHandle = CreateFileA(filePath.c_str(), 0,
+	                                FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+	                                NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+	if(fileHandle == INVALID_HANDLE_VALUE)
+	{
+		LTKReturnError(EFILE_OPEN_ERROR);
+	}
+
+	BY_HANDLE_FILE_INFORMATION fileInfo;
+	BOOL status = GetFileInformationByHandle(fileHandle, &fileInfo);
+	CloseHandle(fileHandle);
+
+	if(!status)
+	{
+		LTKReturnError(EFILE_OPEN_ERROR);
+	}
+
+	ostringstream identity;
+
+	identity << fileInfo.dwVolumeSerialNumber << ":"
+	         << fileInfo.nFileIndexHigh << "." << fileInfo.nFileIndexLow << ":"
+	         << fileInfo.nFileSizeHigh << "." << fileInfo.nFileSizeLow << ":"
+	         << fileInfo.ftLastWriteTime.dwHighDateTime << "."
+	         << fileInfo.ftLastWriteTime.dwLowDateTime;
+
+	outStr = identity.str();
+
+	return SUCCESS;
+}
@@ -31,6 +31,7 @@
 #include <pthread.h>
 #include <sys/time.h>
 #endif
+#include <atomic>
 #include "atomdictbase.h"
 
 namespace ime_pinyin {
@@ -130,7 +131,7 @@ class UserDict : public AtomDictBase {
     uint32 version;
     const char * file_name;
     struct timeval load_time;
-    struct timeval last_update;
+    uint32 change_seq;
     uint32 disk_size;
     uint32 lemma_count;
     uint32 lemma_size;
@@ -149,6 +150,15 @@ class UserDict : public AtomDictBase {
  private:
   uint32 total_other_nfreq_;
   struct timeval load_time_;
+  // Change sequence of the dictionary file, shared by all processes
+  // through a small memory mapped file next to it. It is odd while a
+  // write back is in progress, see begin_write_back().
+  std::atomic<uint32> * change_seq_;
+  // Descriptor of the change sequence file. A writer holds an exclusive
+  // lock on it for the whole write back.
+  int change_seq_fd_;
+  // Change sequence of the file content loaded to memory
+  uint32 load_seq_;
   LemmaIdType start_id_;
   uint32 version_;
   uint8 * lemmas_;
@@ -194,6 +204,8 @@ class UserDict : public AtomDictBase {
 
   size_t lemma_count_left_;
   size_t lemma_size_left_;
+  // Size of the lemmas already in the dictionary file
+  size_t lemma_size_written_;
 
   const char * dict_file_;
 
@@ -333,6 +345,25 @@ class UserDict : public AtomDictBase {
 
   bool is_valid_state();
 
+  bool map_change_seq(const char *file);
+
+  void unmap_change_seq();
+
+  bool lock_change_seq(bool exclusive);
+
+  void unlock_change_seq();
+
+  uint32 wait_change_seq();
+
+  bool is_changed_by_others();
+
+  bool begin_write_back();
+
+  void end_write_back();
+
+  // Write back the changes, unless others changed the file meanwhile
+  bool commit();
+
   bool is_valid_lemma_id(LemmaIdType id);
 
   LemmaIdType get_max_lemma_id();
@@ -363,6 +394,9 @@ class UserDict : public AtomDictBase {
   // Find first item by initial letters
   int32 locate_first_in_offsets(const UserDictSearchable *searchable);
 
+  // Make room for a lemma of lemma_len characters
+  bool grow(uint16 lemma_len);
+
   LemmaIdType append_a_lemma(char16 lemma_str[], uint16 splids[],
                            uint16 lemma_len, uint16 count, uint64 lmt);
 
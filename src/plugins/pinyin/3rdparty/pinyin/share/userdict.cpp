@@ -29,6 +29,7 @@
 #include <unistd.h>
 #endif
 #include <fcntl.h>
+#include <errno.h>
 #include <sys/stat.h>
 #include <assert.h>
 #include <ctype.h>
@@ -40,6 +41,7 @@
 #include <QMutex>
 #else
 #include <pthread.h>
+#include <sys/mman.h>
 #endif
 #include <math.h>
 
@@ -84,7 +86,12 @@ static QMutex g_mutex_;
 #else
 static pthread_mutex_t g_mutex_ = PTHREAD_MUTEX_INITIALIZER;
 #endif
-static struct timeval g_last_update_ = {0, 0};
+
+// Change sequence used when the shared one can not be mapped. It is only
+// visible to this process, just like the dictionary contents.
+static std::atomic<uint32> g_change_seq_(0);
+static_assert(sizeof(std::atomic<uint32>) == sizeof(uint32),
+              "change sequence must match its memory mapped size");
 
 inline uint32 UserDict::get_dict_file_size(UserDictInfo * info) {
   return (4 + info->lemma_size + (info->lemma_count << 3)
@@ -247,7 +254,10 @@ inline bool UserDict::is_valid_state() {
 }
 
 UserDict::UserDict()
-    : start_id_(0),
+    : change_seq_(NULL),
+      change_seq_fd_(-1),
+      load_seq_(0),
+      start_id_(0),
       version_(0),
       lemmas_(NULL),
       offsets_(NULL),
@@ -263,6 +273,7 @@ UserDict::UserDict()
       offsets_by_id_(NULL),
       lemma_count_left_(0),
       lemma_size_left_(0),
+      lemma_size_written_(0),
       dict_file_(NULL),
       state_(USER_DICT_NONE) {
   memset(&dict_info_, 0, sizeof(dict_info_));
@@ -287,6 +298,11 @@ bool UserDict::load_dict(const char *file_name, LemmaIdType start_id,
 
   start_id_ = start_id;
 
+  map_change_seq(file_name);
+  // If the file is changed while it is loaded, the next lookup will
+  // notice that the sequence differs and reload it
+  load_seq_ = wait_change_seq();
+
   if (false == validate(file_name) && false == reset(file_name)) {
     goto error;
   }
@@ -304,6 +320,7 @@ bool UserDict::load_dict(const char *file_name, LemmaIdType start_id,
 #endif
   return true;
  error:
+  unmap_change_seq();
   free((void*)dict_file_);
   dict_file_ = NULL;
   start_id_ = 0;
@@ -320,16 +337,10 @@ bool UserDict::close_dict() {
   // we can not simply write back here
   // To do a safe flush, we have to discard all newly added
   // lemmas and try to reload dict file.
-  pthread_mutex_lock(&g_mutex_);
-  if (load_time_.tv_sec > g_last_update_.tv_sec ||
-    (load_time_.tv_sec == g_last_update_.tv_sec &&
-     load_time_.tv_usec > g_last_update_.tv_usec)) {
-    write_back();
-    gettimeofday(&g_last_update_, NULL);
-  }
-  pthread_mutex_unlock(&g_mutex_);
+  commit();
 
  out:
+  unmap_change_seq();
   free((void*)dict_file_);
   free(lemmas_);
   free(offsets_);
@@ -358,6 +369,7 @@ bool UserDict::close_dict() {
   memset(&dict_info_, 0, sizeof(dict_info_));
   lemma_count_left_ = 0;
   lemma_size_left_ = 0;
+  lemma_size_written_ = 0;
   state_ = USER_DICT_NONE;
 
   return true;
@@ -541,17 +553,9 @@ size_t UserDict::_get_lpis(const uint16 *splid_str,
   if (lpi_max <= 0)
     return 0;
 
-  if (0 == pthread_mutex_trylock(&g_mutex_)) {
-    if (load_time_.tv_sec < g_last_update_.tv_sec ||
-      (load_time_.tv_sec == g_last_update_.tv_sec &&
-       load_time_.tv_usec < g_last_update_.tv_usec)) {
-      // Others updated disk file, have to reload
-      pthread_mutex_unlock(&g_mutex_);
-      flush_cache();
-    } else {
-      pthread_mutex_unlock(&g_mutex_);
-    }
-  } else {
+  if (is_changed_by_others()) {
+    // Others updated disk file, have to reload
+    flush_cache();
   }
 
   UserDictSearchable searchable;
@@ -1020,6 +1024,10 @@ void UserDict::flush_cache() {
   LemmaIdType start_id = start_id_;
   if (!dict_file_)
     return;
+  // Publish the changes without a reload when the memory still has the
+  // latest content of the file
+  if (!is_changed_by_others() && commit())
+    return;
   const char * file = strdup(dict_file_);
   if (!file)
     return;
@@ -1239,6 +1247,7 @@ bool UserDict::load(const char *file, LemmaIdType start_id) {
 #endif
   lemma_count_left_ = kUserDictPreAlloc;
   lemma_size_left_ = kUserDictPreAlloc * (2 + (kUserDictAverageNchar << 2));
+  lemma_size_written_ = dict_info.lemma_size;
   memcpy(&dict_info_, &dict_info, sizeof(dict_info));
   state_ = USER_DICT_SYNC;
 
@@ -1264,8 +1273,153 @@ bool UserDict::load(const char *file, LemmaIdType start_id) {
   return false;
 }
 
+bool UserDict::map_change_seq(const char *file) {
+  change_seq_ = &g_change_seq_;
+#ifndef _WIN32
+  // The sequence lives in "<file>.seq" so that the dictionary file
+  // format stays unchanged
+  size_t len = strlen(file);
+  char * seq_file = (char*)malloc(len + 5);
+  if (!seq_file)
+    return false;
+  memcpy(seq_file, file, len);
+  memcpy(seq_file + len, ".seq", 5);
+  int fd = open(seq_file, O_RDWR | O_CREAT, 0600);
+  free(seq_file);
+  if (fd == -1)
+    return false;
+  struct stat st;
+  if (fstat(fd, &st) == -1 ||
+      (st.st_size < (off_t)sizeof(uint32) &&
+       ftruncate(fd, sizeof(uint32)) == -1)) {
+    close(fd);
+    return false;
+  }
+  void * addr = mmap(NULL, sizeof(uint32), PROT_READ | PROT_WRITE,
+                     MAP_SHARED, fd, 0);
+  if (addr == MAP_FAILED) {
+    close(fd);
+    return false;
+  }
+  change_seq_ = (std::atomic<uint32>*)addr;
+  change_seq_fd_ = fd;
+#endif
+  return true;
+}
+
+void UserDict::unmap_change_seq() {
+#ifndef _WIN32
+  if (change_seq_ && change_seq_ != &g_change_seq_)
+    munmap((void*)change_seq_, sizeof(uint32));
+  if (change_seq_fd_ != -1)
+    close(change_seq_fd_);
+#endif
+  change_seq_ = NULL;
+  change_seq_fd_ = -1;
+}
+
+bool UserDict::lock_change_seq(bool exclusive) {
+#ifndef _WIN32
+  // Record locks belong to the process, so the threads of this process
+  // must be serialized by g_mutex_ before taking one
+  if (change_seq_fd_ == -1)
+    return true;
+  struct flock lock;
+  memset(&lock, 0, sizeof(lock));
+  lock.l_type = exclusive ? F_WRLCK : F_RDLCK;
+  lock.l_whence = SEEK_SET;
+  lock.l_start = 0;
+  lock.l_len = sizeof(uint32);
+  while (fcntl(change_seq_fd_, F_SETLKW, &lock) == -1) {
+    if (errno != EINTR)
+      return false;
+  }
+#endif
+  return true;
+}
+
+void UserDict::unlock_change_seq() {
+#ifndef _WIN32
+  if (change_seq_fd_ == -1)
+    return;
+  struct flock lock;
+  memset(&lock, 0, sizeof(lock));
+  lock.l_type = F_UNLCK;
+  lock.l_whence = SEEK_SET;
+  lock.l_start = 0;
+  lock.l_len = sizeof(uint32);
+  fcntl(change_seq_fd_, F_SETLK, &lock);
+#endif
+}
+
+uint32 UserDict::wait_change_seq() {
+  uint32 seq = change_seq_->load(std::memory_order_acquire);
+  if ((seq & 1) == 0)
+    return seq;
+  // A write back is in progress. The writer holds g_mutex_ and an
+  // exclusive lock on the sequence file until it has published the new
+  // sequence, so a shared lock is granted only after it has finished.
+  // The system releases the lock if the writer dies.
+  pthread_mutex_lock(&g_mutex_);
+  if (lock_change_seq(false)) {
+    seq = change_seq_->load(std::memory_order_acquire);
+    if (seq & 1) {
+      // The writer died in the middle of a write back, release its
+      // claim so that the others do not wait for it again. No writer
+      // can start while the shared lock is held.
+      if (change_seq_->compare_exchange_strong(seq, seq + 1,
+                                               std::memory_order_acq_rel))
+        seq++;
+    }
+    unlock_change_seq();
+  }
+  pthread_mutex_unlock(&g_mutex_);
+  return seq;
+}
+
+bool UserDict::is_changed_by_others() {
+  // A single atomic load, so the check is cheap enough for every lookup
+  uint32 seq = change_seq_->load(std::memory_order_acquire);
+  return seq != load_seq_ && (seq & 1) == 0;
+}
+
+bool UserDict::begin_write_back() {
+  // Only the process which has the latest content may write it back.
+  // The sequence is made odd to tell the readers that the file is
+  // being written.
+  uint32 seq = load_seq_;
+  if (seq & 1)
+    return false;
+  return change_seq_->compare_exchange_strong(seq, seq + 1,
+                                              std::memory_order_acq_rel);
+}
+
+void UserDict::end_write_back() {
+  load_seq_ += 2;
+  change_seq_->store(load_seq_, std::memory_order_release);
+}
+
+bool UserDict::commit() {
+  if (state_ == USER_DICT_NONE || state_ == USER_DICT_SYNC)
+    return true;
+  bool committed = false;
+  pthread_mutex_lock(&g_mutex_);
+  // The lock is held until the new sequence is published, so that the
+  // readers can tell a slow writer from a dead one
+  if (lock_change_seq(true)) {
+    committed = begin_write_back();
+    if (committed) {
+      write_back();
+      end_write_back();
+    }
+    unlock_change_seq();
+  }
+  pthread_mutex_unlock(&g_mutex_);
+  return committed;
+}
+
 void UserDict::write_back() {
-  // XXX write back is only allowed from close_dict due to thread-safe sake
+  // XXX write back is only allowed from commit due to thread-safe sake
   if (state_ == USER_DICT_NONE || state_ == USER_DICT_SYNC)
     return;
   int fd = open(dict_file_, O_WRONLY);
@@ -1299,6 +1453,7 @@ void UserDict::write_back() {
   ftruncate(fd, cur);
 #endif
   close(fd);
+  lemma_size_written_ = dict_info_.lemma_size;
   state_ = USER_DICT_SYNC;
 }
 
@@ -1353,12 +1508,11 @@ void UserDict::write_back_lemma(int fd) {
   if (err == -1)
     return;
   // New lemmas are always appended, no need to write whole lemma block
-  size_t need_write = kUserDictPreAlloc *
-      (2 + (kUserDictAverageNchar << 2)) - lemma_size_left_;
-  err = lseek(fd, dict_info_.lemma_size - need_write, SEEK_CUR);
+  size_t need_write = dict_info_.lemma_size - lemma_size_written_;
+  err = lseek(fd, lemma_size_written_, SEEK_CUR);
   if (err == -1)
     return;
-  write(fd, lemmas_ + dict_info_.lemma_size - need_write, need_write);
+  write(fd, lemmas_ + lemma_size_written_, need_write);
 
   write(fd, offsets_,  dict_info_.lemma_count << 2);
 #ifdef ___PREDICT_ENABLED___
@@ -1538,91 +1692,71 @@ void UserDict::cache_push(UserDictCacheType type,
 
 #endif
 
+// A run of inuse lemmas moved by defragment()
+struct UserDictMovedRun {
+  uint32 begin;
+  uint32 end;
+  uint32 shift;
+};
+
+static uint32 relocate_offset(const UserDictMovedRun * runs, size_t run_count,
+                              uint32 offset) {
+  // Find the last run which begins at or before offset
+  size_t lo = 0;
+  size_t hi = run_count;
+  while (lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    if (runs[mid].begin <= offset)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  if (lo > 0 && offset < runs[lo - 1].end)
+    return offset - runs[lo - 1].shift;
+  return offset;
+}
+
 void UserDict::defragment(void) {
 #ifdef ___DEBUG_PERF___
   DEBUG_PERF_BEGIN;
 #endif
   if (is_valid_state() == false)
     return;
+  // There can not be more runs to move than inuse lemmas
+  UserDictMovedRun * runs = (UserDictMovedRun *)malloc(
+      sizeof(UserDictMovedRun) * (dict_info_.lemma_count + 1));
+  if (!runs)
+    return;
+  int total_size = dict_info_.lemma_size + lemma_size_left_;
+  int total_count = dict_info_.lemma_count + lemma_count_left_;
   // Fixup offsets_, set REMOVE flag to lemma's flag if needed
-  size_t first_freed = 0;
-  size_t first_inuse = 0;
-  while (first_freed < dict_info_.lemma_count) {
-    // Find first freed offset
-    while ((offsets_[first_freed] & kUserDictOffsetFlagRemove) == 0 &&
-            first_freed < dict_info_.lemma_count) {
-      first_freed++;
-    }
-    if (first_freed < dict_info_.lemma_count) {
-      // Save REMOVE flag to lemma flag
-      int off = offsets_[first_freed];
-      set_lemma_flag(off, kUserDictLemmaFlagRemove);
-    } else {
-      break;
-    }
-    // Find first inuse offse after first_freed
-    first_inuse = first_freed + 1;
-    while ((offsets_[first_inuse] & kUserDictOffsetFlagRemove) &&
-           (first_inuse < dict_info_.lemma_count)) {
+  // Inuse items are moved forward in a single pass, keeping their order
+  size_t inuse_count = 0;
+  for (size_t i = 0; i < dict_info_.lemma_count; i++) {
+    if (offsets_[i] & kUserDictOffsetFlagRemove) {
       // Save REMOVE flag to lemma flag
-      int off = offsets_[first_inuse];
-      set_lemma_flag(off, kUserDictLemmaFlagRemove);
-      first_inuse++;
-    }
-    if (first_inuse >= dict_info_.lemma_count) {
-      break;
+      set_lemma_flag(offsets_[i], kUserDictLemmaFlagRemove);
+      continue;
     }
-    // Swap offsets_
-    int tmp = offsets_[first_inuse];
-    offsets_[first_inuse] = offsets_[first_freed];
-    offsets_[first_freed] = tmp;
-    // Move scores_, no need to swap
-    tmp = scores_[first_inuse];
-    scores_[first_inuse] = scores_[first_freed];
-    scores_[first_freed] = tmp;
-    // Swap ids_
-    LemmaIdType tmpid = ids_[first_inuse];
-    ids_[first_inuse] = ids_[first_freed];
-    ids_[first_freed] = tmpid;
-    // Go on
-    first_freed++;
+    offsets_[inuse_count] = offsets_[i];
+    scores_[inuse_count] = scores_[i];
+    ids_[inuse_count] = ids_[i];
+    inuse_count++;
   }
 #ifdef ___PREDICT_ENABLED___
   // Fixup predicts_
-  first_freed = 0;
-  first_inuse = 0;
-  while (first_freed < dict_info_.lemma_count) {
-    // Find first freed offset
-    while ((predicts_[first_freed] & kUserDictOffsetFlagRemove) == 0 &&
-            first_freed < dict_info_.lemma_count) {
-      first_freed++;
-    }
-    if (first_freed >= dict_info_.lemma_count)
-      break;
-    // Find first inuse offse after first_freed
-    first_inuse = first_freed + 1;
-    while ((predicts_[first_inuse] & kUserDictOffsetFlagRemove)
-           && (first_inuse < dict_info_.lemma_count)) {
-      first_inuse++;
-    }
-    if (first_inuse >= dict_info_.lemma_count) {
-      break;
-    }
-    // Swap offsets_
-    int tmp = predicts_[first_inuse];
-    predicts_[first_inuse] = predicts_[first_freed];
-    predicts_[first_freed] = tmp;
-    // Go on
-    first_freed++;
+  size_t predict_count = 0;
+  for (size_t i = 0; i < dict_info_.lemma_count; i++) {
+    if (predicts_[i] & kUserDictOffsetFlagRemove)
+      continue;
+    predicts_[predict_count++] = predicts_[i];
   }
 #endif
-  dict_info_.lemma_count = first_freed;
+  dict_info_.lemma_count = inuse_count;
   // Fixup lemmas_
   size_t begin = 0;
   size_t end = 0;
   size_t dst = 0;
-  int total_size = dict_info_.lemma_size + lemma_size_left_;
-  int total_count = dict_info_.lemma_count + lemma_count_left_;
   size_t real_size = total_size - lemma_size_left_;
   while (dst < real_size) {
     unsigned char flag = get_lemma_flag(dst);
@@ -1633,9 +1767,15 @@ void UserDict::defragment(void) {
     }
     break;
   }
-  if (dst >= real_size)
+  if (dst >= real_size) {
+    free(runs);
     return;
+  }
 
+  // The moved runs are recorded so that each offset is relocated with
+  // a binary search afterwards, instead of scanning all offsets for
+  // every run. This keeps defragmentation linear in dictionary size.
+  size_t run_count = 0;
   end = dst;
   while (end < real_size) {
     begin = end + get_lemma_nchar(end) * 4 + 2;
@@ -1660,26 +1800,25 @@ void UserDict::defragment(void) {
       break;
     }
     memmove(lemmas_ + dst, lemmas_ + begin, end - begin);
-    for (size_t j = 0; j < dict_info_.lemma_count; j++) {
-      if (offsets_[j] >= begin && offsets_[j] < end) {
-        offsets_[j] -= (begin - dst);
-        offsets_by_id_[ids_[j] - start_id_] = offsets_[j];
-      }
+    runs[run_count].begin = begin;
+    runs[run_count].end = end;
+    runs[run_count].shift = begin - dst;
+    run_count++;
+    dst += (end - begin);
+  }
+
+  for (size_t j = 0; j < dict_info_.lemma_count; j++) {
+    offsets_[j] = relocate_offset(runs, run_count, offsets_[j]);
 #ifdef ___PREDICT_ENABLED___
-      if (predicts_[j] >= begin && predicts_[j] < end) {
-        predicts_[j] -= (begin - dst);
-      }
+    predicts_[j] = relocate_offset(runs, run_count, predicts_[j]);
 #endif
-    }
+  }
 #ifdef ___SYNC_ENABLED___
-    for (size_t j = 0; j < dict_info_.sync_count; j++) {
-      if (syncs_[j] >= begin && syncs_[j] < end) {
-        syncs_[j] -= (begin - dst);
-      }
-    }
-#endif
-    dst += (end - begin);
+  for (size_t j = 0; j < dict_info_.sync_count; j++) {
+    syncs_[j] = relocate_offset(runs, run_count, syncs_[j]);
   }
+#endif
+  free(runs);
 
   dict_info_.free_count = 0;
   dict_info_.free_size = 0;
@@ -1957,10 +2096,7 @@ bool UserDict::state(UserDictStat * stat) {
   stat->file_name = dict_file_;
   stat->load_time.tv_sec = load_time_.tv_sec;
   stat->load_time.tv_usec = load_time_.tv_usec;
-  pthread_mutex_lock(&g_mutex_);
-  stat->last_update.tv_sec = g_last_update_.tv_sec;
-  stat->last_update.tv_usec = g_last_update_.tv_usec;
-  pthread_mutex_unlock(&g_mutex_);
+  stat->change_seq = change_seq_->load(std::memory_order_acquire);
   stat->disk_size = get_dict_file_size(&dict_info_);
   stat->lemma_count = dict_info_.lemma_count;
   stat->lemma_size = dict_info_.lemma_size;
@@ -2110,21 +2246,14 @@ LemmaIdType UserDict::_put_lemma(char16 lemma_str[], uint16 splids[],
       // XXX Don't defragment here, it's too time-consuming.
       return 0;
     }
-    int flushed = 0;
-    if (lemma_count_left_ == 0 ||
-        lemma_size_left_ < (size_t)(2 + (lemma_len << 2))) {
-
-      // XXX When there is no space for new lemma, we flush to disk
-      // flush_cache() may be called by upper user
-      // and better place shoule be found instead of here
-      flush_cache();
-      flushed = 1;
-      // Or simply return and do nothing
-      // return 0;
-    }
+    // When there is no space for new lemma, the in-memory arrays are
+    // enlarged. Flushing to disk and reloading the whole dictionary
+    // here would stall the input.
+    if (false == grow(lemma_len))
+      return 0;
 #ifdef ___DEBUG_PERF___
     DEBUG_PERF_END;
-    LOGD_PERF(flushed ? "_put_lemma(flush+add)" : "_put_lemma(add)");
+    LOGD_PERF("_put_lemma(add)");
 #endif
     LemmaIdType id = append_a_lemma(lemma_str, splids, lemma_len, count, lmt);
 #ifdef ___SYNC_ENABLED___
@@ -2204,6 +2333,49 @@ void UserDict::set_total_lemma_count_of_others(size_t count) {
   total_other_nfreq_ = count;
 }
 
+static bool grow_array(uint32 ** array, size_t count) {
+  uint32 * grown = (uint32 *)realloc(*array, count << 2);
+  if (!grown)
+    return false;
+  *array = grown;
+  return true;
+}
+
+bool UserDict::grow(uint16 lemma_len) {
+  size_t lemma_bytes = 2 + (lemma_len << 2);
+  // Grow by half of the current size, so that appending stays
+  // amortized constant time however large the dictionary gets
+  size_t count_inc = dict_info_.lemma_count / 2;
+  if (count_inc < kUserDictPreAlloc)
+    count_inc = kUserDictPreAlloc;
+  if (lemma_size_left_ < lemma_bytes) {
+    size_t size_inc = count_inc * (2 + (kUserDictAverageNchar << 2));
+    if (size_inc < lemma_bytes)
+      size_inc = lemma_bytes;
+    uint8 * lemmas = (uint8 *)realloc(
+        lemmas_, dict_info_.lemma_size + lemma_size_left_ + size_inc);
+    if (!lemmas)
+      return false;
+    lemmas_ = lemmas;
+    lemma_size_left_ += size_inc;
+  }
+  if (lemma_count_left_ == 0) {
+    size_t count = dict_info_.lemma_count + count_inc;
+    // Arrays which are already grown just keep the extra room,
+    // if one of the others can not be grown
+    if (!grow_array(&offsets_, count) ||
+#ifdef ___PREDICT_ENABLED___
+        !grow_array(&predicts_, count) ||
+#endif
+        !grow_array(&scores_, count) ||
+        !grow_array(&ids_, count) ||
+        !grow_array(&offsets_by_id_, count))
+      return false;
+    lemma_count_left_ = count_inc;
+  }
+  return true;
+}
+
 LemmaIdType UserDict::append_a_lemma(char16 lemma_str[], uint16 splids[],
                                    uint16 lemma_len, uint16 count, uint64 lmt) {
   LemmaIdType id = get_max_lemma_id() + 1;
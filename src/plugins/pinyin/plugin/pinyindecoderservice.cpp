@@ -35,6 +35,7 @@
 #include <QDir>
 #include <QtCore/QLibraryInfo>
 #include <QLoggingCategory>
+#include <QTimerEvent>
 
 QT_BEGIN_NAMESPACE
 namespace QtVirtualKeyboard {
@@ -44,6 +45,7 @@ Q_DECLARE_LOGGING_CATEGORY(lcPinyin)
 using namespace ime_pinyin;
 
 QScopedPointer<PinyinDecoderService> PinyinDecoderService::_instance;
+const int PinyinDecoderService::flushCacheDelay = 5000;
 
 /*!
     \class QtVirtualKeyboard::PinyinDecoderService
@@ -52,7 +54,8 @@ QScopedPointer<PinyinDecoderService> PinyinDecoderService::_instance;
 
 PinyinDecoderService::PinyinDecoderService(QObject *parent) :
     QObject(parent),
-    initDone(false)
+    initDone(false),
+    flushCacheTimer(0)
 {
 }
 
@@ -203,7 +206,17 @@ QList<QString> PinyinDecoderService::fetchCandidates(int index, int count, int s
 
 int PinyinDecoderService::chooceCandidate(int index)
 {
-    return int(im_choose(index));
+    int result = int(im_choose(index));
+    // The choice may add a lemma to the user dictionary or update its
+    // scores. The changes are written back when the user has stopped
+    // choosing candidates for a while, so that the other processes
+    // reload the dictionary once for a whole batch of changes.
+    if (im_is_user_dictionary_enabled()) {
+        if (flushCacheTimer)
+            killTimer(flushCacheTimer);
+        flushCacheTimer = startTimer(flushCacheDelay);
+    }
+    return result;
 }
 
 int PinyinDecoderService::cancelLastChoice()
@@ -232,5 +245,14 @@ QList<QString> PinyinDecoderService::predictionList(const QString &history)
     return predictList;
 }
 
+void PinyinDecoderService::timerEvent(QTimerEvent *timerEvent)
+{
+    if (timerEvent->timerId() == flushCacheTimer) {
+        killTimer(flushCacheTimer);
+        flushCacheTimer = 0;
+        flushCache();
+    }
+}
+
 } // namespace QtVirtualKeyboard
 QT_END_NAMESPACE
@@ -75,9 +75,14 @@ public:
     void flushCache();
     QList<QString> predictionList(const QString &history);
 
+protected:
+    void timerEvent(QTimerEvent *timerEvent) override;
+
 private:
     static QScopedPointer<PinyinDecoderService> _instance;
     bool initDone;
+    int flushCacheTimer;
+    static const int flushCacheDelay;
 };
 
 } // namespace QtVirtualKeyboard
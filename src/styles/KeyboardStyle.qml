@@ -318,9 +318,23 @@ QtObject {
         Template for rendering a Trace object.
 
         \note The delegate must be based on the TraceCanvas type.
+        \note The \l traceInkDelegate takes precedence over this delegate.
     */
     property Component traceCanvasDelegate: null
 
+    /*!
+        \since QtQuick.VirtualKeyboard.Styles 2.15
+
+        Template for rendering all the Trace objects of a trace input area.
+
+        One instance of the delegate is created for each trace input area,
+        with the area as its parent. The traces are passed to the
+        TraceInk::addTrace() method as they begin.
+
+        \note The delegate must be based on the TraceInk type.
+    */
+    property Component traceInkDelegate: null
+
     /*! \since QtQuick.VirtualKeyboard.Styles 2.1
 
         Template for the popup list item.
@@ -29,6 +29,7 @@
 
 #include "qtquickvirtualkeyboardstylesplugin.h"
 #include "svgimageprovider.h"
+#include "traceink.h"
 
 #include <qqml.h>
 #include <QtCore/QLibraryInfo>
@@ -73,6 +74,7 @@ void QtQuickVirtualKeyboardStylesPlugin::registerTypes(const char *uri)
     qmlRegisterType(QUrl(path + QLatin1String("SelectionListItem.qml")), uri, 2, 0, "SelectionListItem");
     qmlRegisterType(QUrl(path + QLatin1String("TraceInputKeyPanel.qml")), uri, 2, 0, "TraceInputKeyPanel");
     qmlRegisterType(QUrl(path + QLatin1String("TraceCanvas.qml")), uri, 2, 0, "TraceCanvas");
+    qmlRegisterType<TraceInk>(uri, 2, 15, "TraceInk");
 
     // The minor version used to be the current Qt 5 minor. For compatibility it is the last
     // Qt 5 release.
@@ -7,10 +7,12 @@ CONFIG += no_cxx_module
 
 SOURCES += \
     svgimageprovider.cpp \
+    traceink.cpp \
     qtquickvirtualkeyboardstylesplugin.cpp
 
 HEADERS += \
     svgimageprovider.h \
+    traceink.h \
     qtquickvirtualkeyboardstylesplugin.h
 
 RESOURCES += \
@@ -29,21 +29,104 @@
 
 #include "svgimageprovider.h"
 #include <QImage>
-#include <QPixmap>
+#include <QImageReader>
 #include <QSvgRenderer>
 #include <QPainter>
+#include <QFile>
+#include <QDir>
+#include <QSaveFile>
+#include <QCryptographicHash>
+#include <QRunnable>
+#include <QMutexLocker>
+
+/*
+    Rendered images are kept in an in-memory LRU cache. Its capacity is
+    given in KiB.
+*/
+static const int memoryCacheCapacity = 8 * 1024;
+
+/*
+    Text key of the PNG files in the disk cache, which holds the SHA-1 of the
+    source SVG the image was rendered from.
+*/
+static const char sourceHashKey[] = "QtVirtualKeyboardSourceHash";
+
+class SvgImageResponse : public QQuickImageResponse, public QRunnable
+{
+public:
+    SvgImageResponse(SvgImageProvider *provider, const QString &id, const QSize &requestedSize) :
+        provider(provider),
+        id(id),
+        requestedSize(requestedSize)
+    {
+        setAutoDelete(false);
+    }
+
+    QQuickTextureFactory *textureFactory() const override
+    {
+        return QQuickTextureFactory::textureFactoryForImage(image);
+    }
+
+    void run() override
+    {
+        QSize size;
+        image = provider->requestImage(id, &size, requestedSize);
+        emit finished();
+    }
+
+private:
+    SvgImageProvider *provider;
+    const QString id;
+    const QSize requestedSize;
+    QImage image;
+};
+
+/*!
+    \class SvgImageProvider
+    \internal
+
+    Asynchronous image provider which renders the SVG key images of the
+    styles on a thread pool.
+
+    The image id is a resource path with optional \c width and \c height
+    query parameters. Rendered images are cached in memory by id and
+    requested size. If the QT_VIRTUALKEYBOARD_SVG_CACHE_PATH environment
+    variable is set, the images are also persisted as PNG files in that
+    directory and reused as long as the SHA-1 of the source SVG matches.
+*/
 
 SvgImageProvider::SvgImageProvider() :
-    QQuickImageProvider(QQuickImageProvider::Pixmap)
+    QQuickAsyncImageProvider(),
+    cache(memoryCacheCapacity),
+    diskCachePath(qEnvironmentVariable("QT_VIRTUALKEYBOARD_SVG_CACHE_PATH"))
 {
+    if (!diskCachePath.isEmpty() && !QDir().mkpath(diskCachePath))
+        diskCachePath.clear();
 }
 
 SvgImageProvider::~SvgImageProvider()
 {
+    pool.waitForDone();
+}
+
+QQuickImageResponse *SvgImageProvider::requestImageResponse(const QString &id, const QSize &requestedSize)
+{
+    SvgImageResponse *response = new SvgImageResponse(this, id, requestedSize);
+    pool.start(response);
+    return response;
 }
 
-QPixmap SvgImageProvider::requestPixmap(const QString &id, QSize *size, const QSize &requestedSize)
+QImage SvgImageProvider::requestImage(const QString &id, QSize *size, const QSize &requestedSize)
 {
+    const QString cacheKey = QStringLiteral("%1|%2x%3").arg(id).arg(requestedSize.width()).arg(requestedSize.height());
+    {
+        QMutexLocker guard(&cacheLock);
+        if (const QImage *cachedImage = cache.object(cacheKey)) {
+            *size = cachedImage->size();
+            return *cachedImage;
+        }
+    }
+
     QSize imageSize(-1, -1);
     QUrl request(id);
     QString imagePath = QLatin1String(":/") + request.path();
@@ -74,29 +157,16 @@ QPixmap SvgImageProvider::requestPixmap(const QString &id, QSize *size, const QS
         imageSize = requestedSize;
     }
 
-    QPixmap image;
+    QImage image;
     if ((imageSize.width() > 0 || imageSize.height() > 0) && imagePath.endsWith(QLatin1String(".svg"))) {
-        QSvgRenderer renderer(imagePath);
-        QSize defaultSize(renderer.defaultSize());
-        if (defaultSize.isEmpty())
-            return image;
-        if (imageSize.width() <= 0 && imageSize.height() > 0) {
-            double aspectRatio = (double)defaultSize.width() / (double)defaultSize.height();
-            imageSize.setWidth(qRound(imageSize.height() * aspectRatio));
-        } else if (imageSize.width() > 0 && imageSize.height() <= 0) {
-            double aspectRatio = (double)defaultSize.width() / (double)defaultSize.height();
-            imageSize.setHeight(qRound(imageSize.width() / aspectRatio));
-        }
-        image = QPixmap(imageSize);
-        image.fill(Qt::transparent);
-        QPainter painter(&image);
-        renderer.render(&painter, image.rect());
+        image = renderImage(imagePath, imageSize);
+        imageSize = image.size();
     } else {
-        image = QPixmap(imagePath);
+        image = QImage(imagePath);
         imageSize = image.size();
     }
 
-    QPixmap result;
+    QImage result;
     if (requestedSize.isValid() && requestedSize != imageSize)
         result = image.scaled(requestedSize, Qt::KeepAspectRatio);
     else
@@ -104,5 +174,74 @@ QPixmap SvgImageProvider::requestPixmap(const QString &id, QSize *size, const QS
 
     *size = result.size();
 
+    if (!result.isNull()) {
+        QMutexLocker guard(&cacheLock);
+        cache.insert(cacheKey, new QImage(result), qMax(1, int(result.sizeInBytes() / 1024)));
+    }
+
     return result;
 }
+
+QImage SvgImageProvider::renderImage(const QString &imagePath, const QSize &size)
+{
+    QImage image;
+
+    QFile file(imagePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return image;
+    const QByteArray svgData = file.readAll();
+
+    QString cacheFilePath;
+    QByteArray sourceHash;
+    if (!diskCachePath.isEmpty()) {
+        sourceHash = QCryptographicHash::hash(svgData, QCryptographicHash::Sha1).toHex();
+        const QString cacheName = QStringLiteral("%1|%2x%3").arg(imagePath).arg(size.width()).arg(size.height());
+        cacheFilePath = QDir(diskCachePath).filePath(QString::fromLatin1(QCryptographicHash::hash(cacheName.toUtf8(), QCryptographicHash::Sha1).toHex()) + QLatin1String(".png"));
+        image = loadCachedImage(cacheFilePath, sourceHash);
+        if (!image.isNull())
+            return image;
+    }
+
+    QSvgRenderer renderer(svgData);
+    QSize defaultSize(renderer.defaultSize());
+    if (defaultSize.isEmpty())
+        return image;
+
+    QSize imageSize(size);
+    if (imageSize.width() <= 0 && imageSize.height() > 0) {
+        double aspectRatio = (double)defaultSize.width() / (double)defaultSize.height();
+        imageSize.setWidth(qRound(imageSize.height() * aspectRatio));
+    } else if (imageSize.width() > 0 && imageSize.height() <= 0) {
+        double aspectRatio = (double)defaultSize.width() / (double)defaultSize.height();
+        imageSize.setHeight(qRound(imageSize.width() / aspectRatio));
+    }
+
+    image = QImage(imageSize, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    {
+        QPainter painter(&image);
+        renderer.render(&painter, image.rect());
+    }
+
+    if (!cacheFilePath.isEmpty())
+        saveCachedImage(cacheFilePath, sourceHash, image);
+
+    return image;
+}
+
+QImage SvgImageProvider::loadCachedImage(const QString &cacheFilePath, const QByteArray &sourceHash) const
+{
+    QImageReader reader(cacheFilePath, "png");
+    if (!reader.canRead() || reader.text(QLatin1String(sourceHashKey)).toLatin1() != sourceHash)
+        return QImage();
+    return reader.read();
+}
+
+void SvgImageProvider::saveCachedImage(const QString &cacheFilePath, const QByteArray &sourceHash, QImage image) const
+{
+    // The file is replaced atomically, since several threads may render the same image
+    image.setText(QLatin1String(sourceHashKey), QString::fromLatin1(sourceHash));
+    QSaveFile file(cacheFilePath);
+    if (file.open(QIODevice::WriteOnly) && image.save(&file, "png"))
+        file.commit();
+}
@@ -30,16 +30,31 @@
 #ifndef SVGIMAGEPROVIDER_H
 #define SVGIMAGEPROVIDER_H
 
-#include <QQuickImageProvider>
+#include <QQuickAsyncImageProvider>
+#include <QThreadPool>
+#include <QCache>
+#include <QMutex>
+#include <QImage>
 
-class SvgImageProvider : public QQuickImageProvider
+class SvgImageProvider : public QQuickAsyncImageProvider
 {
 public:
     explicit SvgImageProvider();
     ~SvgImageProvider();
 
-    QPixmap requestPixmap(const QString &id, QSize *size, const QSize &requestedSize) override;
+    QQuickImageResponse *requestImageResponse(const QString &id, const QSize &requestedSize) override;
+
+    QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize) override;
+
+private:
+    QImage renderImage(const QString &imagePath, const QSize &imageSize);
+    QImage loadCachedImage(const QString &cacheFilePath, const QByteArray &sourceHash) const;
+    void saveCachedImage(const QString &cacheFilePath, const QByteArray &sourceHash, QImage image) const;
+
+    QThreadPool pool;
+    QMutex cacheLock;
+    QCache<QString, QImage> cache;
+    QString diskCachePath;
 };
 
 #endif // SVGIMAGEPROVIDER_H
-
@@ -0,0 +1,587 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Virtual Keyboard module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "traceink.h"
+#include <QtVirtualKeyboard/QVirtualKeyboardTrace>
+#include <QSGGeometryNode>
+#include <QSGFlatColorMaterial>
+#include <QSGOpacityNode>
+#include <QElapsedTimer>
+#include <QEasingCurve>
+#include <QPointer>
+#include <QVector>
+#include <QtMath>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \qmltype TraceInk
+    \inqmlmodule QtQuick.VirtualKeyboard.Styles
+    \brief A scene graph item for rendering Trace objects.
+    \ingroup qtvirtualkeyboard-styles-qml
+    \inherits Item
+    \since QtQuick.VirtualKeyboard.Styles 2.15
+
+    This type renders Trace objects directly into the scene graph. One
+    instance renders all the active traces of a trace input area. The
+    points are read from the trace as they are added, and only the new
+    part of the line is tessellated. The line is smoothed the same way as
+    with the \c renderSmoothedLine function of TraceCanvas.
+
+    To use this type for Trace rendering, declare it as the
+    \l {KeyboardStyle::traceInkDelegate}{KeyboardStyle.traceInkDelegate}
+    component. The delegate is created with the trace input area as its
+    parent, so the drawing attributes can depend on the canvas type:
+
+    \code
+        traceInkDelegate: TraceInk {
+            lineWidth: parent.canvasType === "fullscreen" ? 10 : 10 * scaleHint
+            color: "white"
+            fadeDuration: 150
+        }
+    \endcode
+
+    The ink is not antialiased. Enable multisampling in the window
+    surface format for smooth edges.
+*/
+
+/*!
+    \qmlproperty real TraceInk::lineWidth
+
+    The width of the line in pixels. The default value is \c 10.
+*/
+
+/*!
+    \qmlproperty color TraceInk::color
+
+    The color of the line. The default color is black.
+*/
+
+/*!
+    \qmlproperty int TraceInk::fadeDuration
+
+    The duration in milliseconds of the fade out animation, which starts
+    when the trace is destroyed. If the value is \c 0, the line is removed
+    immediately. The default value is \c 150.
+*/
+
+/*!
+    \qmlproperty int TraceInk::count
+
+    The number of traces currently rendered by this item.
+*/
+
+/*!
+    \qmlmethod void TraceInk::addTrace(Trace trace)
+
+    Starts rendering the \a trace. The item follows the trace until it is
+    destroyed, and then fades the line out.
+*/
+
+/*!
+    \qmlmethod void TraceInk::clear()
+
+    Removes all the traces immediately.
+*/
+
+namespace {
+
+const int CHUNK_SIZE = 1024;
+const int DISC_SEGMENTS = 16;
+const int ANIMATION_INTERVAL = 16;
+const int TRACE_OPACITY_DURATION = 1500;
+
+struct Pen
+{
+    QPointF position;
+    bool joinPending = false;
+};
+
+inline QSGGeometry::Point2D vertex(const QPointF &point)
+{
+    QSGGeometry::Point2D v;
+    v.set(float(point.x()), float(point.y()));
+    return v;
+}
+
+// Connects a new run of vertices to the strip with degenerate triangles.
+inline void bridge(QVector<QSGGeometry::Point2D> &vertices, const QSGGeometry::Point2D &next)
+{
+    if (!vertices.isEmpty()) {
+        const QSGGeometry::Point2D last = vertices.last();
+        vertices.append(last);
+        vertices.append(next);
+    }
+}
+
+void appendDisc(const QPointF &center, qreal radius, QVector<QSGGeometry::Point2D> &vertices)
+{
+    const QSGGeometry::Point2D c = vertex(center);
+    bridge(vertices, vertex(center + QPointF(radius, 0)));
+    for (int i = 0; i <= DISC_SEGMENTS; ++i) {
+        const qreal angle = 2 * M_PI * i / DISC_SEGMENTS;
+        vertices.append(vertex(center + QPointF(radius * qCos(angle), radius * qSin(angle))));
+        vertices.append(c);
+    }
+}
+
+void appendSegment(Pen &pen, const QPointF &point, qreal halfWidth, QVector<QSGGeometry::Point2D> &vertices)
+{
+    const QPointF d = point - pen.position;
+    const qreal length = qSqrt(d.x() * d.x() + d.y() * d.y());
+    if (length < 0.01)
+        return;
+    const QPointF normal(-d.y() * halfWidth / length, d.x() * halfWidth / length);
+    const QSGGeometry::Point2D a = vertex(pen.position + normal);
+    if (pen.joinPending) {
+        bridge(vertices, a);
+        pen.joinPending = false;
+    }
+    // Starting each segment with its own normal fills the outer side of
+    // the join, which is enough for the short segments of a tessellated curve.
+    vertices.append(a);
+    vertices.append(vertex(pen.position - normal));
+    vertices.append(vertex(point + normal));
+    vertices.append(vertex(point - normal));
+    pen.position = point;
+}
+
+void appendCurve(Pen &pen, const QPointF &from, const QPointF &control, const QPointF &to,
+                 qreal halfWidth, QVector<QSGGeometry::Point2D> &vertices)
+{
+    const QPointF d1 = control - from;
+    const QPointF d2 = to - control;
+    const qreal length = qSqrt(d1.x() * d1.x() + d1.y() * d1.y()) + qSqrt(d2.x() * d2.x() + d2.y() * d2.y());
+    const int steps = qBound(1, qCeil(length / 4), 16);
+    for (int i = 1; i <= steps; ++i) {
+        const qreal t = qreal(i) / steps;
+        const qreal u = 1 - t;
+        appendSegment(pen, u * u * from + 2 * u * t * control + t * t * to, halfWidth, vertices);
+    }
+}
+
+QSGGeometryNode *createGeometryNode(const QColor &color)
+{
+    QSGGeometry *geometry = new QSGGeometry(QSGGeometry::defaultAttributes_Point2D(), 0);
+    geometry->setDrawingMode(QSGGeometry::DrawTriangleStrip);
+    geometry->setVertexDataPattern(QSGGeometry::DynamicPattern);
+    QSGFlatColorMaterial *material = new QSGFlatColorMaterial();
+    material->setColor(color);
+    QSGGeometryNode *node = new QSGGeometryNode();
+    node->setGeometry(geometry);
+    node->setMaterial(material);
+    node->setFlags(QSGNode::OwnsGeometry | QSGNode::OwnsMaterial);
+    return node;
+}
+
+void fillGeometryNode(QSGGeometryNode *node, const QSGGeometry::Point2D *data, int count)
+{
+    QSGGeometry *geometry = node->geometry();
+    if (count < 3)
+        count = 0;
+    geometry->allocate(count);
+    if (count > 0)
+        memcpy(geometry->vertexDataAsPoint2D(), data, count * sizeof(QSGGeometry::Point2D));
+    node->markDirty(QSGNode::DirtyGeometry);
+}
+
+} // namespace
+
+struct TraceInk::Stroke
+{
+    const QObject *key = nullptr;
+    QPointer<QVirtualKeyboardTrace> trace;
+
+    // Tessellation state. The vertices hold the committed part of the
+    // triangle strip, which only grows while the trace is active.
+    QVector<QSGGeometry::Point2D> vertices;
+    Pen pen;
+    QPointF curveStart;
+    QPointF previousPoint;
+    int consumed = 0;
+
+    qreal opacity = 1.0;
+    qreal opacityFrom = 1.0;
+    qreal opacityTo = 1.0;
+    QElapsedTimer opacityTimer;
+    qreal fade = 1.0;
+    QElapsedTimer fadeTimer;
+
+    bool dirty = true;
+    bool opacityDirty = true;
+
+    // Scene graph state. The committed vertices are split into chunks of
+    // CHUNK_SIZE vertices; a sealed chunk is uploaded once and never again.
+    QSGOpacityNode *node = nullptr;
+    int sealedChunks = 0;
+};
+
+TraceInk::TraceInk(QQuickItem *parent) :
+    QQuickItem(parent),
+    m_color(Qt::black),
+    m_lineWidth(10),
+    m_fadeDuration(150),
+    colorDirty(false)
+{
+    setFlag(ItemHasContents);
+}
+
+TraceInk::~TraceInk()
+{
+    qDeleteAll(strokes);
+}
+
+qreal TraceInk::lineWidth() const
+{
+    return m_lineWidth;
+}
+
+void TraceInk::setLineWidth(qreal lineWidth)
+{
+    if (qFuzzyCompare(m_lineWidth, lineWidth))
+        return;
+    m_lineWidth = lineWidth;
+    rebuildStrokes();
+    emit lineWidthChanged();
+}
+
+QColor TraceInk::color() const
+{
+    return m_color;
+}
+
+void TraceInk::setColor(const QColor &color)
+{
+    if (m_color == color)
+        return;
+    m_color = color;
+    colorDirty = true;
+    update();
+    emit colorChanged();
+}
+
+int TraceInk::fadeDuration() const
+{
+    return m_fadeDuration;
+}
+
+void TraceInk::setFadeDuration(int fadeDuration)
+{
+    if (m_fadeDuration == fadeDuration)
+        return;
+    m_fadeDuration = fadeDuration;
+    emit fadeDurationChanged();
+}
+
+int TraceInk::count() const
+{
+    return strokes.size();
+}
+
+void TraceInk::addTrace(QVirtualKeyboardTrace *trace)
+{
+    if (!trace || findStroke(trace))
+        return;
+
+    Stroke *stroke = new Stroke();
+    stroke->key = trace;
+    stroke->trace = trace;
+    stroke->opacity = trace->opacity();
+    stroke->opacityTo = stroke->opacity;
+    strokes.append(stroke);
+
+    connect(trace, &QVirtualKeyboardTrace::pointsAdded, this, &TraceInk::onTracePointsAdded);
+    connect(trace, &QVirtualKeyboardTrace::opacityChanged, this, &TraceInk::onTraceOpacityChanged);
+    connect(trace, &QObject::destroyed, this, &TraceInk::onTraceDestroyed);
+
+    consumePoints(stroke);
+    update();
+    emit countChanged();
+}
+
+void TraceInk::clear()
+{
+    if (strokes.isEmpty())
+        return;
+    while (!strokes.isEmpty())
+        removeStroke(strokes.last());
+    updateAnimationTimer();
+    update();
+}
+
+QSGNode *TraceInk::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data)
+{
+    Q_UNUSED(data)
+
+    QSGNode *root = oldNode;
+    if (!root) {
+        // The previous node tree, if any, was destroyed with its children
+        root = new QSGNode();
+        removedNodes.clear();
+        for (Stroke *stroke : qAsConst(strokes)) {
+            stroke->node = nullptr;
+            stroke->sealedChunks = 0;
+            stroke->dirty = true;
+            stroke->opacityDirty = true;
+        }
+    }
+
+    for (QSGNode *node : qAsConst(removedNodes)) {
+        root->removeChildNode(node);
+        delete node;
+    }
+    removedNodes.clear();
+
+    for (Stroke *stroke : qAsConst(strokes)) {
+        if (!stroke->node) {
+            stroke->node = new QSGOpacityNode();
+            root->appendChildNode(stroke->node);
+        }
+        if (stroke->opacityDirty) {
+            stroke->node->setOpacity(qBound(qreal(0), stroke->opacity * stroke->fade, qreal(1)));
+            stroke->opacityDirty = false;
+        }
+        if (stroke->dirty) {
+            updateStrokeGeometry(stroke);
+            stroke->dirty = false;
+        }
+        if (colorDirty) {
+            for (QSGNode *child = stroke->node->firstChild(); child; child = child->nextSibling()) {
+                QSGGeometryNode *geometryNode = static_cast<QSGGeometryNode *>(child);
+                static_cast<QSGFlatColorMaterial *>(geometryNode->material())->setColor(m_color);
+                geometryNode->markDirty(QSGNode::DirtyMaterial);
+            }
+        }
+    }
+    colorDirty = false;
+
+    return root;
+}
+
+void TraceInk::timerEvent(QTimerEvent *event)
+{
+    if (event->timerId() != animationTimer.timerId()) {
+        QQuickItem::timerEvent(event);
+        return;
+    }
+    if (!advanceAnimations())
+        animationTimer.stop();
+    update();
+}
+
+void TraceInk::onTracePointsAdded()
+{
+    Stroke *stroke = findStroke(sender());
+    if (!stroke)
+        return;
+    consumePoints(stroke);
+    update();
+}
+
+void TraceInk::onTraceOpacityChanged()
+{
+    Stroke *stroke = findStroke(sender());
+    if (!stroke || !stroke->trace)
+        return;
+    stroke->opacityFrom = stroke->opacity;
+    stroke->opacityTo = stroke->trace->opacity();
+    stroke->opacityTimer.start();
+    updateAnimationTimer();
+}
+
+void TraceInk::onTraceDestroyed(QObject *object)
+{
+    Stroke *stroke = findStroke(object);
+    if (!stroke)
+        return;
+    // A new trace may be allocated at the same address while the stroke
+    // fades out
+    stroke->key = nullptr;
+    if (m_fadeDuration <= 0) {
+        removeStroke(stroke);
+        update();
+        return;
+    }
+    stroke->fadeTimer.start();
+    updateAnimationTimer();
+}
+
+TraceInk::Stroke *TraceInk::findStroke(const QObject *trace) const
+{
+    for (Stroke *stroke : strokes) {
+        if (stroke->key == trace)
+            return stroke;
+    }
+    return nullptr;
+}
+
+void TraceInk::removeStroke(Stroke *stroke)
+{
+    if (stroke->trace)
+        stroke->trace->disconnect(this);
+    if (stroke->node)
+        removedNodes.append(stroke->node);
+    strokes.removeOne(stroke);
+    delete stroke;
+    emit countChanged();
+}
+
+void TraceInk::consumePoints(Stroke *stroke)
+{
+    if (!stroke->trace || stroke->consumed >= stroke->trace->length())
+        return;
+
+    // Follows TraceUtils.renderSmoothedLine: a dot at the first point, then
+    // quadratic curves through the midpoints of consecutive points.
+    const qreal halfWidth = m_lineWidth / 2;
+    const QVariantList points = stroke->trace->points(stroke->consumed);
+    for (const QVariant &value : points) {
+        const QPointF point = value.toPointF();
+        const int index = stroke->consumed++;
+        if (index == 0) {
+            appendDisc(point, halfWidth, stroke->vertices);
+            stroke->pen.position = point;
+            stroke->pen.joinPending = true;
+            stroke->curveStart = point;
+        } else if (index >= 2) {
+            const QPointF midPoint = (stroke->previousPoint + point) / 2;
+            appendCurve(stroke->pen, stroke->curveStart, stroke->previousPoint, midPoint, halfWidth, stroke->vertices);
+            stroke->curveStart = midPoint;
+        }
+        stroke->previousPoint = point;
+    }
+    stroke->dirty = true;
+}
+
+void TraceInk::updateStrokeGeometry(Stroke *stroke)
+{
+    QSGOpacityNode *strokeNode = stroke->node;
+    const QVector<QSGGeometry::Point2D> &vertices = stroke->vertices;
+    const int sealableChunks = vertices.size() / CHUNK_SIZE;
+
+    // Each chunk repeats the last two vertices of the previous one so
+    // that the strip continues without a gap.
+    while (stroke->sealedChunks < sealableChunks) {
+        const int index = stroke->sealedChunks++;
+        QSGGeometryNode *node = static_cast<QSGGeometryNode *>(strokeNode->childAtIndex(index));
+        if (!node) {
+            node = createGeometryNode(m_color);
+            strokeNode->appendChildNode(node);
+        }
+        const int start = qMax(0, index * CHUNK_SIZE - 2);
+        fillGeometryNode(node, vertices.constData() + start, (index + 1) * CHUNK_SIZE - start);
+    }
+
+    // The open chunk carries the straight line to the latest point and the
+    // round end cap, which are replaced on every update.
+    const int start = qMax(0, stroke->sealedChunks * CHUNK_SIZE - 2);
+    QVector<QSGGeometry::Point2D> open(vertices.mid(start));
+    if (stroke->consumed > 1) {
+        const qreal halfWidth = m_lineWidth / 2;
+        Pen pen = stroke->pen;
+        appendSegment(pen, stroke->previousPoint, halfWidth, open);
+        appendDisc(stroke->previousPoint, halfWidth, open);
+    }
+
+    QSGGeometryNode *node = static_cast<QSGGeometryNode *>(strokeNode->childAtIndex(stroke->sealedChunks));
+    if (!node) {
+        node = createGeometryNode(m_color);
+        strokeNode->appendChildNode(node);
+    }
+    fillGeometryNode(node, open.constData(), open.size());
+
+    while (strokeNode->childCount() > stroke->sealedChunks + 1) {
+        QSGNode *child = strokeNode->lastChild();
+        strokeNode->removeChildNode(child);
+        delete child;
+    }
+}
+
+void TraceInk::rebuildStrokes()
+{
+    for (Stroke *stroke : qAsConst(strokes)) {
+        if (!stroke->trace)
+            continue;
+        stroke->vertices.clear();
+        stroke->pen = Pen();
+        stroke->consumed = 0;
+        stroke->sealedChunks = 0;
+        consumePoints(stroke);
+    }
+    update();
+}
+
+bool TraceInk::advanceAnimations()
+{
+    static const QEasingCurve opacityCurve(QEasingCurve::InOutQuad);
+    static const QEasingCurve fadeCurve(QEasingCurve::OutCubic);
+
+    for (int i = strokes.size() - 1; i >= 0; --i) {
+        Stroke *stroke = strokes.at(i);
+        if (stroke->opacityTimer.isValid()) {
+            const qreal progress = qMin(qreal(1), qreal(stroke->opacityTimer.elapsed()) / TRACE_OPACITY_DURATION);
+            stroke->opacity = stroke->opacityFrom + (stroke->opacityTo - stroke->opacityFrom) * opacityCurve.valueForProgress(progress);
+            stroke->opacityDirty = true;
+            if (progress >= 1)
+                stroke->opacityTimer.invalidate();
+        }
+        if (stroke->fadeTimer.isValid()) {
+            const qreal progress = m_fadeDuration > 0 ? qMin(qreal(1), qreal(stroke->fadeTimer.elapsed()) / m_fadeDuration) : 1;
+            if (progress >= 1) {
+                removeStroke(stroke);
+                continue;
+            }
+            stroke->fade = 1 - fadeCurve.valueForProgress(progress);
+            stroke->opacityDirty = true;
+        }
+    }
+
+    for (const Stroke *stroke : qAsConst(strokes)) {
+        if (stroke->opacityTimer.isValid() || stroke->fadeTimer.isValid())
+            return true;
+    }
+    return false;
+}
+
+void TraceInk::updateAnimationTimer()
+{
+    bool animating = false;
+    for (const Stroke *stroke : qAsConst(strokes)) {
+        if (stroke->opacityTimer.isValid() || stroke->fadeTimer.isValid()) {
+            animating = true;
+            break;
+        }
+    }
+    if (animating && !animationTimer.isActive())
+        animationTimer.start(ANIMATION_INTERVAL, this);
+    else if (!animating)
+        animationTimer.stop();
+}
+
+QT_END_NAMESPACE
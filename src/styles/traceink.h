@@ -0,0 +1,105 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Virtual Keyboard module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef TRACEINK_H
+#define TRACEINK_H
+
+#include <QQuickItem>
+#include <QBasicTimer>
+#include <QColor>
+#include <QList>
+
+QT_BEGIN_NAMESPACE
+
+class QVirtualKeyboardTrace;
+
+class TraceInk : public QQuickItem
+{
+    Q_OBJECT
+    Q_PROPERTY(qreal lineWidth READ lineWidth WRITE setLineWidth NOTIFY lineWidthChanged)
+    Q_PROPERTY(QColor color READ color WRITE setColor NOTIFY colorChanged)
+    Q_PROPERTY(int fadeDuration READ fadeDuration WRITE setFadeDuration NOTIFY fadeDurationChanged)
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+public:
+    explicit TraceInk(QQuickItem *parent = nullptr);
+    ~TraceInk();
+
+    qreal lineWidth() const;
+    void setLineWidth(qreal lineWidth);
+
+    QColor color() const;
+    void setColor(const QColor &color);
+
+    int fadeDuration() const;
+    void setFadeDuration(int fadeDuration);
+
+    int count() const;
+
+    Q_INVOKABLE void addTrace(QVirtualKeyboardTrace *trace);
+    Q_INVOKABLE void clear();
+
+Q_SIGNALS:
+    void lineWidthChanged();
+    void colorChanged();
+    void fadeDurationChanged();
+    void countChanged();
+
+protected:
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
+    void timerEvent(QTimerEvent *event) override;
+
+private Q_SLOTS:
+    void onTracePointsAdded();
+    void onTraceOpacityChanged();
+    void onTraceDestroyed(QObject *object);
+
+private:
+    struct Stroke;
+
+    Stroke *findStroke(const QObject *trace) const;
+    void removeStroke(Stroke *stroke);
+    void consumePoints(Stroke *stroke);
+    void updateStrokeGeometry(Stroke *stroke);
+    void rebuildStrokes();
+    bool advanceAnimations();
+    void updateAnimationTimer();
+
+    QList<Stroke *> strokes;
+    QList<QSGNode *> removedNodes;
+    QBasicTimer animationTimer;
+    QColor m_color;
+    qreal m_lineWidth;
+    int m_fadeDuration;
+    bool colorDirty;
+};
+
+QT_END_NAMESPACE
+
+#endif // TRACEINK_H
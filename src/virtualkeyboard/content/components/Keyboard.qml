@@ -32,11 +32,10 @@ import QtQuick 2.0
 import QtQml 2.14
 import QtQuick.Layouts 1.0
 import QtQuick.Window 2.2
-import QtQuick.VirtualKeyboard 2.3
+import QtQuick.VirtualKeyboard 2.15
 import QtQuick.VirtualKeyboard.Styles 2.1
 import QtQuick.VirtualKeyboard.Settings 2.2
 import QtQuick.VirtualKeyboard.Plugins 2.3
-import Qt.labs.folderlistmodel 2.0
 
 Item {
     id: keyboard
@@ -45,12 +44,14 @@ Item {
     property alias style: styleLoader.item
     property alias wordCandidateView: wordCandidateView
     property alias shadowInputControl: shadowInputControl
+    property alias keyHitIndex: keyHitIndex
     property var activeKey: null
     property TouchPoint activeTouchPoint
     property int localeIndex: -1
     property var availableLocaleIndices: []
     property var availableCustomLocaleIndices: []
-    property string locale: localeIndex >= 0 && localeIndex < layoutsModel.count ? layoutsModel.get(localeIndex, "fileName") : ""
+    property var layoutLocales: []
+    property string locale: localeIndex >= 0 && localeIndex < layoutLocales.length ? layoutLocales[localeIndex] : ""
     property string inputLocale
     property int defaultLocaleIndex: -1
     readonly property bool latinOnly: InputContext.inputMethodHints & (Qt.ImhLatinOnly | Qt.ImhEmailCharactersOnly | Qt.ImhUrlCharactersOnly)
@@ -454,17 +455,21 @@ Item {
             }
         }
     }
-    FolderListModel {
-        id: layoutsModel
-        nameFilters: ["$"]
-        folder: VirtualKeyboardSettings.layoutPath
+    LayoutRegistry {
+        id: layoutRegistry
+        layoutPath: VirtualKeyboardSettings.layoutPath
     }
     Connections {
-        target: layoutsModel
-        function onCountChanged() {
+        target: layoutRegistry
+        function onLocalesChanged() {
+            layoutLocales = layoutRegistry.locales
             updateDefaultLocale()
             localeIndex = defaultLocaleIndex
         }
+        function onLayoutsChanged() {
+            updateAvailableLocaleIndices()
+            updateLayout()
+        }
     }
     AlternativeKeys {
         id: alternativeKeys
@@ -813,10 +818,21 @@ Item {
             LayoutMirroring.enabled: false
             LayoutMirroring.childrenInherit: true
 
-            Loader {
+            Item {
                 id: keyboardLayoutLoader
                 objectName: "keyboardLayoutLoader"
 
+                property url source
+                property Item item: null
+                readonly property int status: item ? Loader.Ready : (source.toString().length > 0 ? Loader.Error : Loader.Null)
+
+                function resizeItem() {
+                    if (item) {
+                        item.width = width
+                        item.height = height
+                    }
+                }
+
                 anchors.fill: parent
                 anchors.leftMargin: Math.round(style.keyboardRelativeLeftMargin * parent.width)
                 anchors.rightMargin: Math.round(style.keyboardRelativeRightMargin * parent.width)
@@ -831,11 +847,23 @@ Item {
                     restoreMode: Binding.RestoreBinding
                 }
 
+                onSourceChanged: {
+                    if (item)
+                        keyboardLayoutPool.release(item)
+                    item = source.toString().length > 0 ? keyboardLayoutPool.acquire(source, keyboardLayoutLoader) : null
+                }
                 onItemChanged: {
+                    resizeItem()
                     // Reset input mode if the new layout wants to override it
                     if (item && item.inputMode !== -1)
                         inputModeNeedsReset = true
                 }
+                onWidthChanged: resizeItem()
+                onHeightChanged: resizeItem()
+
+                KeyboardLayoutPool {
+                    id: keyboardLayoutPool
+                }
 
                 MultiPointTouchArea {
                     id: keyboardInputArea
@@ -900,27 +928,18 @@ Item {
                             keyboard.activeKey.active = true
                         }
                     }
+                    KeyHitIndex {
+                        id: keyHitIndex
+                        root: keyboardLayoutLoader
+                    }
+
                     function keyOnPoint(px, py) {
-                        var parentItem = keyboardLayoutLoader
-                        var child = parentItem.childAt(px, py)
-                        while (child !== null) {
-                            var position = parentItem.mapToItem(child, px, py)
-                            px = position.x; py = position.y
-                            parentItem = child
-                            child = parentItem.childAt(px, py)
-                            if (child && child.key !== undefined)
-                                return child
-                        }
-                        return null
+                        return keyHitIndex.keyAt(px, py)
                     }
                     function hitInitialKey(x, y, margin) {
                         if (!initialKey)
                             return false
-                        var position = initialKey.mapFromItem(keyboardInputArea, x, y)
-                        return (position.x > -margin
-                                && position.y > -margin
-                                && position.x < initialKey.width + margin
-                                && position.y < initialKey.height + margin)
+                        return keyHitIndex.keyContains(initialKey, x, y, margin)
                     }
                     function containsPoint(touchPoints, point) {
                         if (!point)
@@ -1435,11 +1454,32 @@ Item {
         layout = newLayout
         inputLocale = locale
         updateInputMethod()
+        if (keyboardLayoutPool.prewarmEnabled)
+            Qt.callLater(prewarmLayouts)
+    }
+
+    function prewarmLayouts() {
+        var locales = [locale]
+        var activeLocales = VirtualKeyboardSettings.activeLocales
+        for (var i = 0; i < activeLocales.length; i++) {
+            if (locales.indexOf(activeLocales[i]) === -1 && isValidLocale(activeLocales[i]))
+                locales.push(activeLocales[i])
+        }
+        var layoutTypes = ["main", "symbols"]
+        if (InputContext.priv.inputMethods.indexOf("HandwritingInputMethod") !== -1)
+            layoutTypes.push("handwriting")
+        for (i = 0; i < locales.length; i++) {
+            for (var j = 0; j < layoutTypes.length; j++) {
+                var layoutFile = findLayout(locales[i], layoutTypes[j])
+                if (layoutFile.length > 0)
+                    keyboardLayoutPool.prewarm(layoutFile, keyboardLayoutLoader)
+            }
+        }
     }
 
     function updateDefaultLocale() {
         updateAvailableLocaleIndices()
-        if (layoutsModel.count > 0) {
+        if (layoutLocales.length > 0) {
             var defaultLocales = []
             if (isValidLocale(VirtualKeyboardSettings.locale))
                 defaultLocales.push(VirtualKeyboardSettings.locale)
@@ -1450,7 +1490,7 @@ Item {
             if (VirtualKeyboardSettings.availableLocales.indexOf("en_GB") !== -1)
                 defaultLocales.push("en_GB")
             if (availableLocaleIndices.length > 0)
-                defaultLocales.push(layoutsModel.get(availableLocaleIndices[0], "fileName"))
+                defaultLocales.push(layoutLocales[availableLocaleIndices[0]])
             var newDefaultLocaleIndex = -1
             for (var i = 0; i < defaultLocales.length; i++) {
                 newDefaultLocaleIndex = findLocale(defaultLocales[i], -1)
@@ -1466,9 +1506,9 @@ Item {
 
     function filterLocaleIndices(filterCb) {
         var localeIndices = []
-        for (var i = 0; i < layoutsModel.count; i++) {
+        for (var i = 0; i < layoutLocales.length; i++) {
             if (localeIndices.indexOf(i) === -1) {
-                var localeName = layoutsModel.get(i, "fileName")
+                var localeName = layoutLocales[i]
                 if (filterCb(localeName) && findLayout(localeName, "main"))
                     localeIndices.push(i)
             }
@@ -1494,7 +1534,7 @@ Item {
         // Fetch matching locale names
         var newAvailableLocales = []
         for (var i = 0; i < newIndices.length; i++) {
-            newAvailableLocales.push(layoutsModel.get(newIndices[i], "fileName"))
+            newAvailableLocales.push(layoutLocales[newIndices[i]])
         }
 
         newIndices.sort(function(a, b) { return a - b })
@@ -1506,7 +1546,7 @@ Item {
         newIndices = []
         for (i = 0; i < availableLocaleIndices.length; i++) {
             if (availableLocaleIndices[i] === localeIndex ||
-                    layoutExists(layoutsModel.get(availableLocaleIndices[i], "fileName"), layoutType))
+                    layoutExists(layoutLocales[availableLocaleIndices[i]], layoutType))
                 newIndices.push(availableLocaleIndices[i])
         }
         availableCustomLocaleIndices = newIndices
@@ -1516,7 +1556,7 @@ Item {
         var locales = []
         var localeIndices = customLayoutsOnly ? availableCustomLocaleIndices : availableLocaleIndices
         for (var i = 0; i < localeIndices.length; i++) {
-            var layoutFolder = layoutsModel.get(localeIndices[i], "fileName")
+            var layoutFolder = layoutLocales[localeIndices[i]]
             if (localeNameOnly)
                 locales.push(layoutFolder)
             else
@@ -1551,10 +1591,8 @@ Item {
     function findLocale(localeName, defaultValue) {
         var languageCode = localeName.substring(0, 3) // Including the '_' delimiter
         var languageMatch = -1
-        for (var i = 0; i < layoutsModel.count; i++) {
-            if (!layoutsModel.isFolder(i))
-                continue
-            var layoutFolder = layoutsModel.get(i, "fileName")
+        for (var i = 0; i < layoutLocales.length; i++) {
+            var layoutFolder = layoutLocales[i]
             if (layoutFolder === localeName)
                 return i
             if (languageMatch == -1 && layoutFolder.substring(0, 3) === languageCode)
@@ -1564,8 +1602,8 @@ Item {
     }
 
     function findFallbackIndex() {
-        for (var i = 0; i < layoutsModel.count; i++) {
-            var layoutFolder = layoutsModel.get(i, "fileName")
+        for (var i = 0; i < layoutLocales.length; i++) {
+            var layoutFolder = layoutLocales[i]
             if (layoutFolder === "fallback")
                 return i
         }
@@ -1575,9 +1613,9 @@ Item {
     function isValidLocale(localeNameOrIndex, ignoreActiveLocales) {
         var localeName
         if (typeof localeNameOrIndex == "number") {
-            if (localeNameOrIndex < 0 || localeNameOrIndex >= layoutsModel.count)
+            if (localeNameOrIndex < 0 || localeNameOrIndex >= layoutLocales.length)
                 return false
-            localeName = layoutsModel.get(localeNameOrIndex, "fileName")
+            localeName = layoutLocales[localeNameOrIndex]
         } else {
             localeName = localeNameOrIndex
         }
@@ -1599,36 +1637,12 @@ Item {
         return true
     }
 
-    function getLayoutFile(localeName, layoutType) {
-        if (localeName === "" || layoutType === "")
-            return ""
-        return layoutsModel.folder + "/" + localeName + "/" + layoutType + ".qml"
-    }
-
-    function getFallbackFile(localeName, layoutType) {
-        if (localeName === "" || layoutType === "")
-            return ""
-        return layoutsModel.folder + "/" + localeName + "/" + layoutType + ".fallback"
-    }
-
     function layoutExists(localeName, layoutType) {
-        var result = InputContext.priv.fileExists(getLayoutFile(localeName, layoutType))
-        if (!result && layoutType === "handwriting")
-            result = InputContext.priv.fileExists(getFallbackFile(localeName, layoutType))
-        return result
+        return layoutRegistry.layoutExists(localeName, layoutType)
     }
 
     function findLayout(localeName, layoutType) {
-        var layoutFile = getLayoutFile(localeName, layoutType)
-        if (InputContext.priv.fileExists(layoutFile))
-            return layoutFile
-        var fallbackFile = getFallbackFile(localeName, layoutType)
-        if (InputContext.priv.fileExists(fallbackFile)) {
-            layoutFile = getLayoutFile("fallback", layoutType)
-            if (InputContext.priv.fileExists(layoutFile))
-                return layoutFile
-        }
-        return ""
+        return layoutRegistry.findLayout(localeName, layoutType)
     }
 
     function isHandwritingAvailable() {
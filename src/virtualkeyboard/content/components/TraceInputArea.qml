@@ -43,8 +43,10 @@ import QtQuick.VirtualKeyboard 2.1
     This type handles the trace interaction between the touch screen and the input engine.
 
     The traces are rendered using the delegate from the
-    \l {KeyboardStyle::}{traceCanvasDelegate} property of the current
-    \l KeyboardStyle.
+    \l {KeyboardStyle::}{traceInkDelegate} property of the current
+    \l KeyboardStyle, which renders all the traces of the area in one item.
+    If the style does not define it, each trace is rendered with the delegate
+    from the \l {KeyboardStyle::}{traceCanvasDelegate} property.
 */
 
 MultiPointTouchArea {
@@ -95,20 +97,44 @@ MultiPointTouchArea {
     */
     property string canvasType
 
-    property var __traceCanvasList: ([])
+    property var __activeTraces: ({})
+    property Component __traceInkDelegate: null
+    property Item __traceInk: null
 
     /*! \internal */
     function findTraceCanvasById(traceId) {
-        for (var i = 0; i < __traceCanvasList.length;) {
-            var traceCanvas = __traceCanvasList[i]
-            if (!traceCanvas || !traceCanvas.trace)
-                __traceCanvasList.splice(i, 1)
-            else if (traceCanvas.trace.traceId === traceId)
-                return traceCanvas
-            else
-                i++
+        return __findTraceById(traceId) ? __activeTraces[traceId].canvas : null
+    }
+
+    function __findTraceById(traceId) {
+        var activeTrace = __activeTraces[traceId]
+        if (!activeTrace)
+            return null
+        // The properties of a destroyed trace read as undefined
+        if (!activeTrace.trace || activeTrace.trace.traceId !== traceId) {
+            delete __activeTraces[traceId]
+            return null
         }
-        return null
+        return activeTrace.trace
+    }
+
+    function __createTraceRenderer(trace) {
+        var traceInkDelegate = keyboard.style.traceInkDelegate
+        if (__traceInkDelegate !== traceInkDelegate) {
+            if (__traceInk)
+                __traceInk.destroy()
+            __traceInk = traceInkDelegate ? traceInkDelegate.createObject(traceInputArea) : null
+            if (__traceInk)
+                __traceInk.anchors.fill = traceInputArea
+            __traceInkDelegate = traceInkDelegate
+        }
+        if (__traceInk) {
+            __traceInk.addTrace(trace)
+            return null
+        }
+        var traceCanvas = keyboard.style.traceCanvasDelegate.createObject(traceInputArea, { "trace": trace, "autoDestroy": true })
+        traceCanvas.anchors.fill = traceCanvas.parent
+        return traceCanvas
     }
 
     property var __traceCaptureDeviceInfo:
@@ -130,28 +156,27 @@ MultiPointTouchArea {
     enabled: patternRecognitionMode !== InputEngine.PatternRecognitionMode.None && InputContext.inputEngine.patternRecognitionModes.indexOf(patternRecognitionMode) !== -1
 
     onPressed: {
-        if (!keyboard.style.traceCanvasDelegate)
+        if (!keyboard.style.traceInkDelegate && !keyboard.style.traceCanvasDelegate)
             return
         for (var i = 0; i < touchPoints.length; i++) {
             var trace = InputContext.inputEngine.traceBegin(touchPoints[i].pointId, patternRecognitionMode, __traceCaptureDeviceInfo, __traceScreenInfo)
             if (trace) {
-                var traceCanvas = keyboard.style.traceCanvasDelegate.createObject(traceInputArea, { "trace": trace, "autoDestroy": true })
-                traceCanvas.anchors.fill = traceCanvas.parent
+                trace.batchUpdates = true
+                var traceCanvas = __createTraceRenderer(trace)
                 var index = trace.addPoint(Qt.point(touchPoints[i].x, touchPoints[i].y))
                 if (trace.channels.indexOf('t') !== -1) {
                     var dt = new Date()
                     trace.setChannelData('t', index, dt.getTime())
                 }
-                __traceCanvasList.push(traceCanvas)
+                __activeTraces[touchPoints[i].pointId] = { "trace": trace, "canvas": traceCanvas }
             }
         }
     }
 
     onUpdated: {
         for (var i = 0; i < touchPoints.length; i++) {
-            var traceCanvas = findTraceCanvasById(touchPoints[i].pointId)
-            if (traceCanvas) {
-                var trace = traceCanvas.trace
+            var trace = __findTraceById(touchPoints[i].pointId)
+            if (trace) {
                 var index = trace.addPoint(Qt.point(touchPoints[i].x, touchPoints[i].y))
                 if (trace.channels.indexOf('t') !== -1) {
                     var dt = new Date()
@@ -163,23 +188,23 @@ MultiPointTouchArea {
 
     onReleased: {
         for (var i = 0; i < touchPoints.length; i++) {
-            var traceCanvas = findTraceCanvasById(touchPoints[i].pointId)
-            if (traceCanvas) {
-                traceCanvas.trace.final = true
-                __traceCanvasList.splice(__traceCanvasList.indexOf(traceCanvas), 1)
-                InputContext.inputEngine.traceEnd(traceCanvas.trace)
+            var trace = __findTraceById(touchPoints[i].pointId)
+            if (trace) {
+                trace.final = true
+                delete __activeTraces[touchPoints[i].pointId]
+                InputContext.inputEngine.traceEnd(trace)
             }
         }
     }
 
     onCanceled: {
         for (var i = 0; i < touchPoints.length; i++) {
-            var traceCanvas = findTraceCanvasById(touchPoints[i].pointId)
-            if (traceCanvas) {
-                traceCanvas.trace.final = true
-                traceCanvas.trace.canceled = true
-                __traceCanvasList.splice(__traceCanvasList.indexOf(traceCanvas), 1)
-                InputContext.inputEngine.traceEnd(traceCanvas.trace)
+            var trace = __findTraceById(touchPoints[i].pointId)
+            if (trace) {
+                trace.final = true
+                trace.canceled = true
+                delete __activeTraces[touchPoints[i].pointId]
+                InputContext.inputEngine.traceEnd(trace)
             }
         }
     }
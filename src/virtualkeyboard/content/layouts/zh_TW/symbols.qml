@@ -37,6 +37,7 @@ KeyboardLayoutLoader {
     }
     sharedLayouts: ['main']
     property int page
+    onVisibleChanged: if (!visible) page = 0
     readonly property int numPages: 3
     property var keysPage1: [
         "1234567890",
@@ -29,7 +29,7 @@
 
 import QtQuick 2.7
 import QtQuick.VirtualKeyboard 2.1
-import QtQuick.VirtualKeyboard.Styles 2.1
+import QtQuick.VirtualKeyboard.Styles 2.15
 
 KeyboardStyle {
     id: currentStyle
@@ -865,25 +865,10 @@ KeyboardStyle {
         }
     }
 
-    traceCanvasDelegate: TraceCanvas {
-        id: traceCanvas
-        onAvailableChanged: {
-            if (!available)
-                return
-            var ctx = getContext("2d")
-            if (parent.canvasType === "fullscreen") {
-                ctx.lineWidth = 10
-                ctx.strokeStyle = Qt.rgba(0, 0, 0)
-            } else {
-                ctx.lineWidth = 10 * scaleHint
-                ctx.strokeStyle = Qt.rgba(0xFF, 0xFF, 0xFF)
-            }
-            ctx.lineCap = "round"
-            ctx.fillStyle = ctx.strokeStyle
-        }
-        autoDestroyDelay: 800
-        onTraceChanged: if (trace === null) opacity = 0
-        Behavior on opacity { PropertyAnimation { easing.type: Easing.OutCubic; duration: 150 } }
+    traceInkDelegate: TraceInk {
+        lineWidth: parent.canvasType === "fullscreen" ? 10 : 10 * scaleHint
+        color: parent.canvasType === "fullscreen" ? Qt.rgba(0, 0, 0) : Qt.rgba(0xFF, 0xFF, 0xFF)
+        fadeDuration: 150
     }
 
     popupListDelegate: SelectionListItem {
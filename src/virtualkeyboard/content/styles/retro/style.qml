@@ -29,7 +29,7 @@
 
 import QtQuick 2.0
 import QtQuick.VirtualKeyboard 2.1
-import QtQuick.VirtualKeyboard.Styles 2.1
+import QtQuick.VirtualKeyboard.Styles 2.15
 
 KeyboardStyle {
     id: currentStyle
@@ -977,20 +977,10 @@ KeyboardStyle {
         }
     }
 
-    traceCanvasDelegate: TraceCanvas {
-        id: traceCanvas
-        onAvailableChanged: {
-            if (!available)
-                return
-            var ctx = getContext("2d")
-            ctx.lineWidth = parent.canvasType === "fullscreen" ? 10 : 10 * scaleHint
-            ctx.lineCap = "round"
-            ctx.strokeStyle = Qt.rgba(0, 0, 0)
-            ctx.fillStyle = ctx.strokeStyle
-        }
-        autoDestroyDelay: 800
-        onTraceChanged: if (trace === null) opacity = 0
-        Behavior on opacity { PropertyAnimation { easing.type: Easing.OutCubic; duration: 150 } }
+    traceInkDelegate: TraceInk {
+        lineWidth: parent.canvasType === "fullscreen" ? 10 : 10 * scaleHint
+        color: Qt.rgba(0, 0, 0)
+        fadeDuration: 150
     }
 
     popupListDelegate: SelectionListItem {
@@ -36,6 +36,8 @@
 #include <QtVirtualKeyboard/qvirtualkeyboardinputcontext.h>
 #include <QGuiApplication>
 #include <QQmlEngine>
+#include <QQmlComponent>
+#include <QPointer>
 #include <QScreen>
 #include <QtVirtualKeyboard/private/virtualkeyboarddebug_p.h>
 #if QT_CONFIG(vkb_xcb)
@@ -49,6 +51,8 @@
 QT_BEGIN_NAMESPACE
 namespace QtVirtualKeyboard {
 
+static const char inputPanelUrl[] = "qrc:///QtQuick/VirtualKeyboard/content/InputPanel.qml";
+
 class DesktopInputPanelPrivate : public AppInputPanelPrivate
 {
 public:
@@ -75,6 +79,7 @@ public:
     }
 
     QScopedPointer<InputView> view;
+    QPointer<QQmlComponent> prewarmComponent;
     QRectF keyboardRect;
     QRectF previewRect;
     bool previewVisible;
@@ -131,39 +136,64 @@ void DesktopInputPanel::setInputRect(const QRect &inputRect)
     updateInputRegion();
 }
 
+/*!
+    Creates the view without loading the input panel and compiles
+    InputPanel.qml asynchronously in the engine of the view. The input
+    panel is not instantiated until createView() is called, which then
+    uses the compiled type.
+*/
+void DesktopInputPanel::prewarmView()
+{
+    Q_D(DesktopInputPanel);
+    if (d->view)
+        return;
+    initView();
+    VIRTUALKEYBOARD_DEBUG() << "DesktopInputPanel::prewarmView()";
+    d->prewarmComponent = new QQmlComponent(d->view->engine(), QUrl(QLatin1String(inputPanelUrl)), QQmlComponent::Asynchronous, this);
+}
+
 void DesktopInputPanel::createView()
 {
     Q_D(DesktopInputPanel);
-    if (!d->view) {
-        if (qGuiApp) {
-            connect(qGuiApp, SIGNAL(focusWindowChanged(QWindow*)), SLOT(focusWindowChanged(QWindow*)));
-            focusWindowChanged(qGuiApp->focusWindow());
-        }
-        d->view.reset(new InputView());
-        d->view->setFlags(Qt::FramelessWindowHint | Qt::WindowStaysOnTopHint | Qt::WindowDoesNotAcceptFocus);
-        /*  Set appropriate WindowType for target environment.
-            There seems to be no common type which would
-            work in all environments. The purpose of this
-            flag is to avoid the window from capturing focus,
-            as well as hiding it from the task bar. */
-        switch (d->windowingSystem) {
-        case DesktopInputPanelPrivate::Xcb:
-            d->view->setFlags(d->view->flags() | Qt::Window | Qt::BypassWindowManagerHint);
-            break;
-        default:
-            d->view->setFlags(d->view->flags() | Qt::Tool);
-            break;
-        }
-        d->view->setColor(QColor(Qt::transparent));
-        d->view->setSource(QUrl(QLatin1String("qrc:///QtQuick/VirtualKeyboard/content/InputPanel.qml")));
-        if (QGuiApplication *app = qGuiApp)
-            connect(app, SIGNAL(aboutToQuit()), SLOT(destroyView()));
+    if (!d->view)
+        initView();
+    if (d->view->source().isEmpty()) {
+        d->view->setSource(QUrl(QLatin1String(inputPanelUrl)));
+        delete d->prewarmComponent.data();
+    }
+}
+
+void DesktopInputPanel::initView()
+{
+    Q_D(DesktopInputPanel);
+    if (qGuiApp) {
+        connect(qGuiApp, SIGNAL(focusWindowChanged(QWindow*)), SLOT(focusWindowChanged(QWindow*)));
+        focusWindowChanged(qGuiApp->focusWindow());
+    }
+    d->view.reset(new InputView());
+    d->view->setFlags(Qt::FramelessWindowHint | Qt::WindowStaysOnTopHint | Qt::WindowDoesNotAcceptFocus);
+    /*  Set appropriate WindowType for target environment.
+        There seems to be no common type which would
+        work in all environments. The purpose of this
+        flag is to avoid the window from capturing focus,
+        as well as hiding it from the task bar. */
+    switch (d->windowingSystem) {
+    case DesktopInputPanelPrivate::Xcb:
+        d->view->setFlags(d->view->flags() | Qt::Window | Qt::BypassWindowManagerHint);
+        break;
+    default:
+        d->view->setFlags(d->view->flags() | Qt::Tool);
+        break;
     }
+    d->view->setColor(QColor(Qt::transparent));
+    if (QGuiApplication *app = qGuiApp)
+        connect(app, SIGNAL(aboutToQuit()), SLOT(destroyView()));
 }
 
 void DesktopInputPanel::destroyView()
 {
     Q_D(DesktopInputPanel);
+    delete d->prewarmComponent.data();
     d->view.reset();
     d->previewBindingActive = false;
 }
@@ -65,6 +65,8 @@ public:
 
     void setInputRect(const QRect &inputRect) override;
 
+    void prewarmView();
+
 public slots:
     void createView() override;
     void destroyView() override;
@@ -77,6 +79,7 @@ protected slots:
     void previewVisibleChanged();
 
 protected:
+    void initView();
     void updateInputRegion();
 };
 
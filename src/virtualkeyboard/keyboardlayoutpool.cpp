@@ -0,0 +1,407 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Virtual Keyboard module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtVirtualKeyboard/private/keyboardlayoutpool_p.h>
+#include <QtVirtualKeyboard/private/virtualkeyboarddebug_p.h>
+#include <QtCore/private/qobject_p.h>
+#include <QQmlComponent>
+#include <QQmlContext>
+#include <QQmlEngine>
+#include <QQmlIncubator>
+#include <QQuickItem>
+#include <QPointer>
+#include <QHash>
+
+QT_BEGIN_NAMESPACE
+namespace QtVirtualKeyboard {
+
+static const char prewarmEnvVarName[] = "QT_VIRTUALKEYBOARD_PREWARM";
+static const int defaultPrewarmCapacity = 6;
+
+class KeyboardLayoutPoolPrivate;
+
+class KeyboardLayoutIncubator : public QQmlIncubator
+{
+public:
+    KeyboardLayoutIncubator(KeyboardLayoutPoolPrivate *pool, const QUrl &source) :
+        QQmlIncubator(QQmlIncubator::Asynchronous),
+        pool(pool),
+        source(source)
+    {
+    }
+
+    KeyboardLayoutPoolPrivate *const pool;
+    const QUrl source;
+
+protected:
+    void setInitialState(QObject *object) override;
+    void statusChanged(Status status) override;
+};
+
+class KeyboardLayoutPoolPrivate : public QObjectPrivate
+{
+    Q_DECLARE_PUBLIC(KeyboardLayoutPool)
+public:
+    struct Entry {
+        QUrl source;
+        QPointer<QQuickItem> item;
+    };
+
+    KeyboardLayoutPoolPrivate() :
+        QObjectPrivate(),
+        capacity(0),
+        prewarmEnabled(KeyboardLayoutPool::isPrewarmEnabledByEnvironment())
+    {
+        if (prewarmEnabled)
+            capacity = defaultPrewarmCapacity;
+    }
+
+    QQmlComponent *component(const QUrl &source, QQmlEngine *engine, QQmlComponent::CompilationMode mode);
+    QQuickItem *adopt(QObject *object, const QUrl &source);
+    QQuickItem *take(const QUrl &source);
+    bool hasItem(const QUrl &source) const;
+    void trim(int size);
+    void incubate(const QUrl &source, QQuickItem *container);
+    void incubated(KeyboardLayoutIncubator *incubator);
+    void reapIncubators();
+
+    QHash<QUrl, QQmlComponent *> components;
+    QHash<QUrl, KeyboardLayoutIncubator *> incubators;
+    QList<KeyboardLayoutIncubator *> finishedIncubators;
+    QList<Entry> pooled;
+    QHash<QObject *, QUrl> sources;
+    int capacity;
+    bool prewarmEnabled;
+};
+
+void KeyboardLayoutIncubator::setInitialState(QObject *object)
+{
+    // Keep the layout out of sight until it is acquired
+    if (QQuickItem *item = qobject_cast<QQuickItem *>(object))
+        item->setVisible(false);
+}
+
+void KeyboardLayoutIncubator::statusChanged(Status status)
+{
+    if (status == QQmlIncubator::Ready || status == QQmlIncubator::Error)
+        pool->incubated(this);
+}
+
+QQmlComponent *KeyboardLayoutPoolPrivate::component(const QUrl &source, QQmlEngine *engine, QQmlComponent::CompilationMode mode)
+{
+    Q_Q(KeyboardLayoutPool);
+    QQmlComponent *component = components.value(source);
+    if (component && component->isLoading() && mode == QQmlComponent::PreferSynchronous) {
+        /*  A component which is still being loaded asynchronously can not
+            be used for creating objects. Replace it with a synchronous one,
+            which shares the type data already loaded by the engine.
+        */
+        components.remove(source);
+        component->deleteLater();
+        component = nullptr;
+    }
+    if (!component) {
+        component = new QQmlComponent(engine, source, mode, q);
+        components.insert(source, component);
+    }
+    return component;
+}
+
+QQuickItem *KeyboardLayoutPoolPrivate::adopt(QObject *object, const QUrl &source)
+{
+    Q_Q(KeyboardLayoutPool);
+    QQuickItem *item = qobject_cast<QQuickItem *>(object);
+    if (!item) {
+        VIRTUALKEYBOARD_WARN() << "KeyboardLayoutPool: the root object of" << source << "is not an Item";
+        delete object;
+        return nullptr;
+    }
+    QQmlEngine::setObjectOwnership(item, QQmlEngine::CppOwnership);
+    item->setParent(q);
+    sources.insert(item, source);
+    QObject::connect(item, &QObject::destroyed, q, [this](QObject *object) {
+        sources.remove(object);
+    });
+    return item;
+}
+
+QQuickItem *KeyboardLayoutPoolPrivate::take(const QUrl &source)
+{
+    for (int i = 0; i < pooled.size(); ++i) {
+        if (pooled.at(i).source == source) {
+            QQuickItem *item = pooled.takeAt(i).item;
+            if (item)
+                return item;
+            --i;
+        }
+    }
+    return nullptr;
+}
+
+bool KeyboardLayoutPoolPrivate::hasItem(const QUrl &source) const
+{
+    for (auto it = sources.constBegin(); it != sources.constEnd(); ++it) {
+        if (it.value() == source)
+            return true;
+    }
+    return false;
+}
+
+void KeyboardLayoutPoolPrivate::trim(int size)
+{
+    while (pooled.size() > size) {
+        QQuickItem *item = pooled.takeLast().item;
+        if (item)
+            item->deleteLater();
+    }
+}
+
+void KeyboardLayoutPoolPrivate::incubate(const QUrl &source, QQuickItem *container)
+{
+    Q_Q(KeyboardLayoutPool);
+    QQmlContext *context = qmlContext(container);
+    if (!context)
+        return;
+
+    QQmlComponent *layoutComponent = component(source, context->engine(), QQmlComponent::Asynchronous);
+    if (layoutComponent->isLoading()) {
+        QPointer<QQuickItem> guard(container);
+        QObject::connect(layoutComponent, &QQmlComponent::statusChanged, q, [this, layoutComponent, source, guard](QQmlComponent::Status status) {
+            if (status == QQmlComponent::Loading)
+                return;
+            QObject::disconnect(layoutComponent, &QQmlComponent::statusChanged, q_func(), nullptr);
+            if (status == QQmlComponent::Ready && guard && !incubators.contains(source) && !hasItem(source))
+                incubate(source, guard);
+        });
+        return;
+    }
+    if (!layoutComponent->isReady()) {
+        VIRTUALKEYBOARD_WARN() << "KeyboardLayoutPool: failed to load" << source << layoutComponent->errorString();
+        return;
+    }
+
+    KeyboardLayoutIncubator *incubator = new KeyboardLayoutIncubator(this, source);
+    incubators.insert(source, incubator);
+    layoutComponent->create(*incubator, context);
+}
+
+void KeyboardLayoutPoolPrivate::incubated(KeyboardLayoutIncubator *incubator)
+{
+    Q_Q(KeyboardLayoutPool);
+    if (incubators.value(incubator->source) == incubator)
+        incubators.remove(incubator->source);
+
+    if (incubator->isReady()) {
+        if (QQuickItem *item = adopt(incubator->object(), incubator->source)) {
+            pooled.append({incubator->source, item});
+            trim(capacity);
+        }
+    } else {
+        VIRTUALKEYBOARD_WARN() << "KeyboardLayoutPool: failed to incubate" << incubator->source << incubator->errors();
+    }
+
+    // The incubator can not be deleted from within its own status callback
+    if (finishedIncubators.isEmpty())
+        QMetaObject::invokeMethod(q, [this]() { reapIncubators(); }, Qt::QueuedConnection);
+    finishedIncubators.append(incubator);
+}
+
+void KeyboardLayoutPoolPrivate::reapIncubators()
+{
+    qDeleteAll(finishedIncubators);
+    finishedIncubators.clear();
+}
+
+/*!
+    \class QtVirtualKeyboard::KeyboardLayoutPool
+    \internal
+    \inmodule QtVirtualKeyboard
+
+    \brief Creates keyboard layout items and keeps recently used ones alive.
+
+    The pool replaces a Loader for the keyboard layouts. Items are created
+    with acquire() and handed back with release(). Released items are hidden,
+    detached from the item tree and kept for reuse, up to \l capacity items.
+    A layout which keeps state of its own must reset it when it becomes
+    hidden, like the symbol layouts do with their current page.
+
+    In pre-warm mode, prewarm() incubates layouts asynchronously so that
+    the first switch to them does not have to compile and create them.
+    Pre-warm mode is enabled by setting the \c QT_VIRTUALKEYBOARD_PREWARM
+    environment variable to a non-zero value.
+*/
+
+KeyboardLayoutPool::KeyboardLayoutPool(QObject *parent) :
+    QObject(*new KeyboardLayoutPoolPrivate(), parent)
+{
+}
+
+KeyboardLayoutPool::~KeyboardLayoutPool()
+{
+    Q_D(KeyboardLayoutPool);
+    qDeleteAll(d->incubators);
+    d->reapIncubators();
+}
+
+bool KeyboardLayoutPool::isPrewarmEnabledByEnvironment()
+{
+    return qEnvironmentVariableIntValue(prewarmEnvVarName) != 0;
+}
+
+/*!
+    \property QtVirtualKeyboard::KeyboardLayoutPool::capacity
+    \internal
+
+    The maximum number of released layout items kept alive. The default
+    is zero, unless pre-warm mode is enabled.
+*/
+int KeyboardLayoutPool::capacity() const
+{
+    Q_D(const KeyboardLayoutPool);
+    return d->capacity;
+}
+
+void KeyboardLayoutPool::setCapacity(int capacity)
+{
+    Q_D(KeyboardLayoutPool);
+    capacity = qMax(0, capacity);
+    if (d->capacity == capacity)
+        return;
+    d->capacity = capacity;
+    d->trim(capacity);
+    emit capacityChanged();
+}
+
+bool KeyboardLayoutPool::isPrewarmEnabled() const
+{
+    Q_D(const KeyboardLayoutPool);
+    return d->prewarmEnabled;
+}
+
+/*!
+    Returns a layout item for \a source, parented to \a container.
+
+    A pooled item is reused if available and a pending incubation is
+    completed synchronously. Otherwise a new item is created in the
+    context of \a container.
+*/
+QQuickItem *KeyboardLayoutPool::acquire(const QUrl &source, QQuickItem *container)
+{
+    Q_D(KeyboardLayoutPool);
+    if (source.isEmpty() || !container)
+        return nullptr;
+
+    if (KeyboardLayoutIncubator *incubator = d->incubators.value(source))
+        incubator->forceCompletion();
+
+    QQuickItem *item = d->take(source);
+    if (!item) {
+        QQmlContext *context = qmlContext(container);
+        if (!context)
+            return nullptr;
+        QQmlComponent *component = d->component(source, context->engine(), QQmlComponent::PreferSynchronous);
+        if (!component->isReady()) {
+            VIRTUALKEYBOARD_WARN() << "KeyboardLayoutPool: failed to load" << source << component->errorString();
+            return nullptr;
+        }
+        QObject *object = component->beginCreate(context);
+        if (!object) {
+            VIRTUALKEYBOARD_WARN() << "KeyboardLayoutPool: failed to create" << source << component->errorString();
+            return nullptr;
+        }
+        if (QQuickItem *newItem = qobject_cast<QQuickItem *>(object))
+            newItem->setParentItem(container);
+        component->completeCreate();
+        item = d->adopt(object, source);
+        if (!item)
+            return nullptr;
+    } else {
+        item->setParentItem(container);
+    }
+    item->setVisible(true);
+    return item;
+}
+
+/*!
+    Hands \a item back to the pool. The item is detached from the item
+    tree immediately and either kept for reuse or destroyed.
+*/
+void KeyboardLayoutPool::release(QQuickItem *item)
+{
+    Q_D(KeyboardLayoutPool);
+    if (!item)
+        return;
+    /*  Detach the item before hiding it, so that it always sees its
+        visibility change to false, even when the keyboard is hidden.
+        Layouts reset their state, such as the current page of the
+        symbol layouts, when they become hidden, which makes a pooled
+        item look newly created when it is handed out again.
+    */
+    item->setParentItem(nullptr);
+    item->setVisible(false);
+    const auto it = d->sources.constFind(item);
+    if (it == d->sources.constEnd() || d->capacity == 0) {
+        item->deleteLater();
+        return;
+    }
+    d->pooled.prepend({it.value(), item});
+    d->trim(d->capacity);
+}
+
+/*!
+    Starts an asynchronous incubation of \a source in the context of
+    \a container, unless pre-warm mode is disabled, an item for \a source
+    already exists, or the pool is full.
+*/
+void KeyboardLayoutPool::prewarm(const QUrl &source, QQuickItem *container)
+{
+    Q_D(KeyboardLayoutPool);
+    if (!d->prewarmEnabled || source.isEmpty() || !container)
+        return;
+    if (d->incubators.contains(source) || d->hasItem(source))
+        return;
+    if (d->pooled.size() + d->incubators.size() >= d->capacity)
+        return;
+    VIRTUALKEYBOARD_DEBUG() << "KeyboardLayoutPool::prewarm():" << source;
+    d->incubate(source, container);
+}
+
+/*!
+    Destroys all pooled items and cancels pending incubations.
+*/
+void KeyboardLayoutPool::clear()
+{
+    Q_D(KeyboardLayoutPool);
+    qDeleteAll(d->incubators);
+    d->incubators.clear();
+    d->trim(0);
+}
+
+} // namespace QtVirtualKeyboard
+QT_END_NAMESPACE
@@ -0,0 +1,86 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Virtual Keyboard module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef KEYBOARDLAYOUTPOOL_P_H
+#define KEYBOARDLAYOUTPOOL_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QObject>
+#include <QUrl>
+#include <QtVirtualKeyboard/qvirtualkeyboard_global.h>
+
+QT_BEGIN_NAMESPACE
+
+class QQuickItem;
+
+namespace QtVirtualKeyboard {
+
+class KeyboardLayoutPoolPrivate;
+
+class QVIRTUALKEYBOARD_EXPORT KeyboardLayoutPool : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(KeyboardLayoutPool)
+    Q_DECLARE_PRIVATE(KeyboardLayoutPool)
+    Q_PROPERTY(int capacity READ capacity WRITE setCapacity NOTIFY capacityChanged)
+    Q_PROPERTY(bool prewarmEnabled READ isPrewarmEnabled CONSTANT)
+
+public:
+    explicit KeyboardLayoutPool(QObject *parent = nullptr);
+    ~KeyboardLayoutPool();
+
+    static bool isPrewarmEnabledByEnvironment();
+
+    int capacity() const;
+    void setCapacity(int capacity);
+    bool isPrewarmEnabled() const;
+
+    Q_INVOKABLE QQuickItem *acquire(const QUrl &source, QQuickItem *container);
+    Q_INVOKABLE void release(QQuickItem *item);
+    Q_INVOKABLE void prewarm(const QUrl &source, QQuickItem *container);
+    Q_INVOKABLE void clear();
+
+signals:
+    void capacityChanged();
+};
+
+} // namespace QtVirtualKeyboard
+QT_END_NAMESPACE
+
+#endif // KEYBOARDLAYOUTPOOL_P_H
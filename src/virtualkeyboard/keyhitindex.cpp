@@ -0,0 +1,352 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Virtual Keyboard module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtVirtualKeyboard/private/keyhitindex_p.h>
+#include <QtCore/private/qobject_p.h>
+#include <QQuickItem>
+#include <QPointer>
+#include <QHash>
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE
+namespace QtVirtualKeyboard {
+
+class KeyHitIndexPrivate : public QObjectPrivate
+{
+    Q_DECLARE_PUBLIC(KeyHitIndex)
+public:
+    struct Node {
+        QPointer<QQuickItem> item;
+        int parent;
+        bool isKey;
+    };
+
+    struct Cell {
+        qreal left;
+        qreal right;
+        QQuickItem *key;
+    };
+
+    KeyHitIndexPrivate() :
+        QObjectPrivate(),
+        structureDirty(true),
+        geometryDirty(true)
+    {
+    }
+
+    void untrack();
+    void collect(QQuickItem *item, int parent, int depth);
+    void build();
+    void update();
+
+    QPointer<QQuickItem> root;
+    QVector<Node> nodes;
+    QHash<QQuickItem *, QRectF> keyRects;
+    QVector<qreal> rowEdges;
+    QVector<int> rowCells;
+    QVector<Cell> cells;
+    bool structureDirty;
+    bool geometryDirty;
+};
+
+static bool isKeyItem(const QQuickItem *item)
+{
+    return item->metaObject()->indexOfProperty("key") >= 0;
+}
+
+void KeyHitIndexPrivate::untrack()
+{
+    Q_Q(KeyHitIndex);
+    if (root)
+        QObject::disconnect(root, nullptr, q, nullptr);
+    for (const Node &node : qAsConst(nodes)) {
+        if (node.item)
+            QObject::disconnect(node.item, nullptr, q, nullptr);
+    }
+    nodes.clear();
+}
+
+/*
+    Collects the items below \a item in depth-first order, which is also
+    the order in which QQuickItem::childAt() prefers overlapping siblings.
+    Keys are leaves: the items inside a key are never hit-tested.
+*/
+void KeyHitIndexPrivate::collect(QQuickItem *item, int parent, int depth)
+{
+    Q_Q(KeyHitIndex);
+    const QList<QQuickItem *> children = item->childItems();
+    for (QQuickItem *child : children) {
+        // Direct children of the root are containers, even if they
+        // have a key property.
+        const bool isKey = depth > 0 && isKeyItem(child);
+        const int index = nodes.size();
+        nodes.append({ child, parent, isKey });
+        QObject::connect(child, &QQuickItem::xChanged, q, &KeyHitIndex::invalidateGeometry);
+        QObject::connect(child, &QQuickItem::yChanged, q, &KeyHitIndex::invalidateGeometry);
+        QObject::connect(child, &QQuickItem::widthChanged, q, &KeyHitIndex::invalidateGeometry);
+        QObject::connect(child, &QQuickItem::heightChanged, q, &KeyHitIndex::invalidateGeometry);
+        QObject::connect(child, &QQuickItem::visibleChanged, q, &KeyHitIndex::invalidateGeometry);
+        QObject::connect(child, &QObject::destroyed, q, &KeyHitIndex::invalidateStructure);
+        if (!isKey) {
+            QObject::connect(child, &QQuickItem::childrenChanged, q, &KeyHitIndex::invalidateStructure);
+            collect(child, index, depth + 1);
+        }
+    }
+}
+
+/*
+    Builds the lookup table from the current geometry.
+
+    QQuickItem::childAt() walks down to the last visible child containing the
+    point, so the item it ends up with is the visible item with the highest
+    depth-first index among those whose rectangle, clipped by all of its
+    ancestors, contains the point.
+
+    The table splits the root into horizontal rows at every top and bottom
+    edge, and each row into cells at every left and right edge. Each cell
+    stores the key that wins there; cells won by a non-key item are dropped.
+*/
+void KeyHitIndexPrivate::build()
+{
+    rowEdges.clear();
+    rowCells.clear();
+    cells.clear();
+    keyRects.clear();
+    if (!root)
+        return;
+
+    struct Entry {
+        QRectF rect;
+        QQuickItem *key;
+    };
+    QVector<Entry> entries;
+    QVector<QRectF> clipRects(nodes.size());
+    entries.reserve(nodes.size());
+    for (int i = 0; i < nodes.size(); ++i) {
+        const Node &node = nodes.at(i);
+        QQuickItem *item = node.item;
+        if (!item || !item->isVisible())
+            continue;
+        const QRectF rect = item->mapRectToItem(root, QRectF(0, 0, item->width(), item->height()));
+        if (node.isKey)
+            keyRects.insert(item, rect);
+        const QRectF clipRect = node.parent >= 0 ? rect.intersected(clipRects.at(node.parent)) : rect;
+        clipRects[i] = clipRect;
+        if (!clipRect.isEmpty())
+            entries.append({ clipRect, node.isKey ? item : nullptr });
+    }
+
+    for (const Entry &entry : qAsConst(entries)) {
+        rowEdges.append(entry.rect.top());
+        rowEdges.append(entry.rect.bottom());
+    }
+    std::sort(rowEdges.begin(), rowEdges.end());
+    rowEdges.erase(std::unique(rowEdges.begin(), rowEdges.end()), rowEdges.end());
+
+    QVector<qreal> columnEdges;
+    QVector<QQuickItem *> columnKeys;
+    QVector<bool> columnHit;
+    for (int row = 0; row + 1 < rowEdges.size(); ++row) {
+        rowCells.append(cells.size());
+        const qreal top = rowEdges.at(row);
+        const qreal bottom = rowEdges.at(row + 1);
+
+        columnEdges.clear();
+        for (const Entry &entry : qAsConst(entries)) {
+            if (entry.rect.top() <= top && entry.rect.bottom() >= bottom) {
+                columnEdges.append(entry.rect.left());
+                columnEdges.append(entry.rect.right());
+            }
+        }
+        std::sort(columnEdges.begin(), columnEdges.end());
+        columnEdges.erase(std::unique(columnEdges.begin(), columnEdges.end()), columnEdges.end());
+        if (columnEdges.size() < 2)
+            continue;
+
+        // Paint the entries in depth-first order, so later ones win
+        columnKeys.fill(nullptr, columnEdges.size() - 1);
+        columnHit.fill(false, columnEdges.size() - 1);
+        for (const Entry &entry : qAsConst(entries)) {
+            if (entry.rect.top() > top || entry.rect.bottom() < bottom)
+                continue;
+            const int first = int(std::lower_bound(columnEdges.cbegin(), columnEdges.cend(), entry.rect.left()) - columnEdges.cbegin());
+            const int last = int(std::lower_bound(columnEdges.cbegin(), columnEdges.cend(), entry.rect.right()) - columnEdges.cbegin());
+            for (int column = first; column < last; ++column) {
+                columnKeys[column] = entry.key;
+                columnHit[column] = true;
+            }
+        }
+
+        for (int column = 0; column + 1 < columnEdges.size(); ++column) {
+            QQuickItem *key = columnKeys.at(column);
+            if (!columnHit.at(column) || !key)
+                continue;
+            if (cells.size() > rowCells.last() &&
+                    cells.last().key == key && cells.last().right == columnEdges.at(column))
+                cells.last().right = columnEdges.at(column + 1);
+            else
+                cells.append({ columnEdges.at(column), columnEdges.at(column + 1), key });
+        }
+    }
+    rowCells.append(cells.size());
+}
+
+void KeyHitIndexPrivate::update()
+{
+    if (structureDirty) {
+        Q_Q(KeyHitIndex);
+        untrack();
+        if (root) {
+            QObject::connect(root, &QQuickItem::childrenChanged, q, &KeyHitIndex::invalidateStructure);
+            collect(root, -1, 0);
+        }
+        structureDirty = false;
+        geometryDirty = true;
+    }
+    if (geometryDirty) {
+        build();
+        geometryDirty = false;
+    }
+}
+
+/*!
+    \class QtVirtualKeyboard::KeyHitIndex
+    \internal
+    \inmodule QtVirtualKeyboard
+    \brief Spatial index for finding the key under a point.
+
+    The index resolves a point in the coordinate system of the root item
+    to the key that QQuickItem::childAt() would find when descending from
+    the root, i.e. the first item with a \c key property. The lookup is
+    a binary search in a table that is rebuilt lazily when the items
+    below the root change geometry, visibility or children.
+*/
+
+KeyHitIndex::KeyHitIndex(QObject *parent) :
+    QObject(*new KeyHitIndexPrivate(), parent)
+{
+}
+
+KeyHitIndex::~KeyHitIndex()
+{
+}
+
+/*!
+    \property QtVirtualKeyboard::KeyHitIndex::root
+    \internal
+    \brief The item whose descendants are indexed.
+*/
+QQuickItem *KeyHitIndex::root() const
+{
+    Q_D(const KeyHitIndex);
+    return d->root.data();
+}
+
+void KeyHitIndex::setRoot(QQuickItem *root)
+{
+    Q_D(KeyHitIndex);
+    if (d->root == root)
+        return;
+    d->untrack();
+    d->root = root;
+    invalidateStructure();
+    emit rootChanged();
+}
+
+/*!
+    \internal
+
+    Returns the key at (\a x, \a y) in root item coordinates, or \c null
+    if there is no key at that point.
+*/
+QQuickItem *KeyHitIndex::keyAt(qreal x, qreal y)
+{
+    Q_D(KeyHitIndex);
+    d->update();
+    const auto rowIt = std::upper_bound(d->rowEdges.cbegin(), d->rowEdges.cend(), y);
+    if (rowIt == d->rowEdges.cbegin() || rowIt == d->rowEdges.cend())
+        return nullptr;
+    const int row = int(rowIt - d->rowEdges.cbegin()) - 1;
+    const auto cellsBegin = d->cells.cbegin() + d->rowCells.at(row);
+    const auto cellsEnd = d->cells.cbegin() + d->rowCells.at(row + 1);
+    auto cellIt = std::upper_bound(cellsBegin, cellsEnd, x,
+                                   [](qreal value, const KeyHitIndexPrivate::Cell &cell) {
+        return value < cell.left;
+    });
+    if (cellIt == cellsBegin)
+        return nullptr;
+    --cellIt;
+    return x < cellIt->right ? cellIt->key : nullptr;
+}
+
+/*!
+    \internal
+
+    Returns \c true if (\a x, \a y) in root item coordinates is inside
+    the \a key extended by \a margin on each side.
+*/
+bool KeyHitIndex::keyContains(QQuickItem *key, qreal x, qreal y, qreal margin)
+{
+    Q_D(KeyHitIndex);
+    if (!key || !d->root)
+        return false;
+    d->update();
+    QRectF rect = d->keyRects.value(key);
+    if (rect.isNull())
+        rect = key->mapRectToItem(d->root, QRectF(0, 0, key->width(), key->height()));
+    return x > rect.left() - margin && y > rect.top() - margin &&
+            x < rect.right() + margin && y < rect.bottom() + margin;
+}
+
+/*!
+    \internal
+
+    Forces the index to be rebuilt on the next query. Changes in the
+    geometry, visibility or children of the indexed items are tracked
+    automatically.
+*/
+void KeyHitIndex::invalidate()
+{
+    invalidateStructure();
+}
+
+void KeyHitIndex::invalidateGeometry()
+{
+    Q_D(KeyHitIndex);
+    d->geometryDirty = true;
+}
+
+void KeyHitIndex::invalidateStructure()
+{
+    Q_D(KeyHitIndex);
+    d->structureDirty = true;
+}
+
+} // namespace QtVirtualKeyboard
+QT_END_NAMESPACE
@@ -0,0 +1,84 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Virtual Keyboard module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef KEYHITINDEX_P_H
+#define KEYHITINDEX_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QObject>
+#include <QtVirtualKeyboard/qvirtualkeyboard_global.h>
+
+QT_BEGIN_NAMESPACE
+
+class QQuickItem;
+
+namespace QtVirtualKeyboard {
+
+class KeyHitIndexPrivate;
+
+class QVIRTUALKEYBOARD_EXPORT KeyHitIndex : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(KeyHitIndex)
+    Q_DECLARE_PRIVATE(KeyHitIndex)
+    Q_PROPERTY(QQuickItem *root READ root WRITE setRoot NOTIFY rootChanged)
+
+public:
+    explicit KeyHitIndex(QObject *parent = nullptr);
+    ~KeyHitIndex();
+
+    QQuickItem *root() const;
+    void setRoot(QQuickItem *root);
+
+    Q_INVOKABLE QQuickItem *keyAt(qreal x, qreal y);
+    Q_INVOKABLE bool keyContains(QQuickItem *key, qreal x, qreal y, qreal margin = 0);
+    Q_INVOKABLE void invalidate();
+
+signals:
+    void rootChanged();
+
+private slots:
+    void invalidateGeometry();
+    void invalidateStructure();
+};
+
+} // namespace QtVirtualKeyboard
+QT_END_NAMESPACE
+
+#endif // KEYHITINDEX_P_H
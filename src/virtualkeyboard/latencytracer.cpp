@@ -0,0 +1,359 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Virtual Keyboard module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtVirtualKeyboard/private/latencytracer_p.h>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMetaEnum>
+#include <QMutex>
+#include <QThread>
+#include <QtMath>
+#include <QVector>
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE
+namespace QtVirtualKeyboard {
+
+static const char latencyTraceEnvVarName[] = "QT_VIRTUALKEYBOARD_LATENCY_TRACE";
+static const int defaultTraceCapacity = 4096;
+static const int latencyWindowSize = 1024;
+
+struct LatencyTraceBuffer
+{
+    struct Event {
+        quint64 span;
+        qint64 timestamp;
+        qint64 duration;
+        int thread;
+        LatencyTracer::Stage stage;
+    };
+
+    LatencyTraceBuffer() :
+        events(defaultTraceCapacity),
+        head(0),
+        size(0),
+        latencies(latencyWindowSize),
+        latencyHead(0),
+        latencyCount(0),
+        nextSpan(0),
+        currentSpan(0),
+        spanStart(0),
+        spanOpen(false)
+    {
+        clock.start();
+    }
+
+    int threadIndex()
+    {
+        const Qt::HANDLE id = QThread::currentThreadId();
+        auto it = threads.constFind(id);
+        if (it != threads.constEnd())
+            return it.value();
+        const int index = threads.size() + 1;
+        threads.insert(id, index);
+        QString name = QThread::currentThread()->objectName();
+        if (name.isEmpty())
+            name = QCoreApplication::instance() && QThread::currentThread() == QCoreApplication::instance()->thread() ?
+                        QStringLiteral("main") : QStringLiteral("thread %1").arg(index);
+        threadNames.insert(index, name);
+        return index;
+    }
+
+    void append(quint64 span, qint64 timestamp, qint64 duration, LatencyTracer::Stage stage)
+    {
+        if (events.isEmpty())
+            return;
+        events[(head + size) % events.size()] = {span, timestamp, duration, threadIndex(), stage};
+        if (size < events.size())
+            ++size;
+        else
+            head = (head + 1) % events.size();
+    }
+
+    QMutex mutex;
+    QElapsedTimer clock;
+    QVector<Event> events;
+    int head;
+    int size;
+    QVector<qint64> latencies;
+    int latencyHead;
+    int latencyCount;
+    QHash<Qt::HANDLE, int> threads;
+    QHash<int, QString> threadNames;
+    quint64 nextSpan;
+    quint64 currentSpan;
+    qint64 spanStart;
+    bool spanOpen;
+};
+
+Q_GLOBAL_STATIC(LatencyTraceBuffer, traceBuffer)
+
+QBasicAtomicInt LatencyTracer::active = Q_BASIC_ATOMIC_INITIALIZER(0);
+
+/*!
+    \class QtVirtualKeyboard::LatencyTracer
+    \internal
+    \inmodule QtVirtualKeyboard
+
+    \brief Traces the latency of key input from the key press to the text
+    delivered to the input item.
+
+    A key press or click starts a new span. Each stage of the processing
+    records a monotonic timestamp for the current span into a process-wide
+    ring buffer. The first pre-edit or commit sent for the span ends the
+    keystroke, and its latency is added to a rolling window, from which
+    percentile() reads.
+
+    Tasks processed in worker threads capture the span when they are
+    created, so their stages are attributed to the key which caused them.
+
+    The tracing is disabled by default, in which case each trace point
+    costs one relaxed atomic load. It is enabled with the \l enabled
+    property, or by setting the \c QT_VIRTUALKEYBOARD_LATENCY_TRACE
+    environment variable to a non-zero value.
+*/
+
+LatencyTracer::LatencyTracer(QObject *parent) :
+    QObject(parent)
+{
+    if (qEnvironmentVariableIntValue(latencyTraceEnvVarName) != 0)
+        setEnabled(true);
+}
+
+LatencyTracer::~LatencyTracer()
+{
+}
+
+/*!
+    \property QtVirtualKeyboard::LatencyTracer::enabled
+    \internal
+
+    Enables the recording of trace events. The setting is process-wide.
+*/
+bool LatencyTracer::isEnabled() const
+{
+    return isActive();
+}
+
+void LatencyTracer::setEnabled(bool enabled)
+{
+    if (isActive() == enabled)
+        return;
+    if (enabled) {
+        // Create the buffer before the first trace point can use it
+        traceBuffer();
+    }
+    active.storeRelease(enabled ? 1 : 0);
+    emit enabledChanged();
+}
+
+/*!
+    \property QtVirtualKeyboard::LatencyTracer::capacity
+    \internal
+
+    The maximum number of trace events kept in the ring buffer. Changing
+    the capacity clears the recorded events.
+*/
+int LatencyTracer::capacity() const
+{
+    LatencyTraceBuffer *buffer = traceBuffer();
+    QMutexLocker guard(&buffer->mutex);
+    return buffer->events.size();
+}
+
+void LatencyTracer::setCapacity(int capacity)
+{
+    capacity = qMax(0, capacity);
+    LatencyTraceBuffer *buffer = traceBuffer();
+    {
+        QMutexLocker guard(&buffer->mutex);
+        if (buffer->events.size() == capacity)
+            return;
+        buffer->events = QVector<LatencyTraceBuffer::Event>(capacity);
+        buffer->head = 0;
+        buffer->size = 0;
+    }
+    emit capacityChanged();
+}
+
+/*!
+    Returns the number of keystroke latencies in the rolling window.
+*/
+int LatencyTracer::sampleCount() const
+{
+    LatencyTraceBuffer *buffer = traceBuffer();
+    QMutexLocker guard(&buffer->mutex);
+    return buffer->latencyCount;
+}
+
+/*!
+    Returns the given \a percentile (0 to 100) of the keystroke latencies in
+    the rolling window in milliseconds, or -1 if there are no samples.
+*/
+qreal LatencyTracer::percentile(qreal percentile) const
+{
+    LatencyTraceBuffer *buffer = traceBuffer();
+    QVector<qint64> samples;
+    {
+        QMutexLocker guard(&buffer->mutex);
+        samples = buffer->latencies.mid(0, buffer->latencyCount);
+    }
+    if (samples.isEmpty())
+        return -1;
+    const int rank = qBound(0, qCeil(qBound(0.0, percentile, 100.0) / 100.0 * samples.size()) - 1, samples.size() - 1);
+    std::nth_element(samples.begin(), samples.begin() + rank, samples.end());
+    return samples.at(rank) / 1000000.0;
+}
+
+/*!
+    Returns the recorded events in the Chrome trace event format.
+
+    Each stage is an instant event, and each completed keystroke is a
+    complete event spanning from the key press to the first text sent.
+    The span identifier is stored in the arguments of each event.
+*/
+QString LatencyTracer::traceEvents() const
+{
+    LatencyTraceBuffer *buffer = traceBuffer();
+    const QMetaEnum stageEnum = QMetaEnum::fromType<Stage>();
+    const qint64 pid = QCoreApplication::applicationPid();
+    QJsonArray traceEvents;
+
+    QMutexLocker guard(&buffer->mutex);
+    for (auto it = buffer->threadNames.constBegin(); it != buffer->threadNames.constEnd(); ++it) {
+        traceEvents.append(QJsonObject {
+            {QStringLiteral("name"), QStringLiteral("thread_name")},
+            {QStringLiteral("ph"), QStringLiteral("M")},
+            {QStringLiteral("pid"), pid},
+            {QStringLiteral("tid"), it.key()},
+            {QStringLiteral("args"), QJsonObject {{QStringLiteral("name"), it.value()}}}
+        });
+    }
+    for (int i = 0; i < buffer->size; ++i) {
+        const LatencyTraceBuffer::Event &event = buffer->events.at((buffer->head + i) % buffer->events.size());
+        QJsonObject traceEvent {
+            {QStringLiteral("name"), QLatin1String(stageEnum.valueToKey(event.stage))},
+            {QStringLiteral("cat"), QStringLiteral("qtvirtualkeyboard")},
+            {QStringLiteral("ts"), event.timestamp / 1000.0},
+            {QStringLiteral("pid"), pid},
+            {QStringLiteral("tid"), event.thread},
+            {QStringLiteral("args"), QJsonObject {{QStringLiteral("span"), static_cast<qint64>(event.span)}}}
+        };
+        if (event.stage == Keystroke) {
+            traceEvent.insert(QStringLiteral("ph"), QStringLiteral("X"));
+            traceEvent.insert(QStringLiteral("dur"), event.duration / 1000.0);
+        } else {
+            traceEvent.insert(QStringLiteral("ph"), QStringLiteral("i"));
+            traceEvent.insert(QStringLiteral("s"), QStringLiteral("t"));
+        }
+        traceEvents.append(traceEvent);
+    }
+    guard.unlock();
+
+    const QJsonObject trace {
+        {QStringLiteral("traceEvents"), traceEvents},
+        {QStringLiteral("displayTimeUnit"), QStringLiteral("ms")}
+    };
+    return QString::fromUtf8(QJsonDocument(trace).toJson(QJsonDocument::Compact));
+}
+
+/*!
+    Writes the recorded events to \a fileName in the Chrome trace event
+    format. Returns \c true on success.
+*/
+bool LatencyTracer::exportTrace(const QString &fileName) const
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    return file.write(traceEvents().toUtf8()) != -1;
+}
+
+/*!
+    Clears the recorded events and latencies.
+*/
+void LatencyTracer::clear()
+{
+    LatencyTraceBuffer *buffer = traceBuffer();
+    QMutexLocker guard(&buffer->mutex);
+    buffer->head = 0;
+    buffer->size = 0;
+    buffer->latencyHead = 0;
+    buffer->latencyCount = 0;
+    buffer->spanOpen = false;
+}
+
+quint64 LatencyTracer::startSpan(Stage stage)
+{
+    LatencyTraceBuffer *buffer = traceBuffer();
+    if (!buffer)
+        return 0;
+    QMutexLocker guard(&buffer->mutex);
+    const quint64 span = ++buffer->nextSpan;
+    buffer->currentSpan = span;
+    buffer->spanStart = buffer->clock.nsecsElapsed();
+    buffer->spanOpen = true;
+    buffer->append(span, buffer->spanStart, 0, stage);
+    return span;
+}
+
+quint64 LatencyTracer::activeSpan()
+{
+    LatencyTraceBuffer *buffer = traceBuffer();
+    if (!buffer)
+        return 0;
+    QMutexLocker guard(&buffer->mutex);
+    return buffer->currentSpan;
+}
+
+void LatencyTracer::record(Stage stage, quint64 span)
+{
+    LatencyTraceBuffer *buffer = traceBuffer();
+    if (!buffer)
+        return;
+    QMutexLocker guard(&buffer->mutex);
+    const qint64 timestamp = buffer->clock.nsecsElapsed();
+    buffer->append(span, timestamp, 0, stage);
+    if ((stage == PreeditSent || stage == CommitSent) && buffer->spanOpen && span == buffer->currentSpan) {
+        const qint64 latency = timestamp - buffer->spanStart;
+        buffer->spanOpen = false;
+        buffer->append(span, buffer->spanStart, latency, Keystroke);
+        buffer->latencies[buffer->latencyHead] = latency;
+        buffer->latencyHead = (buffer->latencyHead + 1) % buffer->latencies.size();
+        buffer->latencyCount = qMin(buffer->latencyCount + 1, buffer->latencies.size());
+    }
+}
+
+} // namespace QtVirtualKeyboard
+QT_END_NAMESPACE
@@ -0,0 +1,109 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Virtual Keyboard module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef LATENCYTRACER_P_H
+#define LATENCYTRACER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QObject>
+#include <QAtomicInt>
+#include <QtVirtualKeyboard/qvirtualkeyboard_global.h>
+
+QT_BEGIN_NAMESPACE
+namespace QtVirtualKeyboard {
+
+class QVIRTUALKEYBOARD_EXPORT LatencyTracer : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(LatencyTracer)
+    Q_PROPERTY(bool enabled READ isEnabled WRITE setEnabled NOTIFY enabledChanged)
+    Q_PROPERTY(int capacity READ capacity WRITE setCapacity NOTIFY capacityChanged)
+
+public:
+    enum Stage {
+        KeyPress,
+        KeyRelease,
+        KeyClick,
+        KeyEvent,
+        KeyEventDone,
+        WorkerTaskStarted,
+        WorkerTaskFinished,
+        SelectionListChanged,
+        PreeditSent,
+        CommitSent,
+        Keystroke
+    };
+    Q_ENUM(Stage)
+
+    explicit LatencyTracer(QObject *parent = nullptr);
+    ~LatencyTracer();
+
+    static inline bool isActive() { return active.loadRelaxed() != 0; }
+    static inline quint64 beginSpan(Stage stage) { return isActive() ? startSpan(stage) : 0; }
+    static inline quint64 currentSpan() { return isActive() ? activeSpan() : 0; }
+    static inline void mark(Stage stage) { if (isActive()) record(stage, activeSpan()); }
+    static inline void mark(Stage stage, quint64 span) { if (isActive()) record(stage, span); }
+
+    bool isEnabled() const;
+    void setEnabled(bool enabled);
+    int capacity() const;
+    void setCapacity(int capacity);
+
+    Q_INVOKABLE int sampleCount() const;
+    Q_INVOKABLE qreal percentile(qreal percentile) const;
+    Q_INVOKABLE QString traceEvents() const;
+    Q_INVOKABLE bool exportTrace(const QString &fileName) const;
+    Q_INVOKABLE void clear();
+
+signals:
+    void enabledChanged();
+    void capacityChanged();
+
+private:
+    static quint64 startSpan(Stage stage);
+    static quint64 activeSpan();
+    static void record(Stage stage, quint64 span);
+
+    static QBasicAtomicInt active;
+};
+
+} // namespace QtVirtualKeyboard
+QT_END_NAMESPACE
+
+#endif // LATENCYTRACER_P_H
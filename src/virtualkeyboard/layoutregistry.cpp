@@ -0,0 +1,262 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Virtual Keyboard module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtVirtualKeyboard/private/layoutregistry_p.h>
+#include <QtVirtualKeyboard/private/virtualkeyboarddebug_p.h>
+#include <QtCore/private/qobject_p.h>
+#include <QDir>
+#include <QHash>
+#include <QSet>
+#include <QFileSystemWatcher>
+
+QT_BEGIN_NAMESPACE
+namespace QtVirtualKeyboard {
+
+struct LayoutIndex
+{
+    QStringList locales;
+    QHash<QString, QSet<QString>> files;
+
+    bool contains(const QString &localeName, const QString &fileName) const
+    {
+        const auto it = files.constFind(localeName);
+        return it != files.constEnd() && it->contains(fileName);
+    }
+};
+
+typedef QHash<QString, LayoutIndex> LayoutIndexCache;
+Q_GLOBAL_STATIC(LayoutIndexCache, resourceLayoutIndexCache)
+
+class LayoutRegistryPrivate : public QObjectPrivate
+{
+    Q_DECLARE_PUBLIC(LayoutRegistry)
+public:
+    LayoutRegistryPrivate() :
+        QObjectPrivate(),
+        refreshPending(false)
+    {
+    }
+
+    static QString directoryPath(const QUrl &url);
+    static LayoutIndex scan(const QString &path);
+    QString layoutUrl(const QString &localeName, const QString &fileName) const;
+    void watch(const QString &path);
+
+    QUrl layoutPath;
+    LayoutIndex index;
+    QScopedPointer<QFileSystemWatcher> watcher;
+    bool refreshPending;
+};
+
+QString LayoutRegistryPrivate::directoryPath(const QUrl &url)
+{
+    if (url.scheme() == QLatin1String("qrc"))
+        return QLatin1Char(':') + url.path();
+    return url.toLocalFile();
+}
+
+/*
+    Lists the locale directories below \a path and the files in each of
+    them. The locales are sorted by name, as FolderListModel would list
+    them.
+*/
+LayoutIndex LayoutRegistryPrivate::scan(const QString &path)
+{
+    LayoutIndex result;
+    if (path.isEmpty())
+        return result;
+    const QDir layoutDirectory(path);
+    result.locales = layoutDirectory.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+    for (const QString &localeName : qAsConst(result.locales)) {
+        const QStringList fileNames = QDir(layoutDirectory.filePath(localeName)).entryList(QDir::Files);
+        result.files.insert(localeName, QSet<QString>(fileNames.cbegin(), fileNames.cend()));
+    }
+    return result;
+}
+
+QString LayoutRegistryPrivate::layoutUrl(const QString &localeName, const QString &fileName) const
+{
+    return layoutPath.toString() + QLatin1Char('/') + localeName + QLatin1Char('/') + fileName;
+}
+
+void LayoutRegistryPrivate::watch(const QString &path)
+{
+    Q_Q(LayoutRegistry);
+    if (!watcher) {
+        watcher.reset(new QFileSystemWatcher());
+        QObject::connect(watcher.data(), &QFileSystemWatcher::directoryChanged, q, &LayoutRegistry::scheduleRefresh);
+    }
+    const QStringList watched = watcher->directories();
+    if (!watched.isEmpty())
+        watcher->removePaths(watched);
+    QStringList paths;
+    paths.append(path);
+    const QDir layoutDirectory(path);
+    for (const QString &localeName : qAsConst(index.locales))
+        paths.append(layoutDirectory.filePath(localeName));
+    watcher->addPaths(paths);
+}
+
+/*!
+    \class QtVirtualKeyboard::LayoutRegistry
+    \internal
+    \inmodule QtVirtualKeyboard
+    \brief Index of the keyboard layouts in the layout path.
+
+    The registry lists the locale directories in the layout path and the
+    layout files in each of them once, and answers the layout queries of
+    the keyboard from memory. The index of a resource path is shared by
+    all registries, since resources do not change. A path in the file
+    system is watched and indexed again when its contents change.
+*/
+
+LayoutRegistry::LayoutRegistry(QObject *parent) :
+    QObject(*new LayoutRegistryPrivate(), parent)
+{
+}
+
+LayoutRegistry::~LayoutRegistry()
+{
+}
+
+/*!
+    \property QtVirtualKeyboard::LayoutRegistry::layoutPath
+    \internal
+    \brief The URL of the directory containing the layouts.
+
+    The directory is indexed asynchronously after the path changes.
+*/
+QUrl LayoutRegistry::layoutPath() const
+{
+    Q_D(const LayoutRegistry);
+    return d->layoutPath;
+}
+
+void LayoutRegistry::setLayoutPath(const QUrl &layoutPath)
+{
+    Q_D(LayoutRegistry);
+    if (d->layoutPath == layoutPath)
+        return;
+    d->layoutPath = layoutPath;
+    d->watcher.reset();
+    scheduleRefresh();
+    emit layoutPathChanged();
+}
+
+/*!
+    \property QtVirtualKeyboard::LayoutRegistry::locales
+    \internal
+    \brief The names of the locale directories, sorted by name.
+*/
+QStringList LayoutRegistry::locales() const
+{
+    Q_D(const LayoutRegistry);
+    return d->index.locales;
+}
+
+/*!
+    \internal
+
+    Returns the URL of the \a layoutType layout for \a localeName, or an
+    empty string if the locale has no such layout. A \c .fallback file in
+    the locale directory selects the layout from the \c fallback
+    directory.
+*/
+QString LayoutRegistry::findLayout(const QString &localeName, const QString &layoutType) const
+{
+    Q_D(const LayoutRegistry);
+    if (localeName.isEmpty() || layoutType.isEmpty())
+        return QString();
+    const QString layoutFileName = layoutType + QLatin1String(".qml");
+    if (d->index.contains(localeName, layoutFileName))
+        return d->layoutUrl(localeName, layoutFileName);
+    if (d->index.contains(localeName, layoutType + QLatin1String(".fallback")) &&
+            d->index.contains(QStringLiteral("fallback"), layoutFileName))
+        return d->layoutUrl(QStringLiteral("fallback"), layoutFileName);
+    return QString();
+}
+
+/*!
+    \internal
+
+    Returns \c true if \a localeName has its own \a layoutType layout.
+    For the handwriting layout, a \c .fallback file is accepted as well.
+*/
+bool LayoutRegistry::layoutExists(const QString &localeName, const QString &layoutType) const
+{
+    Q_D(const LayoutRegistry);
+    if (localeName.isEmpty() || layoutType.isEmpty())
+        return false;
+    if (d->index.contains(localeName, layoutType + QLatin1String(".qml")))
+        return true;
+    return layoutType == QLatin1String("handwriting") &&
+            d->index.contains(localeName, layoutType + QLatin1String(".fallback"));
+}
+
+void LayoutRegistry::scheduleRefresh()
+{
+    Q_D(LayoutRegistry);
+    if (d->refreshPending)
+        return;
+    d->refreshPending = true;
+    QMetaObject::invokeMethod(this, &LayoutRegistry::refresh, Qt::QueuedConnection);
+}
+
+void LayoutRegistry::refresh()
+{
+    Q_D(LayoutRegistry);
+    d->refreshPending = false;
+
+    const QString path = LayoutRegistryPrivate::directoryPath(d->layoutPath);
+    LayoutIndex newIndex;
+    if (path.startsWith(QLatin1Char(':'))) {
+        LayoutIndexCache *cache = resourceLayoutIndexCache();
+        auto it = cache->find(path);
+        if (it == cache->end())
+            it = cache->insert(path, LayoutRegistryPrivate::scan(path));
+        newIndex = *it;
+    } else {
+        newIndex = LayoutRegistryPrivate::scan(path);
+    }
+    VIRTUALKEYBOARD_DEBUG() << "LayoutRegistry::refresh():" << path << newIndex.locales;
+
+    const bool localesChanged = newIndex.locales != d->index.locales;
+    const bool layoutsChanged = newIndex.files != d->index.files;
+    d->index = newIndex;
+    if (!path.isEmpty() && !path.startsWith(QLatin1Char(':')))
+        d->watch(path);
+
+    if (localesChanged)
+        emit this->localesChanged();
+    else if (layoutsChanged)
+        emit this->layoutsChanged();
+}
+
+} // namespace QtVirtualKeyboard
+QT_END_NAMESPACE
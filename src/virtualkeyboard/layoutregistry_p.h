@@ -0,0 +1,86 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Virtual Keyboard module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef LAYOUTREGISTRY_P_H
+#define LAYOUTREGISTRY_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QObject>
+#include <QUrl>
+#include <QStringList>
+#include <QtVirtualKeyboard/qvirtualkeyboard_global.h>
+
+QT_BEGIN_NAMESPACE
+namespace QtVirtualKeyboard {
+
+class LayoutRegistryPrivate;
+
+class QVIRTUALKEYBOARD_EXPORT LayoutRegistry : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(LayoutRegistry)
+    Q_DECLARE_PRIVATE(LayoutRegistry)
+    Q_PROPERTY(QUrl layoutPath READ layoutPath WRITE setLayoutPath NOTIFY layoutPathChanged)
+    Q_PROPERTY(QStringList locales READ locales NOTIFY localesChanged)
+
+public:
+    explicit LayoutRegistry(QObject *parent = nullptr);
+    ~LayoutRegistry();
+
+    QUrl layoutPath() const;
+    void setLayoutPath(const QUrl &layoutPath);
+    QStringList locales() const;
+
+    Q_INVOKABLE QString findLayout(const QString &localeName, const QString &layoutType) const;
+    Q_INVOKABLE bool layoutExists(const QString &localeName, const QString &layoutType) const;
+
+signals:
+    void layoutPathChanged();
+    void localesChanged();
+    void layoutsChanged();
+
+private slots:
+    void scheduleRefresh();
+    void refresh();
+};
+
+} // namespace QtVirtualKeyboard
+QT_END_NAMESPACE
+
+#endif // LAYOUTREGISTRY_P_H
@@ -36,6 +36,7 @@
 #include <QtVirtualKeyboard/private/desktopinputpanel_p.h>
 #endif
 #include <QtVirtualKeyboard/private/appinputpanel_p.h>
+#include <QtVirtualKeyboard/private/keyboardlayoutpool_p.h>
 #include <QtVirtualKeyboard/private/virtualkeyboarddebug_p.h>
 
 #include <QWindow>
@@ -61,13 +62,16 @@ PlatformInputContext::PlatformInputContext() :
     m_inputDirection(m_locale.textDirection()),
     m_filterEvent(nullptr),
     m_visible(false),
-    m_desktopModeDisabled(false)
+    m_desktopModeDisabled(false),
+    m_desktopPanelPrewarmPending(false),
+    m_desktopPanelPrewarmed(false)
 {
     if (!qEnvironmentVariableIsEmpty(disableDesktopEnvVarName)) {
         bool ok;
         int desktopModeDisabled = qgetenv(disableDesktopEnvVarName).toInt(&ok);
         m_desktopModeDisabled = ok && desktopModeDisabled != 0;
     }
+    m_desktopPanelPrewarmPending = KeyboardLayoutPool::isPrewarmEnabledByEnvironment();
 }
 
 PlatformInputContext::~PlatformInputContext()
@@ -98,8 +102,10 @@ void PlatformInputContext::update(Qt::InputMethodQueries queries)
     VIRTUALKEYBOARD_DEBUG() << "PlatformInputContext::update():" << queries;
     bool enabled = inputMethodQuery(Qt::ImEnabled).toBool();
 #ifdef QT_VIRTUALKEYBOARD_DESKTOP
-    if (enabled && !m_inputPanel && !m_desktopModeDisabled) {
-        m_inputPanel = new DesktopInputPanel(this);
+    if (enabled && (!m_inputPanel || m_desktopPanelPrewarmed) && !m_desktopModeDisabled) {
+        if (!m_inputPanel)
+            m_inputPanel = new DesktopInputPanel(this);
+        m_desktopPanelPrewarmed = false;
         m_inputPanel->createView();
         if (m_inputContext) {
             m_selectionControl = new DesktopInputSelectionControl(this, m_inputContext);
@@ -208,6 +214,13 @@ void PlatformInputContext::setFocusObject(QObject *object)
             m_focusObject->installEventFilter(this);
         emit focusObjectChanged();
     }
+    /*  By the time the application has a focus object, its user interface
+        is created, and with it the input panel of its own, if any.
+    */
+    if (m_desktopPanelPrewarmPending && m_focusObject) {
+        m_desktopPanelPrewarmPending = false;
+        QMetaObject::invokeMethod(this, &PlatformInputContext::prewarmInputPanel, Qt::QueuedConnection);
+    }
     update(Qt::ImQueryAll);
 }
 
@@ -270,6 +283,23 @@ QVariant PlatformInputContext::inputMethodQuery(Qt::InputMethodQuery query)
     return event.value(query);
 }
 
+QVariant PlatformInputContext::inputMethodQuery(Qt::InputMethodQuery query, const QVariant &argument)
+{
+    QVariant retval;
+    if (!m_focusObject)
+        return retval;
+
+    bool newMethodWorks = QMetaObject::invokeMethod(m_focusObject, "inputMethodQuery",
+                                                    Qt::DirectConnection,
+                                                    Q_RETURN_ARG(QVariant, retval),
+                                                    Q_ARG(Qt::InputMethodQuery, query),
+                                                    Q_ARG(QVariant, argument));
+    if (newMethodWorks)
+        return retval;
+
+    return inputMethodQuery(query);
+}
+
 void PlatformInputContext::setInputContext(QVirtualKeyboardInputContext *context)
 {
     if (m_inputContext) {
@@ -277,6 +307,11 @@ void PlatformInputContext::setInputContext(QVirtualKeyboardInputContext *context
     }
     m_inputContext = context;
     if (m_inputContext) {
+        // The application has an input panel of its own
+        if (m_desktopPanelPrewarmed) {
+            delete m_inputPanel.data();
+            m_desktopPanelPrewarmed = false;
+        }
         if (!m_inputPanel)
             m_inputPanel = new AppInputPanel(this);
         QObject::connect(m_inputContext->priv(), &QVirtualKeyboardInputContextPrivate::keyboardRectangleChanged, this, &PlatformInputContext::keyboardRectangleChanged);
@@ -285,6 +320,25 @@ void PlatformInputContext::setInputContext(QVirtualKeyboardInputContext *context
     }
 }
 
+/*!
+    Creates the desktop input panel ahead of the first input focus and
+    lets it compile the input panel in the background. The input panel
+    is instantiated on the first input focus. If the application
+    registers an input panel of its own before that, the desktop input
+    panel is destroyed.
+*/
+void PlatformInputContext::prewarmInputPanel()
+{
+#ifdef QT_VIRTUALKEYBOARD_DESKTOP
+    if (m_inputPanel || m_inputContext || m_desktopModeDisabled)
+        return;
+    DesktopInputPanel *desktopInputPanel = new DesktopInputPanel(this);
+    m_inputPanel = desktopInputPanel;
+    m_desktopPanelPrewarmed = true;
+    desktopInputPanel->prewarmView();
+#endif
+}
+
 void PlatformInputContext::keyboardRectangleChanged()
 {
     m_inputPanel->setInputRect(m_inputContext->priv()->keyboardRectangle().toRect());
@@ -100,9 +100,11 @@ protected:
     void sendEvent(QEvent *event);
     void sendKeyEvent(QKeyEvent *event);
     QVariant inputMethodQuery(Qt::InputMethodQuery query);
+    QVariant inputMethodQuery(Qt::InputMethodQuery query, const QVariant &argument);
     void setInputContext(QVirtualKeyboardInputContext *context);
 
 private slots:
+    void prewarmInputPanel();
     void keyboardRectangleChanged();
     void updateInputPanelVisible();
 
@@ -119,6 +121,8 @@ private:
     QEvent *m_filterEvent;
     bool m_visible;
     bool m_desktopModeDisabled;
+    bool m_desktopPanelPrewarmPending;
+    bool m_desktopPanelPrewarmed;
 };
 
 } // namespace QtVirtualKeyboard
@@ -30,6 +30,7 @@
 #include <QtVirtualKeyboard/qvirtualkeyboardinputcontext.h>
 #include <QtVirtualKeyboard/private/qvirtualkeyboardinputcontext_p.h>
 #include <QtVirtualKeyboard/private/shifthandler_p.h>
+#include <QtVirtualKeyboard/private/latencytracer_p.h>
 #include <QtVirtualKeyboard/private/platforminputcontext_p.h>
 #include <QtVirtualKeyboard/private/virtualkeyboarddebug_p.h>
 
@@ -294,6 +295,7 @@ void QVirtualKeyboardInputContext::commit(const QString &text, int replaceFrom,
         QInputMethodEvent inputEvent(QString(), attributes);
         inputEvent.setCommitString(text, replaceFrom, replaceLength);
         d->sendInputMethodEvent(&inputEvent);
+        LatencyTracer::mark(LatencyTracer::CommitSent);
     } else {
         d->preeditText.clear();
         d->preeditTextAttributes.clear();
@@ -31,6 +31,7 @@
 #include <QtVirtualKeyboard/private/platforminputcontext_p.h>
 #include <QtVirtualKeyboard/private/settings_p.h>
 #include <QtVirtualKeyboard/private/shifthandler_p.h>
+#include <QtVirtualKeyboard/private/latencytracer_p.h>
 #include <QtVirtualKeyboard/private/virtualkeyboarddebug_p.h>
 #include <QtVirtualKeyboard/private/enterkeyaction_p.h>
 #include <QtVirtualKeyboard/qvirtualkeyboardinputengine.h>
@@ -62,6 +63,7 @@ QVirtualKeyboardInputContextPrivate::QVirtualKeyboardInputContextPrivate(QVirtua
     platformInputContext(nullptr),
     inputEngine(nullptr),
     _shiftHandler(nullptr),
+    _latencyTracer(nullptr),
     keyboardRect(),
     previewRect(),
     _previewVisible(false),
@@ -71,6 +73,8 @@ QVirtualKeyboardInputContextPrivate::QVirtualKeyboardInputContextPrivate(QVirtua
     anchorPosition(0),
     forceAnchorPosition(-1),
     _forceCursorPosition(-1),
+    surroundingTextWindow(qMax(0, qEnvironmentVariableIntValue("QT_VIRTUALKEYBOARD_SURROUNDING_TEXT_WINDOW"))),
+    _surroundingTextOffset(0),
     inputMethodHints(Qt::ImhNone),
     preeditText(),
     preeditTextAttributes(),
@@ -96,6 +100,7 @@ void QVirtualKeyboardInputContextPrivate::init()
     platformInputContext = qobject_cast<PlatformInputContext *>(unknownPlatformInputContext);
     inputEngine = new QVirtualKeyboardInputEngine(q);
     _shiftHandler = new ShiftHandler(q);
+    _latencyTracer = new LatencyTracer(this);
     inputEngine->init();
     _shiftHandler->init();
     _shadow.setInputContext(q);
@@ -195,11 +200,55 @@ ShadowInputContext *QVirtualKeyboardInputContextPrivate::shadow() const
     return const_cast<ShadowInputContext *>(&_shadow);
 }
 
+LatencyTracer *QVirtualKeyboardInputContextPrivate::latencyTracer() const
+{
+    return _latencyTracer;
+}
+
 QStringList QVirtualKeyboardInputContextPrivate::inputMethods() const
 {
     return platformInputContext ? platformInputContext->inputMethods() : QStringList();
 }
 
+/*!
+    \internal
+
+    Returns the position of the surrounding text within the text of the
+    input item.
+
+    When QT_VIRTUALKEYBOARD_SURROUNDING_TEXT_WINDOW is set, the surrounding
+    text is limited to that many characters before and after the cursor,
+    and the cursor and anchor positions are relative to this window. The
+    offset is always zero otherwise.
+*/
+int QVirtualKeyboardInputContextPrivate::surroundingTextOffset() const
+{
+    return _surroundingTextOffset;
+}
+
+/*!
+    \internal
+
+    Returns \c true if the surrounding text is limited to a window around
+    the cursor.
+*/
+bool QVirtualKeyboardInputContextPrivate::isSurroundingTextWindowed() const
+{
+    return surroundingTextWindow > 0;
+}
+
+/*!
+    \internal
+
+    Returns \c true if the surrounding text window does not start at the
+    beginning of the text of the input item, i.e. some text before the
+    cursor was cut off.
+*/
+bool QVirtualKeyboardInputContextPrivate::isSurroundingTextClipped() const
+{
+    return _surroundingTextOffset > 0;
+}
+
 bool QVirtualKeyboardInputContextPrivate::fileExists(const QUrl &fileUrl)
 {
     QString fileName;
@@ -315,8 +364,9 @@ void QVirtualKeyboardInputContextPrivate::sendPreedit(const QString &text, const
                 event.setCommitString(QString(), replaceFrom, replaceLength);
 
             sendInputMethodEvent(&event);
+            LatencyTracer::mark(LatencyTracer::PreeditSent);
 
-            // Send also to shadow input if only attributes changed.
+            // Update also the shadow input if only attributes changed.
             // In this case the update() may not be called, so the shadow
             // input may be out of sync.
             if (_shadow.inputItem() && !replace && !text.isEmpty() &&
@@ -326,8 +376,7 @@ void QVirtualKeyboardInputContextPrivate::sendPreedit(const QString &text, const
                        << text << replaceFrom << replaceLength
 #endif
                     ;
-                event.setAccepted(true);
-                QGuiApplication::sendEvent(_shadow.inputItem(), &event);
+                _shadow.update(Qt::ImQueryInput);
             }
         }
 
@@ -366,12 +415,17 @@ void QVirtualKeyboardInputContextPrivate::update(Qt::InputMethodQueries queries)
         return;
 
     // fetch
+    const bool windowed = surroundingTextWindow > 0;
+    const Qt::InputMethodQueries inputQueries = windowed ?
+                Qt::InputMethodQueries(Qt::ImCursorRectangle | Qt::ImCursorPosition |
+                                       Qt::ImAnchorRectangle | Qt::ImAnchorPosition) :
+                Qt::InputMethodQueries(Qt::ImQueryInput);
     QInputMethodQueryEvent imQueryEvent(Qt::InputMethodQueries(Qt::ImHints |
-                    Qt::ImQueryInput | Qt::ImInputItemClipRectangle));
+                    inputQueries | Qt::ImInputItemClipRectangle));
     platformInputContext->sendEvent(&imQueryEvent);
     Qt::InputMethodHints inputMethodHints = Qt::InputMethodHints(imQueryEvent.value(Qt::ImHints).toInt());
-    const int cursorPosition = imQueryEvent.value(Qt::ImCursorPosition).toInt();
-    const int anchorPosition = imQueryEvent.value(Qt::ImAnchorPosition).toInt();
+    int cursorPosition = imQueryEvent.value(Qt::ImCursorPosition).toInt();
+    int anchorPosition = imQueryEvent.value(Qt::ImAnchorPosition).toInt();
     QRectF anchorRectangle;
     QRectF cursorRectangle;
     if (const QGuiApplication *app = qApp) {
@@ -381,12 +435,30 @@ void QVirtualKeyboardInputContextPrivate::update(Qt::InputMethodQueries queries)
         anchorRectangle = this->anchorRectangle;
         cursorRectangle = this->cursorRectangle;
     }
-    QString surroundingText = imQueryEvent.value(Qt::ImSurroundingText).toString();
-    QString selectedText = imQueryEvent.value(Qt::ImCurrentSelection).toString();
+    QString surroundingText;
+    QString selectedText;
+    int surroundingTextOffset = 0;
+    if (windowed) {
+        // Fetch only the text around the cursor. The item may return more
+        // than was asked for, so the window is enforced here as well.
+        const QString textBeforeCursor = platformInputContext->inputMethodQuery(Qt::ImTextBeforeCursor, surroundingTextWindow).toString().right(surroundingTextWindow);
+        const QString textAfterCursor = platformInputContext->inputMethodQuery(Qt::ImTextAfterCursor, surroundingTextWindow).toString().left(surroundingTextWindow);
+        if (cursorPosition != anchorPosition)
+            selectedText = platformInputContext->inputMethodQuery(Qt::ImCurrentSelection).toString();
+        surroundingText = textBeforeCursor + textAfterCursor;
+        surroundingTextOffset = cursorPosition - textBeforeCursor.length();
+        cursorPosition = textBeforeCursor.length();
+        anchorPosition = qBound(0, anchorPosition - surroundingTextOffset, surroundingText.length());
+    } else {
+        surroundingText = imQueryEvent.value(Qt::ImSurroundingText).toString();
+        selectedText = imQueryEvent.value(Qt::ImCurrentSelection).toString();
+    }
 
     // check against changes
     bool newInputMethodHints = inputMethodHints != this->inputMethodHints;
-    bool newSurroundingText = surroundingText != this->surroundingText;
+    bool newSurroundingText = surroundingTextOffset != this->_surroundingTextOffset ||
+            surroundingText.length() != this->surroundingText.length() ||
+            surroundingText != this->surroundingText;
     bool newSelectedText = selectedText != this->selectedText;
     bool newAnchorPosition = anchorPosition != this->anchorPosition;
     bool newCursorPosition = cursorPosition != this->cursorPosition;
@@ -408,6 +480,7 @@ void QVirtualKeyboardInputContextPrivate::update(Qt::InputMethodQueries queries)
     // update
     this->inputMethodHints = inputMethodHints;
     this->surroundingText = surroundingText;
+    this->_surroundingTextOffset = surroundingTextOffset;
     this->selectedText = selectedText;
     this->anchorPosition = anchorPosition;
     this->cursorPosition = cursorPosition;
@@ -469,10 +542,8 @@ void QVirtualKeyboardInputContextPrivate::update(Qt::InputMethodQueries queries)
             setState(State::InputMethodClick);
     }
 
-    if (!testState(State::SyncShadowInput)) {
-        QVirtualKeyboardScopedState syncShadowInputState(this, State::SyncShadowInput);
+    if (!testState(State::SyncShadowInput))
         _shadow.update(queries);
-    }
 }
 
 void QVirtualKeyboardInputContextPrivate::invokeAction(QInputMethod::Action action, int cursorPosition)
@@ -562,11 +633,12 @@ void QVirtualKeyboardInputContextPrivate::addSelectionAttribute(QList<QInputMeth
             forceAnchorPosition = -1;
         }
 
+        // The forced positions are relative to the surrounding text
         if (_forceCursorPosition != -1) {
             if (forceAnchorPosition != -1)
-                attributes.append(QInputMethodEvent::Attribute(QInputMethodEvent::Selection, forceAnchorPosition, _forceCursorPosition - forceAnchorPosition, QVariant()));
+                attributes.append(QInputMethodEvent::Attribute(QInputMethodEvent::Selection, _surroundingTextOffset + forceAnchorPosition, _forceCursorPosition - forceAnchorPosition, QVariant()));
             else
-                attributes.append(QInputMethodEvent::Attribute(QInputMethodEvent::Selection, _forceCursorPosition, 0, QVariant()));
+                attributes.append(QInputMethodEvent::Attribute(QInputMethodEvent::Selection, _surroundingTextOffset + _forceCursorPosition, 0, QVariant()));
         }
     }
     forceAnchorPosition = -1;
@@ -60,6 +60,7 @@ extern const bool QT_VIRTUALKEYBOARD_FORCE_EVENTS_WITHOUT_FOCUS;
 
 class PlatformInputContext;
 class ShiftHandler;
+class LatencyTracer;
 }
 class QVirtualKeyboardInputEngine;
 class QVirtualKeyboardInputContextPrivate;
@@ -76,6 +77,7 @@ class QVIRTUALKEYBOARD_EXPORT QVirtualKeyboardInputContextPrivate : public QObje
     Q_PROPERTY(QObject *inputItem READ inputItem NOTIFY inputItemChanged)
     Q_PROPERTY(QtVirtualKeyboard::ShiftHandler *shiftHandler READ shiftHandler CONSTANT)
     Q_PROPERTY(QtVirtualKeyboard::ShadowInputContext *shadow READ shadow CONSTANT)
+    Q_PROPERTY(QtVirtualKeyboard::LatencyTracer *latencyTracer READ latencyTracer CONSTANT)
     Q_PROPERTY(QStringList inputMethods READ inputMethods CONSTANT)
     Q_MOC_INCLUDE("shifthandler_p.h")
 
@@ -108,7 +110,11 @@ public:
     QObject *inputItem() const;
     QtVirtualKeyboard::ShiftHandler *shiftHandler() const;
     QtVirtualKeyboard::ShadowInputContext *shadow() const;
+    QtVirtualKeyboard::LatencyTracer *latencyTracer() const;
     QStringList inputMethods() const;
+    int surroundingTextOffset() const;
+    bool isSurroundingTextWindowed() const;
+    bool isSurroundingTextClipped() const;
 
     // Helper functions
     Q_INVOKABLE bool fileExists(const QUrl &fileUrl);
@@ -154,6 +160,7 @@ private:
     QtVirtualKeyboard::PlatformInputContext *platformInputContext;
     QVirtualKeyboardInputEngine *inputEngine;
     QtVirtualKeyboard::ShiftHandler *_shiftHandler;
+    QtVirtualKeyboard::LatencyTracer *_latencyTracer;
     QPointer<QObject> inputPanel;
     QRectF keyboardRect;
     QRectF previewRect;
@@ -165,6 +172,8 @@ private:
     int anchorPosition;
     int forceAnchorPosition;
     int _forceCursorPosition;
+    int surroundingTextWindow;
+    int _surroundingTextOffset;
     Qt::InputMethodHints inputMethodHints;
     QString preeditText;
     QList<QInputMethodEvent::Attribute> preeditTextAttributes;
@@ -32,6 +32,7 @@
 #include <QtVirtualKeyboard/private/qvirtualkeyboardinputcontext_p.h>
 #include <QtVirtualKeyboard/private/shifthandler_p.h>
 #include <QtVirtualKeyboard/private/fallbackinputmethod_p.h>
+#include <QtVirtualKeyboard/private/latencytracer_p.h>
 #include <QtVirtualKeyboard/qvirtualkeyboardtrace.h>
 #include <QtVirtualKeyboard/private/virtualkeyboarddebug_p.h>
 
@@ -71,13 +72,17 @@ public:
         Q_Q(QVirtualKeyboardInputEngine);
         bool accept = false;
         if (inputMethod) {
+            LatencyTracer::mark(LatencyTracer::KeyEvent);
             accept = inputMethod->keyEvent(key, text, modifiers);
             if (!accept) {
                 accept = fallbackInputMethod->keyEvent(key, text, modifiers);
             }
+            LatencyTracer::mark(LatencyTracer::KeyEventDone);
             emit q->virtualKeyClicked(key, text, modifiers, isAutoRepeat);
         } else if (QT_VIRTUALKEYBOARD_FORCE_EVENTS_WITHOUT_FOCUS) {
+            LatencyTracer::mark(LatencyTracer::KeyEvent);
             accept = fallbackInputMethod->keyEvent(key, text, modifiers);
+            LatencyTracer::mark(LatencyTracer::KeyEventDone);
             emit q->virtualKeyClicked(key, text, modifiers, isAutoRepeat);
         } else {
             qWarning() << "input method is not set";
@@ -231,6 +236,7 @@ bool QVirtualKeyboardInputEngine::virtualKeyPress(Qt::Key key, const QString &te
         if (repeat) {
             d->repeatTimer = startTimer(600);
         }
+        LatencyTracer::beginSpan(LatencyTracer::KeyPress);
         accept = true;
         emit activeKeyChanged(d->activeKey);
     } else {
@@ -297,6 +303,7 @@ bool QVirtualKeyboardInputEngine::virtualKeyRelease(Qt::Key key, const QString &
 
     bool accept = false;
     if (d->activeKey == key) {
+        LatencyTracer::mark(LatencyTracer::KeyRelease);
         if (!d->repeatCount) {
             accept = d->virtualKeyClick(key, text, modifiers, false);
         } else {
@@ -339,6 +346,7 @@ bool QVirtualKeyboardInputEngine::virtualKeyClick(Qt::Key key, const QString &te
            << key << text << modifiers
 #endif
         ;
+    LatencyTracer::beginSpan(LatencyTracer::KeyClick);
     return d->virtualKeyClick(key, text, modifiers, false);
 }
 
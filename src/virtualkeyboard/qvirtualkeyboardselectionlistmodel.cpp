@@ -30,6 +30,7 @@
 #include <QtVirtualKeyboard/qvirtualkeyboardselectionlistmodel.h>
 #include <QtVirtualKeyboard/qvirtualkeyboardabstractinputmethod.h>
 #include <QtVirtualKeyboard/private/settings_p.h>
+#include <QtVirtualKeyboard/private/latencytracer_p.h>
 #include <QtCore/private/qabstractitemmodel_p.h>
 #include <QtCore/qpointer.h>
 
@@ -289,6 +290,7 @@ void QVirtualKeyboardSelectionListModel::selectionListChanged(QVirtualKeyboardSe
 {
     Q_D(QVirtualKeyboardSelectionListModel);
     if (static_cast<Type>(type) == d->type) {
+        LatencyTracer::mark(LatencyTracer::SelectionListChanged);
         int oldCount = d->rowCount;
         int newCount = d->dataSource ? d->dataSource->selectionListItemCount(d->type) : 0;
         if (newCount) {
@@ -29,6 +29,9 @@
 
 #include <QtVirtualKeyboard/qvirtualkeyboardtrace.h>
 #include <QtCore/private/qobject_p.h>
+#include <QtCore/QBasicTimer>
+#include <QtGui/QGuiApplication>
+#include <QtGui/QScreen>
 
 QT_BEGIN_NAMESPACE
 
@@ -40,17 +43,54 @@ public:
         traceId(0),
         final(false),
         canceled(false),
-        opacity(1.0)
+        opacity(1.0),
+        batchUpdates(false),
+        notifiedLength(0)
     { }
 
+    void notifyPointsAdded();
+    void flush();
+
     int traceId;
     QVariantList points;
     QMap<QString, QVariantList> channels;
     bool final;
     bool canceled;
     qreal opacity;
+    bool batchUpdates;
+    int notifiedLength;
+    QBasicTimer flushTimer;
 };
 
+void QVirtualKeyboardTracePrivate::notifyPointsAdded()
+{
+    if (!batchUpdates) {
+        flush();
+        return;
+    }
+    if (flushTimer.isActive())
+        return;
+
+    // Coalesce the notifications to one per display frame
+    Q_Q(QVirtualKeyboardTrace);
+    const QScreen *screen = QGuiApplication::primaryScreen();
+    const qreal refreshRate = screen && screen->refreshRate() > 0 ? screen->refreshRate() : 60;
+    flushTimer.start(qMax(1, qRound(1000 / refreshRate)), Qt::PreciseTimer, q);
+}
+
+void QVirtualKeyboardTracePrivate::flush()
+{
+    Q_Q(QVirtualKeyboardTrace);
+    flushTimer.stop();
+    const int length = points.size();
+    if (notifiedLength == length)
+        return;
+    const int index = notifiedLength;
+    notifiedLength = length;
+    emit q->lengthChanged(length);
+    emit q->pointsAdded(index, length - index);
+}
+
 /*!
     \class QVirtualKeyboardTrace
     \inmodule QtVirtualKeyboard
@@ -103,6 +143,20 @@ public:
         QVariantList timeData = trace->channelData("t");
     \endcode
 
+    High-rate input devices can add the data in bulk with addPoints(), which
+    takes the points and the parallel channel data at once. If the
+    \l batchUpdates property is \c true, the lengthChanged() and
+    pointsAdded() signals are coalesced to at most one per display frame.
+    The pointsAdded() signal carries the range of points added since the
+    previous notification, so a recognizer can process only the new data:
+
+    \code
+        connect(trace, &QVirtualKeyboardTrace::pointsAdded, this, [=](int index, int count) {
+            const QVariantList points = trace->points(index, count);
+            ...
+        });
+    \endcode
+
     QVirtualKeyboardTrace objects are owned by their creator, which is the input method in
     normal case. This means the objects are constructed in the
     \l {InputMethod::traceBegin()}{InputMethod.traceBegin()} (QML) method.
@@ -280,13 +334,58 @@ int QVirtualKeyboardTrace::addPoint(const QPointF &point)
     if (!d->final) {
         index = d->points.size();
         d->points.append(point);
-        emit lengthChanged(d->points.size());
+        d->notifyPointsAdded();
     } else {
         index = -1;
     }
     return index;
 }
 
+/*! Adds \a points to the QVirtualKeyboardTrace with the associated
+    \a channelData.
+
+    The \a channelData maps a channel name to the data for each of the
+    points, in the same order as the points. Channels that are not
+    defined for the trace are ignored, and missing data is padded with
+    empty values.
+
+    The lengthChanged() and pointsAdded() signals are emitted once for
+    the whole range.
+
+    The method returns index of the first point added, or -1 if
+    the points cannot be added (i.e. the \l final is true).
+*/
+
+int QVirtualKeyboardTrace::addPoints(const QList<QPointF> &points, const QMap<QString, QVariantList> &channelData)
+{
+    Q_D(QVirtualKeyboardTrace);
+    if (d->final)
+        return -1;
+
+    const int index = d->points.size();
+    if (points.isEmpty())
+        return index;
+
+    d->points.reserve(index + points.size());
+    for (const QPointF &point : points)
+        d->points.append(point);
+
+    for (auto i = d->channels.begin(), end = d->channels.end(); i != end; ++i) {
+        QVariantList &data = i.value();
+        const QVariantList newData = channelData.value(i.key());
+        data.reserve(d->points.size());
+        while (data.size() < index)
+            data.append(QVariant());
+        if (data.size() == index)
+            data.append(newData.mid(0, points.size()));
+        while (data.size() < d->points.size())
+            data.append(QVariant());
+    }
+
+    d->notifyPointsAdded();
+    return index;
+}
+
 /*! \qmlmethod void Trace::setChannelData(int index, string channel, var data)
 
     Sets \a data for the point at \a index in the given data \a channel.
@@ -349,6 +448,8 @@ void QVirtualKeyboardTrace::setFinal(bool final)
 {
     Q_D(QVirtualKeyboardTrace);
     if (d->final != final) {
+        if (final)
+            d->flush();
         d->final = final;
         emit finalChanged(final);
     }
@@ -384,6 +485,33 @@ void QVirtualKeyboardTrace::setOpacity(qreal opacity)
     }
 }
 
+bool QVirtualKeyboardTrace::batchUpdates() const
+{
+    Q_D(const QVirtualKeyboardTrace);
+    return d->batchUpdates;
+}
+
+void QVirtualKeyboardTrace::setBatchUpdates(bool batchUpdates)
+{
+    Q_D(QVirtualKeyboardTrace);
+    if (d->batchUpdates != batchUpdates) {
+        d->batchUpdates = batchUpdates;
+        if (!batchUpdates)
+            d->flush();
+        emit batchUpdatesChanged(batchUpdates);
+    }
+}
+
+/*! \internal */
+void QVirtualKeyboardTrace::timerEvent(QTimerEvent *event)
+{
+    Q_D(QVirtualKeyboardTrace);
+    if (event->timerId() == d->flushTimer.timerId())
+        d->flush();
+    else
+        QObject::timerEvent(event);
+}
+
 /*! \qmlproperty int Trace::traceId
 
     Unique id of this Trace.
@@ -464,4 +592,36 @@ void QVirtualKeyboardTrace::setOpacity(qreal opacity)
     ones are added.
 */
 
+/*! \qmlproperty bool Trace::batchUpdates
+    \since QtQuick.VirtualKeyboard 2.15
+
+    This property defines whether the change notifications are coalesced.
+
+    If the value is \c true, the \c lengthChanged and \c pointsAdded
+    signals are emitted at most once per display frame. The data itself is
+    available immediately. Pending notifications are delivered before the
+    \l final property changes.
+
+    The default value is \c false.
+*/
+
+/*! \property QVirtualKeyboardTrace::batchUpdates
+    \since 6.0
+    \brief defines whether the change notifications are coalesced.
+
+    If the value is \c true, the lengthChanged() and pointsAdded() signals
+    are emitted at most once per display frame. The data itself is available
+    immediately. Pending notifications are delivered before the \l final
+    property changes.
+
+    The default value is \c false.
+*/
+
+/*! \fn void QVirtualKeyboardTrace::pointsAdded(int index, int count)
+    \since 6.0
+
+    This signal is emitted when \a count points have been added to the
+    trace, starting at \a index.
+*/
+
 QT_END_NAMESPACE
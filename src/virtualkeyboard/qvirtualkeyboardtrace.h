@@ -33,6 +33,7 @@
 #include <QObject>
 #include <QVariant>
 #include <QPointF>
+#include <QMap>
 #include <QtVirtualKeyboard/qvirtualkeyboard_global.h>
 
 QT_BEGIN_NAMESPACE
@@ -49,6 +50,7 @@ class QVIRTUALKEYBOARD_EXPORT QVirtualKeyboardTrace : public QObject
     Q_PROPERTY(bool final READ isFinal WRITE setFinal NOTIFY finalChanged)
     Q_PROPERTY(bool canceled READ isCanceled WRITE setCanceled NOTIFY canceledChanged)
     Q_PROPERTY(qreal opacity READ opacity WRITE setOpacity NOTIFY opacityChanged)
+    Q_PROPERTY(bool batchUpdates READ batchUpdates WRITE setBatchUpdates NOTIFY batchUpdatesChanged)
 public:
     explicit QVirtualKeyboardTrace(QObject *parent = nullptr);
     ~QVirtualKeyboardTrace();
@@ -63,6 +65,7 @@ public:
 
     Q_INVOKABLE QVariantList points(int pos = 0, int count = -1) const;
     Q_INVOKABLE int addPoint(const QPointF &point);
+    int addPoints(const QList<QPointF> &points, const QMap<QString, QVariantList> &channelData = QMap<QString, QVariantList>());
 
     Q_INVOKABLE void setChannelData(const QString &channel, int index, const QVariant &data);
     Q_INVOKABLE QVariantList channelData(const QString &channel, int pos = 0, int count = -1) const;
@@ -76,6 +79,9 @@ public:
     qreal opacity() const;
     void setOpacity(qreal opacity);
 
+    bool batchUpdates() const;
+    void setBatchUpdates(bool batchUpdates);
+
 Q_SIGNALS:
     void traceIdChanged(int traceId);
     void channelsChanged();
@@ -83,6 +89,11 @@ Q_SIGNALS:
     void finalChanged(bool isFinal);
     void canceledChanged(bool isCanceled);
     void opacityChanged(qreal opacity);
+    void batchUpdatesChanged(bool batchUpdates);
+    void pointsAdded(int index, int count);
+
+protected:
+    void timerEvent(QTimerEvent *event) override;
 };
 
 QT_END_NAMESPACE
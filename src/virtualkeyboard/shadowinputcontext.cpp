@@ -29,6 +29,7 @@
 
 #include <QtVirtualKeyboard/private/shadowinputcontext_p.h>
 #include <QtVirtualKeyboard/qvirtualkeyboardinputcontext.h>
+#include <QtVirtualKeyboard/private/qvirtualkeyboardinputcontext_p.h>
 #include <QtVirtualKeyboard/private/virtualkeyboarddebug_p.h>
 
 #include <QtCore/private/qobject_p.h>
@@ -48,7 +49,8 @@ public:
         inputContext(nullptr),
         anchorRectIntersectsClipRect(false),
         cursorRectIntersectsClipRect(false),
-        selectionControlVisible(false)
+        selectionControlVisible(false),
+        syncPending(false)
     {
     }
 
@@ -61,6 +63,7 @@ public:
     bool anchorRectIntersectsClipRect;
     bool cursorRectIntersectsClipRect;
     bool selectionControlVisible;
+    bool syncPending;
 };
 
 ShadowInputContext::ShadowInputContext(QObject *parent) :
@@ -185,13 +188,37 @@ void ShadowInputContext::updateSelectionProperties()
         emit selectionControlVisibleChanged();
 }
 
+/*
+    Schedules the shadow input item to be synchronized with the input
+    context. All updates until the event loop is next entered are
+    coalesced into one synchronization.
+*/
 void ShadowInputContext::update(Qt::InputMethodQueries queries)
 {
     Q_UNUSED(queries)
     Q_D(ShadowInputContext);
-    if (!d->inputItem)
+    if (!d->inputItem || d->syncPending)
+        return;
+
+    d->syncPending = true;
+    QMetaObject::invokeMethod(this, &ShadowInputContext::sync, Qt::QueuedConnection);
+}
+
+/*
+    Sends a single input method event to the shadow input item. The
+    event replaces only the range where the surrounding text of the
+    shadow item differs from the input context, and carries the
+    preedit text and selection along with it.
+*/
+void ShadowInputContext::sync()
+{
+    Q_D(ShadowInputContext);
+    d->syncPending = false;
+    if (!d->inputItem || !d->inputContext)
         return;
 
+    QVirtualKeyboardScopedState syncShadowInputState(d->inputContext->priv(), QVirtualKeyboardInputContextPrivate::State::SyncShadowInput);
+
     QInputMethodQueryEvent imQueryEvent(Qt::ImQueryInput);
     QGuiApplication::sendEvent(d->inputItem, &imQueryEvent);
 
@@ -199,29 +226,62 @@ void ShadowInputContext::update(Qt::InputMethodQueries queries)
     const int cursorPosition = imQueryEvent.value(Qt::ImCursorPosition).toInt();
     const int anchorPosition = imQueryEvent.value(Qt::ImAnchorPosition).toInt();
 
-    const QString newSurroundingText = d->inputContext->surroundingText();
-    const int newCursorPosition = d->inputContext->cursorPosition();
-    const int newAnchorPosition = d->inputContext->anchorPosition();
-
-    bool updateSurroundingText = newSurroundingText != surroundingText;
-    bool updateSelection = newCursorPosition != cursorPosition || newAnchorPosition != anchorPosition;
-    if (updateSurroundingText || updateSelection) {
-        QList<QInputMethodEvent::Attribute> attributes;
-        attributes.append(QInputMethodEvent::Attribute(QInputMethodEvent::Selection,
-                                                       newAnchorPosition,
-                                                       newCursorPosition - newAnchorPosition, QVariant()));
-        QInputMethodEvent inputEvent(QString(), attributes);
-        if (updateSurroundingText)
-            inputEvent.setCommitString(newSurroundingText, -cursorPosition, surroundingText.length());
-        QGuiApplication::sendEvent(d->inputItem, &inputEvent);
+    QString newSurroundingText;
+    int newCursorPosition;
+    int newAnchorPosition;
+    if (d->inputContext->priv()->isSurroundingTextWindowed()) {
+        // The surrounding text of the input context is only a window
+        // around the cursor, while the shadow input item holds the whole text
+        QObject *focusObject = QGuiApplication::focusObject();
+        if (!focusObject)
+            return;
+        QInputMethodQueryEvent focusQueryEvent(Qt::ImQueryInput);
+        QGuiApplication::sendEvent(focusObject, &focusQueryEvent);
+        newSurroundingText = focusQueryEvent.value(Qt::ImSurroundingText).toString();
+        newCursorPosition = focusQueryEvent.value(Qt::ImCursorPosition).toInt();
+        newAnchorPosition = focusQueryEvent.value(Qt::ImAnchorPosition).toInt();
+    } else {
+        newSurroundingText = d->inputContext->surroundingText();
+        newCursorPosition = d->inputContext->cursorPosition();
+        newAnchorPosition = d->inputContext->anchorPosition();
     }
 
+    const bool updateSurroundingText = newSurroundingText != surroundingText;
+    const bool updateSelection = newCursorPosition != cursorPosition || newAnchorPosition != anchorPosition;
+
     const QString newPreeditText = d->inputContext->preeditText();
     const QList<QInputMethodEvent::Attribute> newPreeditAttributes = d->inputContext->preeditTextAttributes();
-    if (d->preeditText != newPreeditText || d->preeditTextAttributes != newPreeditAttributes) {
-        d->preeditText = newPreeditText;
-        d->preeditTextAttributes = newPreeditAttributes;
-        QInputMethodEvent inputEvent(d->preeditText, d->preeditTextAttributes);
+    const bool updatePreedit = d->preeditText != newPreeditText || d->preeditTextAttributes != newPreeditAttributes;
+    d->preeditText = newPreeditText;
+    d->preeditTextAttributes = newPreeditAttributes;
+
+    if (updateSurroundingText || updateSelection || updatePreedit) {
+        // The event always carries the preedit text, since an event
+        // without it would clear the preedit text of the shadow item.
+        QList<QInputMethodEvent::Attribute> attributes = d->preeditTextAttributes;
+        if (updateSurroundingText || updateSelection) {
+            attributes.append(QInputMethodEvent::Attribute(QInputMethodEvent::Selection,
+                                                           newAnchorPosition,
+                                                           newCursorPosition - newAnchorPosition, QVariant()));
+        }
+        QInputMethodEvent inputEvent(d->preeditText, attributes);
+        if (updateSurroundingText) {
+            // Replace only the range between the common prefix and suffix
+            const int oldLength = surroundingText.length();
+            const int newLength = newSurroundingText.length();
+            const int maxLength = qMin(oldLength, newLength);
+            int prefixLength = 0;
+            while (prefixLength < maxLength &&
+                   surroundingText.at(prefixLength) == newSurroundingText.at(prefixLength))
+                ++prefixLength;
+            int suffixLength = 0;
+            while (suffixLength < maxLength - prefixLength &&
+                   surroundingText.at(oldLength - suffixLength - 1) == newSurroundingText.at(newLength - suffixLength - 1))
+                ++suffixLength;
+            inputEvent.setCommitString(newSurroundingText.mid(prefixLength, newLength - prefixLength - suffixLength),
+                                       prefixLength - cursorPosition,
+                                       oldLength - prefixLength - suffixLength);
+        }
         QGuiApplication::sendEvent(d->inputItem, &inputEvent);
     }
 
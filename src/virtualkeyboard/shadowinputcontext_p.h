@@ -94,6 +94,7 @@ signals:
 
 private:
     void update(Qt::InputMethodQueries queries);
+    void sync();
     QVariant queryFocusObject(Qt::InputMethodQuery query, QVariant argument);
 
 private:
@@ -299,12 +299,12 @@ void ShiftHandler::autoCapitalize()
         if (cursorPosition == 0) {
             setShiftActive(!preferLowerCase);
         } else { // space after sentence-ending character triggers auto-capitalization
-            QString text = d->inputContext->surroundingText();
-            text.truncate(cursorPosition);
-            if (text.trimmed().length() == 0)
+            const QString surroundingText = d->inputContext->surroundingText();
+            const QStringView text = QStringView{surroundingText}.left(cursorPosition);
+            if (text.trimmed().isEmpty() && !d->inputContext->priv()->isSurroundingTextClipped())
                 setShiftActive(!preferLowerCase);
             else if (text.endsWith(QLatin1Char(' ')))
-                setShiftActive(d->sentenceEndingCharacters.contains(QStringView{text}.right(2)[0])
+                setShiftActive(text.length() > 1 && d->sentenceEndingCharacters.contains(text.right(2)[0])
                                && !preferLowerCase);
             else
                 setShiftActive(false);
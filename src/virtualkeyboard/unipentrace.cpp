@@ -31,35 +31,305 @@
 #include <QRectF>
 #include <QDir>
 #include <QFile>
+#include <QHash>
+#include <QSet>
+#include <QThread>
+#include <QMutex>
+#include <QSemaphore>
+#include <QWaitCondition>
+#include <QDataStream>
 #include <QDebug>
 
+#include <cstring>
+
 QT_BEGIN_NAMESPACE
 namespace QtVirtualKeyboard {
 
+/*
+    Container file layout (little endian):
+
+        char[8]  magic "VKBTRACE"
+        quint32  version
+
+    followed by any number of records:
+
+        quint32  unicode
+        quint32  confidence
+        qint32   x dimension, y dimension, dpi and sample rate (-1 if unknown)
+        quint32  number of traces
+        quint32  number of points in each trace
+        qint32   x, y and t of each point
+*/
+static const char containerMagic[8] = { 'V', 'K', 'B', 'T', 'R', 'A', 'C', 'E' };
+static const quint32 containerVersion = 1;
+
+// Initial capacity of the point buffer, in points
+static const int pointBufferReserve = 2048;
+
+struct UnipenTraceSample
+{
+    QString directory;
+    UnipenTrace::StorageFormat storageFormat;
+    uint unicode;
+    uint confidence;
+    qint32 xDim;
+    qint32 yDim;
+    qint32 dpi;
+    qint32 sampleRate;
+    QVector<int> traceSizes;
+    QVector<qint32> points;
+};
+
+static QByteArray toUnipen(const UnipenTraceSample &sample)
+{
+    QByteArray data;
+    data.reserve(128 + sample.points.size() * 6);
+    data.append(".VERSION 1.0\n"
+                ".HIERARCHY CHARACTER\n"
+                ".COORD X Y T\n"
+                ".SEGMENT CHARACTER\n");
+    if (sample.xDim >= 0 && sample.yDim >= 0) {
+        data.append(".X_DIM ").append(QByteArray::number(sample.xDim)).append('\n');
+        data.append(".Y_DIM ").append(QByteArray::number(sample.yDim)).append('\n');
+    }
+    if (sample.dpi >= 0) {
+        data.append(".X_POINTS_PER_INCH ").append(QByteArray::number(sample.dpi)).append('\n');
+        data.append(".Y_POINTS_PER_INCH ").append(QByteArray::number(sample.dpi)).append('\n');
+    }
+    if (sample.sampleRate >= 0)
+        data.append(".POINTS_PER_SECOND ").append(QByteArray::number(sample.sampleRate)).append('\n');
+
+    const qint32 *point = sample.points.constData();
+    for (int traceSize : sample.traceSizes) {
+        data.append(".PEN_DOWN\n");
+        for (int i = 0; i < traceSize; ++i, point += 3) {
+            data.append(QByteArray::number(point[0])).append(' ');
+            data.append(QByteArray::number(point[1])).append(' ');
+            data.append(QByteArray::number(point[2])).append('\n');
+        }
+        data.append(".PEN_UP\n");
+    }
+
+    return data;
+}
+
+/*
+    Picks the next free <unicode>_<confidence>_<index>.txt file name. The
+    directory is listed once and the names in use are then tracked in memory.
+*/
+class UnipenFileNames
+{
+public:
+    QString next(const QString &directory, uint unicode, uint confidence)
+    {
+        QDir fileDir(directory);
+        if (!fileDir.exists())
+            fileDir.mkpath(directory);
+
+        auto it = usedFileNames.find(directory);
+        if (it == usedFileNames.end()) {
+            const QStringList entries = fileDir.entryList(QStringList() << QStringLiteral("*.txt"), QDir::Files);
+            it = usedFileNames.insert(directory, QSet<QString>(entries.constBegin(), entries.constEnd()));
+        }
+
+        QString fileName;
+        int fileIndex = 0;
+        do {
+            fileName = QStringLiteral("%1_%2_%3.txt").arg(unicode).arg(confidence, 3, 10, QLatin1Char('0')).arg(fileIndex++);
+        } while (it->contains(fileName));
+        it->insert(fileName);
+
+        return fileDir.absoluteFilePath(fileName);
+    }
+
+private:
+    QHash<QString, QSet<QString>> usedFileNames;
+};
+
+static bool writeUnipenFile(UnipenFileNames &fileNames, const UnipenTraceSample &sample)
+{
+    QFile file(fileNames.next(sample.directory, sample.unicode, sample.confidence));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Cannot open file for writing" << file.fileName();
+        return false;
+    }
+    file.write(toUnipen(sample));
+    return true;
+}
+
+/*!
+    \class QtVirtualKeyboard::UnipenTraceWriter
+    \internal
+
+    Writes the saved samples in a background thread, so that the input
+    method does not block on file system access.
+*/
+
+class UnipenTraceWriter : public QThread
+{
+public:
+    UnipenTraceWriter() :
+        abort(false),
+        idle(true)
+    {
+        start(QThread::LowPriority);
+    }
+
+    ~UnipenTraceWriter()
+    {
+        {
+            QMutexLocker guard(&sampleLock);
+            abort = true;
+        }
+        sampleSema.release();
+        wait();
+    }
+
+    void addSample(const UnipenTraceSample &sample)
+    {
+        QMutexLocker guard(&sampleLock);
+        sampleList.append(sample);
+        idle = false;
+        sampleSema.release();
+    }
+
+    void flush()
+    {
+        QMutexLocker guard(&sampleLock);
+        while (!idle)
+            idleCondition.wait(&sampleLock);
+    }
+
+protected:
+    void run() override
+    {
+        forever {
+            sampleSema.acquire();
+            UnipenTraceSample sample;
+            {
+                QMutexLocker guard(&sampleLock);
+                if (sampleList.isEmpty()) {
+                    idle = true;
+                    idleCondition.wakeAll();
+                    if (abort)
+                        break;
+                    continue;
+                }
+                sample = sampleList.takeFirst();
+            }
+            if (sample.storageFormat == UnipenTrace::StorageFormat::Container)
+                writeContainer(sample);
+            else
+                writeUnipenFile(fileNames, sample);
+            {
+                QMutexLocker guard(&sampleLock);
+                if (sampleList.isEmpty()) {
+                    idle = true;
+                    idleCondition.wakeAll();
+                }
+            }
+        }
+        containerFile.reset();
+    }
+
+private:
+    void writeContainer(const UnipenTraceSample &sample)
+    {
+        const QString filePath = QDir(sample.directory).absoluteFilePath(UnipenTrace::containerFileName());
+        if (!containerFile || containerFile->fileName() != filePath) {
+            QDir fileDir(sample.directory);
+            if (!fileDir.exists())
+                fileDir.mkpath(sample.directory);
+            containerFile.reset(new QFile(filePath));
+            if (!containerFile->open(QIODevice::WriteOnly | QIODevice::Append)) {
+                qWarning() << "Cannot open file for writing" << filePath;
+                containerFile.reset();
+                return;
+            }
+            if (containerFile->size() == 0) {
+                containerFile->write(containerMagic, sizeof(containerMagic));
+                QDataStream stream(containerFile.data());
+                stream.setByteOrder(QDataStream::LittleEndian);
+                stream << containerVersion;
+            }
+        }
+
+        // Serialize into memory first, so that a record is appended with a single write
+        QByteArray record;
+        record.reserve(36 + sample.traceSizes.size() * 4 + sample.points.size() * 4);
+        QDataStream stream(&record, QIODevice::WriteOnly);
+        stream.setByteOrder(QDataStream::LittleEndian);
+        stream << quint32(sample.unicode) << quint32(sample.confidence)
+               << sample.xDim << sample.yDim << sample.dpi << sample.sampleRate
+               << quint32(sample.traceSizes.size());
+        for (int traceSize : sample.traceSizes)
+            stream << quint32(traceSize);
+        for (qint32 value : sample.points)
+            stream << value;
+
+        containerFile->write(record);
+        containerFile->flush();
+    }
+
+    QList<UnipenTraceSample> sampleList;
+    QSemaphore sampleSema;
+    QMutex sampleLock;
+    QWaitCondition idleCondition;
+    bool abort;
+    bool idle;
+    UnipenFileNames fileNames;
+    QScopedPointer<QFile> containerFile;
+};
+
+Q_GLOBAL_STATIC(UnipenTraceWriter, unipenTraceWriter)
+
+/*!
+    \class QtVirtualKeyboard::UnipenTrace
+    \internal
+
+    Records handwriting traces for collecting test data.
+
+    The points are packed into a preallocated buffer while recording and
+    the saved samples are written by a background thread. In the
+    StorageFormat::Unipen format each sample is saved into its own
+    <unicode>_<confidence>_<index>.txt file. In the StorageFormat::Container
+    format all samples are appended into a single containerFileName() file
+    in the directory, which can be converted to Unipen files with
+    exportContainer().
+
+    The default format is Unipen. It can be changed with the
+    QT_VIRTUALKEYBOARD_RECORD_TRACE_FORMAT environment variable, which
+    accepts the values "unipen" and "container".
+*/
+
 UnipenTrace::UnipenTrace(const QVariantMap &traceCaptureDeviceInfo,
                          const QVariantMap &traceScreenInfo,
                          QObject *parent) :
-    QObject(parent)
+    QObject(parent),
+    m_xDim(-1),
+    m_yDim(-1),
+    m_dpi(-1),
+    m_sampleRate(-1),
+    m_storageFormat(StorageFormat::Unipen)
 {
-    m_lines.append(QLatin1String(".VERSION 1.0"));
-    m_lines.append(QLatin1String(".HIERARCHY CHARACTER"));
-    m_lines.append(QLatin1String(".COORD X Y T"));
-    m_lines.append(QLatin1String(".SEGMENT CHARACTER"));
     const QRectF boundingBox = traceScreenInfo[QLatin1String("boundingBox")].toRectF();
     if (!boundingBox.isEmpty()) {
-        m_lines.append(QStringLiteral(".X_DIM %1").arg(qRound(boundingBox.right())));
-        m_lines.append(QStringLiteral(".Y_DIM %1").arg(qRound(boundingBox.bottom())));
+        m_xDim = qRound(boundingBox.right());
+        m_yDim = qRound(boundingBox.bottom());
     }
     bool ok = false;
     int dpi = traceCaptureDeviceInfo[QLatin1String("dpi")].toInt(&ok);
-    if (ok) {
-        m_lines.append(QStringLiteral(".X_POINTS_PER_INCH %1").arg(dpi));
-        m_lines.append(QStringLiteral(".Y_POINTS_PER_INCH %1").arg(dpi));
-    }
+    if (ok)
+        m_dpi = dpi;
     ok = false;
     int sampleRate = traceCaptureDeviceInfo[QLatin1String("sampleRate")].toInt(&ok);
     if (ok)
-        m_lines.append(QStringLiteral(".POINTS_PER_SECOND %1").arg(sampleRate));
+        m_sampleRate = sampleRate;
+
+    if (qEnvironmentVariable("QT_VIRTUALKEYBOARD_RECORD_TRACE_FORMAT") == QLatin1String("container"))
+        m_storageFormat = StorageFormat::Container;
+
+    m_points.reserve(pointBufferReserve * 3);
 }
 
 void UnipenTrace::record(const QList<QVirtualKeyboardTrace *> &traceList)
@@ -73,21 +343,19 @@ void UnipenTrace::record(const QList<QVirtualKeyboardTrace *> &traceList)
         if (t0 == 0 && hasTime)
             t0 = t->toLongLong();
 
-        m_lines.append(QLatin1String(".PEN_DOWN"));
+        m_traceSizes.append(points.size());
 
         for (const QVariant &point : points) {
             const QPointF pt(point.toPointF());
-            QString pointStr(QStringLiteral("%1 %2 ").arg(qRound(pt.x())).arg(qRound(pt.y())));
+            m_points.append(qRound(pt.x()));
+            m_points.append(qRound(pt.y()));
             if (hasTime) {
-                pointStr.append(QString::number(t->toLongLong() - t0));
+                m_points.append(qint32(t->toLongLong() - t0));
                 t++;
             } else {
-                pointStr.append(QLatin1String("0"));
+                m_points.append(0);
             }
-            m_lines.append(pointStr);
         }
-
-        m_lines.append(QLatin1String(".PEN_UP"));
     }
 }
 
@@ -96,25 +364,19 @@ void UnipenTrace::save(uint unicode, uint confidence)
     if (m_directory.isEmpty())
         return;
 
-    QString fileName;
-    QDir fileDir(m_directory);
-    if (!fileDir.exists())
-        fileDir.mkpath(m_directory);
-    if (fileDir.exists()) {
-        int fileIndex = 0;
-        do {
-            fileName = fileDir.absoluteFilePath(QStringLiteral("%1_%2_%3.txt").arg(unicode).arg(confidence, 3, 10, QLatin1Char('0')).arg(fileIndex++));
-        } while (QFileInfo::exists(fileName));
-    }
+    UnipenTraceSample sample;
+    sample.directory = m_directory;
+    sample.storageFormat = m_storageFormat;
+    sample.unicode = unicode;
+    sample.confidence = confidence;
+    sample.xDim = m_xDim;
+    sample.yDim = m_yDim;
+    sample.dpi = m_dpi;
+    sample.sampleRate = m_sampleRate;
+    sample.traceSizes = m_traceSizes;
+    sample.points = m_points;
 
-    QString dataStr(m_lines.join(QLatin1Char('\n')));
-    dataStr.append(QLatin1Char('\n'));
-    QFile file(fileName);
-    if (file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
-        file.write(dataStr.toUtf8().constData());
-    } else {
-        qWarning() << "Cannot open file for writing" << fileName;
-    }
+    unipenTraceWriter->addSample(sample);
 }
 
 QString UnipenTrace::directory() const
@@ -127,4 +389,108 @@ void UnipenTrace::setDirectory(const QString &directory)
     m_directory = directory;
 }
 
+UnipenTrace::StorageFormat UnipenTrace::storageFormat() const
+{
+    return m_storageFormat;
+}
+
+void UnipenTrace::setStorageFormat(StorageFormat storageFormat)
+{
+    m_storageFormat = storageFormat;
+}
+
+/*!
+    Returns the name of the container file used in StorageFormat::Container.
+*/
+QString UnipenTrace::containerFileName()
+{
+    return QStringLiteral("traces.vkbtrace");
 }
+
+/*!
+    Converts the samples in \a containerFilePath to Unipen files in \a directory.
+    Returns \c true on success.
+*/
+bool UnipenTrace::exportContainer(const QString &containerFilePath, const QString &directory)
+{
+    flush();
+
+    QFile file(containerFilePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Cannot open file for reading" << containerFilePath;
+        return false;
+    }
+
+    char magic[sizeof(containerMagic)];
+    if (file.read(magic, sizeof(magic)) != sizeof(magic) || memcmp(magic, containerMagic, sizeof(magic)) != 0) {
+        qWarning() << "Not a trace container" << containerFilePath;
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    quint32 version = 0;
+    stream >> version;
+    if (version != containerVersion) {
+        qWarning() << "Unsupported trace container version" << version;
+        return false;
+    }
+
+    UnipenFileNames fileNames;
+    while (!stream.atEnd()) {
+        UnipenTraceSample sample;
+        sample.directory = directory;
+        sample.storageFormat = StorageFormat::Unipen;
+        quint32 unicode, confidence, traceCount;
+        stream >> unicode >> confidence >> sample.xDim >> sample.yDim >> sample.dpi >> sample.sampleRate >> traceCount;
+        sample.unicode = unicode;
+        sample.confidence = confidence;
+
+        // The counts are validated against the remaining data before
+        // anything is allocated for them
+        if (stream.status() != QDataStream::Ok ||
+                qint64(traceCount) * qint64(sizeof(quint32)) > file.bytesAvailable()) {
+            qWarning() << "Truncated trace container" << containerFilePath;
+            return false;
+        }
+
+        qint64 pointCount = 0;
+        sample.traceSizes.reserve(int(traceCount));
+        for (quint32 i = 0; i < traceCount && stream.status() == QDataStream::Ok; ++i) {
+            quint32 traceSize;
+            stream >> traceSize;
+            sample.traceSizes.append(int(traceSize));
+            pointCount += traceSize;
+        }
+        if (stream.status() != QDataStream::Ok ||
+                pointCount * 3 * qint64(sizeof(qint32)) > file.bytesAvailable()) {
+            qWarning() << "Truncated trace container" << containerFilePath;
+            return false;
+        }
+
+        sample.points.resize(int(pointCount * 3));
+        for (qint32 &value : sample.points)
+            stream >> value;
+
+        if (stream.status() != QDataStream::Ok) {
+            qWarning() << "Truncated trace container" << containerFilePath;
+            return false;
+        }
+
+        if (!writeUnipenFile(fileNames, sample))
+            return false;
+    }
+
+    return true;
+}
+
+/*!
+    Blocks until all saved samples have been written.
+*/
+void UnipenTrace::flush()
+{
+    unipenTraceWriter->flush();
+}
+
+} // namespace QtVirtualKeyboard
+QT_END_NAMESPACE
@@ -42,6 +42,7 @@
 //
 
 #include <QObject>
+#include <QVector>
 #include <QtVirtualKeyboard/qvirtualkeyboardtrace.h>
 #include <QtVirtualKeyboard/qvirtualkeyboard_global.h>
 
@@ -52,6 +53,11 @@ class QVIRTUALKEYBOARD_EXPORT UnipenTrace : public QObject
 {
     Q_OBJECT
 public:
+    enum class StorageFormat {
+        Unipen,
+        Container
+    };
+
     explicit UnipenTrace(const QVariantMap &traceCaptureDeviceInfo, const QVariantMap &traceScreenInfo, QObject *parent = nullptr);
 
     void record(const QList<QVirtualKeyboardTrace *> &traceList);
@@ -60,9 +66,22 @@ public:
     QString directory() const;
     void setDirectory(const QString &directory);
 
+    StorageFormat storageFormat() const;
+    void setStorageFormat(StorageFormat storageFormat);
+
+    static QString containerFileName();
+    static bool exportContainer(const QString &containerFilePath, const QString &directory);
+    static void flush();
+
 private:
-    QStringList m_lines;
+    int m_xDim;
+    int m_yDim;
+    int m_dpi;
+    int m_sampleRate;
+    QVector<int> m_traceSizes;
+    QVector<qint32> m_points;
     QString m_directory;
+    StorageFormat m_storageFormat;
 };
 
 } // namespace QtVirtualKeyboard
@@ -27,6 +27,10 @@ SOURCES += \
     shifthandler.cpp \
     inputmethod.cpp \
     inputselectionhandle.cpp \
+    keyboardlayoutpool.cpp \
+    keyhitindex.cpp \
+    latencytracer.cpp \
+    layoutregistry.cpp \
     qvirtualkeyboardselectionlistmodel.cpp \
     fallbackinputmethod.cpp \
     abstractinputpanel.cpp \
@@ -52,6 +56,10 @@ HEADERS += \
     shifthandler_p.h \
     inputmethod_p.h \
     inputselectionhandle_p.h \
+    keyboardlayoutpool_p.h \
+    keyhitindex_p.h \
+    latencytracer_p.h \
+    layoutregistry_p.h \
     qvirtualkeyboardselectionlistmodel.h \
     fallbackinputmethod_p.h \
     abstractinputpanel_p.h \
@@ -5,4 +5,5 @@ SUBDIRS += \
     styles \
     layoutfilesystem \
     layoutresources \
+    surroundingtextwindow \
     cmake \
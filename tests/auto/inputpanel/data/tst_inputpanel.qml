@@ -1121,6 +1121,11 @@ Rectangle {
                 // Test splitting the final double Jamo and use the second Jamo of
                 // the split Jamo as initial Jamo of the following syllable
                 { initLocale: "ko_KR", inputSequence: "\u3131\u314F\u3131\u3145\u314F", outputText: "\uAC01\uC0AC" },
+                // Test removing Jamos across several composed syllables
+                { initLocale: "ko_KR", inputSequence: "\u3131\u314F\u3134\u314F\u3137\u314F", outputText: "\uAC00\uB098\uB2E4" },
+                { initLocale: "ko_KR", inputSequence: "\u3131\u314F\u3131\u314F\u3131\u314F\u3131", outputText: "\uAC00\uAC00\uAC01" },
+                // Test a syllable that starts with a vowel after a composed syllable
+                { initLocale: "ko_KR", inputSequence: "\u3131\u314F\u314F\u3134\u314F", outputText: "\uAC00\u314F\uB098" },
                 // Test entering a Jamo syllable with surrounding text
                 { initLocale: "ko_KR", initText: "abcdef", initCursorPosition: 3, inputSequence: "\u3131\u314F\u3131", outputText: "abc\uAC01def" },
             ]
@@ -1131,19 +1136,26 @@ Rectangle {
 
             compare(Qt.inputMethod.locale.name, Qt.locale(data.initLocale).name)
 
+            // The syllable under composition is kept in the pre-edit text
+            function composedText() {
+                return textInput.text.substring(0, textInput.cursorPosition) +
+                        textInput.preeditText +
+                        textInput.text.substring(textInput.cursorPosition)
+            }
+
             // Add Jamos one by one
             var intermediateResult = []
             for (var inputIndex in data.inputSequence) {
                 verify(inputPanel.virtualKeyClick(data.inputSequence[inputIndex]))
-                intermediateResult.push(textInput.text)
+                intermediateResult.push(composedText())
             }
 
-            compare(textInput.text, data.outputText)
+            compare(composedText(), data.outputText)
 
             // Remove Jamos one by one.
             // The number of removed characters must match to the number of Jamos entered.
             for (inputIndex = data.inputSequence.length - 1; inputIndex >= 0; inputIndex--) {
-                compare(textInput.text, intermediateResult.pop())
+                compare(composedText(), intermediateResult.pop())
                 inputPanel.virtualKeyClick(Qt.Key_Backspace)
             }
 
@@ -35,8 +35,10 @@ import json
 import datetime
 import getopt
 import re
+import struct
 
 unipen_file_pattern = re.compile(r'(^[0-9]{2,9}).*\.txt')
+container_file_pattern = re.compile(r'.*\.vkbtrace$')
 
 def print_header():
     print """/****************************************************************************
@@ -72,10 +74,45 @@ def scan_unipen_files(path):
     file_list = []
     for root, dirs, files in os.walk(path):
         for name in files:
-            if unipen_file_pattern.match(name):
+            if unipen_file_pattern.match(name) or container_file_pattern.match(name):
                 file_list.append(os.path.join(root, name))
     return file_list
 
+def read_container(file_name):
+    """Reads the trace container written by the record-trace-input mode and
+    returns a list of (unicode, unipen_data) tuples."""
+    samples = []
+    with open(file_name, 'rb') as f:
+        data = f.read()
+    if data[:8] != b'VKBTRACE':
+        sys.exit("Error: not a trace container " + file_name)
+    (version,) = struct.unpack_from('<I', data, 8)
+    if version != 1:
+        sys.exit("Error: unsupported trace container version %d" % version)
+    offset = 12
+    while offset < len(data):
+        unicode_value, confidence, x_dim, y_dim, dpi, sample_rate, trace_count = \
+            struct.unpack_from('<IIiiiiI', data, offset)
+        offset += 28
+        trace_sizes = struct.unpack_from('<%dI' % trace_count, data, offset)
+        offset += 4 * trace_count
+        unipen_data = {'.VERSION': '1.0', '.HIERARCHY': 'CHARACTER',
+                       '.COORD': ['X', 'Y', 'T'], '.SEGMENT': 'CHARACTER', '.PEN': []}
+        if x_dim >= 0 and y_dim >= 0:
+            unipen_data['.X_DIM'] = x_dim
+            unipen_data['.Y_DIM'] = y_dim
+        if dpi >= 0:
+            unipen_data['.X_POINTS_PER_INCH'] = dpi
+            unipen_data['.Y_POINTS_PER_INCH'] = dpi
+        if sample_rate >= 0:
+            unipen_data['.POINTS_PER_SECOND'] = sample_rate
+        for trace_size in trace_sizes:
+            values = struct.unpack_from('<%di' % (3 * trace_size), data, offset)
+            offset += 12 * trace_size
+            unipen_data['.PEN'].append([list(values[i:i + 3]) for i in range(0, len(values), 3)])
+        samples.append((unicode_value, unipen_data))
+    return samples
+
 def help():
     sys.exit("""Command line tool for converting Unipen files to JavaScript.
 
@@ -85,7 +122,8 @@ Scans given directories recursively for Unipen text files and converts
 them into JavaScript format. The result is printed to the stdout.
 
 The Unipen file name must start with the Unicode character encoded in decimal
-format, and end with .txt extension.""" % sys.argv[0])
+format, and end with .txt extension. Trace containers (.vkbtrace) written in
+the container recording format are read as well.""" % sys.argv[0])
 
 def main():
     if len(sys.argv) < 2:
@@ -104,6 +142,10 @@ def main():
     # Scan the Unipen files and build a data structure
     unipen_map = {}
     for file_name in file_list:
+        if container_file_pattern.match(file_name):
+            for unicode_value, unipen_data in read_container(file_name):
+                unipen_map["0x%04x" % unicode_value] = unipen_data
+            continue
         lines = tuple(open(file_name, 'r'))
         unipen_data = {}
         pen_data = []
@@ -0,0 +1,82 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Virtual Keyboard module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+import QtTest 1.0
+import QtQuick 2.0
+import QtQuick.VirtualKeyboard 2.3
+
+Rectangle {
+    id: container
+    width: 400
+    height: 400
+
+    TextEdit {
+        id: textInput
+        anchors.fill: parent
+        focus: true
+    }
+
+    InputPanel {
+        id: inputPanel
+        anchors.left: parent.left
+        anchors.right: parent.right
+        anchors.bottom: parent.bottom
+    }
+
+    TestCase {
+        id: testcase
+        name: "tst_surroundingtextwindow"
+        when: windowShown
+
+        function init() {
+            textInput.forceActiveFocus()
+        }
+
+        function cleanup() {
+            textInput.text = ""
+        }
+
+        // The input context is limited to 4 characters before the cursor
+        function test_autoCapitalization_data() {
+            return [
+                { tag: "within window", text: "   ", surroundingText: "   ", shiftActive: true },
+                { tag: "window boundary", text: "    ", surroundingText: "    ", shiftActive: true },
+                { tag: "clipped", text: "a    ", surroundingText: "    ", shiftActive: false }
+            ]
+        }
+
+        function test_autoCapitalization(data) {
+            textInput.text = data.text
+            textInput.cursorPosition = data.text.length
+            tryCompare(InputContext, "surroundingText", data.surroundingText)
+            compare(InputContext.cursorPosition, data.surroundingText.length)
+            tryCompare(InputContext, "shift", data.shiftActive)
+        }
+    }
+}
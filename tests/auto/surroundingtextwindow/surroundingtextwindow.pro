@@ -0,0 +1,17 @@
+TEMPLATE = app
+TARGET = tst_surroundingtextwindow
+
+QT += testlib
+CONFIG += qmltestcase console
+
+contains(CONFIG, static) {
+    QT += svg
+    QTPLUGIN += qtvirtualkeyboardplugin
+}
+
+SOURCES += $$PWD/tst_surroundingtextwindow.cpp
+
+TESTDATA = $$PWD/data/*
+
+OTHER_FILES += \
+    $$PWD/data/tst_surroundingtextwindow.qml \
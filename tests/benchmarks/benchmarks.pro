@@ -0,0 +1,8 @@
+TEMPLATE = subdirs
+
+QT_FOR_CONFIG += virtualkeyboard-private
+
+SUBDIRS += \
+    inputmethods
+
+qtConfig(lipi-toolkit): SUBDIRS += hwr
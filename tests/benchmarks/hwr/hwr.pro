@@ -0,0 +1,37 @@
+TEMPLATE = app
+TARGET = tst_bench_hwr
+
+QT = core
+CONFIG += benchmark console exceptions
+CONFIG -= app_bundle
+
+LIPI_PLUGIN_DIR = $$PWD/../../../src/plugins/lipi-toolkit/plugin
+LIPI_DIR = $$PWD/../../../src/plugins/lipi-toolkit/3rdparty/lipi-toolkit/src
+
+DEFINES += HWR_TEST_DATA_DIR=\\\"$$PWD/../../auto/inputpanel/hwr_test_data\\\"
+
+INCLUDEPATH += \
+    $$LIPI_PLUGIN_DIR \
+    $$LIPI_DIR/include \
+    $$LIPI_DIR/util/lib
+
+HEADERS += \
+    $$LIPI_PLUGIN_DIR/lipisharedrecognizer_p.h \
+    $$LIPI_PLUGIN_DIR/lipiworker_p.h \
+    hwrbackend.h \
+    lipibackend.h \
+    unipenreader.h
+
+SOURCES += \
+    $$LIPI_PLUGIN_DIR/lipisharedrecognizer.cpp \
+    $$LIPI_PLUGIN_DIR/lipiworker.cpp \
+    lipibackend.cpp \
+    main.cpp \
+    unipenreader.cpp
+
+LIBS += -L$$OUT_PWD/../../../lib \
+    -lshaperecommon$$qtPlatformTargetSuffix() \
+    -lltkcommon$$qtPlatformTargetSuffix() \
+    -lltkutil$$qtPlatformTargetSuffix()
+win32: LIBS += Advapi32.lib
+else: QMAKE_USE += libdl
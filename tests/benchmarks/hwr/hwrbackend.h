@@ -0,0 +1,60 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Virtual Keyboard module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef HWRBACKEND_H
+#define HWRBACKEND_H
+
+#include <QObject>
+#include <QStringList>
+
+#include "unipenreader.h"
+
+/*
+    Asynchronous recognizer interface used by the benchmark.
+
+    A backend accepts any number of outstanding requests and reports each one
+    exactly once through recognitionFinished(), which may be emitted from any
+    thread. The candidates are ordered by descending confidence.
+*/
+class HwrBenchmarkBackend : public QObject
+{
+    Q_OBJECT
+public:
+    explicit HwrBenchmarkBackend(QObject *parent = nullptr) : QObject(parent) {}
+
+    virtual QString name() const = 0;
+    virtual QString model(const QString &script) const = 0;
+    virtual bool setScript(const QString &script) = 0;
+    virtual bool recognize(int requestId, const UnipenSample &sample) = 0;
+
+signals:
+    void recognitionFinished(int requestId, const QStringList &candidates);
+};
+
+#endif // HWRBACKEND_H
@@ -0,0 +1,137 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Virtual Keyboard module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "lipibackend.h"
+
+#include <QLoggingCategory>
+#include <QVariantMap>
+#include <QAtomicInt>
+
+#include "LTKTraceGroup.h"
+#include "LTKTraceFormat.h"
+#include "LTKTrace.h"
+#include "LTKChannel.h"
+
+QT_BEGIN_NAMESPACE
+namespace QtVirtualKeyboard {
+// Normally defined by the input method, which is not part of the benchmark
+Q_LOGGING_CATEGORY(lcLipi, "qt.virtualkeyboard.lipi")
+} // namespace QtVirtualKeyboard
+QT_END_NAMESPACE
+
+using namespace QtVirtualKeyboard;
+
+LipiBenchmarkBackend::LipiBenchmarkBackend(QObject *parent) :
+    HwrBenchmarkBackend(parent)
+{
+}
+
+QString LipiBenchmarkBackend::name() const
+{
+    return QStringLiteral("lipi");
+}
+
+QString LipiBenchmarkBackend::model(const QString &script) const
+{
+    if (script == QLatin1String("alphanumeric"))
+        return QStringLiteral("SHAPEREC_ALPHANUM");
+    return QString();
+}
+
+bool LipiBenchmarkBackend::setScript(const QString &script)
+{
+    const QString modelName = model(script);
+    if (modelName.isEmpty() || !recognizer.setModel(modelName))
+        return false;
+
+    // Same character set as LipiInputMethod uses for Latin handwriting
+    recognizer.subsetOfClasses(QStringLiteral("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz1234567890?,.@+"), subsetOfClasses);
+    return true;
+}
+
+bool LipiBenchmarkBackend::recognize(int requestId, const UnipenSample &sample)
+{
+    LTKCaptureDevice deviceInfo;
+    deviceInfo.setSamplingRate(sample.pointsPerSecond);
+    deviceInfo.setXDPI(sample.pointsPerInch);
+    deviceInfo.setYDPI(sample.pointsPerInch);
+    deviceInfo.setLatency(0.0f);
+    deviceInfo.setUniformSampling(false);
+
+    LTKScreenContext screenContext;
+    if (sample.xDim > 0 && sample.yDim > 0) {
+        screenContext.setBboxLeft(0);
+        screenContext.setBboxTop(0);
+        screenContext.setBboxRight(sample.xDim);
+        screenContext.setBboxBottom(sample.yDim);
+    }
+
+    QSharedPointer<LipiRecognitionTask> recognitionTask = recognizer.newRecognition(deviceInfo, screenContext, subsetOfClasses, 0.0f, 4);
+    if (!recognitionTask)
+        return false;
+
+    vector<LTKChannel> channels;
+    channels.push_back(LTKChannel("X", DT_INT, true));
+    channels.push_back(LTKChannel("Y", DT_INT, true));
+    if (sample.hasTime)
+        channels.push_back(LTKChannel("T", DT_FLOAT, true));
+    LTKTraceFormat traceFormat(channels);
+
+    for (const QVector<UnipenPoint> &trace : sample.traces) {
+        LTKTrace ltktrace(traceFormat);
+        for (const UnipenPoint &p : trace) {
+            vector<float> point;
+            point.push_back(p.x);
+            point.push_back(p.y);
+            if (sample.hasTime)
+                point.push_back(p.t);
+            ltktrace.addPoint(point);
+        }
+        recognitionTask->traceGroup.addTrace(ltktrace);
+    }
+
+    QSharedPointer<LipiRecognitionResultsTask> resultsTask = recognizer.startRecognition(recognitionTask);
+    if (!resultsTask)
+        return false;
+
+    /*  The results task does not emit resultsAvailable() for an empty result,
+        so completion is reported when the worker releases the task.
+    */
+    QSharedPointer<QStringList> candidates(new QStringList());
+    connect(resultsTask.data(), &LipiRecognitionResultsTask::resultsAvailable, this,
+            [candidates](const QVariantList &resultList) {
+        for (const QVariant &result : resultList)
+            candidates->append(result.toMap().value(QLatin1String("unicode")).toString());
+    }, Qt::DirectConnection);
+    connect(resultsTask.data(), &QObject::destroyed, this, [this, requestId, candidates]() {
+        emit recognitionFinished(requestId, *candidates);
+    }, Qt::DirectConnection);
+
+    return true;
+}
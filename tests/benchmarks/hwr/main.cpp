@@ -0,0 +1,362 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Virtual Keyboard module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QDir>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QHash>
+#include <QTextStream>
+#include <QtMath>
+
+#include <algorithm>
+
+#if defined(Q_OS_UNIX)
+#include <sys/resource.h>
+#endif
+
+#include "unipenreader.h"
+#include "hwrbackend.h"
+#include "lipibackend.h"
+
+/*
+    Runs the Unipen samples in tests/auto/inputpanel/hwr_test_data through a
+    handwriting recognizer and reports latency, throughput, peak memory and
+    accuracy as JSON.
+*/
+
+class BenchmarkRunner : public QObject
+{
+    Q_OBJECT
+public:
+    struct Result
+    {
+        qint64 submitNs = 0;
+        qint64 finishNs = -1;
+        QStringList candidates;
+    };
+
+    explicit BenchmarkRunner(HwrBenchmarkBackend *backend) :
+        backend(backend)
+    {
+        connect(backend, &HwrBenchmarkBackend::recognitionFinished,
+                this, &BenchmarkRunner::onRecognitionFinished, Qt::DirectConnection);
+        timer.start();
+    }
+
+    // Keeps up to concurrency requests in flight and returns the results in
+    // sample order, or an empty list if the backend failed.
+    QVector<Result> run(const QList<UnipenSample> &samples, int concurrency, qint64 *elapsedNs)
+    {
+        QVector<Result> results(samples.size());
+        {
+            QMutexLocker guard(&lock);
+            pending.clear();
+            finished = 0;
+        }
+
+        // Request ids are unique across runs, so that a late result of an
+        // abandoned run can not be mistaken for a request of this one
+        const int firstRequestId = nextRequestId;
+        nextRequestId += samples.size();
+
+        const qint64 startNs = timer.nsecsElapsed();
+        int next = 0;
+        int completed = 0;
+        while (completed < samples.size()) {
+            QMutexLocker guard(&lock);
+            while (next < samples.size() && pending.size() < concurrency) {
+                results[next].submitNs = timer.nsecsElapsed();
+                pending.insert(firstRequestId + next, &results[next]);
+                guard.unlock();
+                const bool ok = backend->recognize(firstRequestId + next, samples.at(next));
+                guard.relock();
+                if (!ok) {
+                    abandonPendingRequests();
+                    return QVector<Result>();
+                }
+                ++next;
+            }
+            while (finished == 0) {
+                if (!finishedCondition.wait(&lock, 30000)) {
+                    qWarning("Recognition timed out");
+                    abandonPendingRequests();
+                    return QVector<Result>();
+                }
+            }
+            completed += finished;
+            finished = 0;
+        }
+        if (elapsedNs)
+            *elapsedNs = timer.nsecsElapsed() - startNs;
+
+        return results;
+    }
+
+private slots:
+    void onRecognitionFinished(int requestId, const QStringList &candidates)
+    {
+        const qint64 finishNs = timer.nsecsElapsed();
+        QMutexLocker guard(&lock);
+        Result *result = pending.take(requestId);
+        if (!result)
+            return;
+        result->finishNs = finishNs;
+        result->candidates = candidates;
+        ++finished;
+        finishedCondition.wakeAll();
+    }
+
+private:
+    // Forgets the requests still in flight before their results go out of
+    // scope, so that their late results are dropped. Requires the lock.
+    void abandonPendingRequests()
+    {
+        pending.clear();
+        finished = 0;
+    }
+
+    HwrBenchmarkBackend *backend;
+    QElapsedTimer timer;
+    QMutex lock;
+    QWaitCondition finishedCondition;
+    QHash<int, Result *> pending;
+    int finished = 0;
+    int nextRequestId = 0;
+};
+
+static qint64 peakResidentSetSizeKiB()
+{
+#if defined(Q_OS_UNIX)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return -1;
+#if defined(Q_OS_DARWIN)
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#else
+    return -1;
+#endif
+}
+
+static QJsonObject latencyStatistics(QVector<double> latenciesMs)
+{
+    QJsonObject statistics;
+    if (latenciesMs.isEmpty())
+        return statistics;
+
+    std::sort(latenciesMs.begin(), latenciesMs.end());
+    auto percentile = [&latenciesMs](double p) {
+        const int index = qBound(0, qCeil(p / 100.0 * latenciesMs.size()) - 1, latenciesMs.size() - 1);
+        return latenciesMs.at(index);
+    };
+
+    double sum = 0;
+    for (double latency : qAsConst(latenciesMs))
+        sum += latency;
+
+    statistics.insert(QStringLiteral("min"), latenciesMs.first());
+    statistics.insert(QStringLiteral("p50"), percentile(50));
+    statistics.insert(QStringLiteral("p90"), percentile(90));
+    statistics.insert(QStringLiteral("p95"), percentile(95));
+    statistics.insert(QStringLiteral("p99"), percentile(99));
+    statistics.insert(QStringLiteral("max"), latenciesMs.last());
+    statistics.insert(QStringLiteral("mean"), sum / latenciesMs.size());
+    return statistics;
+}
+
+static QJsonObject benchmarkScript(HwrBenchmarkBackend *backend, const QString &dataPath,
+                                   const QString &script, int iterations, const QList<int> &concurrencyLevels)
+{
+    QJsonObject report;
+    report.insert(QStringLiteral("script"), script);
+
+    const QList<UnipenSample> samples = UnipenReader::readDirectory(QDir(dataPath).filePath(script));
+    report.insert(QStringLiteral("samples"), samples.size());
+    if (samples.isEmpty()) {
+        report.insert(QStringLiteral("skipped"), QStringLiteral("no samples"));
+        return report;
+    }
+
+    const QString model = backend->model(script);
+    if (model.isEmpty() || !backend->setScript(script)) {
+        report.insert(QStringLiteral("skipped"), QStringLiteral("not supported by backend"));
+        return report;
+    }
+    report.insert(QStringLiteral("model"), model);
+
+    BenchmarkRunner runner(backend);
+
+    // Warm-up, includes model loading in the backends which load lazily
+    if (runner.run(samples.mid(0, 1), 1, nullptr).isEmpty()) {
+        report.insert(QStringLiteral("error"), QStringLiteral("recognition failed"));
+        return report;
+    }
+
+    QVector<double> latenciesMs;
+    int top1 = 0;
+    int top4 = 0;
+    int points = 0;
+    for (const UnipenSample &sample : samples)
+        points += sample.pointCount();
+
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+        const QVector<BenchmarkRunner::Result> results = runner.run(samples, 1, nullptr);
+        if (results.isEmpty()) {
+            report.insert(QStringLiteral("error"), QStringLiteral("recognition failed"));
+            return report;
+        }
+        for (int i = 0; i < results.size(); ++i) {
+            const BenchmarkRunner::Result &result = results.at(i);
+            latenciesMs.append((result.finishNs - result.submitNs) / 1000000.0);
+            if (iteration > 0)
+                continue;
+            const int rank = result.candidates.indexOf(samples.at(i).expectedText());
+            if (rank == 0)
+                ++top1;
+            if (rank != -1 && rank < 4)
+                ++top4;
+        }
+    }
+
+    report.insert(QStringLiteral("iterations"), iterations);
+    report.insert(QStringLiteral("averagePoints"), double(points) / samples.size());
+    report.insert(QStringLiteral("latencyMs"), latencyStatistics(latenciesMs));
+
+    QJsonObject accuracy;
+    accuracy.insert(QStringLiteral("top1"), double(top1) / samples.size());
+    accuracy.insert(QStringLiteral("top4"), double(top4) / samples.size());
+    report.insert(QStringLiteral("accuracy"), accuracy);
+
+    QJsonArray throughput;
+    for (int concurrency : concurrencyLevels) {
+        qint64 elapsedNs = 0;
+        const QVector<BenchmarkRunner::Result> results = runner.run(samples, concurrency, &elapsedNs);
+        QJsonObject entry;
+        entry.insert(QStringLiteral("concurrency"), concurrency);
+        if (results.isEmpty() || elapsedNs <= 0) {
+            entry.insert(QStringLiteral("error"), QStringLiteral("recognition failed"));
+        } else {
+            QVector<double> concurrentLatenciesMs;
+            for (const BenchmarkRunner::Result &result : results)
+                concurrentLatenciesMs.append((result.finishNs - result.submitNs) / 1000000.0);
+            entry.insert(QStringLiteral("elapsedMs"), elapsedNs / 1000000.0);
+            entry.insert(QStringLiteral("charactersPerSecond"), samples.size() * 1000000000.0 / elapsedNs);
+            entry.insert(QStringLiteral("latencyMs"), latencyStatistics(concurrentLatenciesMs));
+        }
+        throughput.append(entry);
+    }
+    report.insert(QStringLiteral("throughput"), throughput);
+
+    return report;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Handwriting recognition benchmark over Unipen data"));
+    parser.addHelpOption();
+    QCommandLineOption dataOption(QStringLiteral("data"),
+                                  QStringLiteral("Directory containing one Unipen directory per script."),
+                                  QStringLiteral("path"), QStringLiteral(HWR_TEST_DATA_DIR));
+    QCommandLineOption backendOption(QStringLiteral("backend"),
+                                     QStringLiteral("Recognizer backend."),
+                                     QStringLiteral("name"), QStringLiteral("lipi"));
+    QCommandLineOption scriptOption(QStringLiteral("script"),
+                                    QStringLiteral("Script to benchmark, can be repeated. Defaults to all scripts."),
+                                    QStringLiteral("name"));
+    QCommandLineOption iterationsOption(QStringLiteral("iterations"),
+                                        QStringLiteral("Number of sequential passes used for the latency percentiles."),
+                                        QStringLiteral("count"), QStringLiteral("3"));
+    QCommandLineOption concurrencyOption(QStringLiteral("concurrency"),
+                                         QStringLiteral("Comma separated number of requests in flight for the throughput passes."),
+                                         QStringLiteral("levels"), QStringLiteral("1,2,4,8"));
+    QCommandLineOption outputOption(QStringLiteral("output"),
+                                    QStringLiteral("Write the JSON report to file instead of stdout."),
+                                    QStringLiteral("file"));
+    parser.addOptions({dataOption, backendOption, scriptOption, iterationsOption, concurrencyOption, outputOption});
+    parser.process(app);
+
+    QScopedPointer<HwrBenchmarkBackend> backend;
+    if (parser.value(backendOption) == QLatin1String("lipi"))
+        backend.reset(new LipiBenchmarkBackend());
+    if (!backend) {
+        qCritical("Unsupported backend %s", qPrintable(parser.value(backendOption)));
+        return 1;
+    }
+
+    const QString dataPath = parser.value(dataOption);
+    QStringList scripts = parser.values(scriptOption);
+    if (scripts.isEmpty())
+        scripts = QDir(dataPath).entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+
+    const int iterations = qMax(1, parser.value(iterationsOption).toInt());
+    QList<int> concurrencyLevels;
+    const QStringList levels = parser.value(concurrencyOption).split(QLatin1Char(','), Qt::SkipEmptyParts);
+    for (const QString &level : levels) {
+        const int concurrency = level.trimmed().toInt();
+        if (concurrency > 0)
+            concurrencyLevels.append(concurrency);
+    }
+
+    QJsonArray scriptReports;
+    for (const QString &script : qAsConst(scripts))
+        scriptReports.append(benchmarkScript(backend.data(), dataPath, script, iterations, concurrencyLevels));
+
+    QJsonObject report;
+    report.insert(QStringLiteral("backend"), backend->name());
+    report.insert(QStringLiteral("scripts"), scriptReports);
+    report.insert(QStringLiteral("peakRssKiB"), peakResidentSetSizeKiB());
+
+    const QByteArray json = QJsonDocument(report).toJson();
+    if (parser.isSet(outputOption)) {
+        QFile file(parser.value(outputOption));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qCritical("Cannot write %s", qPrintable(file.fileName()));
+            return 1;
+        }
+        file.write(json);
+    } else {
+        QTextStream(stdout) << json;
+    }
+
+    return 0;
+}
+
+#include "main.moc"
@@ -0,0 +1,165 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Virtual Keyboard module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "unipenreader.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDirIterator>
+#include <QRegularExpression>
+
+/*
+    Unipen files are named <unicode>_<confidence>_<index>.txt, where the
+    unicode is the expected character in decimal format. See
+    tests/auto/inputpanel/hwr_test_data/README.txt.
+*/
+
+QString UnipenSample::expectedText() const
+{
+    const char32_t ucs4 = unicode;
+    return QString::fromUcs4(&ucs4, 1);
+}
+
+int UnipenSample::pointCount() const
+{
+    int count = 0;
+    for (const QVector<UnipenPoint> &trace : traces)
+        count += trace.size();
+    return count;
+}
+
+bool UnipenReader::readFile(const QString &fileName, UnipenSample &sample, QString *errorString)
+{
+    static const QRegularExpression fileNamePattern(QStringLiteral("^([0-9]{2,9}).*\\.txt$"));
+
+    const QRegularExpressionMatch match = fileNamePattern.match(QFileInfo(fileName).fileName());
+    if (!match.hasMatch()) {
+        if (errorString)
+            *errorString = QStringLiteral("%1: not a Unipen file name").arg(fileName);
+        return false;
+    }
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        if (errorString)
+            *errorString = QStringLiteral("%1: %2").arg(fileName, file.errorString());
+        return false;
+    }
+
+    sample = UnipenSample();
+    sample.fileName = fileName;
+    sample.unicode = match.captured(1).toUInt();
+
+    QVector<UnipenPoint> trace;
+    bool penDown = false;
+    int timeColumn = -1;
+    int xColumn = 0;
+    int yColumn = 1;
+
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine().trimmed();
+        if (line.isEmpty())
+            continue;
+
+        const QList<QByteArray> parts = line.simplified().split(' ');
+        if (line.startsWith('.')) {
+            const QByteArray &keyword = parts.first();
+            if (keyword == ".PEN_DOWN") {
+                trace.clear();
+                penDown = true;
+            } else if (keyword == ".PEN_UP") {
+                if (penDown && !trace.isEmpty())
+                    sample.traces.append(trace);
+                trace.clear();
+                penDown = false;
+            } else if (keyword == ".COORD") {
+                for (int i = 1; i < parts.size(); ++i) {
+                    if (parts.at(i) == "X")
+                        xColumn = i - 1;
+                    else if (parts.at(i) == "Y")
+                        yColumn = i - 1;
+                    else if (parts.at(i) == "T")
+                        timeColumn = i - 1;
+                }
+                sample.hasTime = timeColumn != -1;
+            } else if (parts.size() == 2) {
+                if (keyword == ".X_DIM")
+                    sample.xDim = parts.at(1).toInt();
+                else if (keyword == ".Y_DIM")
+                    sample.yDim = parts.at(1).toInt();
+                else if (keyword == ".X_POINTS_PER_INCH")
+                    sample.pointsPerInch = parts.at(1).toInt();
+                else if (keyword == ".POINTS_PER_SECOND")
+                    sample.pointsPerSecond = parts.at(1).toInt();
+            }
+            continue;
+        }
+
+        if (!penDown)
+            continue;
+
+        const int columns = qMax(qMax(xColumn, yColumn), timeColumn) + 1;
+        if (parts.size() < columns) {
+            if (errorString)
+                *errorString = QStringLiteral("%1: invalid point data").arg(fileName);
+            return false;
+        }
+
+        UnipenPoint point;
+        point.x = parts.at(xColumn).toInt();
+        point.y = parts.at(yColumn).toInt();
+        point.t = timeColumn != -1 ? parts.at(timeColumn).toInt() : 0;
+        trace.append(point);
+    }
+
+    if (sample.traces.isEmpty()) {
+        if (errorString)
+            *errorString = QStringLiteral("%1: no traces").arg(fileName);
+        return false;
+    }
+
+    return true;
+}
+
+QList<UnipenSample> UnipenReader::readDirectory(const QString &path, QString *errorString)
+{
+    QStringList fileNames;
+    QDirIterator it(path, QStringList() << QStringLiteral("*.txt"), QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext())
+        fileNames.append(it.next());
+    fileNames.sort();
+
+    QList<UnipenSample> samples;
+    for (const QString &fileName : qAsConst(fileNames)) {
+        UnipenSample sample;
+        if (readFile(fileName, sample, errorString))
+            samples.append(sample);
+    }
+    return samples;
+}
@@ -0,0 +1,66 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Virtual Keyboard module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef UNIPENREADER_H
+#define UNIPENREADER_H
+
+#include <QString>
+#include <QVector>
+#include <QList>
+
+struct UnipenPoint
+{
+    int x;
+    int y;
+    int t;
+};
+
+struct UnipenSample
+{
+    QString fileName;
+    uint unicode = 0;
+    int xDim = 0;
+    int yDim = 0;
+    int pointsPerInch = 96;
+    int pointsPerSecond = 60;
+    bool hasTime = false;
+    QVector<QVector<UnipenPoint>> traces;
+
+    QString expectedText() const;
+    int pointCount() const;
+};
+
+class UnipenReader
+{
+public:
+    static bool readFile(const QString &fileName, UnipenSample &sample, QString *errorString = nullptr);
+    static QList<UnipenSample> readDirectory(const QString &path, QString *errorString = nullptr);
+};
+
+#endif // UNIPENREADER_H
@@ -0,0 +1,15 @@
+TEMPLATE = app
+TARGET = tst_bench_inputmethods
+
+CONFIG += benchmark
+macos:CONFIG -= app_bundle
+
+QT += testlib qml quick virtualkeyboard virtualkeyboard-private
+
+static {
+    QT += svg
+    QTPLUGIN += qtvirtualkeyboardplugin
+}
+
+SOURCES += $$PWD/tst_bench_inputmethods.cpp
+
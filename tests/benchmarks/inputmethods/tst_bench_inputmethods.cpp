@@ -0,0 +1,379 @@
+/****************************************************************************
+**
+** Copyright (C) 2020 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Virtual Keyboard module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/qtest.h>
+#include <QtQml/qqmlcomponent.h>
+#include <QtQml/qqmlengine.h>
+#include <QtQuick/qquickwindow.h>
+#include <QtVirtualKeyboard/qvirtualkeyboardinputcontext.h>
+#include <QtVirtualKeyboard/qvirtualkeyboardinputengine.h>
+#include <QtVirtualKeyboard/qvirtualkeyboardabstractinputmethod.h>
+#include <QtVirtualKeyboard/private/qvirtualkeyboardinputcontext_p.h>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPointer>
+#include <QScopedPointer>
+#include <QtMath>
+#include <algorithm>
+#include <atomic>
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+static bool moduleEnv = qputenv("QT_IM_MODULE", QByteArray("qtvirtualkeyboard"));
+static bool desktopEnv = qputenv("QT_VIRTUALKEYBOARD_DESKTOP_DISABLE", QByteArray("1"));
+static bool platformEnv = qEnvironmentVariableIsSet("QT_QPA_PLATFORM") || qputenv("QT_QPA_PLATFORM", QByteArray("offscreen"));
+
+static std::atomic<quint64> allocationCount(0);
+
+#if defined(__GLIBC__)
+#define ALLOCATION_COUNTING
+/*  Count the heap allocations made by the whole process by interposing
+    the allocation functions of glibc. Operator new and the Qt containers
+    both end up in malloc.
+*/
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+
+void *malloc(size_t size) __THROW
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) __THROW
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) __THROW
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+}
+#endif
+
+static qint64 residentSetSize()
+{
+#ifdef Q_OS_LINUX
+    QFile statm(QStringLiteral("/proc/self/statm"));
+    if (statm.open(QIODevice::ReadOnly)) {
+        const QList<QByteArray> fields = statm.readAll().split(' ');
+        if (fields.size() > 1)
+            return fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE);
+    }
+#endif
+    return -1;
+}
+
+struct Keystroke
+{
+    Qt::Key key;
+    QString text;
+};
+
+/*  Parses a keystroke corpus. Each character is one key press, except
+    for a group in braces, which is a single key with multiple characters
+    (e.g. a multitap key), and "\b", which is a backspace. The end of
+    each line is a return key press.
+*/
+static QList<Keystroke> parseCorpus(const QString &corpus)
+{
+    QList<Keystroke> keystrokes;
+    const QStringList lines = corpus.split(QLatin1Char('\n'), Qt::SkipEmptyParts);
+    for (const QString &line : lines) {
+        for (int i = 0; i < line.length(); ++i) {
+            const QChar c = line.at(i);
+            if (c == QLatin1Char('{')) {
+                const int end = line.indexOf(QLatin1Char('}'), i + 1);
+                if (end > i + 1) {
+                    const QString text = line.mid(i + 1, end - i - 1);
+                    keystrokes.append({static_cast<Qt::Key>(text.at(0).toUpper().unicode()), text});
+                    i = end;
+                    continue;
+                }
+            } else if (c == QLatin1Char('\\') && i + 1 < line.length() && line.at(i + 1) == QLatin1Char('b')) {
+                keystrokes.append({Qt::Key_Backspace, QString()});
+                ++i;
+                continue;
+            } else if (c == QLatin1Char(' ')) {
+                keystrokes.append({Qt::Key_Space, QStringLiteral(" ")});
+                continue;
+            }
+            keystrokes.append({static_cast<Qt::Key>(c.toUpper().unicode()), QString(c)});
+        }
+        keystrokes.append({Qt::Key_Return, QStringLiteral("\n")});
+    }
+    return keystrokes;
+}
+
+static QJsonObject percentiles(QList<qint64> samples)
+{
+    QJsonObject result;
+    if (samples.isEmpty())
+        return result;
+    std::sort(samples.begin(), samples.end());
+    auto at = [&samples](qreal percentile) {
+        const int rank = qBound(0, qCeil(percentile / 100.0 * samples.size()) - 1, int(samples.size()) - 1);
+        return samples.at(rank) / 1000.0;
+    };
+    result.insert(QStringLiteral("count"), int(samples.size()));
+    result.insert(QStringLiteral("p50"), at(50));
+    result.insert(QStringLiteral("p90"), at(90));
+    result.insert(QStringLiteral("p99"), at(99));
+    result.insert(QStringLiteral("max"), samples.last() / 1000.0);
+    return result;
+}
+
+/*  Replays a keystroke corpus through each input method, without the
+    keyboard UI, and reports the latency percentiles, the allocations per
+    keystroke and the resident set size as JSON.
+
+    The report is written to the file named by the environment variable
+    QT_VIRTUALKEYBOARD_BENCHMARK_OUTPUT, or printed if it is not set.
+    QT_VIRTUALKEYBOARD_BENCHMARK_ITERATIONS sets the number of measured
+    passes over each corpus.
+*/
+class tst_bench_inputmethods : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void replay_data();
+    void replay();
+
+private:
+    void pressKey(const Keystroke &keystroke);
+    void waitForCandidates(int quietPeriod);
+
+    QQmlEngine engine;
+    QScopedPointer<QQuickWindow> window;
+    QPointer<QVirtualKeyboardInputContext> inputContext;
+    QJsonArray results;
+    qint64 lastCandidateUpdate = 0;
+    QElapsedTimer clock;
+};
+
+void tst_bench_inputmethods::initTestCase()
+{
+    QQmlComponent component(&engine, QUrl::fromLocalFile(QFINDTESTDATA("data/scene.qml")));
+    window.reset(qobject_cast<QQuickWindow *>(component.create()));
+    QVERIFY2(window, qPrintable(component.errorString()));
+    inputContext = window->property("inputContext").value<QVirtualKeyboardInputContext *>();
+    QVERIFY(inputContext);
+
+    window->show();
+    window->requestActivate();
+    QVERIFY(QTest::qWaitForWindowActive(window.data()));
+    QTRY_VERIFY(inputContext->priv()->focus());
+    clock.start();
+}
+
+void tst_bench_inputmethods::cleanupTestCase()
+{
+    const QJsonObject report {
+        {QStringLiteral("benchmark"), QStringLiteral("inputmethods")},
+        {QStringLiteral("unit"), QStringLiteral("us")},
+        {QStringLiteral("allocationCounting"),
+#ifdef ALLOCATION_COUNTING
+         true
+#else
+         false
+#endif
+        },
+        {QStringLiteral("results"), results}
+    };
+    const QString fileName = qEnvironmentVariable("QT_VIRTUALKEYBOARD_BENCHMARK_OUTPUT");
+    if (fileName.isEmpty()) {
+        qInfo("%s", QJsonDocument(report).toJson().constData());
+    } else {
+        QFile file(fileName);
+        QVERIFY2(file.open(QIODevice::WriteOnly | QIODevice::Truncate), qPrintable(file.errorString()));
+        file.write(QJsonDocument(report).toJson());
+        qInfo("Results written to %s", qPrintable(fileName));
+    }
+    window.reset();
+}
+
+void tst_bench_inputmethods::replay_data()
+{
+    QTest::addColumn<QString>("inputMethodType");
+    QTest::addColumn<QString>("locale");
+    QTest::addColumn<int>("inputMode");
+    QTest::addColumn<QString>("corpus");
+    QTest::addColumn<bool>("asynchronous");
+
+    typedef QVirtualKeyboardInputEngine::InputMode InputMode;
+    QTest::newRow("hunspell") << "HunspellInputMethod" << "en_GB" << int(InputMode::Latin) << "english.txt" << true;
+    QTest::newRow("plain") << "PlainInputMethod" << "en_GB" << int(InputMode::Latin) << "english.txt" << false;
+    QTest::newRow("multitap") << "MultitapInputMethod" << "en_GB" << int(InputMode::Latin) << "multitap.txt" << false;
+    QTest::newRow("pinyin") << "PinyinInputMethod" << "zh_CN" << int(InputMode::Pinyin) << "pinyin.txt" << false;
+    QTest::newRow("cangjie") << "TCInputMethod" << "zh_TW" << int(InputMode::Cangjie) << "cangjie.txt" << false;
+    QTest::newRow("zhuyin") << "TCInputMethod" << "zh_TW" << int(InputMode::Zhuyin) << "zhuyin.txt" << false;
+    QTest::newRow("openwnn") << "JapaneseInputMethod" << "ja_JP" << int(InputMode::Hiragana) << "japanese.txt" << false;
+    QTest::newRow("hangul") << "HangulInputMethod" << "ko_KR" << int(InputMode::Hangul) << "korean.txt" << false;
+    QTest::newRow("thai") << "ThaiInputMethod" << "th_TH" << int(InputMode::Latin) << "thai.txt" << false;
+}
+
+void tst_bench_inputmethods::pressKey(const Keystroke &keystroke)
+{
+    QVirtualKeyboardInputEngine *inputEngine = inputContext->inputEngine();
+    inputEngine->virtualKeyPress(keystroke.key, keystroke.text, Qt::NoModifier, false);
+    inputEngine->virtualKeyRelease(keystroke.key, keystroke.text, Qt::NoModifier);
+}
+
+void tst_bench_inputmethods::waitForCandidates(int quietPeriod)
+{
+    // Let queued work run, and wait for asynchronous candidate updates to settle
+    QElapsedTimer timeout;
+    timeout.start();
+    qint64 lastUpdate = lastCandidateUpdate;
+    QElapsedTimer quiet;
+    quiet.start();
+    do {
+        QCoreApplication::processEvents(QEventLoop::AllEvents, quietPeriod);
+        if (lastCandidateUpdate != lastUpdate) {
+            lastUpdate = lastCandidateUpdate;
+            quiet.restart();
+        }
+    } while (quiet.elapsed() < quietPeriod && timeout.elapsed() < 1000);
+}
+
+void tst_bench_inputmethods::replay()
+{
+    QFETCH(QString, inputMethodType);
+    QFETCH(QString, locale);
+    QFETCH(int, inputMode);
+    QFETCH(QString, corpus);
+    QFETCH(bool, asynchronous);
+
+    QFile corpusFile(QFINDTESTDATA(QStringLiteral("data/") + corpus));
+    QVERIFY2(corpusFile.open(QIODevice::ReadOnly | QIODevice::Text), qPrintable(corpusFile.errorString()));
+    const QList<Keystroke> keystrokes = parseCorpus(QString::fromUtf8(corpusFile.readAll()));
+    QVERIFY(!keystrokes.isEmpty());
+
+    const qint64 rssBefore = residentSetSize();
+
+    QQmlComponent component(&engine);
+    component.setData(QStringLiteral("import QtQuick 2.0\n"
+                                     "import QtQuick.VirtualKeyboard 2.3\n"
+                                     "import QtQuick.VirtualKeyboard.Plugins 2.3\n"
+                                     "%1 {}\n").arg(inputMethodType).toUtf8(), QUrl());
+    QScopedPointer<QObject> object(component.create());
+    QVirtualKeyboardAbstractInputMethod *inputMethod = qobject_cast<QVirtualKeyboardAbstractInputMethod *>(object.data());
+    if (!inputMethod)
+        QSKIP(qPrintable(inputMethodType + QLatin1String(" is not available: ") + component.errorString()));
+
+    connect(inputMethod, &QVirtualKeyboardAbstractInputMethod::selectionListChanged, this, [this](QVirtualKeyboardSelectionListModel::Type type) {
+        if (type == QVirtualKeyboardSelectionListModel::Type::WordCandidateList)
+            lastCandidateUpdate = clock.nsecsElapsed();
+    });
+
+    QVirtualKeyboardInputEngine *inputEngine = inputContext->inputEngine();
+    inputContext->priv()->setLocale(locale);
+    inputEngine->setInputMethod(inputMethod);
+    if (!inputEngine->inputModes().contains(inputMode))
+        QSKIP(qPrintable(inputMethodType + QLatin1String(" does not support the input mode for ") + locale));
+    inputEngine->setInputMode(static_cast<QVirtualKeyboardInputEngine::InputMode>(inputMode));
+
+    QObject *textInput = window->property("textInput").value<QObject *>();
+    const int quietPeriod = asynchronous ? 20 : 0;
+    const int iterations = qMax(1, qEnvironmentVariableIntValue("QT_VIRTUALKEYBOARD_BENCHMARK_ITERATIONS"));
+
+    QList<qint64> keystrokeLatencies;
+    QList<qint64> candidateLatencies;
+    quint64 keystrokeAllocations = 0;
+    quint64 waitAllocations = 0;
+
+    // The first pass is a warm-up, which also gives dictionaries time to load
+    for (int pass = 0; pass <= iterations; ++pass) {
+        const bool measure = pass > 0;
+        inputMethod->reset();
+        textInput->setProperty("text", QString());
+        waitForCandidates(quietPeriod);
+        for (const Keystroke &keystroke : keystrokes) {
+            const qint64 candidateUpdateBefore = lastCandidateUpdate;
+            // The allocations of the key press itself are counted apart from
+            // those of the event loop and rendering while waiting
+            const quint64 allocationsBefore = allocationCount.load(std::memory_order_relaxed);
+            const qint64 start = clock.nsecsElapsed();
+            pressKey(keystroke);
+            const qint64 end = clock.nsecsElapsed();
+            const quint64 allocationsAfter = allocationCount.load(std::memory_order_relaxed);
+            waitForCandidates(quietPeriod);
+            if (!measure)
+                continue;
+            keystrokeAllocations += allocationsAfter - allocationsBefore;
+            waitAllocations += allocationCount.load(std::memory_order_relaxed) - allocationsAfter;
+            keystrokeLatencies.append(end - start);
+            if (lastCandidateUpdate != candidateUpdateBefore)
+                candidateLatencies.append(lastCandidateUpdate - start);
+        }
+    }
+
+    const qint64 rssAfter = residentSetSize();
+    const int keystrokeCount = int(keystrokeLatencies.size());
+    QJsonObject result {
+        {QStringLiteral("name"), QLatin1String(QTest::currentDataTag())},
+        {QStringLiteral("inputMethod"), inputMethodType},
+        {QStringLiteral("locale"), locale},
+        {QStringLiteral("keystrokes"), keystrokeCount},
+        {QStringLiteral("keystrokeLatency"), percentiles(keystrokeLatencies)},
+        {QStringLiteral("candidateListBuildTime"), percentiles(candidateLatencies)},
+        {QStringLiteral("rss"), rssAfter},
+        {QStringLiteral("rssDelta"), rssBefore >= 0 && rssAfter >= 0 ? rssAfter - rssBefore : -1}
+    };
+#ifdef ALLOCATION_COUNTING
+    result.insert(QStringLiteral("allocationsPerKeystroke"), keystrokeCount ? qreal(keystrokeAllocations) / keystrokeCount : 0.0);
+    result.insert(QStringLiteral("allocationsPerCandidateWait"), keystrokeCount ? qreal(waitAllocations) / keystrokeCount : 0.0);
+#endif
+    results.append(result);
+
+    const QJsonObject latency = result.value(QStringLiteral("keystrokeLatency")).toObject();
+    qInfo("%s: p50 %.1f us, p99 %.1f us over %d keystrokes",
+          QTest::currentDataTag(),
+          latency.value(QStringLiteral("p50")).toDouble(),
+          latency.value(QStringLiteral("p99")).toDouble(),
+          keystrokeCount);
+
+    inputEngine->setInputMethod(nullptr);
+}
+
+QTEST_MAIN(tst_bench_inputmethods)
+
+#include "tst_bench_inputmethods.moc"